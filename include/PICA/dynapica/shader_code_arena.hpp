@@ -0,0 +1,52 @@
+#pragma once
+
+// Only do anything if we're on a target with shader JIT support
+#if defined(PANDA3DS_DYNAPICA_SUPPORTED) && (defined(PANDA3DS_X64_HOST) || defined(PANDA3DS_ARM64_HOST))
+#include <map>
+#include <memory>
+
+#include "helpers.hpp"
+
+#ifdef PANDA3DS_X64_HOST
+#include "xbyak/xbyak.h"
+#elif defined(PANDA3DS_ARM64_HOST)
+#include <oaknut/code_block.hpp>
+#endif
+
+// A single block of executable memory shared by all JIT-compiled PICA shaders. Shaders are emitted into a scratch buffer first and only the
+// bytes they actually use get copied in here, so that each cached shader only costs as much memory as its code.
+// The code emitted by the shader recompilers is position-independent, so it can be freely moved around.
+class ShaderCodeArena {
+#ifdef PANDA3DS_X64_HOST
+	std::unique_ptr<Xbyak::CodeArray> memory;
+#elif defined(PANDA3DS_ARM64_HOST)
+	std::unique_ptr<oaknut::CodeBlock> memory;
+#endif
+
+	u8* base = nullptr;
+	usize capacity = 0;
+	usize used = 0;
+
+	// Free ranges of the arena as {offset, size} pairs sorted by offset. Neighbouring free ranges are always merged
+	std::map<usize, usize> freeRanges;
+
+  public:
+	// Allocations are cache line aligned. This also keeps the alignment the emitters expect for their constants
+	static constexpr usize alignment = 64;
+
+	// Allocate the backing memory, throwing away everything that was in the arena before
+	void init(usize newCapacity);
+	// Free all allocations, keeping the backing memory around
+	void clear();
+	bool isInitialized() const { return base != nullptr; }
+
+	// Copy "size" bytes of code into the arena. Returns a pointer to the copy, or nullptr if there's no free range big enough
+	u8* add(const u8* code, usize size);
+	void free(u8* code, usize size);
+
+	usize getCapacity() const { return capacity; }
+	usize getUsed() const { return used; }
+	usize getLargestFreeRange() const;
+};
+
+#endif  // Shader JIT check
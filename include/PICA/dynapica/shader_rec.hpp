@@ -1,10 +1,18 @@
 #pragma once
+#include <algorithm>
+
 #include "PICA/shader.hpp"
+#include "helpers.hpp"
 
 #if defined(PANDA3DS_DYNAPICA_SUPPORTED) && (defined(PANDA3DS_X64_HOST) || defined(PANDA3DS_ARM64_HOST))
 #define PANDA3DS_SHADER_JIT_SUPPORTED
+#include <list>
 #include <memory>
 #include <unordered_map>
+#include <vector>
+
+#include "PICA/dynapica/shader_code_arena.hpp"
+#include "logger.hpp"
 
 #ifdef PANDA3DS_X64_HOST
 #include "shader_rec_emitter_x64.hpp"
@@ -14,18 +22,65 @@
 #endif
 
 class ShaderJIT {
+  public:
+	struct MemoryStats {
+		usize arenaCapacity = 0;  // Size of the executable memory arena in bytes
+		usize arenaUsed = 0;      // Bytes of the arena occupied by compiled code
+		usize cachedShaders = 0;  // Number of shader + operand descriptor combinations in the cache
+		usize uniqueBlocks = 0;   // Number of distinct compiled programs in the arena. Lower than cachedShaders when deduplication kicks in
+		u64 compilations = 0;
+		u64 dedupHits = 0;  // Compilations that produced code identical to an already cached program
+		u64 evictions = 0;
+	};
+
+  private:
 #ifdef PANDA3DS_SHADER_JIT_SUPPORTED
 	using Hash = PICAShader::Hash;
-	using ShaderCache = std::unordered_map<Hash, std::unique_ptr<ShaderEmitter>>;
+
+	// A compiled program living in the code arena. Different shaders can compile to the exact same code (eg if they only differ in operand
+	// descriptors they never use), in which case they share a block
+	struct CodeBlock {
+		u8* code;
+		usize size;
+		u32 refCount;
+	};
+
+	struct CachedShader {
+		Hash blockHash;  // Hash of the compiled code, used as the key for the code block
+		// Offsets of the prologue and of the compiled code for the entrypoint, relative to the start of the block. The code hash covers the
+		// entrypoint, so every entry only ever starts from a single one
+		u32 prologueOffset;
+		u32 entrypointOffset;
+		std::list<Hash>::iterator lruPosition;
+	};
+
 	ShaderEmitter::PrologueCallback prologueCallback;
 	ShaderEmitter::InstructionCallback entrypointCallback;
 
-	ShaderCache cache;
+	ShaderCodeArena arena;
+	std::unordered_map<Hash, CachedShader> cache;
+	std::unordered_map<Hash, CodeBlock> blocks;
+	// Cached shader hashes, from most to least recently used
+	std::list<Hash> lru;
+	MemoryStats stats;
+
+	void evictLeastRecentlyUsed();
+	// Compile the current shader and add it to the cache, evicting old shaders if we're over budget
+	CachedShader& compile(PICAShader& shaderUnit, Hash hash);
+
+	MAKE_LOG_FUNCTION(log, shaderJITLogger)
 #endif
 	bool accurateMul = false;
+	usize memoryBudget = 32_MB;
+	// Maximum number of cached shaders. Deduplicated shaders don't take up any room in the arena, so this also bounds the cache when the
+	// arena never fills up
+	usize maxCachedShaders = 4096;
 
   public:
 	void setAccurateMul(bool value) { accurateMul = value; }
+	// Set the maximum amount of executable memory to use for compiled shaders. Takes effect on the next reset
+	void setMemoryBudget(usize bytes) { memoryBudget = bytes; }
+	void setMaxCachedShaders(usize count) { maxCachedShaders = std::max<usize>(count, 1); }
 
 #ifdef PANDA3DS_SHADER_JIT_SUPPORTED
 	// Call this before starting to process a batch of vertices
@@ -35,6 +90,7 @@ class ShaderJIT {
 	void prepare(PICAShader& shaderUnit);
 	void reset();
 	void run(PICAShader& shaderUnit) { prologueCallback(shaderUnit, entrypointCallback); }
+	MemoryStats getMemoryStats() const;
 
 	static constexpr bool isAvailable() { return true; }
 #else
@@ -51,6 +107,7 @@ class ShaderJIT {
 	Callback activeShaderCallback = nullptr;
 
 	void reset() {}
+	MemoryStats getMemoryStats() const { return {}; }
 	static constexpr bool isAvailable() { return false; }
 #endif
-};
\ No newline at end of file
+};
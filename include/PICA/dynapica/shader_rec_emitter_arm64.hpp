@@ -41,6 +41,8 @@ class ShaderEmitter : private oaknut::CodeBlock, public oaknut::CodeGenerator {
 	bool useSafeMUL = false;
 
 	oaknut::Label log2Func, exp2Func;
+	// Placed right after the last emitted instruction, for figuring out how big the compiled shader is
+	oaknut::Label codeEnd;
 	oaknut::Label emitLog2Func();
 	oaknut::Label emitExp2Func();
 
@@ -132,6 +134,12 @@ class ShaderEmitter : private oaknut::CodeBlock, public oaknut::CodeGenerator {
 
 	PrologueCallback getPrologueCallback() { return prologueCb; }
 	void compile(const PICAShader& shaderUnit);
+
+	// The emitted code and offsets into it, for when the code gets copied elsewhere
+	const u8* getCode() { return reinterpret_cast<const u8*>(oaknut::CodeBlock::ptr()); }
+	usize getSize() { return usize(codeEnd.offset()); }
+	usize getInstructionOffset(u32 pc) { return usize(instructionLabels.at(pc).offset()); }
+	usize getPrologueOffset() { return usize(reinterpret_cast<const u8*>(prologueCb) - getCode()); }
 };
 
 #endif  // arm64 recompiler check
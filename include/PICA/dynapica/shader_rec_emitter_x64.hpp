@@ -154,6 +154,10 @@ class ShaderEmitter : public Xbyak::CodeGenerator {
 	}
 
 	PrologueCallback getPrologueCallback() { return prologueCb; }
+
+	// Offsets into the emitted code, for when the code gets copied elsewhere. The code size and pointer come from Xbyak's getSize and getCode
+	usize getInstructionOffset(u32 pc) { return usize(instructionLabels.at(pc).getAddress() - getCode()); }
+	usize getPrologueOffset() { return usize(reinterpret_cast<const u8*>(prologueCb) - getCode()); }
 };
 
 #endif  // x64 recompiler check
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 #include <array>
+#include <atomic>
+#include <span>
+#include <vector>
 
 #include "PICA/draw_acceleration.hpp"
 #include "PICA/dynapica/shader_rec.hpp"
@@ -20,6 +23,12 @@ enum class ShaderExecMode {
 	Hardware,     // Recompiler shaders to host shaders and run them on the GPU
 };
 
+// Per-frame counters for draw batching
+struct DrawBatchStats {
+	u64 drawsIn = 0;   // Draws issued by the PICA command lists
+	u64 drawsOut = 0;  // Draws submitted to the renderer after merging
+};
+
 class GPU {
 	static constexpr u32 regNum = 0x300;
 	static constexpr u32 extRegNum = 0x1000;
@@ -49,6 +58,26 @@ class GPU {
 	// Previous value for GPUREG_VSH_OUTMAP_MASK
 	u32 oldVsOutputMask;
 
+	// Mask of PICA::DirtyRegs groups modified since the last draw
+	u32 dirtyRegGroups = PICA::DirtyRegs::All;
+
+	// Where each shader output component ends up in the output vertex, derived from the shader output map registers.
+	// Recomputed only when the relevant register groups are dirty, instead of decoding the output map for every vertex
+	struct OutputMapping {
+		Floats::f24* source;
+		u32 target;
+	};
+	std::array<OutputMapping, 7 * 4> outputMappings;
+	u32 outputMappingCount = 0;
+
+	// Recompute state derived from the internal registers that were modified since the last draw
+	void updateDerivedState();
+	void mapShaderOutputs(PICA::Vertex& out) {
+		for (u32 i = 0; i < outputMappingCount; i++) {
+			out.raw[outputMappings[i].target] = *outputMappings[i].source;
+		}
+	}
+
 	uint immediateModeVertIndex;
 	uint immediateModeAttrIndex;  // Index of the immediate mode attribute we're uploading
 
@@ -58,6 +87,27 @@ class GPU {
 	// Silly method of avoiding linking problems. TODO: Change to something less silly
 	void drawArrays(bool indexed);
 
+	// Consecutive CPU-shaded draws are merged into a single triangle list, as games tend to issue long runs of small draws with the same state.
+	// Writes to registers outside of these groups can affect how the pending vertices are rendered, so they flush the batch first.
+	// The vertex pipeline and shader groups are fine to change, as the batched vertices have already gone through the vertex shader
+	static constexpr u32 batchSafeRegGroups = PICA::DirtyRegs::GeometryPipeline | PICA::DirtyRegs::GeometryShader | PICA::DirtyRegs::VertexShader;
+
+	struct DrawBatch {
+		std::vector<PICA::Vertex> vertices;
+		PICA::PrimType primType = PICA::PrimType::TriangleList;
+		u32 drawCount = 0;
+	} drawBatch;
+
+	DrawBatchStats drawBatchStats;
+	DrawBatchStats lastFrameDrawBatchStats;
+
+	// Set while emulating a frame that won't be presented, if rendering of skipped frames is disabled. Read by the GX thread
+	std::atomic<bool> skipDraws = false;
+
+	// Send the vertices of a CPU-shaded draw to the renderer, merging them into the pending batch if possible
+	void submitVertices(PICA::PrimType primType, std::span<const PICA::Vertex> vertices);
+	bool hasPendingDraws() const { return drawBatch.drawCount != 0; }
+
 	struct AttribInfo {
 		u32 offset = 0;  // Offset from base vertex array
 		int size = 0;    // Bytes per vertex
@@ -105,9 +155,25 @@ class GPU {
 	std::array<uint32_t, 128> fogLUT;
 
 	GPU(Memory& mem, EmulatorConfig& config);
-	void display() { renderer->display(); }
-	void screenshot(const std::string& name) { renderer->screenshot(name); }
-	void deinitGraphicsContext() { renderer->deinitGraphicsContext(); }
+	void display();
+	void screenshot(const std::string& name) {
+		flushDrawBatch();
+		renderer->screenshot(name);
+	}
+
+	void deinitGraphicsContext() {
+		flushDrawBatch();
+		renderer->deinitGraphicsContext();
+	}
+
+	// Submit the pending batched draws to the renderer. Needs to be called before anything that reads or modifies render targets
+	void flushDrawBatch();
+	// Draw batching counters for the last frame that was displayed
+	const DrawBatchStats& getDrawBatchStats() const { return lastFrameDrawBatchStats; }
+
+	// Drop the draws of a frame that isn't going to be presented. Display transfers and texture copies still happen, but render targets
+	// keep their old contents, so effects that render to a texture and sample it in a later frame can show stale data
+	void setSkipDraws(bool skip) { skipDraws.store(skip, std::memory_order_relaxed); }
 
 	void initGraphicsContext(void* context) { renderer->initGraphicsContext(context); }
 
@@ -117,6 +183,13 @@ class GPU {
 	Registers& getRegisters() { return regs; }
 	ExternalRegisters& getExtRegisters() { return externalRegs; }
 	void startCommandList(u32 addr, u32 size);
+	// Execute a command list located in host memory. Size is in bytes
+	void runCommandList(u32* start, u32 size);
+
+	// Groups of internal registers (See PICA::DirtyRegs) modified since the last draw. Renderers can use this in prepareForDraw to skip
+	// recomputing state whose inputs didn't change. The mask is cleared after every draw, so renderers need to accumulate it themselves
+	// if they need to remember changes across draws
+	u32 getDirtyRegGroups() const { return dirtyRegGroups; }
 
 	// Used by the GSP GPU service for readHwRegs/writeHwRegs/writeHwRegsMasked
 	u32 readReg(u32 address);
@@ -136,15 +209,20 @@ class GPU {
 
 	// TODO: Emulate the transfer engine & its registers
 	// Then this can be emulated by just writing the appropriate values there
-	void clearBuffer(u32 startAddress, u32 endAddress, u32 value, u32 control) { renderer->clearBuffer(startAddress, endAddress, value, control); }
+	void clearBuffer(u32 startAddress, u32 endAddress, u32 value, u32 control) {
+		flushDrawBatch();
+		renderer->clearBuffer(startAddress, endAddress, value, control);
+	}
 
 	// TODO: Emulate the transfer engine & its registers
 	// Then this can be emulated by just writing the appropriate values there
 	void displayTransfer(u32 inputAddr, u32 outputAddr, u32 inputSize, u32 outputSize, u32 flags) {
+		flushDrawBatch();
 		renderer->displayTransfer(inputAddr, outputAddr, inputSize, outputSize, flags);
 	}
 
 	void textureCopy(u32 inputAddr, u32 outputAddr, u32 totalBytes, u32 inputSize, u32 outputSize, u32 flags) {
+		flushDrawBatch();
 		renderer->textureCopy(inputAddr, outputAddr, totalBytes, inputSize, outputSize, flags);
 	}
 
@@ -0,0 +1,110 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "helpers.hpp"
+#include "ring_buffer.hpp"
+
+// A unit of GPU work recorded by the emulator thread to be executed on the GPU thread
+struct GPUThreadCommand {
+	enum class Type : u32 {
+		GX = 0,             // A GX command from a GSP command queue. The payload is the command as it was in GSP shared memory
+		WriteRegister = 1,  // A masked GPU register write. The payload is {address, value, mask}
+	};
+
+	Type type;
+	u32 gspThread;  // For GX commands, the index of the GSP thread whose command queue the command came from
+	std::array<u32, 8> payload;
+};
+static_assert(std::is_trivial_v<GPUThreadCommand>, "GPU thread commands need to be trivially copyable to be pushed to the command ring");
+
+// Keeps track of the physical memory ranges that in-flight GPU thread commands read from or write to, so that the emulator thread knows when it
+// needs to wait for the GPU thread before touching guest memory. Only accessed from the emulator thread.
+class GPUHazardTracker {
+	struct Range {
+		u32 start;
+		u32 end;
+		u64 sequence;  // Sequence number of the command that uses this range
+	};
+
+	std::vector<Range> ranges;
+
+  public:
+	void add(u32 paddr, u32 size, u64 sequence) {
+		if (size != 0) {
+			ranges.push_back({paddr, paddr + size, sequence});
+		}
+	}
+
+	// Drop all ranges belonging to commands that have finished executing
+	void retire(u64 completedSequence) {
+		std::erase_if(ranges, [completedSequence](const Range& range) { return range.sequence <= completedSequence; });
+	}
+
+	// Returns the sequence number of the last command that uses memory overlapping [paddr, paddr + size), or 0 if there's none
+	u64 findHazard(u32 paddr, u32 size) const {
+		u64 sequence = 0;
+		const u32 end = paddr + size;
+
+		for (const Range& range : ranges) {
+			if (paddr < range.end && range.start < end) {
+				sequence = std::max(sequence, range.sequence);
+			}
+		}
+
+		return sequence;
+	}
+
+	void clear() { ranges.clear(); }
+};
+
+// Dedicated thread for executing GPU work. The emulator thread records commands into a lock-free SPSC ring which the GPU thread drains in order.
+// Every command gets a sequence number, starting from 1, which the emulator thread can use to wait for specific commands to finish.
+class GPUThread {
+	using Executor = std::function<void(const GPUThreadCommand&)>;
+	static constexpr usize ringCapacity = 1024;
+
+	Common::RingBuffer<GPUThreadCommand, ringCapacity> ring;
+	Executor executor;
+	std::thread thread;
+
+	// Only used for putting the GPU thread to sleep when it runs out of work, and the emulator thread to sleep while waiting for it.
+	// Pushing and popping commands is lock-free.
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	std::condition_variable progress;
+
+	u64 submitted = 0;  // Only accessed by the emulator thread
+	std::atomic<u64> completed = 0;
+	std::atomic<bool> exiting = false;
+	// Set while the respective thread is blocked (or about to block) on a condition variable, so that the other side only has to take the mutex
+	// to notify it when it is actually sleeping
+	std::atomic<bool> gpuThreadSleeping = false;
+	std::atomic<bool> emulatorThreadWaiting = false;
+
+	void threadLoop();
+
+  public:
+	~GPUThread() { stop(); }
+
+	void start(Executor executor);
+	// Stop the GPU thread, discarding any work that hasn't been executed yet
+	void stop();
+	bool isRunning() const { return thread.joinable(); }
+
+	// Record a command for the GPU thread. Returns the sequence number of the command
+	u64 push(const GPUThreadCommand& command);
+	// Wait until the command with the specified sequence number and all commands before it have finished executing
+	void waitFor(u64 sequence);
+	void waitIdle() { waitFor(submitted); }
+
+	u64 getSubmitted() const { return submitted; }
+	u64 getCompleted() const { return completed.load(std::memory_order_acquire); }
+};
@@ -214,6 +214,48 @@ namespace PICA {
 		};
 	}
 
+	// Internal registers are split into groups based on the part of the pipeline they configure. The GPU keeps a mask of the groups that were
+	// modified since the last draw, so that state derived from the registers only needs to be recomputed when its inputs have actually changed
+	namespace DirtyRegs {
+		enum : u32 {
+			Misc = 1 << 0,              // 0x000 - 0x03F
+			Rasterizer = 1 << 1,        // 0x040 - 0x07F
+			Texturing = 1 << 2,         // 0x080 - 0x0BF
+			TexEnv = 1 << 3,            // 0x0C0 - 0x0FF, including fog and gas
+			Framebuffer = 1 << 4,       // 0x100 - 0x13F
+			Lighting = 1 << 5,          // 0x140 - 0x1FF
+			GeometryPipeline = 1 << 6,  // 0x200 - 0x27F
+			GeometryShader = 1 << 7,    // 0x280 - 0x2AF
+			VertexShader = 1 << 8,      // 0x2B0 - 0x2FF
+			All = (1 << 9) - 1,
+
+			// Groups that fragment shader configuration and fragment uniforms are derived from
+			Fragment = Rasterizer | Texturing | TexEnv | Framebuffer | Lighting,
+		};
+
+		// Index of the group that an internal register belongs to
+		inline constexpr u32 groupIndex(u32 reg) {
+			if (reg < 0x40) return 0;
+			if (reg < 0x80) return 1;
+			if (reg < 0xC0) return 2;
+			if (reg < 0x100) return 3;
+			if (reg < 0x140) return 4;
+			if (reg < 0x200) return 5;
+			if (reg < 0x280) return 6;
+			if (reg < 0x2B0) return 7;
+			return 8;
+		}
+
+		inline constexpr u32 groupOf(u32 reg) { return 1u << groupIndex(reg); }
+
+		// Mask of all groups touched by the register range [first, last]. Groups are laid out in register order, so this is a contiguous run of bits
+		inline constexpr u32 groupsInRange(u32 first, u32 last) {
+			const u32 low = groupIndex(first);
+			const u32 high = groupIndex(last);
+			return ((2u << high) - 1) & ~((1u << low) - 1);
+		}
+	}  // namespace DirtyRegs
+
 	namespace ExternalRegs {
 		enum : u32 {
 			MemFill1BufferStartPaddr = 0x3,
@@ -1,6 +1,7 @@
 #pragma once
 #include <algorithm>
 #include <array>
+#include <bitset>
 #include <cassert>
 #include <cstddef>
 #include <cstring>
@@ -132,6 +133,12 @@ class PICAShader {
 
 	Hash lastCodeHash = 0;    // Last hash computed for the shader code (Used for the JIT caching mechanism)
 	Hash lastOpdescHash = 0;  // Last hash computed for the operand descriptors (Also used for the JIT)
+	u32 lastCodeHashEntrypoint = 0;  // Entrypoint lastCodeHash was computed for
+
+	// Range of instructions that have been modified since the code hash was last computed, as [dirtyCodeStart, dirtyCodeEnd)
+	u32 dirtyCodeStart = 0;
+	u32 dirtyCodeEnd = 0;
+	u32 codeSize = 0;  // Index of the highest instruction modified since reset + 1. Everything after this is guaranteed to be 0
 
   public:
 	bool uniformsDirty = false;
@@ -236,6 +243,26 @@ class PICAShader {
 	static constexpr size_t maxInstructionCount = 4096;
 	std::array<u32, maxInstructionCount> loadedShader;  // Currently loaded & active shader
 
+  private:
+	// The code hash only covers the instructions that are reachable from the entrypoint, so that programs which only differ in dead code
+	// share the same JIT/GLSL cache entry. We keep the hashes for the last few entrypoints around along with their reachable instructions,
+	// as games often switch between a couple of entrypoints in the same program, and uploads that don't touch reachable code
+	// don't invalidate the hash.
+	struct CodeHashEntry {
+		std::bitset<maxInstructionCount> reachable;
+		Hash hash = 0;
+		u32 entrypoint = 0;
+		bool valid = false;
+	};
+
+	std::array<CodeHashEntry, 4> codeHashCache;
+	u32 nextCodeHashEntry = 0;  // Entry of the code hash cache to replace next
+
+	Hash computeCodeHash(CodeHashEntry& entry);
+	void invalidateCodeHashes();
+
+  public:
+
 	PICAShader(ShaderType type) : type(type) {}
 
 	void setBufferIndex(u32 index) { bufferIndex = index & 0xfff; }
@@ -246,17 +273,27 @@ class PICAShader {
 			Helpers::panic("o no, shader upload overflew");
 		}
 
-		loadedShader[bufferIndex++] = word;
-		bufferIndex &= 0xfff;
+		// Games tend to upload the same program over and over again, so only mark the code as dirty if it actually changed
+		if (loadedShader[bufferIndex] != word) {
+			loadedShader[bufferIndex] = word;
 
-		codeHashDirty = true;  // Signal the JIT if necessary that the program hash has potentially changed
+			const u32 index = u32(bufferIndex);
+			dirtyCodeStart = codeHashDirty ? std::min(dirtyCodeStart, index) : index;
+			dirtyCodeEnd = codeHashDirty ? std::max(dirtyCodeEnd, index + 1) : index + 1;
+			codeSize = std::max(codeSize, index + 1);
+			codeHashDirty = true;  // Signal the JIT if necessary that the program hash has potentially changed
+		}
+
+		bufferIndex = (bufferIndex + 1) & 0xfff;
 	}
 
 	void uploadDescriptor(u32 word) {
-		operandDescriptors[opDescriptorIndex++] = word;
-		opDescriptorIndex &= 0x7f;
+		if (operandDescriptors[opDescriptorIndex] != word) {
+			operandDescriptors[opDescriptorIndex] = word;
+			opdescHashDirty = true;  // Signal the JIT if necessary that the program hash has potentially changed
+		}
 
-		opdescHashDirty = true;  // Signal the JIT if necessary that the program hash has potentially changed
+		opDescriptorIndex = (opDescriptorIndex + 1) & 0x7f;
 	}
 
 	void setFloatUniformIndex(u32 word) {
@@ -311,6 +348,7 @@ class PICAShader {
 	void run();
 	void reset();
 
+	// Returns a hash of the code reachable from the current entrypoint. Programs that only differ in unreachable code hash the same
 	Hash getCodeHash();
 	Hash getOpdescHash();
 
@@ -1,6 +1,7 @@
 #pragma once
 #include <fmt/format.h>
 
+#include <bitset>
 #include <map>
 #include <set>
 #include <string>
@@ -11,9 +12,13 @@
 #include "PICA/shader.hpp"
 #include "PICA/shader_gen_types.hpp"
 
-struct EmulatorConfig;
-
 namespace PICA::ShaderGen {
+	// The settings that affect the generated code. This is kept apart from EmulatorConfig, so that background compile jobs can carry
+	// their own copy cheaply
+	struct DecompilerConfig {
+		bool accurateShaderMul = false;
+	};
+
 	// Control flow analysis is partially based on
 	// https://github.com/PabloMK7/citra/blob/d0179559466ff09731d74474322ee880fbb44b00/src/video_core/shader/generator/glsl_shader_decompiler.cpp#L33
 	struct ControlFlow {
@@ -54,6 +59,8 @@ namespace PICA::ShaderGen {
 
 		std::set<Function> functions{};
 		std::map<AddressRange, Function::ExitMode> exitMap{};
+		// Every instruction the analysis visited, ie every instruction that can be executed starting from the entrypoint
+		std::bitset<PICAShader::maxInstructionCount> reachable{};
 
 		// Tells us whether analysis of the shader we're trying to compile failed, in which case we'll need to fail back to shader emulation
 		// On the CPU
@@ -92,7 +99,7 @@ namespace PICA::ShaderGen {
 		ControlFlow controlFlow{};
 
 		PICAShader& shader;
-		EmulatorConfig& config;
+		DecompilerConfig config;
 		std::string decompiledShader;
 
 		u32 entrypoint;
@@ -121,11 +128,11 @@ namespace PICA::ShaderGen {
 		bool usesCommonEncoding(u32 instruction) const;
 
 	  public:
-		ShaderDecompiler(PICAShader& shader, EmulatorConfig& config, u32 entrypoint, API api, Language language)
+		ShaderDecompiler(PICAShader& shader, const DecompilerConfig& config, u32 entrypoint, API api, Language language)
 			: shader(shader), entrypoint(entrypoint), config(config), api(api), language(language), decompiledShader("") {}
 
 		std::string decompile();
 	};
 
-	std::string decompileShader(PICAShader& shader, EmulatorConfig& config, u32 entrypoint, API api, Language language);
+	std::string decompileShader(PICAShader& shader, const DecompilerConfig& config, u32 entrypoint, API api, Language language);
 }  // namespace PICA::ShaderGen
\ No newline at end of file
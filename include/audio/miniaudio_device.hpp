@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "audio/audio_device_interface.hpp"
+#include "audio/time_stretcher.hpp"
 #include "miniaudio.h"
 
 class MiniAudioDevice final : public AudioDeviceInterface {
@@ -16,6 +17,9 @@ class MiniAudioDevice final : public AudioDeviceInterface {
 	ma_context context;
 	ma_device_config deviceConfig;
 
+	// Only touched by the audio thread while the device is running
+	Audio::TimeStretcher timeStretcher;
+
 	// Store the last stereo sample we output. We play this when underruning to avoid pops.
 	std::vector<std::string> audioDevices;
 
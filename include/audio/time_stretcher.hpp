@@ -0,0 +1,84 @@
+#pragma once
+#include <array>
+
+#include "helpers.hpp"
+#include "ring_buffer.hpp"
+
+namespace Audio {
+	// Sits between the DSP's sample buffer and the audio device, and plays the DSP's output back faster or slower so that the amount of
+	// buffered audio stays around a target latency. This absorbs the difference between how fast the emulator produces samples and how fast
+	// the host consumes them, eg when emulation lags behind, is fast-forwarding, or the host audio clock drifts, without ever having to block
+	// the emulator or change the pitch of the audio.
+	// Uses WSOLA (Waveform Similarity Overlap-Add): the output is built out of overlapping windowed segments of the input. When stretching,
+	// segments are taken from input positions that advance slower or faster than the output does, and each segment is picked from a small
+	// search range around its nominal position so that it lines up with the previous one, so that the waveform stays continuous.
+	class TimeStretcher {
+	  public:
+		// Same as the DSP sample buffer: interleaved stereo s16 samples
+		using Samples = Common::RingBuffer<s16, 0x2000 * 2>;
+
+		static constexpr usize channelCount = 2;
+		static constexpr usize sampleRate = 32768;
+
+		// Length of a segment in stereo frames, ~15.6ms. Consecutive segments overlap by half
+		static constexpr usize segmentLength = 512;
+		static constexpr usize hopLength = segmentLength / 2;
+		// How far away from its nominal position a segment can be taken from, ~3.9ms, which covers a period of anything above 256Hz
+		static constexpr usize searchRadius = 128;
+
+		// The amount of buffered audio we try to keep, in stereo frames (62.5ms)
+		static constexpr usize targetLatency = 2048;
+		// If this much audio is buffered, the oldest audio gets dropped, as we're not managing to consume it fast enough even at the max ratio
+		static constexpr usize maxLatency = 6144;
+
+		// Number of input frames consumed per output frame. Above 1 speeds audio up, below 1 slows it down
+		static constexpr double minRatio = 0.5;
+		static constexpr double maxRatio = 4.0;
+
+	  private:
+		// Enough for the furthest a segment can be from the previous one at the max ratio, plus the segment and its search range
+		static constexpr usize inputCapacity = 4096;
+		// How much of the difference between the current and the wanted ratio gets applied per segment. Small enough that the jitter from
+		// samples getting produced in bursts once per emulated frame gets smoothed out
+		static constexpr double ratioSmoothing = 0.05;
+
+		// Input frames pulled out of the sample buffer but not fully consumed yet, as floats
+		std::array<float, inputCapacity * channelCount> input;
+		usize inputFrames = 0;
+
+		double analysisPosition = 0.0;  // Nominal position of the next segment in the input
+		usize naturalPosition = 0;      // Where the input that follows the previous segment starts
+		bool hasPreviousSegment = false;
+		double ratio = 1.0;
+
+		// Second half of the previous windowed segment, which gets added to the first half of the next one
+		std::array<float, hopLength * channelCount> overlap;
+		// Output of the last segment that hasn't been played yet
+		std::array<s16, hopLength * channelCount> pending;
+		usize pendingPosition = hopLength;
+
+		std::array<float, segmentLength> window;
+
+		usize droppedFrames = 0;
+
+		float mono(usize frame) const { return input[frame * 2] + input[frame * 2 + 1]; }
+
+		void updateRatio(Samples& samples);
+		// Pull enough input for the next segment out of the sample buffer. Returns false if there isn't enough available
+		bool fillInput(Samples& samples, usize frames);
+		usize findBestPosition(usize nominal, usize natural) const;
+		void processSegment();
+
+	  public:
+		TimeStretcher();
+		void reset();
+
+		// Fill up to frameCount stereo frames of output with time-stretched audio from the sample buffer. Never blocks. Returns the number of
+		// frames written, which is less than frameCount if we ran out of audio
+		usize process(Samples& samples, s16* output, usize frameCount);
+
+		double getRatio() const { return ratio; }
+		// Number of frames dropped because the sample buffer got too full
+		usize getDroppedFrames() const { return droppedFrames; }
+	};
+}  // namespace Audio
@@ -6,6 +6,8 @@
 #include "frontend_settings.hpp"
 #include "renderer.hpp"
 #include "screen_layout.hpp"
+#include "services/camera_source.hpp"
+#include "services/mic_source.hpp"
 #include "services/region_codes.hpp"
 
 struct AudioDeviceConfig {
@@ -19,6 +21,9 @@ struct AudioDeviceConfig {
 	VolumeCurve volumeCurve = VolumeCurve::Cubic;
 
 	bool muteAudio = false;
+	// Time-stretch the audio to match the speed it's produced at, instead of letting the buffer run dry or overflow when emulation isn't
+	// running at exactly full speed
+	bool timeStretching = true;
 
 	float getVolume() const {
 		if (muteAudio) {
@@ -67,9 +72,34 @@ struct EmulatorConfig {
 	static constexpr bool enableFastmemDefault = true;
 
 	bool shaderJitEnabled = shaderJitDefault;
+	// Maximum amount of executable memory in MB used for caching shaders compiled by the shader JIT. Least recently used shaders get evicted
+	u32 shaderJitCacheSize = 32;
 	bool useUbershaders = ubershaderDefault;
 	bool accelerateShaders = accelerateShadersDefault;
 	bool fastmemEnabled = enableFastmemDefault;
+	// Run threads created for the system core on a second emulated ARM11 core, on its own host thread. Requires a restart
+	bool secondCoreEnabled = false;
+
+	// Emulated CPU clock as a percentage of the old 3DS clock (268MHz). Higher values run more instructions per frame, which can help games
+	// that slow down on hardware. 300 matches the 804MHz mode of the New 3DS
+	static constexpr u32 minCPUClockPercent = 25;
+	static constexpr u32 maxCPUClockPercent = 400;
+	static constexpr u32 new3DSClockPercent = 300;
+	u32 cpuClockPercent = 100;
+	// Use at least the New 3DS clock for titles that ask for it in their exheader
+	bool autoNew3DSClock = true;
+
+	// Frame pacing, for frontends that let the core pace emulation. Speeds are percentages of full speed, where 0 means unlimited.
+	// Fast-forward is toggled by a hotkey, while turbo is active as long as its hotkey is held
+	static constexpr u32 minSpeed = 50;
+	static constexpr u32 maxSpeed = 1000;
+	u32 targetSpeed = 100;
+	u32 fastForwardSpeed = 0;
+	u32 turboSpeed = 200;
+	// Maximum number of frames in a row that aren't presented when emulation can't keep up with the target speed. 0 disables frame skipping
+	u32 maxFrameSkip = 0;
+	// Don't render the frames that aren't presented either. Speeds up fast-forwarding further, but can glitch render-to-texture effects
+	bool skipRenderingSkippedFrames = false;
 	bool hashTextures = hashTexturesDefault;
 
 	ScreenLayout::Layout screenLayout = ScreenLayout::Layout::Default;
@@ -82,6 +112,14 @@ struct EmulatorConfig {
 	bool forceShadergenForLights = true;
 	int lightShadergenThreshold = 1;
 
+	// Execute GX commands submitted via GSP on a dedicated thread instead of inside the TriggerCmdReqQueue call
+	// Only used with renderers that don't need to be driven from the frontend's thread
+	bool asyncGXCommands = false;
+	// Compile specialized shaders in the background and render with the ubershader until they're ready, instead of stalling the draw
+	bool asyncShaderCompilation = false;
+	// Merge consecutive CPU-shaded draws that share the same render state into a single draw call
+	bool batchDraws = true;
+
 	RendererType rendererType = rendererDefault;
 	Audio::DSPCore::Type dspType = Audio::DSPCore::Type::HLE;
 
@@ -97,6 +135,10 @@ struct EmulatorConfig {
 	bool enableRenderdoc = false;
 	bool printAppVersion = true;
 	bool printDSPFirmware = false;
+	// Collect per-command IPC call counts and latencies. They're reported over HTTP/Lua, and dumped to ipc_stats.txt on exit
+	bool ipcStatistics = false;
+	// Comma-separated "category:level" pairs applied to the loggers on startup, eg "*:off,kernel:debug,fs:info"
+	std::string logFilter = "";
 
 	bool chargerPlugged = true;
 	// Default to 3% battery to make users suffer
@@ -104,6 +146,14 @@ struct EmulatorConfig {
 
 	LanguageCodes systemLanguage = LanguageCodes::English;
 
+	// Image source used for the emulated cameras, and the image file or directory of images to use for the Image source
+	Camera::SourceType cameraSource = Camera::SourceType::Pattern;
+	std::filesystem::path cameraImagePath = "";
+
+	// Sample source used for the emulated microphone, and the WAV file to loop for the WAV source
+	Microphone::SourceType micSource = Microphone::SourceType::Silence;
+	std::filesystem::path micWavPath = "";
+
 	// Default ROM path to open in Qt and misc frontends
 	std::filesystem::path defaultRomPath = "";
 	std::filesystem::path filePath;
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
 #include <span>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "dynarmic/interface/A32/a32.h"
 #include "dynarmic/interface/A32/config.h"
@@ -17,9 +24,18 @@ class CPU;
 class MyEnvironment final : public Dynarmic::A32::UserCallbacks {
   public:
 	u64 ticksLeft = 0;
+	// Timestamp of the core these callbacks belong to. Core 0 advances the scheduler's timestamp, while the second core keeps its own,
+	// which is synchronized with the scheduler at the start of every time slice
+	u64& timestamp;
 	Memory& mem;
 	Kernel& kernel;
-	Scheduler& scheduler;
+	CPU& cpu;
+	int coreID;
+
+	// Speed of the emulated CPU relative to the system clock, in percent. 300 is the 804MHz mode of the New 3DS
+	u32 clockPercent = 100;
+	// Fraction of a system tick that hasn't been added to the timestamp yet, in 1/100ths of a CPU cycle
+	u64 cycleRemainder = 0;
 
     u64 getCyclesForInstruction(bool isThumb, u32 instruction);
 
@@ -78,9 +94,7 @@ class MyEnvironment final : public Dynarmic::A32::UserCallbacks {
         std::terminate();
     }
 
-	void CallSVC(u32 swi) override {
-		kernel.serviceSVC(swi);
-	}
+	void CallSVC(u32 swi) override;
 
 	void ExceptionRaised(u32 pc, Dynarmic::A32::Exception exception) override {
 		switch (exception) {
@@ -92,8 +106,9 @@ class MyEnvironment final : public Dynarmic::A32::UserCallbacks {
 		}
 	}
 
-	void AddTicks(u64 ticks) override {
-		scheduler.currentTimestamp += ticks;
+	// Advance the timestamp of this core by a number of system ticks
+	void addSystemTicks(u64 ticks) {
+		timestamp += ticks;
 
 		if (ticks > ticksLeft) {
 			ticksLeft = 0;
@@ -102,32 +117,99 @@ class MyEnvironment final : public Dynarmic::A32::UserCallbacks {
 		ticksLeft -= ticks;
 	}
 
+	// Dynarmic counts CPU cycles, while timestamps are in system ticks, which run at the 268MHz of the old 3DS CPU no matter how fast the
+	// CPU is clocked. So with a faster clock, more cycles fit in a tick. Leftover fractions of a tick are carried over to the next call
+	void AddTicks(u64 cycles) override {
+		if (clockPercent == 100) [[likely]] {
+			addSystemTicks(cycles);
+			return;
+		}
+
+		cycleRemainder += cycles * 100;
+		addSystemTicks(cycleRemainder / clockPercent);
+		cycleRemainder %= clockPercent;
+	}
+
 	u64 GetTicksRemaining() override {
-		return ticksLeft;
+		// Round up so that the JIT always has at least one cycle to run when the scheduler has time left
+		return (ticksLeft * clockPercent + 99) / 100;
+	}
+
+	void setClockPercent(u32 percent) {
+		clockPercent = percent;
+		cycleRemainder = 0;
 	}
 
 	u64 GetTicksForCode(bool isThumb, u32 vaddr, u32 instruction) override {
 		return getCyclesForInstruction(isThumb, instruction);
 	}
 
-	MyEnvironment(Memory& mem, Kernel& kernel, Scheduler& scheduler) : mem(mem), kernel(kernel), scheduler(scheduler) {}
+	MyEnvironment(u64& timestamp, Memory& mem, Kernel& kernel, CPU& cpu, int coreID)
+		: timestamp(timestamp), mem(mem), kernel(kernel), cpu(cpu), coreID(coreID) {}
 };
 
 class CPU {
-	std::unique_ptr<Dynarmic::A32::Jit> jit;
-	std::shared_ptr<CP15> cp15;
-
-	// Make exclusive monitor with only 1 CPU core
-	Dynarmic::ExclusiveMonitor exclusiveMonitor{1};
-	MyEnvironment env;
+	// The JIT, CP15 and callbacks of one emulated ARM11 core
+	struct Core {
+		std::unique_ptr<MyEnvironment> env;
+		std::shared_ptr<CP15> cp15;
+		std::unique_ptr<Dynarmic::A32::Jit> jit;
+	};
+
+	static constexpr int coreCount = 2;
+	// Maximum length of a time slice when both cores are running. Shorter slices mean less latency when a core wakes up a thread on the other
+	// one, at the cost of synchronizing the cores more often
+	static constexpr u64 maxSliceTicks = 65536;
+
+	// Core 1 only exists if the second core is enabled. Otherwise, every thread runs on core 0
+	std::array<Core, coreCount> cores;
+	// The JIT and CP15 of the core whose state is being accessed. This is always core 0, except while the kernel is servicing an SVC from
+	// the second core between slices, so the kernel can keep using the same accessors regardless of which core it's running on
+	Dynarmic::A32::Jit* jit;
+	CP15* cp15;
+	int activeCore = 0;
+
+	// Exclusive monitor shared between the cores, so that LDREX/STREX work across them
+	Dynarmic::ExclusiveMonitor exclusiveMonitor{coreCount};
 	Memory& mem;
 	Scheduler& scheduler;
 	Emulator& emu;
+	Kernel& kernel;
+
+	// Optional second core, running the threads created for the system core on its own host thread.
+	// Both cores run in time slices of the same length, and neither core runs between slices, so scheduler events and anything else
+	// that touches both cores are handled between slices. The kernel only ever runs on the emulator thread: SVCs from core 1 stop both
+	// cores, and are serviced as soon as core 0 reaches a block boundary
+	bool secondCoreEnabled = false;
+	std::thread secondCoreThread;
+	std::mutex sliceMutex;
+	std::condition_variable sliceCondition;
+	bool secondCoreRunning = false;  // Set when a slice starts on the second core, cleared by the second core when it's done
+	bool stopSecondCore = false;
+	u64 secondCoreTimestamp = 0;
+	std::optional<u32> secondCorePendingSVC;  // SVC core 1 stopped at, waiting to be serviced on the emulator thread
+
+	// Cache invalidations requested while a core was running on another host thread. They're applied at the end of the slice
+	struct PendingInvalidation {
+		bool clearAll = false;
+		std::vector<std::pair<u32, u32>> ranges;
+	};
+	std::array<PendingInvalidation, coreCount> pendingInvalidations;
+
+	void makeCore(int coreID, u64& timestamp);
+	void runFrameMultiCore();
+	void secondCoreLoop();
+	void startSecondCore();
+	void waitForSecondCore();
+	void applyPendingInvalidations();
+	// Services the SVC core 1 stopped at, if any. Both cores need to be stopped. Returns whether core 1 was restarted for the rest of its slice
+	bool serviceSecondCoreSVC();
 
   public:
     static constexpr u64 ticksPerSec = Scheduler::arm11Clock;
 
     CPU(Memory& mem, Kernel& kernel, Emulator& emu);
+    ~CPU();
     void reset();
 
     void setReg(int index, u32 value) {
@@ -165,8 +247,9 @@ class CPU {
         cp15->setTLSBase(value);
     }
 
+    // Get the timestamp of the active core
     u64 getTicks() {
-        return scheduler.currentTimestamp;
+        return cores[activeCore].env->timestamp;
     }
 
     // Get reference to tick count. Memory needs access to this
@@ -178,10 +261,28 @@ class CPU {
 		return scheduler;
 	}
 
-    void addTicks(u64 ticks) { env.AddTicks(ticks); }
+    // Skip ahead by a number of system ticks on the active core, eg when idling
+    void addTicks(u64 ticks) { cores[activeCore].env->addSystemTicks(ticks); }
 
-    void clearCache() { jit->ClearCache(); }
-    void clearCacheRange(u32 start, u32 size) { jit->InvalidateCacheRange(start, size); }
+	// Set the emulated CPU clock, as a percentage of the old 3DS clock (268MHz). Timers, VBlank and the system tick counter keep running
+	// at the same rate, so a higher clock just means more instructions get executed per frame
+	void setClockPercent(u32 percent);
+	u32 getClockPercent() const { return cores[0].env->clockPercent; }
+
+    void clearCache();
+    void clearCacheRange(u32 start, u32 size);
 
     void runFrame();
+
+	bool isSecondCoreEnabled() const { return secondCoreEnabled; }
+	int getActiveCore() const { return activeCore; }
+	// Select the core whose state the register and CP15 accessors refer to. Only the kernel should call this
+	void setActiveCore(int coreID) {
+		activeCore = coreID;
+		jit = cores[coreID].jit.get();
+		cp15 = cores[coreID].cp15.get();
+	}
+
+	// Called when core 1 hits an SVC. Stops both cores so that the SVC can be serviced on the emulator thread
+	void deferSecondCoreSVC(u32 svc);
 };
\ No newline at end of file
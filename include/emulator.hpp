@@ -14,6 +14,7 @@
 #include "cpu.hpp"
 #include "crypto/aes_engine.hpp"
 #include "discord_rpc.hpp"
+#include "frame_pacer.hpp"
 #include "fs/romfs.hpp"
 #include "io_file.hpp"
 #include "lua_manager.hpp"
@@ -47,6 +48,7 @@ class Emulator {
 	Crypto::AESEngine aesEngine;
 	AudioDevice audioDevice;
 	Cheats cheats;
+	FramePacer framePacer;
 
   public:
 	static constexpr u32 width = 400;
@@ -126,6 +128,11 @@ class Emulator {
 	ServiceManager& getServiceManager() { return kernel.getServiceManager(); }
 	LuaManager& getLua() { return lua; }
 	AudioDeviceInterface& getAudioDevice() { return audioDevice; }
+	FramePacer& getFramePacer() { return framePacer; }
+
+	// Whether the frontend should present the frame that was just run. When fast-forwarding or skipping frames, runFrame doesn't display
+	// every frame, and swapping buffers for those would just show the previous frame again and wait for vsync
+	bool shouldPresentFrame() const { return !running || framePacer.isPresentingFrame(); }
 
 	RendererType getRendererType() const { return config.rendererType; }
 	Renderer* getRenderer() { return gpu.getRenderer(); }
@@ -140,4 +147,8 @@ class Emulator {
 
   private:
 	void loadRenderdoc();
+	// Write the IPC statistics collected during this session to the app data folder, if they were enabled
+	void dumpIPCStats();
+	// Set the emulated CPU clock from the config, taking into account whether the loaded title asks for the New 3DS clock
+	void updateCPUClock();
 };
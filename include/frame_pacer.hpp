@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <mutex>
+
+#include "helpers.hpp"
+
+// Paces emulation to a target speed using the host's monotonic clock instead of relying on vsync, and decides which frames don't get
+// presented, either because we're fast-forwarding and presenting every frame would be wasted work, or because the host can't keep up.
+// Frontends that want pacing enable it. The emulator then calls beginFrame before emulating a frame and endFrame after it.
+// Speeds are percentages of full speed, where 0 means unlimited.
+class FramePacer {
+  public:
+	using Clock = std::chrono::steady_clock;
+	using Duration = std::chrono::nanoseconds;
+
+	// The emulated screen refreshes 60 times per emulated second, matching the VBlank event of the scheduler
+	static constexpr Duration framePeriod = Duration(1000000000 / 60);
+
+	struct Stats {
+		double fps = 0.0;               // Emulated frames per second of host time
+		double speed = 0.0;             // Emulation speed as a percentage of full speed
+		double averageFrameTime = 0.0;  // Host time spent emulating a frame, not counting the time spent waiting, in milliseconds
+		double maxFrameTime = 0.0;
+		u64 framesEmulated = 0;
+		u64 framesPresented = 0;
+		u64 framesSkipped = 0;
+	};
+
+  private:
+	// Number of frames the statistics are averaged over
+	static constexpr usize statWindow = 60;
+	// If emulation falls more than this many frames behind, we stop trying to catch up, instead of running faster than the target speed
+	// for a while, which would make eg a stall from loading a file show up as a burst of fast-forwarding afterwards
+	static constexpr int maxFramesBehind = 4;
+	// Sleep until this long before a frame's deadline, then spin for the rest, as sleeps can oversleep by a millisecond or more
+	static constexpr Duration spinThreshold = std::chrono::milliseconds(2);
+	// When emulating faster than full speed, present at most once every this often, which matches a 60Hz display
+	static constexpr Duration presentInterval = framePeriod;
+
+	bool enabled = false;
+	u32 targetSpeed = 100;
+	u32 fastForwardSpeed = 0;
+	u32 turboSpeed = 200;
+	u32 maxFrameSkip = 0;
+	bool fastForward = false;  // Toggled by the frontend
+	bool turbo = false;        // Held by the frontend
+
+	bool started = false;        // Whether the timestamps below are valid
+	Clock::time_point deadline;  // When the current frame was due to start
+	Clock::time_point frameStart;
+	Clock::time_point lastPresent;
+	Duration frameInterval = Duration::zero();  // Time between the start of the previous frame and the current one
+	bool presenting = true;                     // Whether the current frame gets presented
+	u32 skippedInARow = 0;
+
+	// Recent frame timings, for the statistics
+	std::array<Duration, statWindow> frameTimes{};
+	std::array<Duration, statWindow> frameIntervals{};
+	usize statIndex = 0;
+	usize statCount = 0;
+
+	mutable std::mutex statsMutex;
+	Stats stats;
+
+	Duration getCurrentPeriod() const;
+	bool shouldPresent(Clock::time_point now);
+	void updateStats(Duration frameTime, Duration interval);
+
+  public:
+	void setEnabled(bool enable) {
+		enabled = enable;
+		reset();
+	}
+
+	void setTargetSpeed(u32 speed) { targetSpeed = speed; }
+	void setFastForwardSpeed(u32 speed) { fastForwardSpeed = speed; }
+	void setTurboSpeed(u32 speed) { turboSpeed = speed; }
+	// Maximum number of frames in a row that can be skipped when emulation runs behind the target speed. 0 disables frame skipping
+	void setMaxFrameSkip(u32 frames) { maxFrameSkip = frames; }
+
+	void setFastForward(bool enable) { fastForward = enable; }
+	void toggleFastForward() { fastForward = !fastForward; }
+	void setTurbo(bool enable) { turbo = enable; }
+
+	bool isEnabled() const { return enabled; }
+	bool isFastForwarding() const { return fastForward || turbo; }
+	bool isPresentingFrame() const { return presenting; }
+
+	// Forget the pacing state, eg after the emulator was paused, so that we don't try to catch up with the time spent paused
+	void reset() { started = false; }
+
+	// Called before emulating a frame. Returns whether the frame should be presented
+	bool beginFrame() { return beginFrame(Clock::now()); }
+	bool beginFrame(Clock::time_point now);
+
+	// Called after a frame is done. Waits until it's time to start the next one
+	void endFrame();
+	// Returns when the next frame should start, without waiting. endFrame is this followed by waitUntil
+	Clock::time_point finishFrame(Clock::time_point now);
+
+	static void waitUntil(Clock::time_point time);
+
+	// Get a snapshot of the frame statistics. This can be called from any thread
+	Stats getStats() const {
+		std::scoped_lock lock(statsMutex);
+		return stats;
+	}
+};
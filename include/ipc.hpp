@@ -1,5 +1,10 @@
 #pragma once
 #include <cstdint>
+#include <cstring>
+
+#include "helpers.hpp"
+
+class Memory;
 
 namespace IPC {
 	namespace BufferType {
@@ -17,4 +22,105 @@ namespace IPC {
 	constexpr std::uint32_t pointerHeader(std::uint32_t index, std::uint32_t size, std::uint32_t type) {
 		return (size << 14) | (index << 10) | (type << 1);
 	}
-}  // namespace IPC
\ No newline at end of file
+
+	// Translate parameter descriptors. Each one is followed by the handles, process ID or buffer address it describes
+	constexpr std::uint32_t copyHandleDescriptor(std::uint32_t count) { return (count - 1) << 26; }
+	constexpr std::uint32_t moveHandleDescriptor(std::uint32_t count) { return ((count - 1) << 26) | 0x10; }
+	constexpr std::uint32_t callingPidDescriptor() { return 0x20; }
+
+	constexpr std::uint32_t staticBufferDescriptor(std::uint32_t size, std::uint32_t id) { return (size << 14) | (id << 10) | 2; }
+	constexpr std::uint32_t pxiBufferDescriptor(std::uint32_t size, std::uint32_t id, bool readOnly) {
+		return (size << 8) | (id << 4) | (readOnly ? 6 : 4);
+	}
+
+	constexpr std::uint32_t mappedBufferDescriptor(std::uint32_t size, std::uint32_t permissions) { return (size << 4) | 8 | (permissions << 1); }
+
+	// A view of an IPC message in the command buffer of the calling thread, which lives at TLS + 0x80.
+	// The command buffer never crosses a page, so it's resolved to a host pointer once instead of going through the page table
+	// on every word. Parameters are accessed by their word index in the message, with the header being word 0.
+	class Message {
+		u32* words;
+
+		template <typename T>
+		T readRaw(usize index) const {
+			T value;
+			std::memcpy(&value, &words[index], sizeof(T));
+			return value;
+		}
+
+		template <typename T>
+		void writeRaw(usize index, T value) {
+			std::memcpy(&words[index], &value, sizeof(T));
+		}
+
+	  public:
+		// Size of the command buffer in words
+		static constexpr usize commandBufferWords = 0x40;
+		// The static buffers a thread is willing to receive are described right after the command buffer, at TLS + 0x180
+		static constexpr usize receiveBufferWords = commandBufferWords;
+
+		struct StaticBuffer {
+			u32 id;
+			u32 size;
+			u32 address;
+		};
+
+		struct PXIBuffer {
+			u32 id;
+			u32 size;
+			bool readOnly;
+			u32 address;
+		};
+
+		struct MappedBuffer {
+			u32 permissions;
+			u32 size;
+			u32 address;
+		};
+
+		Message(Memory& mem, u32 messagePointer);
+		explicit Message(u32* words) : words(words) {}
+
+		u32 header() const { return words[0]; }
+		u16 commandID() const { return u16(words[0] >> 16); }
+
+		// Normal parameters. The 8 and 16-bit accessors only touch the low bytes of the word, same as a byte or halfword memory access
+		u8 read8(usize index) const { return readRaw<u8>(index); }
+		u16 read16(usize index) const { return readRaw<u16>(index); }
+		u32 read32(usize index) const { return words[index]; }
+		u64 read64(usize index) const { return readRaw<u64>(index); }
+
+		void write8(usize index, u8 value) { writeRaw(index, value); }
+		void write16(usize index, u16 value) { writeRaw(index, value); }
+		void write32(usize index, u32 value) { words[index] = value; }
+		void write64(usize index, u64 value) { writeRaw(index, value); }
+
+		// Raw access to the message, for parameters that aren't words, like strings and structs embedded in the message
+		u8* getPointer(usize index) { return reinterpret_cast<u8*>(&words[index]); }
+
+		// Overwrite the header of the request with the header of our response, in place
+		void respond(u32 commandID, u32 normalResponses, u32 translateResponses) {
+			words[0] = responseHeader(commandID, normalResponses, translateResponses);
+		}
+
+		// Translate parameters. Each of these reads a descriptor at the specified index, and the address that follows it
+		StaticBuffer readStaticBuffer(usize index) const { return {(words[index] >> 10) & 0xF, words[index] >> 14, words[index + 1]}; }
+		PXIBuffer readPXIBuffer(usize index) const {
+			return {(words[index] >> 4) & 0xF, words[index] >> 8, (words[index] & 2) != 0, words[index + 1]};
+		}
+		MappedBuffer readMappedBuffer(usize index) const { return {(words[index] >> 1) & 3, words[index] >> 4, words[index + 1]}; }
+
+		// The static buffer the calling thread set up with the specified ID to receive data into
+		StaticBuffer getReceiveBuffer(u32 id) const { return readStaticBuffer(receiveBufferWords + id * 2); }
+
+		void writeStaticBuffer(usize index, u32 id, u32 size, u32 address) {
+			words[index] = staticBufferDescriptor(size, id);
+			words[index + 1] = address;
+		}
+
+		void writeMappedBuffer(usize index, u32 permissions, u32 size, u32 address) {
+			words[index] = mappedBufferDescriptor(size, permissions);
+			words[index + 1] = address;
+		}
+	};
+}  // namespace IPC
@@ -0,0 +1,98 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+
+#include "helpers.hpp"
+
+// Threads sleeping on address arbiters, keyed by the guest address they're waiting on, so that signalling an address only has to look at
+// the threads that are actually waiting on it instead of every thread in the process.
+// Like the kernel object waitlists, each queue is a bitfield of thread indices. Waiters are woken in priority order when signalling.
+class ArbiterWaitQueues {
+	// Games tend to wait on the same few addresses over and over, so empty queues are kept around to avoid a map insertion on every wait.
+	// They're only thrown away once there's a lot of them
+	static constexpr usize pruneThreshold = 256;
+
+	std::unordered_map<u32, u64> waitlists;
+
+	void pruneEmptyQueues() {
+		if (waitlists.size() > pruneThreshold) [[unlikely]] {
+			std::erase_if(waitlists, [](const auto& entry) { return entry.second == 0; });
+		}
+	}
+
+  public:
+	void add(u32 address, int threadIndex) {
+		waitlists[address] |= (1ull << threadIndex);
+		pruneEmptyQueues();
+	}
+
+	void remove(u32 address, int threadIndex) {
+		auto it = waitlists.find(address);
+		if (it != waitlists.end()) {
+			it->second &= ~(1ull << threadIndex);
+		}
+	}
+
+	// Returns the bitfield of the threads waiting on an address
+	u64 getWaitlist(u32 address) const {
+		auto it = waitlists.find(address);
+		return it != waitlists.end() ? it->second : 0;
+	}
+
+	// Returns how many addresses have threads waiting on them
+	usize addressCount() const {
+		return std::count_if(waitlists.begin(), waitlists.end(), [](const auto& entry) { return entry.second != 0; });
+	}
+
+	void clear() { waitlists.clear(); }
+
+	// Remove up to "count" threads waiting on "address" from the queue and call wake(threadIndex) for each of them, highest priority first.
+	// If count is negative, every waiting thread is woken up. getPriority(threadIndex) returns the priority of a thread, where lower values
+	// mean higher priority. Threads with the same priority are woken in index order. Returns the number of threads woken up
+	template <typename PriorityFunc, typename WakeFunc>
+	s32 signal(u32 address, s32 count, PriorityFunc&& getPriority, WakeFunc&& wake) {
+		auto it = waitlists.find(address);
+		if (it == waitlists.end() || it->second == 0 || count == 0) {
+			return 0;
+		}
+
+		u64& waitlist = it->second;
+		s32 woken = 0;
+
+		if (count < 0 || count >= std::popcount(waitlist)) {
+			// Everyone's getting woken up, so order only matters between threads that become ready at the same time. Since the scheduler
+			// picks threads by priority anyways, we can skip the sorting
+			while (waitlist != 0) {
+				const int index = std::countr_zero(waitlist);
+				waitlist ^= (1ull << index);
+				wake(index);
+				woken++;
+			}
+		} else {
+			for (; woken < count; woken++) {
+				// Find the waiting thread with the highest priority
+				u64 remaining = waitlist;
+				int threadIndex = std::countr_zero(remaining);
+				auto maxPriority = getPriority(threadIndex);
+				remaining ^= (1ull << threadIndex);
+
+				while (remaining != 0) {
+					const int index = std::countr_zero(remaining);
+					remaining ^= (1ull << index);
+
+					const auto priority = getPriority(index);
+					if (priority < maxPriority) {
+						threadIndex = index;
+						maxPriority = priority;
+					}
+				}
+
+				waitlist ^= (1ull << threadIndex);
+				wake(threadIndex);
+			}
+		}
+
+		return woken;
+	}
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <list>
+#include <map>
 #include <memory>
 
 #include "helpers.hpp"
@@ -22,29 +23,30 @@ struct FcramBlock {
 using FcramBlockList = std::list<FcramBlock>;
 
 class KFcram {
-	struct Region {
-		struct Block {
-			s32 pages;
-			s32 pageOffset;
-			bool used;
-
-			Block(s32 pages, u32 pageOffset) : pages(pages), pageOffset(pageOffset), used(false) {}
-		};
-
-		std::list<Block> blocks;
+  public:
+	class Region {
+		// The free blocks of the region, keyed by their page offset from the start of the region and mapped to their size in pages.
+		// Blocks are sorted by address and adjacent free blocks are always merged, so allocations are first-fit in address order
+		std::map<s32, s32> freeBlocks;
 		u32 start;
 		s32 pages;
 		s32 freePages;
 
+		// Take the first "count" pages of a free block and add them to the output list
+		void takePages(std::map<s32, s32>::iterator it, s32 count, std::list<FcramBlock>& out);
+
 	  public:
-		Region() : start(0), pages(0) {}
+		Region() : start(0), pages(0), freePages(0) {}
 		void reset(u32 start, size_t size);
 		void alloc(std::list<FcramBlock>& out, s32 pages, bool linear);
+		void free(u32 paddr, s32 pages);
 
+		usize getFreeBlockCount() const { return freeBlocks.size(); }
 		u32 getUsedCount();
 		u32 getFreeCount();
 	};
 
+  private:
 	Memory& mem;
 
 	Region appRegion, sysRegion, baseRegion;
@@ -57,7 +59,6 @@ class KFcram {
 	void alloc(FcramBlockList& out, s32 pages, FcramRegion region, bool linear);
 
 	void incRef(FcramBlockList& list);
-	void decRef(FcramBlockList& list);
 
 	u32 getUsedCount(FcramRegion region);
 };
\ No newline at end of file
@@ -2,16 +2,20 @@
 #include <array>
 #include <span>
 #include <string>
+#include <tuple>
 #include <vector>
 
+#include "arbiter_wait_queues.hpp"
 #include "config.hpp"
 #include "fcram.hpp"
 #include "helpers.hpp"
+#include "kernel_object_table.hpp"
 #include "kernel_types.hpp"
 #include "logger.hpp"
 #include "memory.hpp"
 #include "resource_limits.hpp"
 #include "services/service_manager.hpp"
+#include "slab_pool.hpp"
 
 class CPU;
 class LuaManager;
@@ -28,29 +32,43 @@ class Kernel {
 	KFcram fcramManager;
 
   private:
-	// The handle number for the next kernel object to be created
-	u32 handleCounter;
 	// A list of our OS threads, the max number of which depends on the resource limit (hardcoded 32 per process on retail it seems).
 	// We have an extra thread for when no thread is capable of running. This thread is called the "idle thread" in our code
 	// This thread is set up in setupIdleThread and just yields in a loop to see if any other thread has woken up
 	std::array<Thread, appResourceLimits.maxThreads + 1> threads;
 	static constexpr int idleThreadIndex = appResourceLimits.maxThreads;
+	// Stands for "no thread" in currentThreadIndex. Only the second core can be left without a thread to run, as it has no idle thread
+	static constexpr int noThreadIndex = -1;
 	// Our waitlist system uses a bitfield of 64 bits to show which threads are waiting on an object.
 	// That means we can have a maximum of 63 threads + 1 idle thread. This assert should never trigger because the max thread # is 32
 	// But we have it here for safety purposes
 	static_assert(appResourceLimits.maxThreads <= 63, "The waitlist system is built on the premise that <= 63 threads max can be active");
 
-	std::vector<KernelObject> objects;
+	KernelObjectTable objects;
+	// Pools for the data of every kernel object type that owns heap data. Thread and resource limit objects point into other structures
+	std::tuple<
+		SlabPool<AddressArbiter>, SlabPool<ArchiveSession>, SlabPool<DirectorySession>, SlabPool<Event>, SlabPool<FileSession>,
+		SlabPool<MemoryBlock>, SlabPool<Mutex>, SlabPool<Port>, SlabPool<Process>, SlabPool<Semaphore>, SlabPool<Session>, SlabPool<Timer>>
+		objectPools;
 	std::vector<Handle> portHandles;
 	std::vector<Handle> mutexHandles;
 	std::vector<Handle> timerHandles;
 
 	// Thread indices, sorted by priority
 	std::vector<int> threadIndices;
+	// Threads waiting on address arbiters, keyed by address
+	ArbiterWaitQueues arbiterWaitQueues;
 
 	Handle currentProcess;
 	Handle mainThread;
+	// The thread running on the core that's executing kernel code
 	int currentThreadIndex;
+	// When the second core is enabled, threads created for the system core run on core 1 and everything else on core 0.
+	// The kernel works on one core at a time: currentThreadIndex and regs belong to the active core, and the thread of the other core is
+	// kept in coreThreadIndices until we switch back to it
+	bool secondCoreEnabled = false;
+	int activeCore = 0;
+	std::array<int, 2> coreThreadIndices = {0, noThreadIndex};
 	Handle srvHandle;        // Handle for the special service manager port "srv:"
 	Handle errorPortHandle;  // Handle for the err:f port used for displaying errors
 
@@ -102,6 +120,10 @@ class Kernel {
 	void sleepThreadOnArbiterWithTimeout(u32 waitingAddress, s64 timeoutNs);
 
 	void switchThread(int newThreadIndex);
+	void switchToCore(int core);
+	int getThreadCore(int threadIndex) const {
+		return (secondCoreEnabled && threadIndex != idleThreadIndex && threads[threadIndex].processorID == ProcessorID::Syscore) ? 1 : 0;
+	}
 	void sortThreads();
 	std::optional<int> getNextThread();
 	void rescheduleThreads();
@@ -120,6 +142,13 @@ class Kernel {
 
 	std::optional<Handle> getPortHandle(const char* name);
 	void deleteObjectData(KernelObject& object);
+	// Destroy an object in response to CloseHandle and recycle its slot in the handle table. Returns whether the object was destroyed
+	bool destroyObject(KernelObject& object);
+
+	template <typename T>
+	SlabPool<T>& getObjectPool() {
+		return std::get<SlabPool<T>>(objectPools);
+	}
 
 	KernelObject* getProcessFromPID(Handle handle);
 	s32 getCurrentResourceValue(const KernelObject* limit, u32 resourceName);
@@ -212,6 +241,12 @@ class Kernel {
 	void serviceSVC(u32 svc);
 	void reset();
 
+	// Service an SVC from one of the cores while the second core is enabled. Must only be called when neither core is running.
+	// Returns false if the core has no thread left to run afterwards
+	bool serviceSVCOnCore(u32 svc, int core);
+	// Pick the threads both cores run next. Must only be called when neither core is running. Returns whether core 1 has a thread to run
+	bool rescheduleCores();
+
 	void requireReschedule() { needReschedule = true; }
 
 	void evalReschedule() {
@@ -223,37 +258,49 @@ class Kernel {
 
 	void addWakeupEvent(u64 tick);
 
-	Handle makeObject(KernelObjectType type) {
-		if (handleCounter > KernelHandles::Max) [[unlikely]] {
-			Helpers::panic("Hlep we somehow created enough kernel objects to overflow this thing");
-		}
-
-		objects.push_back(KernelObject(handleCounter, type));
-		log("Created %s object with handle %d\n", kernelObjectTypeToString(type), handleCounter);
-		return handleCounter++;
+	// Objects marked as closable are destroyed when the guest closes their handle. See KernelObject::closable
+	Handle makeObject(KernelObjectType type, bool closable = false) {
+		const Handle handle = objects.allocate(type);
+		objects[handle].closable = closable;
+		log("Created %s object with handle %X\n", kernelObjectTypeToString(type), handle);
+		return handle;
 	}
 
-	std::vector<KernelObject>& getObjects() { return objects; }
-
-	// Get pointer to the object with the specified handle
-	KernelObject* getObject(Handle handle) {
-		// Accessing an object that has not been created
-		if (handle >= objects.size()) [[unlikely]] {
-			return nullptr;
-		}
-
-		return &objects[handle];
+	// Services that keep a handle the guest gave them, such as interrupt events, hold a reference to the object for as long as they keep it.
+	// Otherwise the guest closing its handle would destroy the object from under them
+	void retainObject(Handle handle);
+	void releaseObject(Handle handle);
+
+	// Allocate the data of a freshly made object from the pool for its type
+	template <typename T, typename... Args>
+	T* makeObjectData(Handle handle, Args&&... args) {
+		T* data = getObjectPool<T>().allocate(std::forward<Args>(args)...);
+		objects[handle].data = data;
+		return data;
 	}
 
+	// Get pointer to the object with the specified handle. Returns nullptr for handles that were never allocated or have been closed
+	KernelObject* getObject(Handle handle) { return objects.get(handle); }
+
 	// Get pointer to the object with the specified handle and type
 	KernelObject* getObject(Handle handle, KernelObjectType type) {
-		if (handle >= objects.size() || objects[handle].type != type) [[unlikely]] {
+		KernelObject* object = objects.get(handle);
+		if (object == nullptr || object->type != type) [[unlikely]] {
 			return nullptr;
 		}
 
-		return &objects[handle];
+		return object;
 	}
 
+	// Usage counters for every kernel object type, for debugging leaks
+	struct ObjectStats {
+		KernelObjectTable::TypeStats counts;
+		usize poolCapacity = 0;       // How many objects of this type the pool can hold before allocating more memory
+		usize poolReservedBytes = 0;  // Memory allocated by the pool for objects of this type
+	};
+
+	std::array<ObjectStats, kernelObjectTypeCount> getObjectStats();
+
 	ServiceManager& getServiceManager() { return serviceManager; }
 	Scheduler& getScheduler();
 
@@ -0,0 +1,155 @@
+#pragma once
+#include <array>
+#include <deque>
+#include <vector>
+
+#include "helpers.hpp"
+#include "kernel_types.hpp"
+
+// The table mapping handles to kernel objects.
+// Like on the real kernel, the low 15 bits of a handle are the index of its slot in the table, and the bits above that are a generation
+// counter which is incremented every time the slot is reused. This lets us recycle the slots of closed objects while still catching
+// stale handles, as a handle to a closed object won't match the generation of whatever object took over its slot.
+// The first object to use a slot gets generation 0, so handles are plain indices until slots start getting recycled.
+// Each slot also has a reference count. Creating an object gives the guest the first reference, and services that hold on to a handle the
+// guest gave them take one more, so that the object outlives the guest closing its own handle.
+class KernelObjectTable {
+	using Handle = HorizonHandle;
+
+  public:
+	static constexpr u32 indexBits = 15;
+	static constexpr u32 maxObjects = 1u << indexBits;
+	// Stored in the handle field of free slots. Generations are 16 bits, so no allocated handle can ever have this value
+	static constexpr Handle freeSlotHandle = 0xFFFFFFFF;
+
+	struct TypeStats {
+		u32 live = 0;       // Objects of this type that are currently alive
+		u32 peak = 0;       // Maximum number of objects of this type that were alive at the same time
+		u64 created = 0;    // Objects of this type created since the last reset
+		u64 destroyed = 0;  // Objects of this type closed since the last reset
+	};
+
+  private:
+	std::vector<KernelObject> slots;
+	std::vector<u16> generations;
+	std::vector<u32> refCounts;
+	// Freed slots are reused in FIFO order, so that a stale handle stays invalid for as long as possible
+	std::deque<u32> freeSlots;
+	std::array<TypeStats, kernelObjectTypeCount> stats = {};
+
+  public:
+	static constexpr u32 getIndex(Handle handle) { return handle & (maxObjects - 1); }
+
+	Handle allocate(KernelObjectType type) {
+		u32 index;
+		if (!freeSlots.empty()) {
+			index = freeSlots.front();
+			freeSlots.pop_front();
+		} else {
+			if (slots.size() >= maxObjects) [[unlikely]] {
+				Helpers::panic("Hlep we somehow created enough kernel objects to overflow this thing");
+			}
+
+			index = u32(slots.size());
+			slots.push_back(KernelObject(freeSlotHandle, type));
+			generations.push_back(0);
+			refCounts.push_back(0);
+		}
+
+		const Handle handle = (u32(generations[index]) << indexBits) | index;
+		slots[index] = KernelObject(handle, type);
+		refCounts[index] = 1;
+
+		TypeStats& typeStats = stats[static_cast<usize>(type)];
+		typeStats.live++;
+		typeStats.created++;
+		typeStats.peak = std::max(typeStats.peak, typeStats.live);
+
+		return handle;
+	}
+
+	// Release the slot of an object. The object's data needs to have been freed beforehand
+	void free(Handle handle) {
+		KernelObject* object = get(handle);
+		if (object == nullptr) [[unlikely]] {
+			return;
+		}
+
+		TypeStats& typeStats = stats[static_cast<usize>(object->type)];
+		typeStats.live--;
+		typeStats.destroyed++;
+
+		const u32 index = getIndex(handle);
+		object->handle = freeSlotHandle;
+		object->data = nullptr;
+		object->type = KernelObjectType::Dummy;
+
+		generations[index]++;
+		refCounts[index] = 0;
+		freeSlots.push_back(index);
+	}
+
+	// Take a reference to an object. Does nothing if the handle is invalid
+	void retain(Handle handle) {
+		if (get(handle) != nullptr) {
+			refCounts[getIndex(handle)]++;
+		}
+	}
+
+	// Drop a reference to an object. Returns true if that was the last one, in which case the object should be destroyed and freed.
+	// A failed destroy leaves the count at 0, so that dropping the reference again retries it
+	bool release(Handle handle) {
+		if (get(handle) == nullptr) [[unlikely]] {
+			return false;
+		}
+
+		u32& refCount = refCounts[getIndex(handle)];
+		if (refCount > 0) {
+			refCount--;
+		}
+
+		return refCount == 0;
+	}
+
+	u32 getRefCount(Handle handle) { return get(handle) != nullptr ? refCounts[getIndex(handle)] : 0; }
+
+	// Get the object a handle refers to, or nullptr if the handle is invalid or the object has been closed
+	KernelObject* get(Handle handle) {
+		const u32 index = getIndex(handle);
+		if (index >= slots.size() || slots[index].handle != handle) [[unlikely]] {
+			return nullptr;
+		}
+
+		return &slots[index];
+	}
+
+	// Returns whether this is a handle to an object that has since been closed
+	bool isStale(Handle handle) const {
+		const u32 index = getIndex(handle);
+		return handle < (u32(0x10000) << indexBits) && index < slots.size() && slots[index].handle != handle;
+	}
+
+	// Unchecked access, for objects the kernel just created
+	KernelObject& operator[](Handle handle) { return slots[getIndex(handle)]; }
+
+	auto begin() { return slots.begin(); }
+	auto end() { return slots.end(); }
+
+	void reserve(usize count) {
+		slots.reserve(count);
+		generations.reserve(count);
+		refCounts.reserve(count);
+	}
+
+	void clear() {
+		slots.clear();
+		generations.clear();
+		refCounts.clear();
+		freeSlots.clear();
+		stats = {};
+	}
+
+	usize getSlotCount() const { return slots.size(); }
+	usize getFreeSlotCount() const { return freeSlots.size(); }
+	const TypeStats& getStats(KernelObjectType type) const { return stats[static_cast<usize>(type)]; }
+};
@@ -22,9 +22,12 @@ enum class KernelObjectType : u8 {
 	Port,
 	Semaphore,
 	Timer,
-	Thread
+	Thread,
+	Count,
 };
 
+static constexpr usize kernelObjectTypeCount = static_cast<usize>(KernelObjectType::Count);
+
 enum class ResourceLimitCategory : int {
 	Application = 0,
 	SystemApplet = 1,
@@ -174,6 +177,7 @@ static const char* kernelObjectTypeToString(KernelObjectType t) {
 		case KernelObjectType::Mutex: return "mutex";
 		case KernelObjectType::Semaphore: return "semaphore";
 		case KernelObjectType::Thread: return "thread";
+		case KernelObjectType::Timer: return "timer";
 		case KernelObjectType::Dummy: return "dummy";
 		default: return "unknown";
 	}
@@ -229,11 +233,14 @@ struct KernelObject {
 	Handle handle = 0;  // A u32 the OS will use to identify objects
 	void* data = nullptr;
 	KernelObjectType type;
+	// Whether closing the handle destroys the object. Only set for objects that the game created itself and that the kernel doesn't keep
+	// handles to, such as events made by svcCreateEvent or file sessions
+	bool closable = false;
 
 	KernelObject(Handle handle, KernelObjectType type) : handle(handle), type(type) {}
 
-	// Our destructor does not free the data in order to avoid it being freed when our std::vector is expanded
-	// Thus, the kernel needs to delete it when appropriate
+	// Our destructor does not free the data in order to avoid it being freed when the object table is expanded
+	// Thus, the kernel needs to return it to its slab pool when appropriate
 	~KernelObject() {}
 
 	template <typename T>
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "helpers.hpp"
+
+// Pool allocator for kernel object data. Objects are carved out of fixed-size slabs, and freed objects go to a free list so their memory is
+// reused by the next allocation of the same type, instead of going through the heap every time a game creates and closes an object.
+// Slabs are never released until the pool is destroyed, so pointers to objects stay valid for as long as the objects are alive
+template <typename T, usize objectsPerSlab = 64>
+class SlabPool {
+	struct Slab {
+		alignas(T) std::byte storage[sizeof(T) * objectsPerSlab];
+	};
+
+	std::vector<std::unique_ptr<Slab>> slabs;
+	std::vector<T*> freeList;
+	usize liveObjects = 0;
+
+	void addSlab() {
+		Slab* slab = slabs.emplace_back(std::make_unique<Slab>()).get();
+		T* objects = reinterpret_cast<T*>(slab->storage);
+
+		// Push the objects in reverse so that they get allocated in address order
+		freeList.reserve(freeList.size() + objectsPerSlab);
+		for (usize i = objectsPerSlab; i > 0; i--) {
+			freeList.push_back(&objects[i - 1]);
+		}
+	}
+
+  public:
+	SlabPool() = default;
+	SlabPool(const SlabPool&) = delete;
+	SlabPool& operator=(const SlabPool&) = delete;
+
+	template <typename... Args>
+	T* allocate(Args&&... args) {
+		if (freeList.empty()) {
+			addSlab();
+		}
+
+		T* object = freeList.back();
+		freeList.pop_back();
+		liveObjects++;
+
+		return new (object) T(std::forward<Args>(args)...);
+	}
+
+	void free(T* object) {
+		object->~T();
+		freeList.push_back(object);
+		liveObjects--;
+	}
+
+	usize getLiveObjects() const { return liveObjects; }
+	usize getCapacity() const { return slabs.size() * objectsPerSlab; }
+	usize getReservedBytes() const { return slabs.size() * sizeof(Slab); }
+};
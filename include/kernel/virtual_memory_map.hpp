@@ -0,0 +1,122 @@
+#pragma once
+#include <iterator>
+#include <map>
+#include <optional>
+
+#include "helpers.hpp"
+
+// The virtual memory regions of a process, each one being a range of pages with the same permissions and memory state.
+// Regions are kept in a balanced tree keyed by their base address, so finding the region an address belongs to takes O(log regions) instead
+// of walking a list. The regions always cover the whole address space without gaps, and adjacent regions with the same permissions and state
+// are merged, same as the official kernel does.
+class VirtualMemoryMap {
+  public:
+	struct Region {
+		u32 pages;
+		u32 perms;
+		u32 state;
+	};
+
+	using RegionMap = std::map<u32, Region>;
+	using const_iterator = RegionMap::const_iterator;
+
+  private:
+	RegionMap regions;
+
+	using iterator = RegionMap::iterator;
+	static bool canMerge(const Region& a, const Region& b) { return a.perms == b.perms && a.state == b.state; }
+
+	iterator findMutable(u32 vaddr) {
+		auto it = regions.upper_bound(vaddr);
+		if (it == regions.begin()) {
+			return regions.end();
+		}
+
+		it = std::prev(it);
+		return vaddr < getEnd(it) ? it : regions.end();
+	}
+
+  public:
+	static u32 getEnd(const_iterator it) { return it->first + (it->second.pages << 12); }
+
+	// Make the whole map a single region starting at address 0
+	void reset(u32 pages, u32 perms, u32 state) {
+		regions.clear();
+		regions.emplace(0, Region{pages, perms, state});
+	}
+
+	// Returns the region that contains vaddr, or end() if the address isn't mapped by any region
+	const_iterator find(u32 vaddr) const {
+		auto it = regions.upper_bound(vaddr);
+		if (it == regions.begin()) {
+			return regions.end();
+		}
+
+		it = std::prev(it);
+		return vaddr < getEnd(it) ? it : regions.end();
+	}
+
+	// Returns whether all the pages in [vaddr, vaddr + pages * 4KB) are in the specified state
+	bool testState(u32 vaddr, s32 pages, u32 state) const {
+		for (auto it = find(vaddr); it != regions.end(); it++) {
+			if (it->second.state != state) return false;
+
+			// If the end of this region comes after the end of the requested range with no errors, it's a success
+			if (getEnd(it) >= vaddr + (pages << 12)) return true;
+		}
+
+		return false;
+	}
+
+	// Change the permissions and/or state of [vaddr, vaddr + pages * 4KB), splitting the region that contains it as needed.
+	// The range must be inside a single region. Returns false if it isn't, in which case nothing is changed. Empty ranges are a no-op
+	bool change(u32 vaddr, s32 pages, std::optional<u32> perms, std::optional<u32> state) {
+		if (pages <= 0) {
+			return true;
+		}
+
+		const u32 reqStart = vaddr;
+		const u32 reqEnd = vaddr + (pages << 12);
+
+		auto it = findMutable(reqStart);
+		if (it == regions.end() || reqEnd > getEnd(it)) {
+			return false;
+		}
+
+		const u32 blockStart = it->first;
+		const u32 blockEnd = getEnd(it);
+		const Region old = it->second;
+		const Region updated{u32(pages), perms.value_or(old.perms), state.value_or(old.state)};
+
+		// If the requested range is smaller than the region, the region must be split
+		if (blockStart < reqStart) {
+			it->second.pages = (reqStart - blockStart) >> 12;
+			it = regions.emplace_hint(std::next(it), reqStart, updated);
+		} else {
+			it->second = updated;
+		}
+
+		if (reqEnd < blockEnd) {
+			regions.emplace_hint(std::next(it), reqEnd, Region{(blockEnd - reqEnd) >> 12, old.perms, old.state});
+		}
+
+		// Neighbouring regions were already merged before this change, so only the changed region can be merged with its neighbours
+		if (auto next = std::next(it); next != regions.end() && canMerge(it->second, next->second)) {
+			it->second.pages += next->second.pages;
+			regions.erase(next);
+		}
+
+		if (it != regions.begin()) {
+			if (auto prev = std::prev(it); canMerge(prev->second, it->second)) {
+				prev->second.pages += it->second.pages;
+				regions.erase(it);
+			}
+		}
+
+		return true;
+	}
+
+	const_iterator begin() const { return regions.begin(); }
+	const_iterator end() const { return regions.end(); }
+	usize size() const { return regions.size(); }
+};
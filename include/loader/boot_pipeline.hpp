@@ -0,0 +1,61 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "helpers.hpp"
+
+namespace Loader {
+	// Runs the independent stages of loading a ROM, like reading and decrypting the files of different partitions, in parallel.
+	// Jobs are queued up with submit and start running once wait is called, on a few short-lived threads plus the calling thread.
+	class TaskGroup {
+		using Job = std::function<void()>;
+		std::vector<Job> jobs;
+
+	  public:
+		// Loading is mostly bound by disk reads and AES decryption, so a few threads are plenty
+		static constexpr usize maxThreads = 4;
+
+		void submit(Job job) { jobs.push_back(std::move(job)); }
+		// Run all submitted jobs and wait for them to finish
+		void wait();
+	};
+
+	// Wall-clock time spent in each stage of loading a ROM. Stages that ran in parallel overlap, so they can add up to more than the total
+	class BootTimings {
+	  public:
+		using Clock = std::chrono::steady_clock;
+
+	  private:
+		struct Stage {
+			std::string name;
+			double milliseconds;
+		};
+
+		std::mutex mutex;
+		std::vector<Stage> stages;
+		Clock::time_point start = Clock::now();
+
+	  public:
+		void record(std::string name, Clock::time_point stageStart);
+
+		// Run func and record how long it took as a stage. Safe to call from multiple threads
+		template <typename Func>
+		auto measure(std::string name, Func&& func) {
+			const Clock::time_point stageStart = Clock::now();
+			if constexpr (std::is_void_v<decltype(func())>) {
+				func();
+				record(std::move(name), stageStart);
+			} else {
+				auto result = func();
+				record(std::move(name), stageStart);
+				return result;
+			}
+		}
+
+		void print();
+	};
+}  // namespace Loader
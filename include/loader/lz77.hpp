@@ -14,4 +14,9 @@ namespace CartLZ77 {
 
     // Decompresses an LZ77-compressed buffer stored in input to output
     bool decompress(std::vector<u8>& output, const std::vector<u8>& input);
+
+    // Decompresses the compressedSize bytes at the start of buffer in place. The compression scheme works backwards from the end of the
+    // buffer so that this is possible, which lets the code be decompressed straight into the memory it gets loaded to.
+    // buffer must have room for decompressedSize bytes
+    bool decompressInPlace(u8* buffer, u32 compressedSize, u32 decompressedSize);
 } // End namespace CartLZ77
@@ -40,12 +40,14 @@ struct NCCH {
 	u64 fileOffset = 0;
 
 	bool isNew3DS = false;
+	bool requestsNew3DSClock = false;  // Whether the exheader asks for the 804MHz clock of the New 3DS
 	bool initialized = false;
 	bool compressCode = false;  // Shows whether the .code file in the ExeFS is compressed
 	bool mountRomFS = false;
 	bool encrypted = false;
 	bool fixedCryptoKey = false;
 	bool seedCrypto = false;
+	bool gotCryptoKeys = true;  // Shows whether we got the primary and secondary keys correctly
 	u8 secondaryKeySlot = 0;
 
 	static constexpr u64 mediaUnit = 0x200;
@@ -63,20 +65,32 @@ struct NCCH {
 
 	std::optional<Crypto::AESKey> primaryKey, secondaryKey;
 
-	// Contents of the .code file in the ExeFS
-	std::vector<u8> codeFile;
+	// Location of the .code and icon files, relative to the start of the ExeFS
+	u32 codeOffset = 0, codeSize = 0;
+	u32 iconOffset = 0, iconSize = 0;
 	// The cart region. Only the CXI's region matters to us. Necessary to get past region locking
 	std::optional<Regions> region = std::nullopt;
 	std::vector<u8> smdh;
 
-	// Returns true on success, false on failure
+	// Loading happens in stages so that the independent ones can run in parallel. All of these return true on success, false on failure.
+	// loadHeader comes first, and must only run on one partition at a time as it uses the key slots of the AES engine.
 	// Partition index/offset/size must have been set before this
-	bool loadFromHeader(Crypto::AESEngine &aesEngine, IOFile &file, const FSInfo &info);
+	bool loadHeader(Crypto::AESEngine &aesEngine, IOFile &file, const FSInfo &info);
+	// Then loadExtendedHeader followed by loadExeFSHeader. After these, the code and icon can be loaded in any order
+	bool loadExtendedHeader(Crypto::AESEngine &aesEngine, IOFile &file);
+	bool loadExeFSHeader(IOFile &file);
+	// Reads the icon, if any, to detect the region. The CXI falls back to the default region even if reading the icon fails
+	bool loadIcon(IOFile &file);
+
+	// Size of the .code file once decompressed
+	std::optional<u32> getCodeSize(IOFile &file);
+	// Read the .code file into dst and decompress it in place if needed. dst must have room for getCodeSize() bytes
+	bool loadCode(IOFile &file, u8 *dst, u32 decompressedSize);
 
 	bool hasExtendedHeader() { return exheaderSize != 0; }
 	bool hasExeFS() { return exeFS.size != 0; }
 	bool hasRomFS() { return romFS.size != 0; }
-	bool hasCode() { return codeFile.size() != 0; }
+	bool hasCode() { return codeSize != 0; }
 	bool hasSaveData() { return saveDataSize != 0; }
 
 	// Parse SMDH for region info and such. Returns false on failure, true on success
@@ -85,5 +99,7 @@ struct NCCH {
 	std::pair<bool, Crypto::AESKey> getPrimaryKey(Crypto::AESEngine &aesEngine, const Crypto::AESKey &keyY);
 	std::pair<bool, Crypto::AESKey> getSecondaryKey(Crypto::AESEngine &aesEngine, const Crypto::AESKey &keyY);
 
+	// ExeFS info with the key used for decrypting the .code file
+	FSInfo getCodeFSInfo();
 	std::pair<bool, std::size_t> readFromFile(IOFile &file, const FSInfo &info, u8 *dst, std::size_t offset, std::size_t size);
 };
\ No newline at end of file
@@ -1,94 +1,312 @@
 #pragma once
-#include <cstdarg>
-#include <fstream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
-#ifdef __ANDROID__
-#include <android/log.h>
-#endif
+#include "helpers.hpp"
 
+// Logging backend. Every logger is a category with a level that can be changed at runtime, so logs can be captured from any build without
+// recompiling. Log calls don't format anything: they pack the format string pointer and a copy of their arguments into a fixed-size binary
+// record, which is pushed to a ring buffer owned by the calling thread. A background worker drains the buffers and formats the records.
+// If the worker isn't running (eg before the emulator is constructed, or in tools), records are formatted immediately instead.
+// The rare messages with arguments too big for a record, like long strings, are formatted immediately as well rather than truncated.
 namespace Log {
+	enum class Level : u8 {
+		Debug,
+		Info,
+		Warning,
+		Error,
+		Off,
+	};
+
+	enum class Category : u8 {
+		Kernel,
+		DebugString,
+		Error,
+		FileIO,
+		SVC,
+		Thread,
+		GPU,
+		Renderer,
+		ShaderJIT,
+		DSP,
+
+		// Services
+		AC,
+		ACT,
+		AM,
+		APT,
+		BOSS,
+		CAM,
+		CECD,
+		CFG,
+		CSND,
+		DSPService,
+		DLPSrvr,
+		FRD,
+		FS,
+		HID,
+		HTTP,
+		IRUser,
+		GSPGPU,
+		GSPLCD,
+		LDR,
+		MCU,
+		MIC,
+		NEWS,
+		NFC,
+		NWMUDS,
+		NIM,
+		NDM,
+		NS,
+		PTM,
+		SOC,
+		SSL,
+		Y2R,
+		SRV,
+
+		Count,
+	};
+
+	static constexpr usize categoryCount = static_cast<usize>(Category::Count);
+
+	// The minimum level a message needs for it to be logged, for each category
+	extern std::array<std::atomic<Level>, categoryCount> categoryLevels;
+
+	static bool isEnabled(Category category, Level level) {
+		return level >= categoryLevels[static_cast<usize>(category)].load(std::memory_order_relaxed);
+	}
+
+	void setLevel(Category category, Level level);
+	Level getLevel(Category category);
+	const char* categoryName(Category category);
+
+	// Apply a comma-separated list of "category:level" pairs, eg "*:off,kernel:debug,fs:info". Category names are case-insensitive, and "*"
+	// matches every category. Returns false if any of the entries was invalid, in which case the valid ones are still applied
+	bool applyFilter(const std::string& filter);
+
+	// Start the background thread that formats records. Until it is started, records are formatted as soon as they're logged
+	void startWorker();
+	// Format every pending record, then stop the background thread
+	void stopWorker();
+	// Format every pending record on the calling thread
+	void flush();
+	// Number of records that were thrown away because a ring buffer was full
+	u64 getDroppedRecords();
+
+	// A log message as stored in the ring buffers. The payload holds the message arguments, each one being a type tag followed by its value
+	struct Record {
+		static constexpr usize size = 256;
+		static constexpr usize headerSize = sizeof(u64) + sizeof(const char*) + 3 * sizeof(u8);
+		static constexpr usize payloadCapacity = size - headerSize;
+
+		enum class ArgType : u8 {
+			Int32,
+			Int64,
+			Double,
+			Pointer,
+			String,  // Followed by a u32 length, then the characters
+		};
+
+		u64 timestamp;
+		const char* format;
+		Category category;
+		Level level;
+		u8 payloadSize;
+		std::array<u8, payloadCapacity> payload;
+	};
+	static_assert(sizeof(Record) == Record::size);
+
+	// Packs the arguments of a log message into a payload. If they don't fit, the writer stops and reports an overflow.
+	// With a null buffer, nothing is written and the writer only counts how big the payload is
+	class PayloadWriter {
+		u8* data;
+		usize capacity;
+		usize payloadSize = 0;
+		bool overflow = false;
+
+		void pushBytes(Record::ArgType type, const void* header, usize headerSize, const void* body = nullptr, usize bodySize = 0) {
+			if (overflow || payloadSize + 1 + headerSize + bodySize > capacity) {
+				overflow = true;
+				return;
+			}
+
+			if (data != nullptr) {
+				data[payloadSize] = static_cast<u8>(type);
+				std::memcpy(&data[payloadSize + 1], header, headerSize);
+				if (bodySize != 0) {
+					std::memcpy(&data[payloadSize + 1 + headerSize], body, bodySize);
+				}
+			}
+
+			payloadSize += 1 + headerSize + bodySize;
+		}
+
+	  public:
+		PayloadWriter(u8* data, usize capacity) : data(data), capacity(capacity) {}
+
+		usize size() const { return payloadSize; }
+		bool overflowed() const { return overflow; }
+
+		template <typename T>
+		void push(const T& arg) {
+			using Type = std::decay_t<T>;
+
+			if constexpr (std::is_convertible_v<const Type&, std::string_view>) {
+				std::string_view string;
+				if constexpr (std::is_pointer_v<Type>) {
+					const char* pointer = arg;
+					string = pointer == nullptr ? std::string_view("(null)") : std::string_view(pointer);
+				} else {
+					string = std::string_view(arg);
+				}
+
+				const u32 length = u32(std::min<usize>(string.size(), UINT32_MAX));
+				pushBytes(Record::ArgType::String, &length, sizeof(length), string.data(), length);
+			} else if constexpr (std::is_enum_v<Type>) {
+				push(static_cast<std::underlying_type_t<Type>>(arg));
+			} else if constexpr (std::is_floating_point_v<Type>) {
+				const double value = arg;
+				pushBytes(Record::ArgType::Double, &value, sizeof(value));
+			} else if constexpr (std::is_integral_v<Type> && sizeof(Type) <= sizeof(u32)) {
+				// Sign-extend or zero-extend the same way the default argument promotions would
+				const u32 value = std::is_signed_v<Type> ? u32(s32(arg)) : u32(arg);
+				pushBytes(Record::ArgType::Int32, &value, sizeof(value));
+			} else if constexpr (std::is_integral_v<Type>) {
+				const u64 value = u64(arg);
+				pushBytes(Record::ArgType::Int64, &value, sizeof(value));
+			} else if constexpr (std::is_pointer_v<Type>) {
+				const u64 value = u64(reinterpret_cast<uintptr_t>(arg));
+				pushBytes(Record::ArgType::Pointer, &value, sizeof(value));
+			} else {
+				static_assert(std::is_pointer_v<Type>, "Unsupported log argument type");
+			}
+		}
+	};
+
+	// Returns a record to fill in, from the ring buffer of the calling thread. Returns nullptr if the buffer is full
+	Record* beginRecord();
+	// Publish a record obtained from beginRecord. If the background worker isn't running, it's formatted immediately
+	void commitRecord(Record* record);
+	// Format a record to a string, as printf would have
+	std::string formatRecord(const Record& record);
+	// Slow path for messages whose arguments don't fit in a record. The message is formatted and printed on the calling thread, after
+	// every record that's already pending, so that it doesn't get cut off
+	void logOversized(Category category, Level level, const char* format, const u8* payload, usize payloadSize);
+
 	// Our logger class
-	template <bool enabled>
 	class Logger {
+		Category category;
+
+		template <typename... Args>
+		void logOversized(Level level, const char* fmt, const Args&... args) const {
+			PayloadWriter counter(nullptr, SIZE_MAX);
+			(counter.push(args), ...);
+
+			std::vector<u8> payload(counter.size());
+			PayloadWriter writer(payload.data(), payload.size());
+			(writer.push(args), ...);
+			Log::logOversized(category, level, fmt, payload.data(), payload.size());
+		}
+
 	  public:
-		void log(const char* fmt, ...) {
-			if constexpr (!enabled) return;
-
-			std::va_list args;
-			va_start(args, fmt);
-#ifdef __ANDROID__
-			__android_log_vprint(ANDROID_LOG_DEFAULT, "Panda3DS", fmt, args);
-#else
-			std::vprintf(fmt, args);
-#endif
-			va_end(args);
+		constexpr Logger(Category category) : category(category) {}
+
+		template <typename... Args>
+		void log(Level level, const char* fmt, const Args&... args) const {
+			if (!isEnabled(category, level)) [[likely]] {
+				return;
+			}
+
+			Record* record = beginRecord();
+			if (record == nullptr) [[unlikely]] {
+				return;
+			}
+
+			PayloadWriter writer(record->payload.data(), Record::payloadCapacity);
+			(writer.push(args), ...);
+
+			// Messages with long strings don't fit in a record. We leave the record unpublished and take the slow path instead
+			if (writer.overflowed()) [[unlikely]] {
+				logOversized(level, fmt, args...);
+				return;
+			}
+
+			record->format = fmt;
+			record->category = category;
+			record->level = level;
+			record->payloadSize = u8(writer.size());
+			commitRecord(record);
 		}
 	};
 
-	// Our loggers here. Enable/disable by toggling the template param
-	static Logger<false> kernelLogger;
+	// Our loggers here. Their default level is set in logger.cpp, and they can be toggled at runtime with setLevel or applyFilter
+	static constexpr Logger kernelLogger{Category::Kernel};
 	// Enables output for the outputDebugString SVC
-	static Logger<true> debugStringLogger;
-	static Logger<false> errorLogger;
-	static Logger<false> fileIOLogger;
-	static Logger<false> svcLogger;
-	static Logger<false> threadLogger;
-	static Logger<false> gpuLogger;
-	static Logger<false> rendererLogger;
-	static Logger<false> shaderJITLogger;
-	static Logger<false> dspLogger;
+	static constexpr Logger debugStringLogger{Category::DebugString};
+	static constexpr Logger errorLogger{Category::Error};
+	static constexpr Logger fileIOLogger{Category::FileIO};
+	static constexpr Logger svcLogger{Category::SVC};
+	static constexpr Logger threadLogger{Category::Thread};
+	static constexpr Logger gpuLogger{Category::GPU};
+	static constexpr Logger rendererLogger{Category::Renderer};
+	static constexpr Logger shaderJITLogger{Category::ShaderJIT};
+	static constexpr Logger dspLogger{Category::DSP};
 
 	// Service loggers
-	static Logger<false> acLogger;
-	static Logger<false> actLogger;
-	static Logger<false> amLogger;
-	static Logger<false> aptLogger;
-	static Logger<false> bossLogger;
-	static Logger<false> camLogger;
-	static Logger<false> cecdLogger;
-	static Logger<false> cfgLogger;
-	static Logger<false> csndLogger;
-	static Logger<false> dspServiceLogger;
-	static Logger<false> dlpSrvrLogger;
-	static Logger<false> frdLogger;
-	static Logger<false> fsLogger;
-	static Logger<false> hidLogger;
-	static Logger<false> httpLogger;
-	static Logger<false> irUserLogger;
-	static Logger<false> gspGPULogger;
-	static Logger<false> gspLCDLogger;
-	static Logger<false> ldrLogger;
-	static Logger<false> mcuLogger;
-	static Logger<false> micLogger;
-	static Logger<false> newsLogger;
-	static Logger<false> nfcLogger;
-	static Logger<false> nwmUdsLogger;
-	static Logger<false> nimLogger;
-	static Logger<false> ndmLogger;
-	static Logger<false> nsLogger;
-	static Logger<false> ptmLogger;
-	static Logger<false> socLogger;
-	static Logger<false> sslLogger;
-	static Logger<false> y2rLogger;
-	static Logger<false> srvLogger;
+	static constexpr Logger acLogger{Category::AC};
+	static constexpr Logger actLogger{Category::ACT};
+	static constexpr Logger amLogger{Category::AM};
+	static constexpr Logger aptLogger{Category::APT};
+	static constexpr Logger bossLogger{Category::BOSS};
+	static constexpr Logger camLogger{Category::CAM};
+	static constexpr Logger cecdLogger{Category::CECD};
+	static constexpr Logger cfgLogger{Category::CFG};
+	static constexpr Logger csndLogger{Category::CSND};
+	static constexpr Logger dspServiceLogger{Category::DSPService};
+	static constexpr Logger dlpSrvrLogger{Category::DLPSrvr};
+	static constexpr Logger frdLogger{Category::FRD};
+	static constexpr Logger fsLogger{Category::FS};
+	static constexpr Logger hidLogger{Category::HID};
+	static constexpr Logger httpLogger{Category::HTTP};
+	static constexpr Logger irUserLogger{Category::IRUser};
+	static constexpr Logger gspGPULogger{Category::GSPGPU};
+	static constexpr Logger gspLCDLogger{Category::GSPLCD};
+	static constexpr Logger ldrLogger{Category::LDR};
+	static constexpr Logger mcuLogger{Category::MCU};
+	static constexpr Logger micLogger{Category::MIC};
+	static constexpr Logger newsLogger{Category::NEWS};
+	static constexpr Logger nfcLogger{Category::NFC};
+	static constexpr Logger nwmUdsLogger{Category::NWMUDS};
+	static constexpr Logger nimLogger{Category::NIM};
+	static constexpr Logger ndmLogger{Category::NDM};
+	static constexpr Logger nsLogger{Category::NS};
+	static constexpr Logger ptmLogger{Category::PTM};
+	static constexpr Logger socLogger{Category::SOC};
+	static constexpr Logger sslLogger{Category::SSL};
+	static constexpr Logger y2rLogger{Category::Y2R};
+	static constexpr Logger srvLogger{Category::SRV};
 
 	// We have 2 ways to create a log function
-	// MAKE_LOG_FUNCTION: Creates a log function which is toggleable but always killed for user-facing builds
-	// MAKE_LOG_FUNCTION_USER: Creates a log function which is toggleable, may be on for user builds as well
-	// We need this because sadly due to the loggers taking variadic arguments, compilers will not properly
-	// Kill them fully even when they're disabled. The only way they will is if the function with varargs is totally empty
-
-#define MAKE_LOG_FUNCTION_USER(functionName, logger)     \
-	template <typename... Args>                          \
-	void functionName(const char* fmt, Args&&... args) { \
-		Log::logger.log(fmt, args...);                   \
+	// MAKE_LOG_FUNCTION: Creates a log function for developer-facing messages, logged at the Debug level
+	// MAKE_LOG_FUNCTION_USER: Creates a log function for messages that may be of interest to users as well, logged at the Info level
+	// Both are available in every build. When their category is disabled, a log call costs an atomic load and a branch
+
+#define MAKE_LOG_FUNCTION_USER(functionName, logger)          \
+	template <typename... Args>                               \
+	void functionName(const char* fmt, const Args&... args) { \
+		Log::logger.log(Log::Level::Info, fmt, args...);      \
 	}
 
-#ifdef PANDA3DS_USER_BUILD
-#define MAKE_LOG_FUNCTION(functionName, logger) \
-	template <typename... Args>                 \
-	void functionName(const char* fmt, Args&&... args) {}
-#else
-#define MAKE_LOG_FUNCTION(functionName, logger) MAKE_LOG_FUNCTION_USER(functionName, logger)
-#endif
-}
\ No newline at end of file
+#define MAKE_LOG_FUNCTION(functionName, logger)               \
+	template <typename... Args>                               \
+	void functionName(const char* fmt, const Args&... args) { \
+		Log::logger.log(Log::Level::Debug, fmt, args...);     \
+	}
+}
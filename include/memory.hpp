@@ -12,7 +12,9 @@
 #include "helpers.hpp"
 #include "host_memory/host_memory.h"
 #include "kernel/fcram.hpp"
+#include "kernel/virtual_memory_map.hpp"
 #include "loader/3dsx.hpp"
+#include "loader/boot_pipeline.hpp"
 #include "loader/ncsd.hpp"
 #include "result/result.hpp"
 #include "services/region_codes.hpp"
@@ -129,7 +131,7 @@ class Memory {
 	std::vector<u32> paddrTable;
 
 	// This tracks our OS' memory allocations
-	std::list<KernelMemoryTypes::MemoryInfo> memoryInfo;
+	VirtualMemoryMap memoryInfo;
 
 	std::array<SharedMemoryBlock, 5> sharedMemBlocks = {
 		SharedMemoryBlock(
@@ -233,7 +235,7 @@ class Memory {
 	std::optional<NCSD> loadNCSD(Crypto::AESEngine& aesEngine, const std::filesystem::path& path);
 	std::optional<NCSD> loadCXI(Crypto::AESEngine& aesEngine, const std::filesystem::path& path);
 
-	bool mapCXI(NCSD& ncsd, NCCH& cxi);
+	bool mapCXI(NCSD& ncsd, NCCH& cxi, Loader::BootTimings& timings);
 	bool map3DSX(HB3DSX& hb3dsx, const HB3DSX::Header& header);
 
 	u8 read8(u32 vaddr);
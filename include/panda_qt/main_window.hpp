@@ -54,6 +54,8 @@ class MainWindow : public QMainWindow {
 		ReloadUbershader,
 		SetScreenSize,
 		UpdateConfig,
+		ToggleFastForward,
+		SetTurbo,
 	};
 
 	// Tagged union representing our message queue messages
@@ -90,6 +92,10 @@ class MainWindow : public QMainWindow {
 				u32 width;
 				u32 height;
 			} screenSize;
+
+			struct {
+				bool enabled;
+			} turbo;
 		};
 	};
 
@@ -115,6 +121,8 @@ class MainWindow : public QMainWindow {
 	CPUDebugger* cpuDebugger;
 	DSPDebugger* dspDebugger;
 	ThreadDebugger* threadDebugger;
+	QTimer* statsTimer;
+	u64 lastFramesEmulated = 0;
 
 	// We use SDL's game controller API since it's the sanest API that supports as many controllers as possible
 	SDL_GameController* gameController = nullptr;
@@ -135,6 +143,7 @@ class MainWindow : public QMainWindow {
 	void sendMessage(const EmulatorMessage& message);
 	void dispatchMessage(const EmulatorMessage& message);
 	void loadTranslation();
+	void updateWindowTitle();
 
 	void loadKeybindings();
 	void saveKeybindings();
@@ -160,6 +169,8 @@ class MainWindow : public QMainWindow {
 	void closeEvent(QCloseEvent* event) override;
 	void keyPressEvent(QKeyEvent* event) override;
 	void keyReleaseEvent(QKeyEvent* event) override;
+	// Tab is the turbo hotkey, so don't let Qt use it for moving focus between widgets
+	bool focusNextPrevChild(bool next) override { return false; }
 
 	void mousePressEvent(QMouseEvent* event) override;
 	void mouseReleaseEvent(QMouseEvent* event) override;
@@ -3,6 +3,7 @@
 #include <SDL.h>
 
 #include <filesystem>
+#include <string>
 
 #include "emulator.hpp"
 #include "input_mappings.hpp"
@@ -21,6 +22,8 @@ class FrontendSDL {
 	u32 getMapping(InputMappings::Scancode scancode) { return keyboardMappings.getMapping(scancode); }
 
 	SDL_Window* window = nullptr;
+	std::string windowTitle;
+	u32 lastTitleUpdate = 0;  // SDL tick count of the last time the frame statistics in the title were updated
 	SDL_GameController* gameController = nullptr;
 	InputMappings keyboardMappings;
 
@@ -46,4 +49,5 @@ class FrontendSDL {
   private:
 	void setupControllerSensors(SDL_GameController* controller);
 	void handleLeftClick(int mouseX, int mouseY);
+	void updateWindowTitle();
 };
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+#include <array>
+#include <filesystem>
+
+#include "helpers.hpp"
+
+// Lightweight instrumentation for finding out where frame time goes. Code is annotated with PROFILE_SCOPE, which records the start and end of
+// the scope into a buffer owned by the calling thread, without taking any locks. The recorded events can be exported as a Chrome trace
+// (viewable in chrome://tracing or ui.perfetto.dev), and are also summed up into per-frame counters for every subsystem.
+// The scopes compile to nothing unless we're building with ENABLE_PROFILING.
+namespace Profiler {
+	enum class Category : u8 {
+		CPU,
+		Kernel,
+		Service,
+		GPU,
+		Renderer,
+		DSP,
+		Count,
+	};
+
+	static constexpr usize categoryCount = static_cast<usize>(Category::Count);
+
+	struct CategoryStats {
+		u64 nanoseconds = 0;  // Total time spent in scopes of this category. Nested scopes of the same category are counted twice
+		u32 scopes = 0;       // Number of scopes of this category that ended during the frame
+	};
+
+	using FrameStats = std::array<CategoryStats, categoryCount>;
+
+	const char* categoryName(Category category);
+}  // namespace Profiler
+
+#ifdef PANDA3DS_ENABLE_PROFILING
+namespace Profiler {
+	// Recording is on by default in profiling builds. Disabled scopes only cost an atomic load
+	void setEnabled(bool enabled);
+	bool isEnabled();
+
+	// Marks the end of an emulated frame, moving the counters accumulated during it to the "last frame" stats
+	void endFrame();
+	FrameStats getLastFrameStats();
+
+	// Write every event still held in the per-thread buffers to a Chrome trace event JSON file. Returns whether it succeeded
+	bool exportChromeTrace(const std::filesystem::path& path);
+	// Throw away all recorded events
+	void clear();
+
+	// Returns whether we've compiled with profiling support
+	static constexpr bool isSupported() { return true; }
+
+	class Scope {
+		const char* name;
+		u64 start;
+		Category category;
+
+	  public:
+		// The name is stored as a pointer, so it needs to outlive the profiler. In practice this means it should be a string literal
+		Scope(const char* name, Category category);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+}  // namespace Profiler
+
+#define PROFILE_SCOPE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_SCOPE_CONCAT(a, b) PROFILE_SCOPE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name, category) Profiler::Scope PROFILE_SCOPE_CONCAT(profilerScope, __LINE__)(name, Profiler::Category::category)
+#define PROFILE_END_FRAME() Profiler::endFrame()
+#else
+namespace Profiler {
+	static void setEnabled(bool enabled) {}
+	static constexpr bool isEnabled() { return false; }
+	static void endFrame() {}
+	static FrameStats getLastFrameStats() { return {}; }
+	static bool exportChromeTrace(const std::filesystem::path& path) { return false; }
+	static void clear() {}
+	static constexpr bool isSupported() { return false; }
+}  // namespace Profiler
+
+#define PROFILE_SCOPE(name, category) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
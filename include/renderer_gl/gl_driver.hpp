@@ -8,6 +8,8 @@ namespace OpenGL {
 		bool usingGLES = false;
 		bool supportsExtFbFetch = false;
 		bool supportsArmFbFetch = false;
+		// KHR_parallel_shader_compile or ARB_parallel_shader_compile. Lets us check if shaders are done compiling without blocking
+		bool supportsParallelShaderCompile = false;
 
 		// Minimum alignment for UBO offsets. Fetched by the OpenGL renderer using glGetIntegerV.
 		GLuint uboAlignment = 16;
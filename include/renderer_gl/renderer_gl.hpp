@@ -4,13 +4,16 @@
 #include <cstring>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "PICA/float_types.hpp"
 #include "PICA/pica_frag_config.hpp"
+#include "PICA/pica_frag_uniforms.hpp"
 #include "PICA/pica_hash.hpp"
 #include "PICA/pica_vert_config.hpp"
 #include "PICA/pica_vertex.hpp"
@@ -22,12 +25,20 @@
 #include "helpers.hpp"
 #include "logger.hpp"
 #include "renderer.hpp"
+#include "shader_compile_workers.hpp"
 #include "surface_cache.hpp"
 #include "textures.hpp"
 
 // More circular dependencies!
 class GPU;
 
+// Per-frame counters for uniform uploads. Used for checking that we're not uploading uniforms that didn't change
+struct UniformUploadStats {
+	u64 bytesUploaded = 0;   // Bytes of uniform data uploaded to the GPU, both via UBOs and glUniform calls
+	u32 updates = 0;         // Draws that had to upload fragment uniforms or ubershader registers
+	u32 skippedUpdates = 0;  // Draws that could reuse the uniforms of a previous draw
+};
+
 class RendererGL final : public Renderer {
 	GLStateManager gl = {};
 
@@ -49,8 +60,9 @@ class RendererGL final : public Renderer {
 		GLint textureEnvColorLoc = -1;
 		GLint textureEnvScaleLoc = -1;
 
-		// Uniform of PICA registers
+		// Uniform of PICA registers, and the location of the first register of each register group in it, so that we can upload groups separately
 		GLint picaRegLoc = -1;
+		std::array<GLint, 5> picaRegGroupLocs;
 
 		// Depth configuration uniform locations
 		GLint depthOffsetLoc = -1;
@@ -61,6 +73,22 @@ class RendererGL final : public Renderer {
 	float oldDepthScale = -1.0;
 	float oldDepthOffset = 0.0;
 	bool oldDepthmapEnable = false;
+
+	// Fragment shader configuration for the current draw. Only rebuilt when the registers it's derived from have been modified
+	std::optional<PICA::FragmentConfig> fsConfig;
+	// PICA register groups whose registers & TEV configuration uploaded to the ubershader are out of date
+	u32 ubershaderDirtyGroups = PICA::DirtyRegs::Fragment;
+
+	// Fragment uniforms for specialized shaders. We only recompute the parts whose registers were modified since the last draw,
+	// and only upload them to the UBO if they actually changed, otherwise the UBO range from the previous upload is reused
+	PICA::FragmentUniforms fragmentUniforms{};
+	u32 fragmentUniformDirtyGroups = PICA::DirtyRegs::Fragment;
+	bool fragmentUniformsUploaded = false;
+	// Whether hwShaderUniformUBOOffset is bound to the vertex shader uniform block binding point, to skip redundant glBindBufferRange calls
+	bool hwShaderUBOBound = false;
+
+	UniformUploadStats uniformStats;
+	UniformUploadStats lastFrameUniformStats;
 	// Set by prepareForDraw, tells us whether the current draw is using hw-accelerated shader
 	bool usingAcceleratedShader = false;
 	bool performIndexedRender = false;
@@ -107,19 +135,38 @@ class RendererGL final : public Renderer {
 	// Cache of fixed attribute values so that we don't do any duplicate updates
 	std::array<std::array<float, 4>, 16> fixedAttrValues;
 
+	// State of a specialized shader or program. Without async shader compilation, everything is compiled on the spot and is always Ready
+	enum class CompileStatus : u8 {
+		Generating,  // Source code is being generated by a compile worker
+		Compiling,   // Compiling or linking has been kicked off, but the driver might still be working on it
+		Ready,       // Compilation finished. The handle is 0 if it failed
+	};
+
+	struct CachedShader {
+		OpenGL::Shader shader;
+		CompileStatus status = CompileStatus::Ready;
+	};
+
 	// Cached recompiled fragment shader
 	struct CachedProgram {
 		OpenGL::Program program;
+		CompileStatus status = CompileStatus::Ready;
+		bool usesHwVertexShader = false;
 	};
 
 	struct ShaderCache {
-		std::unordered_map<PICA::VertConfig, std::optional<OpenGL::Shader>> vertexShaderCache;
-		std::unordered_map<PICA::FragmentConfig, OpenGL::Shader> fragmentShaderCache;
+		// If a vertex config is not in the cache, we have never tried to recompile the shader before
+		std::unordered_map<PICA::VertConfig, CachedShader> vertexShaderCache;
+		std::unordered_map<PICA::FragmentConfig, CachedShader> fragmentShaderCache;
 
 		// Program cache indexed by GLuints for the vertex and fragment shader to use
 		// Top 32 bits are the vertex shader GLuint, bottom 32 bits are the fs GLuint
 		std::unordered_map<u64, CachedProgram> programCache;
 
+		// Shaders and programs that are currently being compiled or linked by the driver in the background
+		std::vector<CachedShader*> compilingShaders;
+		std::vector<CachedProgram*> linkingPrograms;
+
 		void clear() {
 			for (auto& it : programCache) {
 				CachedProgram& cachedProgram = it.second;
@@ -127,25 +174,46 @@ class RendererGL final : public Renderer {
 			}
 
 			for (auto& it : vertexShaderCache) {
-				if (it.second.has_value()) {
-					it.second->free();
-				}
+				it.second.shader.free();
 			}
 
 			for (auto& it : fragmentShaderCache) {
-				it.second.free();
+				it.second.shader.free();
 			}
 
 			programCache.clear();
 			vertexShaderCache.clear();
 			fragmentShaderCache.clear();
+			compilingShaders.clear();
+			linkingPrograms.clear();
 		}
 	};
 	ShaderCache shaderCache;
 
+	// Asynchronous shader compilation: Shader source is generated by a pool of worker threads, and compiled & linked in the background by the
+	// driver when it supports KHR/ARB_parallel_shader_compile. Until a specialized program is ready, draws are rendered with the ubershader.
+	bool asyncShaderCompilation = false;
+	ShaderCompileWorkers shaderCompileWorkers;
+	ShaderCompileStats shaderCompileStats;
+
+	// Shader sources produced by the compile workers, waiting to be compiled on the emulator thread
+	std::mutex generatedShadersMutex;
+	std::vector<std::pair<PICA::VertConfig, std::string>> generatedVertexShaders;
+	std::vector<std::pair<PICA::FragmentConfig, std::string>> generatedFragmentShaders;
+
+	static constexpr uint vsUBOBlockBinding = 1;
+	static constexpr uint fsUBOBlockBinding = 2;
+
 	OpenGL::Framebuffer getColourFBO();
 	OpenGL::Texture getTexture(Texture& tex);
-	OpenGL::Program& getSpecializedShader();
+	// Returns nullptr if the program isn't ready yet because it's being compiled asynchronously
+	OpenGL::Program* getSpecializedShader();
+	// Returns nullptr if the current PICA vertex shader can't be recompiled, or if it's still being compiled
+	OpenGL::Shader* getAcceleratedVertexShader(ShaderUnit& shaderUnit);
+	void setupSpecializedProgram(OpenGL::Program& program, bool usesHwVertexShader);
+
+	void compileShaderAsync(CachedShader& entry, const std::string& source, GLenum type);
+	void pollAsyncShaders();
 
 	PICA::ShaderGen::FragmentGenerator fragShaderGen;
 	OpenGL::Driver driverInfo;
@@ -176,6 +244,8 @@ class RendererGL final : public Renderer {
 	void setupStencilTest(bool stencilEnable);
 	void bindDepthBuffer();
 	void setupUbershaderTexEnv();
+	void uploadUbershaderRegs();
+	void uploadFragmentUniforms();
 	void bindTexturesToSlots();
 	void updateLightingLUT();
 	void updateFogLUT();
@@ -213,4 +283,7 @@ class RendererGL final : public Renderer {
 
 	// Take a screenshot of the screen and store it in a file
 	void screenshot(const std::string& name) override;
+	const ShaderCompileStats& getShaderCompileStats() const { return shaderCompileStats; }
+	// Uniform upload counters for the last frame that was displayed
+	const UniformUploadStats& getUniformUploadStats() const { return lastFrameUniformStats; }
 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "helpers.hpp"
+
+// Counters for monitoring specialized shader compilation
+struct ShaderCompileStats {
+	u64 pendingCompiles = 0;   // Shaders and programs that have been requested but aren't ready to use yet
+	u64 finishedCompiles = 0;  // Shaders and programs that finished compiling or linking, successfully or not
+	u64 failedCompiles = 0;
+	u64 fallbackDraws = 0;  // Draws that were rendered with the ubershader because their specialized program wasn't ready yet
+	// Time the emulator thread spent generating, compiling and linking shaders, or waiting for the driver to do so
+	double stallTimeMs = 0.0;
+};
+
+// Pool of threads for generating shader source code off the emulator thread. Jobs must not touch the graphics API, as the GL context is only
+// current on the emulator thread. Instead, they hand their results back to the renderer, which does the actual compiling and linking.
+class ShaderCompileWorkers {
+	using Job = std::function<void()>;
+
+	std::vector<std::thread> threads;
+	std::deque<Job> jobs;
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	bool exiting = false;
+
+	void threadLoop();
+
+  public:
+	~ShaderCompileWorkers() { stop(); }
+
+	// Start the worker threads. If threadCount is 0, pick a thread count based on the number of host cores
+	void start(usize threadCount = 0);
+	// Stop all workers. Jobs that haven't started executing yet are discarded
+	void stop();
+	bool isRunning() const { return !threads.empty(); }
+
+	void submit(Job job);
+};
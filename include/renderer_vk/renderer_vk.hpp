@@ -61,6 +61,8 @@ class RendererVK final : public Renderer {
 		u32 loc = 0;
 		u32 sizePerPixel = 0;
 		std::array<u32, 2> size = {};
+		// Only meaningful for colour render-textures, needed to encode the surface when writing it back to guest memory
+		PICA::ColorFmt colorFormat = PICA::ColorFmt::RGBA8;
 
 		vk::Format format;
 		vk::UniqueImage image;
@@ -82,6 +84,13 @@ class RendererVK final : public Renderer {
 	Texture& getColorRenderTexture(u32 addr, PICA::ColorFmt format, u32 width, u32 height);
 	Texture& getDepthRenderTexture(u32 addr, PICA::DepthFmt format, u32 width, u32 height);
 
+	// Submit the current command buffer, block until the GPU has executed it and start recording a new one
+	void flushCommandBuffer();
+	// Copy the colour contents of an image in ShaderReadOnlyOptimal layout into host memory. This flushes the current command buffer
+	std::vector<u8> readbackImage(vk::Image image, u32 width, u32 height, usize bytesPerPixel);
+	// Write the contents of every colour render-texture back to emulated memory, in the tiled PICA format
+	void writebackRenderTextures();
+
 	// Framebuffer for the top/bottom image
 	std::vector<vk::UniqueImage> screenTexture = {};
 	std::vector<vk::UniqueImageView> screenTextureViews = {};
@@ -13,11 +13,17 @@ struct Scheduler {
 		UpdateTimers = 3,    // Update kernel timer objects
 		SignalY2R = 4,       // Signal that a Y2R conversion has finished
 		UpdateIR = 5,        // Update an IR device (For now, just the CirclePad Pro/N3DS controls)
-		Panic = 6,           // Dummy event that is always pending and should never be triggered (Timestamp = UINT64_MAX)
+		UpdateCamera = 6,    // Deliver a new frame to the camera ports that are currently capturing
+		UpdateMic = 7,       // Write a new batch of microphone samples to MIC shared memory
+		SyncGX = 8,          // Wait for GX commands running on the GX thread to finish and relay their interrupts
+		Panic = 9,           // Dummy event that is always pending and should never be triggered (Timestamp = UINT64_MAX)
 		TotalNumberOfEvents  // How many event types do we have in total?
 	};
 	static constexpr usize totalNumberOfEvents = static_cast<usize>(EventType::TotalNumberOfEvents);
+	// Timestamps are counted in system ticks, which run at the old 3DS CPU clock. The tick rate stays the same when the emulated CPU is
+	// clocked higher (eg the New 3DS 804MHz mode), so event timings don't depend on the CPU clock
 	static constexpr u64 arm11Clock = 268111856;
+	static constexpr u64 ticksPerFrame = arm11Clock / 60;
 
 	template <typename Key, typename Val, usize size>
 	using EventMap = boost::container::flat_multimap<Key, Val, std::less<Key>, boost::container::static_vector<std::pair<Key, Val>, size>>;
@@ -93,7 +99,7 @@ struct Scheduler {
 
 		// Clear any pending events
 		events.clear();
-		addEvent(Scheduler::EventType::VBlank, arm11Clock / 60);
+		addEvent(Scheduler::EventType::VBlank, ticksPerFrame);
 
 		// Add a dummy event to always keep the scheduler non-empty
 		addEvent(EventType::Panic, std::numeric_limits<u64>::max());
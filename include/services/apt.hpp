@@ -3,6 +3,7 @@
 
 #include "applets/applet_manager.hpp"
 #include "helpers.hpp"
+#include "ipc.hpp"
 #include "kernel_types.hpp"
 #include "logger.hpp"
 #include "memory.hpp"
@@ -58,29 +59,29 @@ class APTService {
 	MAKE_LOG_FUNCTION(log, aptLogger)
 
 	// Service commands
-	void appletUtility(u32 messagePointer);
-	void getApplicationCpuTimeLimit(u32 messagePointer);
-	void getLockHandle(u32 messagePointer);
-	void checkNew3DS(u32 messagePointer);
-	void checkNew3DSApp(u32 messagePointer);
-	void enable(u32 messagePointer);
-	void getAppletInfo(u32 messagePointer);
-	void getSharedFont(u32 messagePointer);
-	void getWirelessRebootInfo(u32 messagePointer);
-	void glanceParameter(u32 messagePointer);
-	void initialize(u32 messagePointer);
-	void inquireNotification(u32 messagePointer);
-	void isRegistered(u32 messagePointer);
-	void notifyToWait(u32 messagePointer);
-	void preloadLibraryApplet(u32 messagePointer);
-	void prepareToStartLibraryApplet(u32 messagePointer);
-	void receiveParameter(u32 messagePointer);
-	void replySleepQuery(u32 messagePointer);
-	void setApplicationCpuTimeLimit(u32 messagePointer);
-	void setScreencapPostPermission(u32 messagePointer);
-	void sendParameter(u32 messagePointer);
-	void startLibraryApplet(u32 messagePointer);
-	void theSmashBrosFunction(u32 messagePointer);
+	void appletUtility(IPC::Message message);
+	void getApplicationCpuTimeLimit(IPC::Message message);
+	void getLockHandle(IPC::Message message);
+	void checkNew3DS(IPC::Message message);
+	void checkNew3DSApp(IPC::Message message);
+	void enable(IPC::Message message);
+	void getAppletInfo(IPC::Message message);
+	void getSharedFont(IPC::Message message);
+	void getWirelessRebootInfo(IPC::Message message);
+	void glanceParameter(IPC::Message message);
+	void initialize(IPC::Message message);
+	void inquireNotification(IPC::Message message);
+	void isRegistered(IPC::Message message);
+	void notifyToWait(IPC::Message message);
+	void preloadLibraryApplet(IPC::Message message);
+	void prepareToStartLibraryApplet(IPC::Message message);
+	void receiveParameter(IPC::Message message);
+	void replySleepQuery(IPC::Message message);
+	void setApplicationCpuTimeLimit(IPC::Message message);
+	void setScreencapPostPermission(IPC::Message message);
+	void sendParameter(IPC::Message message);
+	void startLibraryApplet(IPC::Message message);
+	void theSmashBrosFunction(IPC::Message message);
 
 	// Percentage of the syscore available to the application, between 5% and 89%
 	u32 cpuTimeLimit;
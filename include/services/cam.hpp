@@ -1,41 +1,109 @@
 #pragma once
 #include <array>
+#include <memory>
 #include <optional>
+#include <vector>
 
 #include "helpers.hpp"
 #include "kernel_types.hpp"
 #include "logger.hpp"
 #include "memory.hpp"
 #include "result/result.hpp"
+#include "services/camera_source.hpp"
 
 // Yay, circular dependencies!
 class Kernel;
+struct EmulatorConfig;
 
 class CAMService {
 	using Handle = HorizonHandle;
 	using Event = std::optional<Handle>;
 
+	enum class OutputFormat : u32 {
+		YUV422 = 0,
+		RGB565 = 1,
+	};
+
+	// Indices into the "cameras" array. Note that these do not match the bits of the CameraSelect values games pass us
+	enum CameraIndex : int {
+		Outer1 = 0,
+		Inner = 1,
+		Outer2 = 2,
+	};
+
+	// Each camera has 2 contexts (A and B) with their own settings. We only ever capture using context A for now
+	struct Context {
+		u32 size = 0;  // Index into the resolution table, defaults to VGA
+		OutputFormat outputFormat = OutputFormat::YUV422;
+	};
+
+	struct CameraSettings {
+		std::array<Context, 2> contexts;
+		u32 frameRate = 0;  // Index into the frame rate table, defaults to 15 FPS
+	};
+
 	struct Port {
 		Event bufferErrorInterruptEvent = std::nullopt;
 		Event receiveEvent = std::nullopt;
 		u16 transferBytes;
 
+		// Which camera is feeding this port
+		CameraIndex camera;
+
+		bool trimming;
+		s16 trimX0, trimY0, trimX1, trimY1;
+
+		// Guest buffer set up via SetReceiving
+		bool receiving;
+		u32 destination;
+		u32 destinationSize;
+
+		bool capturing;
+		u64 nextFrameTimestamp;
+
 		void reset() {
 			bufferErrorInterruptEvent = std::nullopt;
 			receiveEvent = std::nullopt;
 			transferBytes = 256;
+
+			trimming = false;
+			trimX0 = trimY0 = trimX1 = trimY1 = 0;
+
+			receiving = false;
+			destination = destinationSize = 0;
+
+			capturing = false;
+			nextFrameTimestamp = 0;
 		}
 	};
 
 	Handle handle = KernelHandles::CAM;
 	Memory& mem;
 	Kernel& kernel;
+	const EmulatorConfig& config;
 	MAKE_LOG_FUNCTION(log, camLogger)
 
 	static constexpr size_t portCount = 2;
+	static constexpr size_t cameraCount = 3;
 	std::array<Port, portCount> ports;
+	std::array<CameraSettings, cameraCount> cameras;
+
+	// Host image source feeding all the cameras, created on DriverInitialize based on the emulator config
+	std::unique_ptr<Camera::FrameSource> source;
+	// Scratch buffers for frame conversion, kept around to avoid reallocating every frame
+	std::vector<u32> scaledFrame;
+	std::vector<u8> convertedFrame;
+
+	// Get a bitmask of cameras (1 << CameraIndex) from a CameraSelect value
+	static u32 getCameraMask(u32 cameraSelect);
+	u64 getFramePeriod(const Port& port) const;
+
+	void deliverFrame(Port& port);
+	void scheduleNextFrame();
+	void writeToGuest(u32 vaddr, const u8* data, u32 size);
 
 	// Service commands
+	void activate(u32 messagePointer);
 	void driverInitialize(u32 messagePointer);
 	void driverFinalize(u32 messagePointer);
 	void getMaxBytes(u32 messagePointer);
@@ -43,18 +111,26 @@ class CAMService {
 	void getBufferErrorInterruptEvent(u32 messagePointer);
 	void getSuitableY2RCoefficients(u32 messagePointer);
 	void getTransferBytes(u32 messagePointer);
+	void isBusy(u32 messagePointer);
+	void isFinishedReceiving(u32 messagePointer);
 	void setContrast(u32 messagePointer);
 	void setFrameRate(u32 messagePointer);
+	void setOutputFormat(u32 messagePointer);
 	void setReceiving(u32 messagePointer);
 	void setSize(u32 messagePointer);
 	void setTransferBytes(u32 messagePointer);
 	void setTransferLines(u32 messagePointer);
 	void setTrimming(u32 messagePointer);
+	void setTrimmingParams(u32 messagePointer);
 	void setTrimmingParamsCenter(u32 messagePointer);
 	void startCapture(u32 messagePointer);
+	void stopCapture(u32 messagePointer);
 
   public:
-	CAMService(Memory& mem, Kernel& kernel) : mem(mem), kernel(kernel) {}
+	CAMService(Memory& mem, Kernel& kernel, const EmulatorConfig& config) : mem(mem), kernel(kernel), config(config) {}
 	void reset();
 	void handleSyncRequest(u32 messagePointer);
+
+	// Called from the scheduler when it's time for a capturing port to receive a new frame
+	void updateCapture();
 };
\ No newline at end of file
@@ -0,0 +1,219 @@
+#pragma once
+#include <algorithm>
+
+#include "compiler_builtins.hpp"
+#include "helpers.hpp"
+
+#if defined(_M_AMD64) || defined(__x86_64__)
+#define CAM_SIMD_X64
+#include <immintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define CAM_SIMD_ARM64
+#include <arm_neon.h>
+#endif
+
+// Optimized functions for converting RGBA8888 camera frames (R in the lowest byte) into the output formats of the 3DS cameras
+namespace Camera::Convert {
+	ALWAYS_INLINE static u16 pixelToRGB565(u32 pixel) {
+		const u32 r = (pixel >> 0) & 0xff;
+		const u32 g = (pixel >> 8) & 0xff;
+		const u32 b = (pixel >> 16) & 0xff;
+
+		return u16(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+	}
+
+	// BT.601 studio-swing RGB -> YCbCr conversion, which is what Y2R expects by default
+	ALWAYS_INLINE static u8 rgbToY(s32 r, s32 g, s32 b) { return u8(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16); }
+	ALWAYS_INLINE static u8 rgbToU(s32 r, s32 g, s32 b) { return u8(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128); }
+	ALWAYS_INLINE static u8 rgbToV(s32 r, s32 g, s32 b) { return u8(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128); }
+
+	// Non-SIMD, portable algorithms
+	static void toRGB565Portable(const u32* input, u16* output, usize pixelCount) {
+		for (usize i = 0; i < pixelCount; i++) {
+			output[i] = pixelToRGB565(input[i]);
+		}
+	}
+
+	// YUV422 output is packed as Y0 U Y1 V for every pair of pixels, with the chroma of the pair being the average of both pixels
+	static void toYUV422Portable(const u32* input, u8* output, usize pixelCount) {
+		for (usize i = 0; i + 1 < pixelCount; i += 2) {
+			const u32 p0 = input[i];
+			const u32 p1 = input[i + 1];
+
+			const s32 r0 = p0 & 0xff, g0 = (p0 >> 8) & 0xff, b0 = (p0 >> 16) & 0xff;
+			const s32 r1 = p1 & 0xff, g1 = (p1 >> 8) & 0xff, b1 = (p1 >> 16) & 0xff;
+			const s32 r = (r0 + r1) >> 1, g = (g0 + g1) >> 1, b = (b0 + b1) >> 1;
+
+			output[0] = rgbToY(r0, g0, b0);
+			output[1] = rgbToU(r, g, b);
+			output[2] = rgbToY(r1, g1, b1);
+			output[3] = rgbToV(r, g, b);
+			output += 4;
+		}
+
+		// With an odd pixel count, the last pixel has no partner. Pair it with itself so the 2 bytes it owns still get written
+		if (pixelCount & 1) {
+			const u32 p = input[pixelCount - 1];
+			const s32 r = p & 0xff, g = (p >> 8) & 0xff, b = (p >> 16) & 0xff;
+
+			output[0] = rgbToY(r, g, b);
+			output[1] = rgbToU(r, g, b);
+		}
+	}
+
+#if defined(CAM_SIMD_X64) && (defined(__SSE4_1__) || defined(__AVX__))
+	// Converts 8 pixels per iteration
+	static void toRGB565SSE4_1(const u32* input, u16* output, usize pixelCount) {
+		const __m128i redMask = _mm_set1_epi32(0xf8);
+		const __m128i greenMask = _mm_set1_epi32(0xfc00);
+		const __m128i blueMask = _mm_set1_epi32(0xf80000);
+
+		const auto convert4 = [&](__m128i pixels) {
+			const __m128i r = _mm_slli_epi32(_mm_and_si128(pixels, redMask), 8);     // (r >> 3) << 11
+			const __m128i g = _mm_srli_epi32(_mm_and_si128(pixels, greenMask), 5);   // ((g >> 2) << 5), with g starting at bit 8
+			const __m128i b = _mm_srli_epi32(_mm_and_si128(pixels, blueMask), 19);  // b >> 3, with b starting at bit 16
+			return _mm_or_si128(_mm_or_si128(r, g), b);
+		};
+
+		usize i = 0;
+		for (; i + 8 <= pixelCount; i += 8) {
+			const __m128i lo = convert4(_mm_loadu_si128((const __m128i*)&input[i]));
+			const __m128i hi = convert4(_mm_loadu_si128((const __m128i*)&input[i + 4]));
+			_mm_storeu_si128((__m128i*)&output[i], _mm_packus_epi32(lo, hi));
+		}
+
+		toRGB565Portable(input + i, output + i, pixelCount - i);
+	}
+
+	// Converts 4 pixels (2 YUYV pairs) per iteration
+	static void toYUV422SSE4_1(const u32* input, u8* output, usize pixelCount) {
+		const __m128i byteMask = _mm_set1_epi32(0xff);
+		const __m128i round = _mm_set1_epi32(128);
+		const __m128i yOffset = _mm_set1_epi32(16);
+		const __m128i uvOffset = _mm_set1_epi32(128);
+
+		const auto dot = [&](__m128i r, __m128i g, __m128i b, s32 cr, s32 cg, s32 cb) {
+			__m128i sum = _mm_mullo_epi32(r, _mm_set1_epi32(cr));
+			sum = _mm_add_epi32(sum, _mm_mullo_epi32(g, _mm_set1_epi32(cg)));
+			sum = _mm_add_epi32(sum, _mm_mullo_epi32(b, _mm_set1_epi32(cb)));
+			return _mm_srai_epi32(_mm_add_epi32(sum, round), 8);
+		};
+
+		usize i = 0;
+		for (; i + 4 <= pixelCount; i += 4) {
+			const __m128i pixels = _mm_loadu_si128((const __m128i*)&input[i]);
+			const __m128i r = _mm_and_si128(pixels, byteMask);
+			const __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 8), byteMask);
+			const __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 16), byteMask);
+
+			// Average every pair of pixels for the chroma. The averages end up in lanes 0 and 2
+			const auto pairAverage = [](__m128i v) { return _mm_srli_epi32(_mm_add_epi32(v, _mm_shuffle_epi32(v, 0b10110001)), 1); };
+			const __m128i rAvg = pairAverage(r);
+			const __m128i gAvg = pairAverage(g);
+			const __m128i bAvg = pairAverage(b);
+
+			const __m128i y = _mm_add_epi32(dot(r, g, b, 66, 129, 25), yOffset);
+			const __m128i u = _mm_add_epi32(dot(rAvg, gAvg, bAvg, -38, -74, 112), uvOffset);
+			const __m128i v = _mm_add_epi32(dot(rAvg, gAvg, bAvg, 112, -94, -18), uvOffset);
+
+			// uv = (u0, v0, u2, v2), then interleave with y to get (y0, u0, y1, v0) and (y2, u2, y3, v2)
+			const __m128i uv = _mm_blend_epi16(u, _mm_slli_si128(v, 4), 0b11001100);
+			const __m128i lo = _mm_unpacklo_epi32(y, uv);
+			const __m128i hi = _mm_unpackhi_epi32(y, uv);
+
+			const __m128i packed16 = _mm_packus_epi32(lo, hi);
+			_mm_storel_epi64((__m128i*)output, _mm_packus_epi16(packed16, packed16));
+			output += 8;
+		}
+
+		toYUV422Portable(input + i, output, pixelCount - i);
+	}
+#endif
+
+#ifdef CAM_SIMD_ARM64
+	// Converts 8 pixels per iteration
+	static void toRGB565NEON(const u32* input, u16* output, usize pixelCount) {
+		usize i = 0;
+		for (; i + 8 <= pixelCount; i += 8) {
+			// Deinterleave 8 pixels into separate R, G, B and A vectors
+			const uint8x8x4_t pixels = vld4_u8(reinterpret_cast<const u8*>(&input[i]));
+			const uint16x8_t r = vshlq_n_u16(vmovl_u8(vshr_n_u8(pixels.val[0], 3)), 11);
+			const uint16x8_t g = vshlq_n_u16(vmovl_u8(vshr_n_u8(pixels.val[1], 2)), 5);
+			const uint16x8_t b = vmovl_u8(vshr_n_u8(pixels.val[2], 3));
+
+			vst1q_u16(&output[i], vorrq_u16(vorrq_u16(r, g), b));
+		}
+
+		toRGB565Portable(input + i, output + i, pixelCount - i);
+	}
+
+	// Converts 8 pixels (4 YUYV pairs) per iteration
+	static void toYUV422NEON(const u32* input, u8* output, usize pixelCount) {
+		usize i = 0;
+		for (; i + 8 <= pixelCount; i += 8) {
+			const uint8x8x4_t pixels = vld4_u8(reinterpret_cast<const u8*>(&input[i]));
+			const uint16x8_t r = vmovl_u8(pixels.val[0]);
+			const uint16x8_t g = vmovl_u8(pixels.val[1]);
+			const uint16x8_t b = vmovl_u8(pixels.val[2]);
+
+			// Luma: The intermediate sum fits in 16 bits, so we can stay in u16 the whole way
+			uint16x8_t ySum = vmulq_n_u16(r, 66);
+			ySum = vmlaq_n_u16(ySum, g, 129);
+			ySum = vmlaq_n_u16(ySum, b, 25);
+			const uint8x8_t y = vadd_u8(vshrn_n_u16(vaddq_u16(ySum, vdupq_n_u16(128)), 8), vdup_n_u8(16));
+
+			// Chroma: Average every pair of pixels, then do the signed dot products in s16
+			const int16x4_t rAvg = vreinterpret_s16_u16(vshr_n_u16(vpaddl_u8(pixels.val[0]), 1));
+			const int16x4_t gAvg = vreinterpret_s16_u16(vshr_n_u16(vpaddl_u8(pixels.val[1]), 1));
+			const int16x4_t bAvg = vreinterpret_s16_u16(vshr_n_u16(vpaddl_u8(pixels.val[2]), 1));
+
+			int16x4_t uSum = vmul_n_s16(rAvg, -38);
+			uSum = vmla_n_s16(uSum, gAvg, -74);
+			uSum = vmla_n_s16(uSum, bAvg, 112);
+			int16x4_t vSum = vmul_n_s16(rAvg, 112);
+			vSum = vmla_n_s16(vSum, gAvg, -94);
+			vSum = vmla_n_s16(vSum, bAvg, -18);
+
+			const int16x4_t offset = vdup_n_s16(128);
+			const int16x8_t uv16 = vcombine_s16(
+				vadd_s16(vshr_n_s16(vadd_s16(uSum, offset), 8), offset), vadd_s16(vshr_n_s16(vadd_s16(vSum, offset), 8), offset)
+			);
+			// Low half: u0-u3, high half: v0-v3
+			const uint8x8_t uv = vqmovun_s16(uv16);
+
+			// Split luma into even and odd pixels, then interleave as Y0 U Y1 V
+			const uint8x8x2_t yEvenOdd = vuzp_u8(y, y);
+			const uint8x8_t yu = vzip_u8(yEvenOdd.val[0], uv).val[0];
+			const uint8x8_t yv = vzip_u8(yEvenOdd.val[1], vext_u8(uv, uv, 4)).val[0];
+			const uint16x4x2_t result = vzip_u16(vreinterpret_u16_u8(yu), vreinterpret_u16_u8(yv));
+
+			vst1q_u16(reinterpret_cast<u16*>(output), vcombine_u16(result.val[0], result.val[1]));
+			output += 16;
+		}
+
+		toYUV422Portable(input + i, output, pixelCount - i);
+	}
+#endif
+
+	// Converts "pixelCount" RGBA8888 pixels to RGB565
+	static void toRGB565(const u32* input, u16* output, usize pixelCount) {
+#if defined(CAM_SIMD_ARM64)
+		return toRGB565NEON(input, output, pixelCount);
+#elif defined(CAM_SIMD_X64) && (defined(__SSE4_1__) || defined(__AVX__))
+		return toRGB565SSE4_1(input, output, pixelCount);
+#else
+		return toRGB565Portable(input, output, pixelCount);
+#endif
+	}
+
+	// Converts "pixelCount" RGBA8888 pixels to packed YUV422. pixelCount is expected to be even
+	static void toYUV422(const u32* input, u8* output, usize pixelCount) {
+#if defined(CAM_SIMD_ARM64)
+		return toYUV422NEON(input, output, pixelCount);
+#elif defined(CAM_SIMD_X64) && (defined(__SSE4_1__) || defined(__AVX__))
+		return toYUV422SSE4_1(input, output, pixelCount);
+#else
+		return toYUV422Portable(input, output, pixelCount);
+#endif
+	}
+}  // namespace Camera::Convert
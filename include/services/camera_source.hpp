@@ -0,0 +1,70 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "helpers.hpp"
+
+// Host-side image sources that feed the emulated cameras. A source produces RGBA8888 frames (R in the lowest byte) at whatever resolution
+// it likes, and the CAM service takes care of scaling, trimming and converting them to the format the guest asked for.
+namespace Camera {
+	enum class SourceType : int {
+		Blank = 0,    // Always output a black frame
+		Pattern = 1,  // Synthetic, animated colour bar pattern. Useful for headless testing
+		Image = 2,    // A single image file, or a directory of image files which is played back as a video, one image per frame
+	};
+
+	SourceType sourceTypeFromString(std::string inString);
+	const char* sourceTypeToString(SourceType type);
+
+	struct Frame {
+		std::vector<u32> pixels;
+		u32 width = 0;
+		u32 height = 0;
+
+		bool isValid() const { return width != 0 && height != 0 && pixels.size() >= usize(width) * height; }
+	};
+
+	class FrameSource {
+	  public:
+		virtual ~FrameSource() {}
+		// Produce the next frame. The requested size is a hint, sources are free to output frames of any size.
+		virtual const Frame& nextFrame(u32 requestedWidth, u32 requestedHeight) = 0;
+	};
+
+	class BlankSource final : public FrameSource {
+		Frame frame;
+
+	  public:
+		const Frame& nextFrame(u32 requestedWidth, u32 requestedHeight) override;
+	};
+
+	class PatternSource final : public FrameSource {
+		Frame frame;
+		u32 frameCounter = 0;
+
+	  public:
+		const Frame& nextFrame(u32 requestedWidth, u32 requestedHeight) override;
+	};
+
+	class ImageSource final : public FrameSource {
+		std::vector<Frame> frames;
+		usize currentFrame = 0;
+		BlankSource fallback;
+
+	  public:
+		ImageSource(const std::filesystem::path& path);
+		const Frame& nextFrame(u32 requestedWidth, u32 requestedHeight) override;
+
+		bool isValid() const { return !frames.empty(); }
+	};
+
+	std::unique_ptr<FrameSource> makeSource(SourceType type, const std::filesystem::path& imagePath);
+
+	// Nearest-neighbour scale "frame" to outWidth x outHeight, then crop the window starting at (cropX, cropY) with size cropWidth x cropHeight
+	// into "output".
+	void scaleAndCrop(
+		const Frame& frame, u32 outWidth, u32 outHeight, u32 cropX, u32 cropY, u32 cropWidth, u32 cropHeight, std::vector<u32>& output
+	);
+}  // namespace Camera
@@ -6,6 +6,7 @@
 
 #include "audio/dsp_core.hpp"
 #include "helpers.hpp"
+#include "ipc.hpp"
 #include "logger.hpp"
 #include "memory.hpp"
 #include "result/result.hpp"
@@ -47,21 +48,21 @@ class DSPService {
 	bool headphonesInserted = true;
 
 	// Service functions
-	void convertProcessAddressFromDspDram(u32 messagePointer);  // Nice function name
-	void flushDataCache(u32 messagePointer);
-	void forceHeadphoneOut(u32 messagePointer);
-	void getHeadphoneStatus(u32 messagePointer);
-	void getSemaphoreEventHandle(u32 messagePointer);
-	void invalidateDCache(u32 messagePointer);
-	void loadComponent(u32 messagePointer);
-	void readPipeIfPossible(u32 messagePointer);
-	void recvData(u32 messagePointer);
-	void recvDataIsReady(u32 messagePointer);
-	void registerInterruptEvents(u32 messagePointer);
-	void setSemaphore(u32 messagePointer);
-	void setSemaphoreMask(u32 messagePointer);
-	void unloadComponent(u32 messagePointer);
-	void writeProcessPipe(u32 messagePointer);
+	void convertProcessAddressFromDspDram(IPC::Message message);  // Nice function name
+	void flushDataCache(IPC::Message message);
+	void forceHeadphoneOut(IPC::Message message);
+	void getHeadphoneStatus(IPC::Message message);
+	void getSemaphoreEventHandle(IPC::Message message);
+	void invalidateDCache(IPC::Message message);
+	void loadComponent(IPC::Message message);
+	void readPipeIfPossible(IPC::Message message);
+	void recvData(IPC::Message message);
+	void recvDataIsReady(IPC::Message message);
+	void registerInterruptEvents(IPC::Message message);
+	void setSemaphore(IPC::Message message);
+	void setSemaphoreMask(IPC::Message message);
+	void unloadComponent(IPC::Message message);
+	void writeProcessPipe(IPC::Message message);
 
   public:
 	DSPService(Memory& mem, Kernel& kernel, const EmulatorConfig& config) : mem(mem), kernel(kernel), config(config) {}
@@ -11,6 +11,7 @@
 #include "fs/archive_twl_sound.hpp"
 #include "fs/archive_user_save_data.hpp"
 #include "helpers.hpp"
+#include "ipc.hpp"
 #include "kernel_types.hpp"
 #include "logger.hpp"
 #include "memory.hpp"
@@ -55,37 +56,37 @@ class FSService {
 	const EmulatorConfig& config;
 
 	// Service commands
-	void abnegateAccessRight(u32 messagePointer);
-	void cardSlotIsInserted(u32 messagePointer);
-	void createDirectory(u32 messagePointer);
-	void createExtSaveData(u32 messagePointer);
-	void createFile(u32 messagePointer);
-	void closeArchive(u32 messagePointer);
-	void controlArchive(u32 messagePointer);
-	void deleteDirectory(u32 messagePointer);
-	void deleteExtSaveData(u32 messagePointer);
-	void deleteFile(u32 messagePointer);
-	void formatSaveData(u32 messagePointer);
-	void formatThisUserSaveData(u32 messagePointer);
-	void getArchiveResource(u32 messagePointer);
-	void getFreeBytes(u32 messagePointer);
-	void getFormatInfo(u32 messagePointer);
-	void getPriority(u32 messagePointer);
-	void getSdmcArchiveResource(u32 messagePointer);
-	void getThisSaveDataSecureValue(u32 messagePointer);
-	void theGameboyVCFunction(u32 messagePointer);
-	void initialize(u32 messagePointer);
-	void initializeWithSdkVersion(u32 messagePointer);
-	void isSdmcDetected(u32 messagePointer);
-	void isSdmcWritable(u32 messagePOinter);
-	void openArchive(u32 messagePointer);
-	void openDirectory(u32 messagePointer);
-	void openFile(u32 messagePointer);
-	void openFileDirectly(u32 messagePointer);
-	void renameFile(u32 messagePointer);
-	void setArchivePriority(u32 messagePointer);
-	void setPriority(u32 messagePointer);
-	void setThisSaveDataSecureValue(u32 messagePointer);
+	void abnegateAccessRight(IPC::Message message);
+	void cardSlotIsInserted(IPC::Message message);
+	void createDirectory(IPC::Message message);
+	void createExtSaveData(IPC::Message message);
+	void createFile(IPC::Message message);
+	void closeArchive(IPC::Message message);
+	void controlArchive(IPC::Message message);
+	void deleteDirectory(IPC::Message message);
+	void deleteExtSaveData(IPC::Message message);
+	void deleteFile(IPC::Message message);
+	void formatSaveData(IPC::Message message);
+	void formatThisUserSaveData(IPC::Message message);
+	void getArchiveResource(IPC::Message message);
+	void getFreeBytes(IPC::Message message);
+	void getFormatInfo(IPC::Message message);
+	void getPriority(IPC::Message message);
+	void getSdmcArchiveResource(IPC::Message message);
+	void getThisSaveDataSecureValue(IPC::Message message);
+	void theGameboyVCFunction(IPC::Message message);
+	void initialize(IPC::Message message);
+	void initializeWithSdkVersion(IPC::Message message);
+	void isSdmcDetected(IPC::Message message);
+	void isSdmcWritable(IPC::Message message);
+	void openArchive(IPC::Message message);
+	void openDirectory(IPC::Message message);
+	void openFile(IPC::Message message);
+	void openFileDirectly(IPC::Message message);
+	void renameFile(IPC::Message message);
+	void setArchivePriority(IPC::Message message);
+	void setPriority(IPC::Message message);
+	void setThisSaveDataSecureValue(IPC::Message message);
 
 	// Used for set/get priority: Not sure what sort of priority this is referring to
 	u32 priority;
@@ -1,13 +1,20 @@
 #pragma once
+#include <array>
 #include <cstring>
+#include <mutex>
 #include <optional>
+#include <vector>
 
 #include "PICA/gpu.hpp"
+#include "PICA/gpu_thread.hpp"
+#include "config.hpp"
 #include "helpers.hpp"
+#include "ipc.hpp"
 #include "kernel_types.hpp"
 #include "logger.hpp"
 #include "memory.hpp"
 #include "result/result.hpp"
+#include "scheduler.hpp"
 
 enum class GPUInterrupt : u8 {
 	PSC0 = 0,     // Memory fill completed
@@ -29,19 +36,75 @@ class GPUService {
 	Memory& mem;
 	GPU& gpu;
 	Kernel& kernel;
+	const EmulatorConfig& config;
 	u32& currentPID;  // Process ID of the current process
 	u8* sharedMem;    // Pointer to GSP shared memory
 
 	// At any point in time only 1 process has privileges to use rendering functions
 	// This is the PID of that process
 	u32 privilegedProcess;
-	std::optional<Handle> interruptEvent;
+
+	// Each thread registered via RegisterInterruptRelayQueue gets its own interrupt queue, framebuffer info and command queue in shared memory
+	// The index of a thread in this array is its index in GSP shared memory
+	static constexpr u32 maxGSPThreads = 4;
+	std::array<std::optional<Handle>, maxGSPThreads> interruptEvents;
+	std::array<u32, maxGSPThreads> gspThreadPIDs;  // Process that registered each thread
 
 	// Number of threads registered via RegisterInterruptRelayQueue
 	u32 gspThreadCount = 0;
 
+	// Only the VBlank (PDC0/PDC1) interrupts go to every thread. Interrupts raised by GX commands go to the thread whose command queue the
+	// command came from, and the framebuffer info that gets applied on VBlank is the one of the thread that holds the GPU rights
+	static constexpr u32 noGSPThread = 0xFFFFFFFF;
+	u32 activeGSPThread = noGSPThread;  // Thread that holds the GPU rights
+	u32 executingGSPThread = 0;         // Thread whose GX command is currently being executed
+
+	// Layout of GSP shared memory
+	static constexpr u32 interruptInfoOffset = 0;
+	static constexpr u32 interruptInfoSize = 0x40;
+	static constexpr u32 framebufferInfoOffset = 0x200;
+	static constexpr u32 framebufferInfoSize = 0x80;
+	static constexpr u32 commandQueueOffset = 0x800;
+	static constexpr u32 commandQueueSize = 0x200;
+	static constexpr u32 commandQueueSlots = 15;  // Each queue fits 15 commands of 0x20 bytes each, after a 0x20 byte header
+
+	// Asynchronous GX command processing. When enabled, TriggerCmdReqQueue and register writes are recorded into the command ring of a dedicated
+	// GPU thread and return immediately. The interrupts raised by GX commands are buffered and only relayed to the guest from the emulator
+	// thread when we fully synchronize with the GPU thread, as the kernel is not thread-safe. Full synchronization happens after a fixed amount
+	// of emulated time via the SyncGX scheduler event, and whenever the emulator thread needs to touch GPU state itself, which keeps interrupt
+	// timing deterministic. Guest cache maintenance on memory used by in-flight commands waits for just those commands via the hazard tracker.
+	static constexpr u64 gxCommandLatency = Scheduler::arm11Clock / 2000;  // Emulated time it takes for queued commands to complete (0.5ms)
+
+	bool asyncCommands = false;
+	GPUThread gpuThread;
+	GPUHazardTracker hazards;
+
+	struct CompletedInterrupt {
+		GPUInterrupt type;
+		u32 gspThread;
+	};
+
+	std::mutex interruptMutex;
+	std::vector<CompletedInterrupt> completedInterrupts;  // Interrupts raised by commands executed on the GPU thread, waiting to be relayed
+	bool syncEventScheduled = false;
+
 	MAKE_LOG_FUNCTION(log, gspGPULogger)
 	void processCommandBuffer();
+	void executeCommand(u32* cmd);
+	// Called by GX command handlers when the command has completed, to raise the corresponding interrupt
+	void commandFinished(GPUInterrupt type);
+	// Write an interrupt to the interrupt queue of a single GSP thread and signal its event
+	void relayInterrupt(GPUInterrupt type, u32 threadIndex);
+	// Returns the first thread registered by the given process, or noGSPThread if it has none
+	u32 findGSPThread(u32 pid) const;
+
+	// Helpers for async GX
+	void queueGXCommand(const u32* cmd, u32 threadIndex);
+	void queueRegisterWrite(u32 address, u32 value, u32 mask);
+	void executeThreadCommand(const GPUThreadCommand& command);
+	void trackHazards(const u32* cmd, u64 sequence);
+	// Wait for in-flight commands that use the virtual address range [vaddr, vaddr + size), without relaying any interrupts
+	void syncRange(u32 vaddr, u32 size);
 
 	struct FramebufferInfo {
 		u32 activeFb;
@@ -73,23 +136,23 @@ class GPUService {
 	static_assert(sizeof(CaptureInfo) == 16, "GSP::GPU::CaptureInfo has the wrong size");
 
 	// Service commands
-	void acquireRight(u32 messagePointer);
-	void flushDataCache(u32 messagePointer);
-	void invalidateDataCache(u32 messagePointer);
-	void importDisplayCaptureInfo(u32 messagePointer);
-	void readHwRegs(u32 messagePointer);
-	void registerInterruptRelayQueue(u32 messagePointer);
-	void releaseRight(u32 messagePointer);
-	void restoreVramSysArea(u32 messagePointer);
-	void saveVramSysArea(u32 messagePointer);
-	void setAxiConfigQoSMode(u32 messagePointer);
-	void setBufferSwap(u32 messagePointer);
-	void setInternalPriorities(u32 messagePointer);
-	void setLCDForceBlack(u32 messagePointer);
-	void storeDataCache(u32 messagePointer);
-	void triggerCmdReqQueue(u32 messagePointer);
-	void writeHwRegs(u32 messagePointer);
-	void writeHwRegsWithMask(u32 messagePointer);
+	void acquireRight(IPC::Message message);
+	void flushDataCache(IPC::Message message);
+	void invalidateDataCache(IPC::Message message);
+	void importDisplayCaptureInfo(IPC::Message message);
+	void readHwRegs(IPC::Message message);
+	void registerInterruptRelayQueue(IPC::Message message);
+	void releaseRight(IPC::Message message);
+	void restoreVramSysArea(IPC::Message message);
+	void saveVramSysArea(IPC::Message message);
+	void setAxiConfigQoSMode(IPC::Message message);
+	void setBufferSwap(IPC::Message message);
+	void setInternalPriorities(IPC::Message message);
+	void setLCDForceBlack(IPC::Message message);
+	void storeDataCache(IPC::Message message);
+	void triggerCmdReqQueue(IPC::Message message);
+	void writeHwRegs(IPC::Message message);
+	void writeHwRegsWithMask(IPC::Message message);
 
 	// GSP commands processed via TriggerCmdReqQueue
 	void processCommandList(u32* cmd);
@@ -101,20 +164,31 @@ class GPUService {
 
 	void setBufferSwapImpl(u32 screen_id, const FramebufferInfo& info);
 
-	// Get the framebuffer info in shared memory for a given screen
-	FramebufferUpdate* getFramebufferInfo(int screen) {
-		// TODO: Offset depends on GSP thread being triggered
-		return reinterpret_cast<FramebufferUpdate*>(&sharedMem[0x200 + screen * sizeof(FramebufferUpdate)]);
+	// Get the framebuffer info in shared memory for a given screen and GSP thread
+	FramebufferUpdate* getFramebufferInfo(int screen, u32 threadIndex = 0) {
+		const u32 offset = framebufferInfoOffset + threadIndex * framebufferInfoSize + screen * sizeof(FramebufferUpdate);
+		return reinterpret_cast<FramebufferUpdate*>(&sharedMem[offset]);
 	}
 
-	FramebufferUpdate* getTopFramebufferInfo() { return getFramebufferInfo(0); }
-	FramebufferUpdate* getBottomFramebufferInfo() { return getFramebufferInfo(1); }
+	// The framebuffers that get displayed are the ones of the thread with the GPU rights. If no thread holds them, we use the first thread's
+	u32 getFramebufferThread() const { return activeGSPThread != noGSPThread ? activeGSPThread : 0; }
+
+	FramebufferUpdate* getTopFramebufferInfo() { return getFramebufferInfo(0, getFramebufferThread()); }
+	FramebufferUpdate* getBottomFramebufferInfo() { return getFramebufferInfo(1, getFramebufferThread()); }
 
   public:
-	GPUService(Memory& mem, GPU& gpu, Kernel& kernel, u32& currentPID) : mem(mem), gpu(gpu), kernel(kernel), currentPID(currentPID) {}
+	GPUService(Memory& mem, GPU& gpu, Kernel& kernel, const EmulatorConfig& config, u32& currentPID)
+		: mem(mem), gpu(gpu), kernel(kernel), config(config), currentPID(currentPID) {}
+	~GPUService();
+
 	void reset();
 	void handleSyncRequest(u32 messagePointer);
+	// Relay an interrupt to the guest. VBlank interrupts go to every registered thread, others to the thread that holds the GPU rights
 	void requestInterrupt(GPUInterrupt type);
+
+	// Wait for all queued GX commands to finish executing and relay their interrupts to the guest. Does nothing if async GX is disabled.
+	// Must be called before the emulator thread touches GPU or renderer state while the GX thread might be running.
+	void syncCommands();
 	void setSharedMem(u8* ptr) {
 		sharedMem = ptr;
 		if (ptr != nullptr) {  // Zero-fill shared memory in case the process tries to read stale service data or vice versa
@@ -4,6 +4,7 @@
 #include <string>
 
 #include "helpers.hpp"
+#include "ipc.hpp"
 #include "kernel_types.hpp"
 #include "logger.hpp"
 #include "memory.hpp"
@@ -81,14 +82,14 @@ class HIDService {
 	MAKE_LOG_FUNCTION(log, hidLogger)
 
 	// Service commands
-	void disableAccelerometer(u32 messagePointer);
-	void disableGyroscopeLow(u32 messagePointer);
-	void enableAccelerometer(u32 messagePointer);
-	void enableGyroscopeLow(u32 messagePointer);
-	void getGyroscopeLowCalibrateParam(u32 messagePointer);
-	void getGyroscopeCoefficient(u32 messagePointer);
-	void getIPCHandles(u32 messagePointer);
-	void getSoundVolume(u32 messagePointer);
+	void disableAccelerometer(IPC::Message message);
+	void disableGyroscopeLow(IPC::Message message);
+	void enableAccelerometer(IPC::Message message);
+	void enableGyroscopeLow(IPC::Message message);
+	void getGyroscopeLowCalibrateParam(IPC::Message message);
+	void getGyroscopeCoefficient(IPC::Message message);
+	void getIPCHandles(IPC::Message message);
+	void getSoundVolume(IPC::Message message);
 
 	// Don't call these prior to initializing shared mem pls
 	template <typename T>
@@ -0,0 +1,56 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "helpers.hpp"
+#include "kernel/handles.hpp"
+
+// Optional per-command statistics for IPC requests sent to HLE services. For every (service, command header) pair we count how many times
+// it was called, how much host time was spent servicing it, and a log2 histogram of the latency of individual calls.
+// Useful for finding out which service calls a game spams, and which ones are slow to emulate.
+class IPCStats {
+	using Handle = HorizonHandle;
+
+  public:
+	// Bucket 0 holds calls that took less than 1us, bucket N holds calls that took [2^(N - 1), 2^N) us. The last bucket holds everything slower
+	static constexpr usize bucketCount = 16;
+
+	struct CommandStats {
+		u64 calls = 0;
+		u64 totalNanoseconds = 0;
+		u64 maxNanoseconds = 0;
+		std::array<u64, bucketCount> histogram = {};
+	};
+
+	struct Entry {
+		Handle handle;
+		u32 header;  // The IPC header of the command, eg 0x000E00C0
+		CommandStats stats;
+	};
+
+  private:
+	// Commands are keyed by (handle << 32) | header
+	std::unordered_map<u64, CommandStats> commands;
+	// Statistics are recorded on the emulator thread but may be read from the HTTP server thread
+	mutable std::mutex mutex;
+	// Toggled from the emulator thread and checked by the HTTP server. It doesn't guard any other data, so relaxed accesses are enough
+	std::atomic<bool> enabled = false;
+
+  public:
+	static usize getBucket(u64 nanoseconds);
+
+	void setEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+	bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	void record(Handle handle, u32 header, u64 nanoseconds);
+	void reset();
+
+	// Get every command that has been called, sorted by total time spent in it
+	std::vector<Entry> snapshot() const;
+	// Format the statistics as a human-readable table
+	std::string report() const;
+};
@@ -1,4 +1,8 @@
 #pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "helpers.hpp"
 #include "kernel_types.hpp"
 #include "logger.hpp"
@@ -7,6 +11,106 @@
 
 class Kernel;
 
+namespace LDR {
+	// Segment table entry, same layout as in the CRO
+	struct Segment {
+		u32 offset;
+		u32 size;
+		u32 id;
+	};
+
+	// Relocation patch table entry, same layout as in the CRO. Used both for the relocations a CRO applies to itself and for the batches
+	// of relocations that get patched with the address of a symbol once it's imported
+	struct Relocation {
+		u32 segmentTag;  // Segment index in the low 4 bits, offset in the segment in the rest
+		u8 patchType;
+		union {
+			u8 isLastEntry;   // For import patches
+			u8 segmentIndex;  // For relocation patches
+		};
+		u8 isResolved;
+		u8 padding;
+		u32 addend;
+	};
+	static_assert(sizeof(Segment) == 12 && sizeof(Relocation) == 12);
+
+	// Symbol imports point at the first entry of a batch of relocations in the import patch table of the importing CRO
+	struct NamedImport {
+		std::string name;
+		u32 batch;
+	};
+
+	struct IndexedImport {
+		u32 exportIndex;
+		u32 batch;
+	};
+
+	struct AnonymousImport {
+		u32 segmentTag;
+		u32 batch;
+	};
+
+	struct ImportModule {
+		std::string name;
+		std::vector<IndexedImport> indexedImports;
+		std::vector<AnonymousImport> anonymousImports;
+	};
+
+	// Host-side copy of the tables of a loaded CRO or the CRS. These get parsed once when the CRO is loaded, so that linking doesn't have to
+	// walk the tables in guest memory and compare every exported symbol name against every import
+	struct Module {
+		std::string name;
+		std::vector<Segment> segments;
+		std::unordered_map<std::string, u32> namedExports;  // Symbol name -> segment tag of the symbol
+		std::vector<u32> indexedExports;                    // Segment tags of the symbols
+		std::vector<NamedImport> namedImports;
+		std::vector<ImportModule> importModules;
+
+		std::vector<Relocation> importPatches;
+		u32 importPatchTable = 0;  // Address of the import patch table, as the resolved flags of the batches live in guest memory
+		u32 onUnresolved = 0;      // Segment tag of the function that unresolved imports point to
+		u32 oldDataSegmentOffset = 0;
+
+		// Load time stats
+		u64 loadMicroseconds = 0;
+		usize relocationCount = 0;
+
+		u32 getSegmentAddr(u32 segmentTag) const {
+			const u32 segmentIndex = segmentTag & 0xF;
+			const u32 offset = segmentTag >> 4;
+
+			if (segmentIndex >= segments.size() || offset >= segments[segmentIndex].size) {
+				return 0;
+			}
+
+			return segments[segmentIndex].offset + offset;
+		}
+	};
+
+	// Loads, links and unloads the CRS and CROs once they're mapped into the address space of the process. Only needs guest memory, while the
+	// service around it takes care of mapping and of flushing the instruction cache
+	class Linker {
+		Memory& mem;
+
+		u32 loadedCRS = 0;
+		// The loaded CRS and CROs, indexed by the address they're mapped to
+		std::unordered_map<u32, Module> modules;
+
+	  public:
+		Linker(Memory& mem) : mem(mem) {}
+		void reset();
+
+		u32 getLoadedCRS() const { return loadedCRS; }
+		// Returns the module loaded at the given address, or nullptr if there is none
+		const Module* getModule(u32 address) const;
+
+		void loadCRS(u32 address);
+		const Module& loadCRO(u32 address, u32 dataVaddr, u32 bssVaddr, bool autoLink, u32 fixLevel, bool isNew);
+		void linkCRO(u32 address);
+		void unloadCRO(u32 address);
+	};
+}  // namespace LDR
+
 class LDRService {
 	using Handle = HorizonHandle;
 
@@ -15,7 +119,7 @@ class LDRService {
 	Kernel& kernel;
 	MAKE_LOG_FUNCTION(log, ldrLogger)
 
-	u32 loadedCRS;
+	LDR::Linker linker;
 
 	// Service commands
 	void initialize(u32 messagePointer);
@@ -25,7 +129,7 @@ class LDRService {
 	void unloadCRO(u32 messagePointer);
 
   public:
-	LDRService(Memory& mem, Kernel& kernel) : mem(mem), kernel(kernel) {}
+	LDRService(Memory& mem, Kernel& kernel) : mem(mem), kernel(kernel), linker(mem) {}
 	void reset();
 	void handleSyncRequest(u32 messagePointer);
-};
\ No newline at end of file
+};
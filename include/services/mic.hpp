@@ -1,12 +1,19 @@
 #pragma once
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "audio/audio_interpolation.hpp"
 #include "helpers.hpp"
 #include "kernel_types.hpp"
 #include "logger.hpp"
 #include "memory.hpp"
 #include "result/result.hpp"
+#include "services/mic_source.hpp"
 
 // Circular dependencies, yay
 class Kernel;
+struct EmulatorConfig;
 
 class MICService {
 	using Handle = HorizonHandle;
@@ -14,8 +21,23 @@ class MICService {
 	Handle handle = KernelHandles::MIC;
 	Memory& mem;
 	Kernel& kernel;
+	const EmulatorConfig& config;
 	MAKE_LOG_FUNCTION(log, micLogger)
 
+	enum class Encoding : u8 {
+		PCM8 = 0,
+		PCM16 = 1,
+		PCM8Signed = 2,
+		PCM16Signed = 3,
+	};
+
+	enum class SampleRate : u8 {
+		Rate32730 = 0,
+		Rate16360 = 1,
+		Rate10910 = 2,
+		Rate8180 = 3,
+	};
+
 	// Service commands
 	void getEventHandle(u32 messagePointer);
 	void getGain(u32 messagePointer);
@@ -37,9 +59,38 @@ class MICService {
 	bool currentlySampling = false;
 
 	std::optional<Handle> eventHandle;
+	std::optional<MemoryBlock> sharedMemory;
+
+	// Parameters of the current StartSampling call
+	Encoding encoding = Encoding::PCM16Signed;
+	u32 sampleRate = 32730;
+	u32 bufferOffset = 0;  // Offset of the sample ring buffer inside the shared memory block
+	u32 bufferSize = 0;    // Size of the sample ring buffer in bytes
+	bool loop = false;
+	u32 writeOffset = 0;  // Where the next sample will be written, relative to the start of the shared memory
+
+	// Scheduling. We track the number of samples produced since sampling started, so the event period doesn't drift due to rounding
+	u64 samplingStartTimestamp = 0;
+	u64 samplesProduced = 0;
+
+	std::unique_ptr<Microphone::SampleSource> source;
+	Audio::Interpolation::State interpolationState;
+	Audio::Interpolation::StereoBuffer16 sourceSamples;
+	std::vector<s16> sourceScratch;
+	std::vector<u8> encodedSamples;
+
+	static u32 getSampleRate(SampleRate rate);
+	static u32 getSampleSize(Encoding encoding) { return (encoding == Encoding::PCM16 || encoding == Encoding::PCM16Signed) ? 2 : 1; }
+
+	void scheduleNextUpdate();
+	void stopSamplingInternal();
+	void writeToSharedMemory(u32 offset, const u8* data, u32 size);
 
   public:
-	MICService(Memory& mem, Kernel& kernel) : mem(mem), kernel(kernel) {}
+	MICService(Memory& mem, Kernel& kernel, const EmulatorConfig& config) : mem(mem), kernel(kernel), config(config) {}
 	void reset();
 	void handleSyncRequest(u32 messagePointer);
+
+	// Called from the scheduler to produce a new batch of samples while sampling
+	void updateSampling();
 };
\ No newline at end of file
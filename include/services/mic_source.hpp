@@ -0,0 +1,70 @@
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "helpers.hpp"
+#include "ring_buffer.hpp"
+
+// Forward declared so that including this header (eg through config.hpp) doesn't pull in all of miniaudio
+struct ma_device;
+
+// Host-side sample sources that feed the emulated microphone. Sources output mono PCM16 at their own native sample rate, and the MIC service
+// resamples and re-encodes the samples to whatever format the game requested.
+namespace Microphone {
+	enum class SourceType : int {
+		Silence = 0,  // Always output silence
+		WAV = 1,      // Loop the contents of a WAV file
+		Host = 2,     // Capture audio from the host's default recording device
+	};
+
+	SourceType sourceTypeFromString(std::string inString);
+	const char* sourceTypeToString(SourceType type);
+
+	class SampleSource {
+	  public:
+		virtual ~SampleSource() {}
+		virtual u32 getSampleRate() const = 0;
+		// Read up to "count" samples into "output". Returns the number of samples actually read.
+		virtual usize read(s16* output, usize count) = 0;
+	};
+
+	class SilenceSource final : public SampleSource {
+	  public:
+		u32 getSampleRate() const override { return 32730; }
+		usize read(s16* output, usize count) override;
+	};
+
+	class WAVSource final : public SampleSource {
+		std::vector<s16> samples;
+		usize position = 0;
+		u32 sampleRate = 32730;
+
+		bool load(const std::filesystem::path& path);
+
+	  public:
+		WAVSource(const std::filesystem::path& path);
+		u32 getSampleRate() const override { return sampleRate; }
+		usize read(s16* output, usize count) override;
+	};
+
+	class HostSource final : public SampleSource {
+		static constexpr u32 sampleRate = 32730;
+		// Roughly 0.5 seconds of audio
+		static constexpr usize ringBufferSize = 16384;
+
+		std::unique_ptr<ma_device> device;
+		bool initialized = false;
+		Common::RingBuffer<s16, ringBufferSize> ringBuffer;
+
+	  public:
+		HostSource();
+		~HostSource() override;
+
+		u32 getSampleRate() const override { return sampleRate; }
+		usize read(s16* output, usize count) override;
+	};
+
+	std::unique_ptr<SampleSource> makeSource(SourceType type, const std::filesystem::path& wavPath);
+}  // namespace Microphone
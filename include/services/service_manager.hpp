@@ -26,6 +26,7 @@
 #include "services/gsp_lcd.hpp"
 #include "services/hid.hpp"
 #include "services/http.hpp"
+#include "services/ipc_stats.hpp"
 #include "services/ir/ir_user.hpp"
 #include "services/ldr_ro.hpp"
 #include "services/mcu/mcu_hwc.hpp"
@@ -101,9 +102,14 @@ class ServiceManager {
 	// separately and check it on service calls, for performance reasons
 	bool haveServiceIntercepts = false;
 
+	// Per-command call counts and latencies, only collected when enabled
+	IPCStats ipcStats;
+
 	// Checks for whether a service call is intercepted by Lua and handles it. Returns true if Lua told us not to handle the function,
 	// or false if we should handle it as normal
 	bool checkForIntercept(u32 messagePointer, Handle handle);
+	// Call the handleSyncRequest function of the service with the respective handle
+	void dispatchToService(u32 messagePointer, Handle handle);
 
 	// "srv:" commands
 	void enableNotification(u32 messagePointer);
@@ -125,6 +131,7 @@ class ServiceManager {
 
 	// Wrappers for communicating with certain services
 	void sendGPUInterrupt(GPUInterrupt type) { gsp_gpu.requestInterrupt(type); }
+	void syncGPUCommands() { gsp_gpu.syncCommands(); }
 	void setGSPSharedMem(u8* ptr) { gsp_gpu.setSharedMem(ptr); }
 	void setHIDSharedMem(u8* ptr) { hid.setSharedMem(ptr); }
 	void setCSNDSharedMem(u8* ptr) { csnd.setSharedMemory(ptr); }
@@ -135,6 +142,9 @@ class ServiceManager {
 	DSPService& getDSP() { return dsp; }
 	Y2RService& getY2R() { return y2r; }
 	IRUserService& getIRUser() { return ir_user; }
+	CAMService& getCAM() { return cam; }
+	MICService& getMIC() { return mic; }
+	IPCStats& getIPCStats() { return ipcStats; }
 
 	void addServiceIntercept(const std::string& service, u32 function, int callbackRef) {
 		auto success = interceptedServices.try_emplace(InterceptedService(service, function), callbackRef);
@@ -49,6 +49,13 @@ void EmulatorConfig::load() {
 			printAppVersion = toml::find_or<toml::boolean>(general, "PrintAppVersion", true);
 			circlePadProEnabled = toml::find_or<toml::boolean>(general, "EnableCirclePadPro", true);
 			fastmemEnabled = toml::find_or<toml::boolean>(general, "EnableFastmem", enableFastmemDefault);
+			secondCoreEnabled = toml::find_or<toml::boolean>(general, "EnableSecondCore", false);
+			cpuClockPercent = u32(std::clamp<toml::integer>(
+				toml::find_or<toml::integer>(general, "CPUClockPercent", 100), minCPUClockPercent, maxCPUClockPercent
+			));
+			autoNew3DSClock = toml::find_or<toml::boolean>(general, "AutoNew3DSClock", true);
+			ipcStatistics = toml::find_or<toml::boolean>(general, "EnableIPCStatistics", false);
+			logFilter = toml::find_or<std::string>(general, "LogFilter", "");
 			systemLanguage = languageCodeFromString(toml::find_or<std::string>(general, "SystemLanguage", "en"));
 
 			// Load recent games list
@@ -70,6 +77,25 @@ void EmulatorConfig::load() {
 		}
 	}
 
+	if (data.contains("Speed")) {
+		auto speedResult = toml::expect<toml::value>(data.at("Speed"));
+		if (speedResult.is_ok()) {
+			auto speed = speedResult.unwrap();
+
+			// 0 means unlimited, anything else is clamped to the supported range
+			auto getSpeed = [&](const char* key, u32 defaultValue) -> u32 {
+				const auto value = toml::find_or<toml::integer>(speed, key, defaultValue);
+				return value <= 0 ? 0 : u32(std::clamp<toml::integer>(value, minSpeed, maxSpeed));
+			};
+
+			targetSpeed = getSpeed("TargetSpeed", 100);
+			fastForwardSpeed = getSpeed("FastForwardSpeed", 0);
+			turboSpeed = getSpeed("TurboSpeed", 200);
+			maxFrameSkip = u32(std::clamp<toml::integer>(toml::find_or<toml::integer>(speed, "MaxFrameSkip", 0), 0, 10));
+			skipRenderingSkippedFrames = toml::find_or<toml::boolean>(speed, "SkipRenderingSkippedFrames", false);
+		}
+	}
+
 	if (data.contains("Window")) {
 		auto windowResult = toml::expect<toml::value>(data.at("Window"));
 		if (windowResult.is_ok()) {
@@ -102,10 +128,14 @@ void EmulatorConfig::load() {
 			}
 
 			shaderJitEnabled = toml::find_or<toml::boolean>(gpu, "EnableShaderJIT", shaderJitDefault);
+			shaderJitCacheSize = std::max<u32>(1, toml::find_or<toml::integer>(gpu, "ShaderJITCacheSize", 32));
 			vsyncEnabled = toml::find_or<toml::boolean>(gpu, "EnableVSync", true);
 			useUbershaders = toml::find_or<toml::boolean>(gpu, "UseUbershaders", ubershaderDefault);
 			accurateShaderMul = toml::find_or<toml::boolean>(gpu, "AccurateShaderMultiplication", false);
 			accelerateShaders = toml::find_or<toml::boolean>(gpu, "AccelerateShaders", accelerateShadersDefault);
+			asyncGXCommands = toml::find_or<toml::boolean>(gpu, "AsyncGXCommands", false);
+			asyncShaderCompilation = toml::find_or<toml::boolean>(gpu, "AsyncShaderCompilation", false);
+			batchDraws = toml::find_or<toml::boolean>(gpu, "BatchDraws", true);
 
 			forceShadergenForLights = toml::find_or<toml::boolean>(gpu, "ForceShadergenForLighting", true);
 			lightShadergenThreshold = toml::find_or<toml::integer>(gpu, "ShadergenLightThreshold", 1);
@@ -131,6 +161,7 @@ void EmulatorConfig::load() {
 			printDSPFirmware = toml::find_or<toml::boolean>(audio, "PrintDSPFirmware", false);
 
 			audioDeviceConfig.muteAudio = toml::find_or<toml::boolean>(audio, "MuteAudio", false);
+			audioDeviceConfig.timeStretching = toml::find_or<toml::boolean>(audio, "TimeStretching", true);
 			// Our volume ranges from 0.0 (muted) to 2.0 (boosted, using a logarithmic scale). 1.0 is the "default" volume, ie we don't adjust the PCM
 			// samples at all.
 			audioDeviceConfig.volumeRaw = float(std::clamp(toml::find_or<toml::floating>(audio, "AudioVolume", 1.0), 0.0, 2.0));
@@ -161,6 +192,26 @@ void EmulatorConfig::load() {
 		}
 	}
 
+	if (data.contains("Camera")) {
+		auto cameraResult = toml::expect<toml::value>(data.at("Camera"));
+		if (cameraResult.is_ok()) {
+			auto camera = cameraResult.unwrap();
+
+			cameraSource = Camera::sourceTypeFromString(toml::find_or<std::string>(camera, "Source", "pattern"));
+			cameraImagePath = toml::find_or<std::string>(camera, "ImagePath", "");
+		}
+	}
+
+	if (data.contains("Microphone")) {
+		auto micResult = toml::expect<toml::value>(data.at("Microphone"));
+		if (micResult.is_ok()) {
+			auto mic = micResult.unwrap();
+
+			micSource = Microphone::sourceTypeFromString(toml::find_or<std::string>(mic, "Source", "silence"));
+			micWavPath = toml::find_or<std::string>(mic, "WavPath", "");
+		}
+	}
+
 	if (data.contains("UI")) {
 		auto uiResult = toml::expect<toml::value>(data.at("UI"));
 		if (uiResult.is_ok()) {
@@ -199,6 +250,11 @@ void EmulatorConfig::save() {
 	data["General"]["SystemLanguage"] = languageCodeToString(systemLanguage);
 	data["General"]["EnableCirclePadPro"] = circlePadProEnabled;
 	data["General"]["EnableFastmem"] = fastmemEnabled;
+	data["General"]["EnableSecondCore"] = secondCoreEnabled;
+	data["General"]["CPUClockPercent"] = cpuClockPercent;
+	data["General"]["AutoNew3DSClock"] = autoNew3DSClock;
+	data["General"]["EnableIPCStatistics"] = ipcStatistics;
+	data["General"]["LogFilter"] = logFilter;
 
 	toml::array recentsArray;
 	for (const auto& gamePath : recentlyPlayed) {
@@ -206,6 +262,12 @@ void EmulatorConfig::save() {
 	}
 	data["General"]["RecentGames"] = recentsArray;
 
+	data["Speed"]["TargetSpeed"] = targetSpeed;
+	data["Speed"]["FastForwardSpeed"] = fastForwardSpeed;
+	data["Speed"]["TurboSpeed"] = turboSpeed;
+	data["Speed"]["MaxFrameSkip"] = maxFrameSkip;
+	data["Speed"]["SkipRenderingSkippedFrames"] = skipRenderingSkippedFrames;
+
 	data["Window"]["AppVersionOnWindow"] = windowSettings.showAppVersion;
 	data["Window"]["RememberWindowPosition"] = windowSettings.rememberPosition;
 	data["Window"]["WindowPosX"] = windowSettings.x;
@@ -214,6 +276,7 @@ void EmulatorConfig::save() {
 	data["Window"]["WindowHeight"] = windowSettings.height;
 
 	data["GPU"]["EnableShaderJIT"] = shaderJitEnabled;
+	data["GPU"]["ShaderJITCacheSize"] = shaderJitCacheSize;
 	data["GPU"]["Renderer"] = std::string(Renderer::typeToString(rendererType));
 	data["GPU"]["EnableVSync"] = vsyncEnabled;
 	data["GPU"]["AccurateShaderMultiplication"] = accurateShaderMul;
@@ -221,6 +284,9 @@ void EmulatorConfig::save() {
 	data["GPU"]["ForceShadergenForLighting"] = forceShadergenForLights;
 	data["GPU"]["ShadergenLightThreshold"] = lightShadergenThreshold;
 	data["GPU"]["AccelerateShaders"] = accelerateShaders;
+	data["GPU"]["AsyncGXCommands"] = asyncGXCommands;
+	data["GPU"]["AsyncShaderCompilation"] = asyncShaderCompilation;
+	data["GPU"]["BatchDraws"] = batchDraws;
 	data["GPU"]["EnableRenderdoc"] = enableRenderdoc;
 	data["GPU"]["HashTextures"] = hashTextures;
 	data["GPU"]["ScreenLayout"] = std::string(ScreenLayout::layoutToString(screenLayout));
@@ -230,6 +296,7 @@ void EmulatorConfig::save() {
 	data["Audio"]["EnableAudio"] = audioEnabled;
 	data["Audio"]["EnableAACAudio"] = aacEnabled;
 	data["Audio"]["MuteAudio"] = audioDeviceConfig.muteAudio;
+	data["Audio"]["TimeStretching"] = audioDeviceConfig.timeStretching;
 	data["Audio"]["AudioVolume"] = double(audioDeviceConfig.volumeRaw);
 	data["Audio"]["VolumeCurve"] = std::string(AudioDeviceConfig::volumeCurveToString(audioDeviceConfig.volumeCurve));
 	data["Audio"]["PrintDSPFirmware"] = printDSPFirmware;
@@ -240,6 +307,12 @@ void EmulatorConfig::save() {
 	data["SD"]["UseVirtualSD"] = sdCardInserted;
 	data["SD"]["WriteProtectVirtualSD"] = sdWriteProtected;
 
+	data["Camera"]["Source"] = std::string(Camera::sourceTypeToString(cameraSource));
+	data["Camera"]["ImagePath"] = cameraImagePath.string();
+
+	data["Microphone"]["Source"] = std::string(Microphone::sourceTypeToString(micSource));
+	data["Microphone"]["WavPath"] = micWavPath.string();
+
 	data["UI"]["Theme"] = std::string(FrontendSettings::themeToString(frontendSettings.theme));
 	data["UI"]["WindowIcon"] = std::string(FrontendSettings::iconToString(frontendSettings.icon));
 	data["UI"]["Language"] = frontendSettings.language;
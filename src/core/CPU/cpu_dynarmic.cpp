@@ -3,18 +3,45 @@
 
 #include "arm_defs.hpp"
 #include "emulator.hpp"
+#include "profiler.hpp"
 
-CPU::CPU(Memory& mem, Kernel& kernel, Emulator& emu) : mem(mem), emu(emu), scheduler(emu.getScheduler()), env(mem, kernel, emu.getScheduler()) {
-	cp15 = std::make_shared<CP15>();
+CPU::CPU(Memory& mem, Kernel& kernel, Emulator& emu) : mem(mem), emu(emu), scheduler(emu.getScheduler()), kernel(kernel) {
 	mem.setCPUTicks(getTicksRef());
 
+	makeCore(0, scheduler.currentTimestamp);
+	secondCoreEnabled = emu.getConfig().secondCoreEnabled;
+	if (secondCoreEnabled) {
+		makeCore(1, secondCoreTimestamp);
+		secondCoreThread = std::thread(&CPU::secondCoreLoop, this);
+	}
+
+	setActiveCore(0);
+}
+
+CPU::~CPU() {
+	if (secondCoreThread.joinable()) {
+		{
+			std::unique_lock lock(sliceMutex);
+			stopSecondCore = true;
+		}
+
+		sliceCondition.notify_all();
+		secondCoreThread.join();
+	}
+}
+
+void CPU::makeCore(int coreID, u64& timestamp) {
+	Core& core = cores[coreID];
+	core.env = std::make_unique<MyEnvironment>(timestamp, mem, kernel, *this, coreID);
+	core.cp15 = std::make_shared<CP15>();
+
 	Dynarmic::A32::UserConfig config;
 	config.arch_version = Dynarmic::A32::ArchVersion::v6K;
-	config.callbacks = &env;
-	config.coprocessors[15] = cp15;
+	config.callbacks = core.env.get();
+	config.coprocessors[15] = core.cp15;
 	config.define_unpredictable_behaviour = true;
 	config.global_monitor = &exclusiveMonitor;
-	config.processor_id = 0;
+	config.processor_id = coreID;
 
 	if (mem.isFastmemEnabled()) {
 		config.fastmem_pointer = u64(mem.getFastmemArenaBase());
@@ -22,30 +49,144 @@ CPU::CPU(Memory& mem, Kernel& kernel, Emulator& emu) : mem(mem), emu(emu), sched
 		config.fastmem_pointer = std::nullopt;
 	}
 
-	jit = std::make_unique<Dynarmic::A32::Jit>(config);
+	core.jit = std::make_unique<Dynarmic::A32::Jit>(config);
 }
 
 void CPU::reset() {
-	setCPSR(CPSR::UserMode);
-	setFPSCR(FPSCR::MainThreadDefault);
+	for (int i = coreCount - 1; i >= 0; i--) {
+		if (cores[i].jit == nullptr) {
+			continue;
+		}
+
+		setActiveCore(i);
+		setCPSR(CPSR::UserMode);
+		setFPSCR(FPSCR::MainThreadDefault);
+
+		cp15->reset();
+		cp15->setTLSBase(VirtualAddrs::TLSBase);  // Set cp15 TLS pointer to the main thread's thread-local storage
+		jit->Reset();
+		jit->ClearCache();
+		jit->Regs().fill(0);
+		jit->ExtRegs().fill(0);
+
+		pendingInvalidations[i] = {};
+	}
+
+	exclusiveMonitor.Clear();
+}
+
+void CPU::setClockPercent(u32 percent) {
+	for (auto& core : cores) {
+		if (core.env != nullptr) {
+			core.env->setClockPercent(percent);
+		}
+	}
+}
+
+void CPU::clearCache() {
+	if (!secondCoreEnabled) [[likely]] {
+		jit->ClearCache();
+		return;
+	}
+
+	// We can only touch the JIT of the core we're running on. The other core catches up at the end of the slice
+	cores[activeCore].jit->ClearCache();
+	pendingInvalidations[activeCore ^ 1].clearAll = true;
+}
+
+void CPU::clearCacheRange(u32 start, u32 size) {
+	if (!secondCoreEnabled) [[likely]] {
+		jit->InvalidateCacheRange(start, size);
+		return;
+	}
+
+	cores[activeCore].jit->InvalidateCacheRange(start, size);
+	pendingInvalidations[activeCore ^ 1].ranges.emplace_back(start, size);
+}
+
+void CPU::applyPendingInvalidations() {
+	for (int i = 0; i < coreCount; i++) {
+		PendingInvalidation& pending = pendingInvalidations[i];
+
+		if (pending.clearAll) {
+			cores[i].jit->ClearCache();
+		} else {
+			for (auto [start, size] : pending.ranges) {
+				cores[i].jit->InvalidateCacheRange(start, size);
+			}
+		}
+
+		pending.clearAll = false;
+		pending.ranges.clear();
+	}
+}
+
+void MyEnvironment::CallSVC(u32 swi) {
+	// The HLE kernel and services aren't thread-safe and expect to run on the emulator thread, so core 1 leaves its SVCs to be serviced
+	// there, as soon as core 0 stops at its next block boundary
+	if (coreID == 0) [[likely]] {
+		kernel.serviceSVC(swi);
+	} else {
+		cpu.deferSecondCoreSVC(swi);
+	}
+}
+
+void CPU::deferSecondCoreSVC(u32 svc) {
+	// Dynarmic has already moved the PC past the SVC instruction, so the core resumes after it once the SVC has been serviced
+	secondCorePendingSVC = svc;
+	cores[1].jit->HaltExecution(Dynarmic::HaltReason::UserDefined1);
+	// Ask core 0 to stop too, so the emulator thread can service the SVC without waiting for the end of the slice
+	cores[0].jit->HaltExecution(Dynarmic::HaltReason::UserDefined2);
+}
+
+bool CPU::serviceSecondCoreSVC() {
+	if (!secondCorePendingSVC.has_value()) {
+		return false;
+	}
 
-	cp15->reset();
-	cp15->setTLSBase(VirtualAddrs::TLSBase);  // Set cp15 TLS pointer to the main thread's thread-local storage
-	jit->Reset();
-	jit->ClearCache();
-	jit->Regs().fill(0);
-	jit->ExtRegs().fill(0);
+	const u32 svc = *secondCorePendingSVC;
+	secondCorePendingSVC = std::nullopt;
+
+	if (!kernel.serviceSVCOnCore(svc, 1) || cores[1].env->ticksLeft == 0) {
+		return false;
+	}
+
+	// Both cores are stopped, so we can catch up on invalidations before core 1 goes on with the rest of its slice
+	applyPendingInvalidations();
+	startSecondCore();
+	return true;
+}
+
+void CPU::startSecondCore() {
+	{
+		std::unique_lock lock(sliceMutex);
+		secondCoreRunning = true;
+	}
+
+	sliceCondition.notify_all();
+}
+
+void CPU::waitForSecondCore() {
+	PROFILE_SCOPE("CPU::waitForSecondCore", CPU);
+	std::unique_lock lock(sliceMutex);
+	sliceCondition.wait(lock, [this] { return !secondCoreRunning; });
 }
 
 void CPU::runFrame() {
+	PROFILE_SCOPE("CPU::runFrame", CPU);
 	emu.frameDone = false;
 
+	if (secondCoreEnabled) {
+		runFrameMultiCore();
+		return;
+	}
+
 	while (!emu.frameDone) {
 		// Run CPU until the next scheduler event
-		env.ticksLeft = scheduler.nextTimestamp - scheduler.currentTimestamp;
+		cores[0].env->ticksLeft = scheduler.nextTimestamp - scheduler.currentTimestamp;
 
 	execute:
-		const auto exitReason = jit->Run();
+		const auto exitReason = cores[0].jit->Run();
 
 		// Handle any scheduler events that need handling.
 		emu.pollScheduler();
@@ -62,4 +203,92 @@ void CPU::runFrame() {
 	}
 }
 
+void CPU::runFrameMultiCore() {
+	Core& core = cores[0];
+
+	while (!emu.frameDone) {
+		// Neither core is running at this point, so we can pick the threads each core will run and catch up on cache invalidations
+		applyPendingInvalidations();
+		secondCoreTimestamp = scheduler.currentTimestamp;
+		const bool runSecondCore = kernel.rescheduleCores();
+		const u64 sliceTicks = std::min<u64>(scheduler.nextTimestamp - scheduler.currentTimestamp, maxSliceTicks);
+
+		if (runSecondCore) {
+			cores[1].env->ticksLeft = sliceTicks;
+			startSecondCore();
+		}
+
+		core.env->ticksLeft = sliceTicks;
+		bool secondCoreRunningSlice = runSecondCore;
+
+		while (true) {
+			const auto exitReason = core.jit->Run();
+
+			// Core 1 stopped at an SVC and halted core 0 at a block boundary, where it isn't inside the kernel. Service the SVC, then resume
+			// both cores with the rest of their slices
+			if (Dynarmic::Has(exitReason, Dynarmic::HaltReason::UserDefined2)) {
+				core.jit->ClearHalt(Dynarmic::HaltReason::UserDefined2);
+				waitForSecondCore();
+				secondCoreRunningSlice = serviceSecondCoreSVC();
+
+				if (core.env->ticksLeft == 0) {
+					break;
+				}
+			} else if (static_cast<u32>(exitReason) == 0) [[likely]] {
+				break;
+			} else if (!Dynarmic::Has(exitReason, Dynarmic::HaltReason::CacheInvalidation)) {
+				Helpers::panic("Exit reason: %d\nPC: %08X", static_cast<u32>(exitReason), core.jit->Regs()[15]);
+			}
+		}
+
+		// SVCs core 1 hits after core 0 has finished its slice are serviced here, until core 1 is done with its own slice
+		while (secondCoreRunningSlice) {
+			waitForSecondCore();
+			secondCoreRunningSlice = serviceSecondCoreSVC();
+		}
+
+		// Core 1 may have asked core 0 to stop after core 0 ran out of ticks. It's stopped now, so don't carry the request over
+		core.jit->ClearHalt(Dynarmic::HaltReason::UserDefined2);
+
+		// Handle any scheduler events that need handling.
+		emu.pollScheduler();
+	}
+}
+
+void CPU::secondCoreLoop() {
+	Core& core = cores[1];
+
+	while (true) {
+		{
+			std::unique_lock lock(sliceMutex);
+			sliceCondition.wait(lock, [this] { return secondCoreRunning || stopSecondCore; });
+
+			if (stopSecondCore) {
+				return;
+			}
+		}
+
+		while (true) {
+			const auto exitReason = core.jit->Run();
+
+			// Stopped at an SVC, or out of ticks for this slice
+			if (Dynarmic::Has(exitReason, Dynarmic::HaltReason::UserDefined1)) {
+				core.jit->ClearHalt(Dynarmic::HaltReason::UserDefined1);
+				break;
+			} else if (static_cast<u32>(exitReason) == 0) {
+				break;
+			} else if (!Dynarmic::Has(exitReason, Dynarmic::HaltReason::CacheInvalidation)) {
+				Helpers::panic("Exit reason: %d\nPC: %08X (core 1)", static_cast<u32>(exitReason), core.jit->Regs()[15]);
+			}
+		}
+
+		{
+			std::unique_lock lock(sliceMutex);
+			secondCoreRunning = false;
+		}
+
+		sliceCondition.notify_all();
+	}
+}
+
 #endif  // CPU_DYNARMIC
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "PICA/dynapica/shader_code_arena.hpp"
+
+#if defined(PANDA3DS_DYNAPICA_SUPPORTED) && (defined(PANDA3DS_X64_HOST) || defined(PANDA3DS_ARM64_HOST))
+#include <algorithm>
+#include <cstring>
+
+static constexpr usize alignUp(usize value, usize alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+void ShaderCodeArena::init(usize newCapacity) {
+	capacity = alignUp(newCapacity, alignment);
+
+#ifdef PANDA3DS_X64_HOST
+	// Xbyak allocates its code buffers as RWX, so we can copy code in and execute it without changing the protection
+	memory = std::make_unique<Xbyak::CodeArray>(capacity);
+	base = const_cast<u8*>(memory->getCode());
+#elif defined(PANDA3DS_ARM64_HOST)
+	memory = std::make_unique<oaknut::CodeBlock>(capacity);
+	base = reinterpret_cast<u8*>(memory->ptr());
+#endif
+
+	clear();
+}
+
+void ShaderCodeArena::clear() {
+	freeRanges.clear();
+	used = 0;
+
+	if (capacity != 0) {
+		freeRanges[0] = capacity;
+	}
+}
+
+u8* ShaderCodeArena::add(const u8* code, usize size) {
+	const usize allocSize = alignUp(size, alignment);
+
+	// First fit. There's usually only a handful of free ranges, as shaders are evicted in LRU order and neighbours get merged
+	auto it = std::find_if(freeRanges.begin(), freeRanges.end(), [allocSize](const auto& range) { return range.second >= allocSize; });
+	if (it == freeRanges.end()) {
+		return nullptr;
+	}
+
+	const usize offset = it->first;
+	const usize remaining = it->second - allocSize;
+	freeRanges.erase(it);
+	if (remaining != 0) {
+		freeRanges[offset + allocSize] = remaining;
+	}
+
+	u8* pointer = base + offset;
+	used += allocSize;
+
+#ifdef PANDA3DS_X64_HOST
+	std::memcpy(pointer, code, size);
+#elif defined(PANDA3DS_ARM64_HOST)
+	memory->unprotect();
+	std::memcpy(pointer, code, size);
+	memory->protect();
+	memory->invalidate(reinterpret_cast<std::uint32_t*>(pointer), size);
+#endif
+
+	return pointer;
+}
+
+void ShaderCodeArena::free(u8* code, usize size) {
+	usize offset = usize(code - base);
+	usize freeSize = alignUp(size, alignment);
+	used -= freeSize;
+
+	// Merge with the next free range if it starts right where we end
+	auto next = freeRanges.lower_bound(offset);
+	if (next != freeRanges.end() && next->first == offset + freeSize) {
+		freeSize += next->second;
+		next = freeRanges.erase(next);
+	}
+
+	// And with the previous one if it ends right where we start
+	if (next != freeRanges.begin()) {
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			freeSize += prev->second;
+			freeRanges.erase(prev);
+		}
+	}
+
+	freeRanges[offset] = freeSize;
+}
+
+usize ShaderCodeArena::getLargestFreeRange() const {
+	usize largest = 0;
+	for (const auto& [offset, size] : freeRanges) {
+		largest = std::max(largest, size);
+	}
+
+	return largest;
+}
+
+#endif  // Shader JIT check
@@ -1,9 +1,102 @@
 #include "PICA/dynapica/shader_rec.hpp"
+
 #include <bit>
+#include <cstring>
+
+#include "PICA/pica_hash.hpp"
 
 #ifdef PANDA3DS_SHADER_JIT_SUPPORTED
 void ShaderJIT::reset() {
+	if (!cache.empty()) {
+		const MemoryStats memoryStats = getMemoryStats();
+		log("Resetting shader cache. %zu shaders, %zu blocks, %zu/%zu bytes of code, %llu evictions\n", memoryStats.cachedShaders,
+			memoryStats.uniqueBlocks, memoryStats.arenaUsed, memoryStats.arenaCapacity, (unsigned long long)memoryStats.evictions);
+	}
+
 	cache.clear();
+	blocks.clear();
+	lru.clear();
+	stats = {};
+
+	// The arena is allocated lazily on the first compile, so that we don't reserve executable memory if the JIT is never used
+	if (arena.isInitialized()) {
+		if (arena.getCapacity() != memoryBudget) {
+			arena.init(memoryBudget);
+		} else {
+			arena.clear();
+		}
+	}
+}
+
+void ShaderJIT::evictLeastRecentlyUsed() {
+	const Hash hash = lru.back();
+	lru.pop_back();
+
+	auto it = cache.find(hash);
+	const Hash blockHash = it->second.blockHash;
+	cache.erase(it);
+
+	CodeBlock& block = blocks.at(blockHash);
+	if (--block.refCount == 0) {
+		arena.free(block.code, block.size);
+		blocks.erase(blockHash);
+	}
+
+	stats.evictions++;
+}
+
+ShaderJIT::CachedShader& ShaderJIT::compile(PICAShader& shaderUnit, Hash hash) {
+	if (!arena.isInitialized()) {
+		arena.init(memoryBudget);
+	}
+
+	while (cache.size() >= maxCachedShaders) {
+		evictLeastRecentlyUsed();
+	}
+
+	// Emit the shader into a temporary buffer first. Once we know how big it is, we copy it into the arena and free the buffer
+	auto emitter = std::make_unique<ShaderEmitter>(accurateMul);
+	emitter->compile(shaderUnit);
+	stats.compilations++;
+
+	const u8* code = emitter->getCode();
+	const usize size = emitter->getSize();
+	Hash blockHash = PICAHash::computeHash(reinterpret_cast<const char*>(code), size);
+
+	// See if an identical program is already in the arena, in which case we can share it. Probe past any blocks whose hash collides with
+	// ours but have different code, however unlikely that is
+	const auto hasSameCode = [&](const CodeBlock& block) { return block.size == size && std::memcmp(block.code, code, size) == 0; };
+	auto blockIt = blocks.find(blockHash);
+	while (blockIt != blocks.end() && !hasSameCode(blockIt->second)) [[unlikely]] {
+		blockIt = blocks.find(++blockHash);
+	}
+
+	if (blockIt != blocks.end()) {
+		blockIt->second.refCount++;
+		stats.dedupHits++;
+	} else {
+		u8* pointer = arena.add(code, size);
+		// Arena is full, evict shaders until there's room for the new one
+		while (pointer == nullptr && !lru.empty()) {
+			evictLeastRecentlyUsed();
+			pointer = arena.add(code, size);
+		}
+
+		if (pointer == nullptr) {
+			Helpers::panic("Shader JIT: Compiled shader (%zu bytes) does not fit in the code arena (%zu bytes)", size, arena.getCapacity());
+		}
+
+		blocks.emplace(blockHash, CodeBlock{pointer, size, 1});
+	}
+
+	CachedShader entry;
+	entry.blockHash = blockHash;
+	entry.prologueOffset = u32(emitter->getPrologueOffset());
+	entry.entrypointOffset = u32(emitter->getInstructionOffset(shaderUnit.entrypoint));
+
+	lru.push_front(hash);
+	entry.lruPosition = lru.begin();
+	return cache.emplace(hash, std::move(entry)).first->second;
 }
 
 void ShaderJIT::prepare(PICAShader& shaderUnit) {
@@ -15,18 +108,27 @@ void ShaderJIT::prepare(PICAShader& shaderUnit) {
 	Hash hash = std::rotl(shaderUnit.getCodeHash(), 1) ^ shaderUnit.getOpdescHash();
 	auto it = cache.find(hash);
 
-	if (it == cache.end()) { // Block has not been compiled yet
-		auto emitter = std::make_unique<ShaderEmitter>(accurateMul);
-		emitter->compile(shaderUnit);
-		// Get pointer to callbacks
-		entrypointCallback = emitter->getInstructionCallback(shaderUnit.entrypoint);
-		prologueCallback = emitter->getPrologueCallback();
-
-		cache.emplace_hint(it, hash, std::move(emitter));
-	} else { // Block has been compiled and found, use it
-		auto emitter = it->second.get();
-		entrypointCallback = emitter->getInstructionCallback(shaderUnit.entrypoint);
-		prologueCallback = emitter->getPrologueCallback();
+	CachedShader* shader;
+	if (it == cache.end()) {  // Block has not been compiled yet
+		shader = &compile(shaderUnit, hash);
+	} else {  // Block has been compiled and found, mark it as the most recently used one
+		shader = &it->second;
+		lru.splice(lru.begin(), lru, shader->lruPosition);
 	}
+
+	// Get pointer to callbacks
+	u8* code = blocks.at(shader->blockHash).code;
+	entrypointCallback = reinterpret_cast<ShaderEmitter::InstructionCallback>(code + shader->entrypointOffset);
+	prologueCallback = reinterpret_cast<ShaderEmitter::PrologueCallback>(code + shader->prologueOffset);
+}
+
+ShaderJIT::MemoryStats ShaderJIT::getMemoryStats() const {
+	MemoryStats memoryStats = stats;
+	memoryStats.arenaCapacity = arena.getCapacity();
+	memoryStats.arenaUsed = arena.getUsed();
+	memoryStats.cachedShaders = cache.size();
+	memoryStats.uniqueBlocks = blocks.size();
+
+	return memoryStats;
 }
-#endif // PANDA3DS_SHADER_JIT_SUPPORTED
\ No newline at end of file
+#endif  // PANDA3DS_SHADER_JIT_SUPPORTED
@@ -75,6 +75,7 @@ void ShaderEmitter::compile(const PICAShader& shaderUnit) {
 	recompilerPC = 0;
 	loopLevel = 0;
 	compileUntil(shaderUnit, PICAShader::maxInstructionCount);
+	l(codeEnd);
 
 	// Protect the memory and invalidate icache before executing the code
 	oaknut::CodeBlock::protect();
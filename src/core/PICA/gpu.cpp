@@ -7,6 +7,7 @@
 
 #include "PICA/float_types.hpp"
 #include "PICA/regs.hpp"
+#include "profiler.hpp"
 #include "renderer_null/renderer_null.hpp"
 #include "renderer_sw/renderer_sw.hpp"
 #ifdef PANDA3DS_ENABLE_OPENGL
@@ -76,6 +77,7 @@ GPU::GPU(Memory& mem, EmulatorConfig& config) : mem(mem), config(config) {
 void GPU::reset() {
 	regs.fill(0);
 	shaderUnit.reset();
+	shaderJIT.setMemoryBudget(usize(config.shaderJitCacheSize) * 1_MB);
 	shaderJIT.reset();
 	shaderJIT.setAccurateMul(config.accurateShaderMul);
 
@@ -97,6 +99,14 @@ void GPU::reset() {
 
 	oldVsOutputMask = 0;
 	setVsOutputMask(0xFFFF);
+	dirtyRegGroups = PICA::DirtyRegs::All;
+	outputMappingCount = 0;
+
+	// Anything still batched belongs to the previous session
+	drawBatch.vertices.clear();
+	drawBatch.drawCount = 0;
+	drawBatchStats = {};
+	lastFrameDrawBatchStats = {};
 
 	for (auto& e : attributeInfo) {
 		e.offset = 0;
@@ -134,6 +144,12 @@ static std::array<PICA::Vertex, Renderer::vertexBufferSize> vertices;
 // Call the correct version of drawArrays based on whether this is an indexed draw (first template parameter)
 // And whether we are going to use the shader JIT (second template parameter)
 void GPU::drawArrays(bool indexed) {
+	if (skipDraws.load(std::memory_order_relaxed)) [[unlikely]] {
+		return;
+	}
+
+	PROFILE_SCOPE("GPU::drawArrays", GPU);
+	updateDerivedState();
 	PICA::DrawAcceleration accel;
 
 	if (config.accelerateShaders) {
@@ -142,7 +158,12 @@ void GPU::drawArrays(bool indexed) {
 		getAcceleratedDrawInfo(accel, indexed);
 	}
 
-	const bool hwShaders = renderer->prepareForDraw(shaderUnit, &accel);
+	// If there's a pending batch, nothing that affects rendering has changed since it was started (that would have flushed it),
+	// so the renderer is already set up for this draw and it can be merged into the batch
+	bool hwShaders = false;
+	if (!hasPendingDraws()) {
+		hwShaders = renderer->prepareForDraw(shaderUnit, &accel);
+	}
 
 	if (hwShaders) {
 		// Hardware shaders have their own accelerated code path for draws, so they skip everything here
@@ -152,6 +173,8 @@ void GPU::drawArrays(bool indexed) {
 
 		// Note: In the hardware shader path the vertices span shouldn't actually be used as the renderer will perform its own attribute fetching
 		renderer->drawVertices(primType, std::span(vertices).first(vertexCount));
+		drawBatchStats.drawsIn++;
+		drawBatchStats.drawsOut++;
 	} else {
 		const bool shaderJITEnabled = ShaderJIT::isAvailable() && config.shaderJitEnabled;
 
@@ -169,6 +192,29 @@ void GPU::drawArrays(bool indexed) {
 			}
 		}
 	}
+
+	// Both our own derived state and the renderer have caught up with the register changes
+	dirtyRegGroups = 0;
+}
+
+void GPU::updateDerivedState() {
+	using namespace PICA::DirtyRegs;
+
+	// The output mappings depend on the output map registers (Rasterizer group) and GPUREG_VSH_OUTMAP_MASK (VertexShader group)
+	if (dirtyRegGroups & (Rasterizer | VertexShader)) {
+		setVsOutputMask(regs[PICA::InternalRegs::VertexShaderOutputMask]);
+		outputMappingCount = 0;
+
+		const u32 totalShaderOutputs = regs[PICA::InternalRegs::ShaderOutputCount] & 7;
+		for (u32 i = 0; i < totalShaderOutputs; i++) {
+			const u32 config = regs[PICA::InternalRegs::ShaderOutmap0 + i];
+
+			for (u32 j = 0; j < 4; j++) {
+				const u32 mapping = (config >> (j * 8)) & 0x1F;
+				outputMappings[outputMappingCount++] = {vsOutputRegisters[i] + j, mapping};
+			}
+		}
+	}
 }
 
 template <bool indexed, ShaderExecMode mode>
@@ -182,7 +228,6 @@ void GPU::drawArrays() {
 
 	// We can have up to 16 attributes, each one consisting of 4 floats
 	constexpr u32 maxAttrSizeInFloats = 16 * 4;
-	setVsOutputMask(regs[PICA::InternalRegs::VertexShaderOutputMask]);
 
 	// Base address for vertex attributes
 	// The vertex base is always on a quadword boundary because the PICA does weird alignment shit any time possible
@@ -372,24 +417,116 @@ void GPU::drawArrays() {
 			shaderUnit.vs.run();
 		}
 
-		PICA::Vertex& out = vertices[i];
 		// Map shader outputs to fixed function properties
-		const u32 totalShaderOutputs = regs[PICA::InternalRegs::ShaderOutputCount] & 7;
-		for (int i = 0; i < totalShaderOutputs; i++) {
-			const u32 config = regs[PICA::InternalRegs::ShaderOutmap0 + i];
+		mapShaderOutputs(vertices[i]);
+	}
 
-			for (int j = 0; j < 4; j++) {  // pls unroll
-				const u32 mapping = (config >> (j * 8)) & 0x1F;
-				out.raw[mapping] = vsOutputRegisters[i][j];
+	submitVertices(primType, std::span(vertices).first(vertexCount));
+}
+
+// Append a primitive to a triangle list, converting strips and fans to lists
+static void appendAsTriangleList(std::vector<PICA::Vertex>& out, PICA::PrimType primType, std::span<const PICA::Vertex> vertices) {
+	switch (primType) {
+		case PICA::PrimType::TriangleStrip:
+			for (usize i = 0; i + 2 < vertices.size(); i++) {
+				// Every other triangle in a strip has its first 2 vertices swapped to keep the winding order consistent
+				if (i & 1) {
+					out.push_back(vertices[i + 1]);
+					out.push_back(vertices[i]);
+				} else {
+					out.push_back(vertices[i]);
+					out.push_back(vertices[i + 1]);
+				}
+				out.push_back(vertices[i + 2]);
+			}
+			break;
+
+		case PICA::PrimType::TriangleFan:
+			for (usize i = 1; i + 1 < vertices.size(); i++) {
+				out.push_back(vertices[0]);
+				out.push_back(vertices[i]);
+				out.push_back(vertices[i + 1]);
 			}
+			break;
+
+		// Lists and geometry primitives are both drawn as triangle lists
+		default: out.insert(out.end(), vertices.begin(), vertices.end()); break;
+	}
+}
+
+static usize triangleListSize(PICA::PrimType primType, usize vertexCount) {
+	if (primType == PICA::PrimType::TriangleStrip || primType == PICA::PrimType::TriangleFan) {
+		return vertexCount >= 3 ? (vertexCount - 2) * 3 : 0;
+	}
+
+	return vertexCount;
+}
+
+void GPU::submitVertices(PICA::PrimType primType, std::span<const PICA::Vertex> vertices) {
+	drawBatchStats.drawsIn++;
+
+	// Batching is only done for CPU-shaded draws. Hardware shaded draws are submitted straight from drawArrays
+	if (!config.batchDraws || config.accelerateShaders) {
+		PROFILE_SCOPE("Renderer::drawVertices", Renderer);
+		renderer->drawVertices(primType, vertices);
+		drawBatchStats.drawsOut++;
+		return;
+	}
+
+	if (hasPendingDraws()) {
+		const usize mergedSize = triangleListSize(drawBatch.primType, drawBatch.vertices.size()) + triangleListSize(primType, vertices.size());
+
+		if (mergedSize <= Renderer::vertexBufferSize) {
+			// Merging requires everything to be a triangle list, so convert the pending draw to one if it isn't already
+			if (drawBatch.primType != PICA::PrimType::TriangleList) {
+				std::vector<PICA::Vertex> pending = std::move(drawBatch.vertices);
+				drawBatch.vertices.clear();
+				appendAsTriangleList(drawBatch.vertices, drawBatch.primType, pending);
+				drawBatch.primType = PICA::PrimType::TriangleList;
+			}
+
+			appendAsTriangleList(drawBatch.vertices, primType, vertices);
+			drawBatch.drawCount++;
+			return;
 		}
+
+		// Batch is full, start a new one
+		flushDrawBatch();
 	}
 
-	renderer->drawVertices(primType, std::span(vertices).first(vertexCount));
+	// Keep a lone draw in its original form, so that draws that don't end up merged with anything don't pay for the conversion
+	drawBatch.vertices.assign(vertices.begin(), vertices.end());
+	drawBatch.primType = primType;
+	drawBatch.drawCount = 1;
+}
+
+void GPU::flushDrawBatch() {
+	if (!hasPendingDraws()) {
+		return;
+	}
+
+	PROFILE_SCOPE("Renderer::drawVertices", Renderer);
+	renderer->drawVertices(drawBatch.primType, drawBatch.vertices);
+	drawBatchStats.drawsOut++;
+
+	drawBatch.vertices.clear();
+	drawBatch.drawCount = 0;
+}
+
+void GPU::display() {
+	flushDrawBatch();
+
+	{
+		PROFILE_SCOPE("Renderer::display", Renderer);
+		renderer->display();
+	}
+
+	lastFrameDrawBatchStats = drawBatchStats;
+	drawBatchStats = {};
 }
 
 PICA::Vertex GPU::getImmediateModeVertex() {
-	setVsOutputMask(regs[PICA::InternalRegs::VertexShaderOutputMask]);
+	updateDerivedState();
 
 	PICA::Vertex v;
 	const int totalAttrCount = (regs[PICA::InternalRegs::VertexShaderAttrNum] & 0xf) + 1;
@@ -403,16 +540,7 @@ PICA::Vertex GPU::getImmediateModeVertex() {
 	shaderUnit.vs.run();
 
 	// Map shader outputs to fixed function properties
-	const u32 totalShaderOutputs = regs[PICA::InternalRegs::ShaderOutputCount] & 7;
-	for (int i = 0; i < totalShaderOutputs; i++) {
-		const u32 config = regs[PICA::InternalRegs::ShaderOutmap0 + i];
-
-		for (int j = 0; j < 4; j++) {  // pls unroll
-			const u32 mapping = (config >> (j * 8)) & 0x1F;
-			v.raw[mapping] = vsOutputRegisters[i][j];
-		}
-	}
-
+	mapShaderOutputs(v);
 	return v;
 }
 
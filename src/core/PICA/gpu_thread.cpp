@@ -0,0 +1,82 @@
+#include "PICA/gpu_thread.hpp"
+
+void GPUThread::start(Executor executor) {
+	stop();
+
+	this->executor = std::move(executor);
+	exiting = false;
+	thread = std::thread([this]() { threadLoop(); });
+}
+
+void GPUThread::stop() {
+	if (thread.joinable()) {
+		exiting = true;
+		{
+			std::scoped_lock lock(mutex);
+		}
+
+		wakeup.notify_one();
+		thread.join();
+	}
+
+	// Throw away any work that was never executed
+	GPUThreadCommand discarded;
+	while (ring.pop(&discarded, 1) != 0) {
+	}
+
+	submitted = 0;
+	completed = 0;
+}
+
+u64 GPUThread::push(const GPUThreadCommand& command) {
+	// If the ring is full, we need to wait for the GPU thread to catch up
+	while (ring.push(&command, 1) == 0) [[unlikely]] {
+		waitFor(completed.load() + 1);
+	}
+
+	// Only take the mutex if the GPU thread is asleep. The sleeping flag is set before the GPU thread re-checks the ring under the mutex,
+	// so either it will see our command, or we will see the flag and wake it up
+	if (gpuThreadSleeping.load()) {
+		{
+			std::scoped_lock lock(mutex);
+		}
+		wakeup.notify_one();
+	}
+
+	return ++submitted;
+}
+
+void GPUThread::waitFor(u64 sequence) {
+	if (completed.load(std::memory_order_acquire) >= sequence) {
+		return;
+	}
+
+	std::unique_lock lock(mutex);
+	emulatorThreadWaiting = true;
+	progress.wait(lock, [this, sequence]() { return completed.load() >= sequence || !thread.joinable(); });
+	emulatorThreadWaiting = false;
+}
+
+void GPUThread::threadLoop() {
+	GPUThreadCommand command;
+
+	while (!exiting.load()) {
+		if (ring.pop(&command, 1) != 0) {
+			executor(command);
+			completed.fetch_add(1);
+
+			if (emulatorThreadWaiting.load()) {
+				{
+					std::scoped_lock lock(mutex);
+				}
+				progress.notify_all();
+			}
+			continue;
+		}
+
+		std::unique_lock lock(mutex);
+		gpuThreadSleeping = true;
+		wakeup.wait(lock, [this]() { return exiting.load() || ring.size() != 0; });
+		gpuThreadSleeping = false;
+	}
+}
@@ -1,5 +1,9 @@
 #include "PICA/pica_hash.hpp"
+
+#include <vector>
+
 #include "PICA/shader.hpp"
+#include "PICA/shader_decompiler.hpp"
 
 #ifdef PANDA3DS_PICA_CITYHASH
 #include "cityhash.hpp"
@@ -19,14 +23,94 @@ PICAHash::HashType PICAHash::computeHash(const char* buf, std::size_t len) {
 #endif
 }
 
+void PICAShader::invalidateCodeHashes() {
+	for (auto& entry : codeHashCache) {
+		entry.valid = false;
+	}
+}
+
+PICAShader::Hash PICAShader::computeCodeHash(CodeHashEntry& entry) {
+	PICA::ShaderGen::ControlFlow controlFlow;
+	controlFlow.analyze(*this, entrypoint);
+
+	// If we can't figure out which code is reachable (eg because of jmp shenanigans), hash all the code that has been uploaded
+	// and treat all of it as reachable, so that any write invalidates the hash
+	if (controlFlow.analysisFailed) {
+		entry.reachable.set();
+
+		std::vector<u32> key;
+		key.reserve(codeSize + 1);
+		key.push_back(entrypoint);
+		key.insert(key.end(), loadedShader.begin(), loadedShader.begin() + codeSize);
+		return PICAHash::computeHash((const char*)key.data(), key.size() * sizeof(u32));
+	}
+
+	entry.reachable = controlFlow.reachable;
+
+	// The key is made of the entrypoint, followed by a {start, length, instructions...} record for each run of reachable instructions.
+	// The positions need to be part of the key, as jumps and calls use absolute addresses
+	std::vector<u32> key;
+	key.reserve(entry.reachable.count() + 16);
+	key.push_back(entrypoint);
+
+	for (u32 pc = 0; pc < maxInstructionCount;) {
+		if (!entry.reachable.test(pc)) {
+			pc++;
+			continue;
+		}
+
+		const u32 start = pc;
+		while (pc < maxInstructionCount && entry.reachable.test(pc)) {
+			pc++;
+		}
+
+		key.push_back(start);
+		key.push_back(pc - start);
+		key.insert(key.end(), loadedShader.begin() + start, loadedShader.begin() + pc);
+	}
+
+	return PICAHash::computeHash((const char*)key.data(), key.size() * sizeof(u32));
+}
+
 PICAShader::Hash PICAShader::getCodeHash() {
-	// Hash the code again if the code changed
 	if (codeHashDirty) {
 		codeHashDirty = false;
-		lastCodeHash = PICAHash::computeHash((const char*)&loadedShader[0], loadedShader.size() * sizeof(loadedShader[0]));
+
+		// Throw away the hashes whose reachable code was touched by the uploads since the last time we hashed. Writes that only hit
+		// unreachable code can't change what's reachable, so the rest of the hashes stay valid
+		for (auto& entry : codeHashCache) {
+			if (!entry.valid) {
+				continue;
+			}
+
+			for (u32 pc = dirtyCodeStart; pc < dirtyCodeEnd; pc++) {
+				if (entry.reachable.test(pc)) {
+					entry.valid = false;
+					break;
+				}
+			}
+		}
+	} else if (entrypoint == lastCodeHashEntrypoint) {
+		return lastCodeHash;
 	}
 
-	// Return the code hash
+	lastCodeHashEntrypoint = entrypoint;
+	for (auto& entry : codeHashCache) {
+		if (entry.valid && entry.entrypoint == entrypoint) {
+			lastCodeHash = entry.hash;
+			return lastCodeHash;
+		}
+	}
+
+	// Hash the code again if the reachable code changed or we haven't seen this entrypoint before
+	CodeHashEntry& entry = codeHashCache[nextCodeHashEntry];
+	nextCodeHashEntry = (nextCodeHashEntry + 1) % codeHashCache.size();
+
+	entry.entrypoint = entrypoint;
+	entry.hash = computeCodeHash(entry);
+	entry.valid = true;
+
+	lastCodeHash = entry.hash;
 	return lastCodeHash;
 }
 
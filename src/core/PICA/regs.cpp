@@ -1,10 +1,66 @@
 #include "PICA/regs.hpp"
 
 #include "PICA/gpu.hpp"
+#include "profiler.hpp"
 
 using namespace Floats;
 using namespace Helpers;
 
+namespace {
+	// Registers that writeInternalReg needs to do more than store the value for. Writes to any other register can be applied directly
+	constexpr bool hasWriteSideEffects(u32 index) {
+		using namespace PICA::InternalRegs;
+
+		switch (index) {
+			case SignalDrawArrays:
+			case SignalDrawElements:
+			case AttribFormatHigh:
+			case ColourBufferLoc:
+			case ColourBufferFormat:
+			case DepthBufferLoc:
+			case DepthBufferFormat:
+			case FramebufferSize:
+			case VertexFloatUniformIndex:
+			case FixedAttribIndex:
+			case PrimitiveRestart:
+			case VertexShaderOpDescriptorIndex:
+			case VertexBoolUniform:
+			case VertexShaderEntrypoint:
+			case VertexShaderTransferIndex:
+			case CmdBufTrigger0:
+			case CmdBufTrigger1: return true;
+
+			default:
+				return (index >= FogLUTData0 && index <= FogLUTData7) || (index >= LightingLUTData0 && index <= LightingLUTData7) ||
+					   (index >= VertexFloatUniformData0 && index <= VertexFloatUniformData7) ||
+					   (index >= FixedAttribData0 && index <= FixedAttribData2) ||
+					   (index >= VertexShaderOpDescriptorData0 && index <= VertexShaderOpDescriptorData7) ||
+					   (index >= VertexIntUniform0 && index <= VertexIntUniform3) ||
+					   (index >= VertexShaderData0 && index <= VertexShaderData7) || (index >= AttribInfoStart && index <= AttribInfoEnd);
+		}
+	}
+
+	struct RegisterTables {
+		static constexpr u32 regNum = 0x300;
+
+		std::array<u16, regNum> dirtyGroup;
+		// sideEffectCount[i] = Number of registers with side effects in the range [0, i). Used for checking whole ranges in O(1)
+		std::array<u16, regNum + 1> sideEffectCount;
+
+		constexpr RegisterTables() : dirtyGroup(), sideEffectCount() {
+			for (u32 i = 0; i < regNum; i++) {
+				dirtyGroup[i] = u16(PICA::DirtyRegs::groupOf(i));
+				sideEffectCount[i + 1] = sideEffectCount[i] + (hasWriteSideEffects(i) ? 1 : 0);
+			}
+		}
+
+		// Check if none of the registers in [start, start + count) have side effects
+		constexpr bool isPlainRange(u32 start, u32 count) const { return sideEffectCount[start + count] == sideEffectCount[start]; }
+	};
+
+	constexpr RegisterTables registerTables;
+}  // namespace
+
 u32 GPU::readReg(u32 address) {
 	if (address >= 0x1EF01000 && address < 0x1EF01C00) {  // Internal registers
 		const u32 index = (address - 0x1EF01000) / sizeof(u32);
@@ -52,7 +108,7 @@ void GPU::writeExternalReg(u32 index, u32 value) {
 u32 GPU::readInternalReg(u32 index) {
 	using namespace PICA::InternalRegs;
 
-	if (index > regNum) [[unlikely]] {
+	if (index >= regNum) [[unlikely]] {
 		Helpers::panic("Tried to read invalid GPU register. Index: %X\n", index);
 		return 0;
 	}
@@ -79,14 +135,21 @@ u32 GPU::readInternalReg(u32 index) {
 void GPU::writeInternalReg(u32 index, u32 value, u32 mask) {
 	using namespace PICA::InternalRegs;
 
-	if (index > regNum) [[unlikely]] {
+	if (index >= regNum) [[unlikely]] {
 		Helpers::panic("Tried to write to invalid GPU register. Index: %X, value: %08X\n", index, value);
 		return;
 	}
 
+	// Registers that affect rendering must not change under the batched draws that are still waiting to be submitted
+	if (hasPendingDraws() && (registerTables.dirtyGroup[index] & ~batchSafeRegGroups) != 0) [[unlikely]] {
+		flushDrawBatch();
+	}
+
 	u32 currentValue = regs[index];
 	u32 newValue = (currentValue & ~mask) | (value & mask);  // Only overwrite the bits specified by "mask"
 	regs[index] = newValue;
+	// Registers with side effects are mostly data ports (eg LUT or shader uploads), whose register value doesn't change when the data does
+	dirtyRegGroups |= registerTables.dirtyGroup[index];
 
 	// TODO: Figure out if things like the shader index use the unmasked value or the masked one
 	// We currently use the unmasked value like Citra does
@@ -249,8 +312,10 @@ void GPU::writeInternalReg(u32 index, u32 value, u32 mask) {
 						// If we've reached 3 verts, issue a draw call
 						// Handle rendering depending on the primitive type
 						if (immediateModeVertIndex == 3) {
+							flushDrawBatch();
 							renderer->prepareForDraw(shaderUnit, nullptr);
 							renderer->drawVertices(PICA::PrimType::TriangleList, immediateModeVertices);
+							dirtyRegGroups = 0;
 
 							switch (primType) {
 								// Triangle or geometry primitive. Draw a triangle and discard all vertices
@@ -379,10 +444,16 @@ void GPU::writeInternalReg(u32 index, u32 value, u32 mask) {
 }
 
 void GPU::startCommandList(u32 addr, u32 size) {
-	cmdBuffStart = static_cast<u32*>(mem.getReadPointer(addr));
-	if (!cmdBuffStart) Helpers::panic("Couldn't get buffer for command list");
-	// TODO: This is very memory unsafe. We get a pointer to FCRAM and just keep writing without checking if we're gonna go OoB
+	PROFILE_SCOPE("GPU::startCommandList", GPU);
+	u32* start = static_cast<u32*>(mem.getReadPointer(addr));
+	if (!start) Helpers::panic("Couldn't get buffer for command list");
+
+	runCommandList(start, size);
+}
 
+void GPU::runCommandList(u32* start, u32 size) {
+	// TODO: This is very memory unsafe. We get a pointer to FCRAM and just keep writing without checking if we're gonna go OoB
+	cmdBuffStart = start;
 	cmdBuffCurr = cmdBuffStart;
 	cmdBuffEnd = cmdBuffStart + (size / sizeof(u32));
 
@@ -395,6 +466,19 @@ void GPU::startCommandList(u32 addr, u32 size) {
 		0xff000000, 0xff0000ff, 0xff00ff00, 0xff00ffff, 0xffff0000, 0xffff00ff, 0xffffff00, 0xffffffff,
 	};
 
+	// Write to a register with no side effects. These don't need to go through writeInternalReg, we just need to store them and track changes
+	const auto writePlainReg = [this](u32 index, u32 value, u32 mask) {
+		const u32 newValue = (regs[index] & ~mask) | (value & mask);
+		if (newValue != regs[index]) {
+			if (hasPendingDraws() && (registerTables.dirtyGroup[index] & ~batchSafeRegGroups) != 0) [[unlikely]] {
+				flushDrawBatch();
+			}
+
+			regs[index] = newValue;
+			dirtyRegGroups |= registerTables.dirtyGroup[index];
+		}
+	};
+
 	while (cmdBuffCurr < cmdBuffEnd) {
 		// If the buffer is not aligned to an 8 byte boundary, force align it by moving the pointer up a word
 		// The curr pointer starts out doubleword-aligned and is increased by 4 bytes each time
@@ -419,6 +503,36 @@ void GPU::startCommandList(u32 addr, u32 size) {
 		u32 mask = maskLUT[paramMaskIndex];  // Actual parameter mask
 		// Increment the ID by 1 after each write if we're in consecutive mode, or 0 otherwise
 		u32 idIncrement = (consecutiveWritingMode) ? 1 : 0;
+		// Number of registers this command touches
+		const u32 regCount = consecutiveWritingMode ? paramCount + 1 : 1;
+
+		// Fast path: Every register we're writing to is a plain register, so we can apply all the writes in bulk without decoding them one by one
+		if (id + regCount <= regNum && registerTables.isPlainRange(id, regCount)) [[likely]] {
+			if (consecutiveWritingMode && mask == 0xffffffff) {
+				// Full writes to a range of registers. The first value comes before the header, the rest are contiguous in the command list
+				const u32 oldDirty = dirtyRegGroups;
+				const bool changed = regs[id] != param1 || std::memcmp(&regs[id + 1], cmdBuffCurr, paramCount * sizeof(u32)) != 0;
+
+				if (changed) {
+					if (hasPendingDraws() && (PICA::DirtyRegs::groupsInRange(id, id + regCount - 1) & ~batchSafeRegGroups) != 0) [[unlikely]] {
+						flushDrawBatch();
+					}
+
+					regs[id] = param1;
+					std::memcpy(&regs[id + 1], cmdBuffCurr, paramCount * sizeof(u32));
+					dirtyRegGroups = oldDirty | PICA::DirtyRegs::groupsInRange(id, id + regCount - 1);
+				}
+			} else {
+				writePlainReg(id, param1, mask);
+				for (u32 i = 0; i < paramCount; i++) {
+					id += idIncrement;
+					writePlainReg(id, cmdBuffCurr[i], mask);
+				}
+			}
+
+			cmdBuffCurr += paramCount;
+			continue;
+		}
 
 		writeInternalReg(id, param1, mask);
 		for (u32 i = 0; i < paramCount; i++) {
@@ -427,4 +541,7 @@ void GPU::startCommandList(u32 addr, u32 size) {
 			writeInternalReg(id, param, mask);
 		}
 	}
+
+	// The CPU is free to modify textures and buffers once the command list is done, so submit any batched draws now
+	flushDrawBatch();
 }
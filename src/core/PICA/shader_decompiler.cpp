@@ -5,7 +5,6 @@
 #include <array>
 #include <cassert>
 
-#include "config.hpp"
 
 using namespace PICA;
 using namespace PICA::ShaderGen;
@@ -69,6 +68,7 @@ ExitMode ControlFlow::analyzeFunction(const PICAShader& shader, u32 start, u32 e
 	for (u32 pc = start; pc < PICAShader::maxInstructionCount && pc != end; pc++) {
 		const u32 instruction = shader.loadedShader[pc];
 		const u32 opcode = instruction >> 26;
+		reachable.set(pc);
 
 		switch (opcode) {
 			case ShaderOpcodes::JMPC:
@@ -794,7 +794,7 @@ void ShaderDecompiler::callFunction(const Function& function) {
 	}
 }
 
-std::string ShaderGen::decompileShader(PICAShader& shader, EmulatorConfig& config, u32 entrypoint, API api, Language language) {
+std::string ShaderGen::decompileShader(PICAShader& shader, const DecompilerConfig& config, u32 entrypoint, API api, Language language) {
 	ShaderDecompiler decompiler(shader, config, entrypoint, api, language);
 
 	return decompiler.decompile();
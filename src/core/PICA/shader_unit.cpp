@@ -32,6 +32,11 @@ void PICAShader::reset() {
 	addrRegister[1] = 0;
 	loopCounter = 0;
 
+	codeSize = 0;
+	dirtyCodeStart = 0;
+	dirtyCodeEnd = maxInstructionCount;
+	invalidateCodeHashes();
+
 	codeHashDirty = true;
 	opdescHashDirty = true;
 	uniformsDirty = true;
@@ -3,7 +3,6 @@
 #include <algorithm>
 #include <cassert>
 #include <iterator>
-#include <thread>
 #include <utility>
 
 #include "audio/aac_decoder.hpp"
@@ -243,12 +242,9 @@ namespace Audio {
 		StereoFrame<s16> frame;
 		generateFrame(frame);
 
-		if (audioEnabled) {
-			// Wait until we've actually got room to push our frame
-			while (sampleBuffer.size() + frame.size() * 2 > sampleBuffer.Capacity()) {
-				std::this_thread::sleep_for(std::chrono::milliseconds{1});
-			}
-
+		// Never wait for the audio device to make room, as that would stall emulation. The audio device time-stretches the audio to keep
+		// the buffer from filling up, and if it still does, eg when fast-forwarding way faster than it can compress the audio, drop the frame
+		if (audioEnabled && sampleBuffer.size() + frame.size() * 2 <= sampleBuffer.Capacity()) {
 			sampleBuffer.push(frame.data(), frame.size() * 2);
 		}
 	}
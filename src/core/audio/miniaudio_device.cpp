@@ -103,12 +103,17 @@ void MiniAudioDevice::init(Samples& samples, bool safe) {
 		}
 
 		s16* output = reinterpret_cast<ma_int16*>(out);
-		usize samplesWritten = 0;
-		samplesWritten += self->samples->pop(output, frameCount * channelCount);
+		usize framesWritten = 0;
+
+		if (self->audioSettings.timeStretching) {
+			framesWritten = self->timeStretcher.process(*self->samples, output, frameCount);
+		} else {
+			framesWritten = self->samples->pop(output, frameCount * channelCount) / channelCount;
+		}
 
 		// Get the last sample for underrun handling
-		if (samplesWritten != 0) {
-			std::memcpy(&self->lastStereoSample[0], &output[(samplesWritten - 1) * 2], sizeof(lastStereoSample));
+		if (framesWritten != 0) {
+			std::memcpy(&self->lastStereoSample[0], &output[(framesWritten - 1) * 2], sizeof(lastStereoSample));
 		}
 
 		// Adjust the volume of our samples based on the emulator's volume slider
@@ -125,7 +130,7 @@ void MiniAudioDevice::init(Samples& samples, bool safe) {
 				constexpr s32 min = s32(std::numeric_limits<s16>::min());
 				constexpr s32 max = s32(std::numeric_limits<s16>::max());
 
-				for (usize i = 0; i < samplesWritten; i += 2) {
+				for (usize i = 0; i < framesWritten; i++) {
 					s16 l = s16(std::clamp<s32>(s32(float(sample[0]) * audioVolume), min, max));
 					s16 r = s16(std::clamp<s32>(s32(float(sample[1]) * audioVolume), min, max));
 
@@ -141,7 +146,7 @@ void MiniAudioDevice::init(Samples& samples, bool safe) {
 					audioVolume = audioVolume * audioVolume * audioVolume;
 				}
 
-				for (usize i = 0; i < samplesWritten; i += 2) {
+				for (usize i = 0; i < framesWritten; i++) {
 					s16 l = s16(float(sample[0]) * audioVolume);
 					s16 r = s16(float(sample[1]) * audioVolume);
 
@@ -153,11 +158,11 @@ void MiniAudioDevice::init(Samples& samples, bool safe) {
 
 		// If underruning, copy the last output sample
 		{
-			s16* pointer = &output[samplesWritten * 2];
+			s16* pointer = &output[framesWritten * 2];
 			s16 l = self->lastStereoSample[0];
 			s16 r = self->lastStereoSample[1];
 
-			for (usize i = samplesWritten; i < frameCount; i++) {
+			for (usize i = framesWritten; i < frameCount; i++) {
 				*pointer++ = l;
 				*pointer++ = r;
 			}
@@ -181,6 +186,9 @@ void MiniAudioDevice::start() {
 
 	// Ignore the call to start if the device is already running
 	if (!running) {
+		// The audio thread isn't running, so it's safe to reset the stretcher. Start over instead of stitching onto audio from before we stopped
+		timeStretcher.reset();
+
 		if (ma_device_start(&device) == MA_SUCCESS) {
 			running = true;
 		} else {
@@ -1,9 +1,7 @@
 #include "audio/teakra_core.hpp"
 
 #include <algorithm>
-#include <chrono>
 #include <cstring>
-#include <thread>
 
 #include "audio/dsp_binary.hpp"
 #include "services/dsp.hpp"
@@ -112,12 +110,10 @@ void TeakraDSP::setAudioEnabled(bool enable) {
 				if (audioFrameIndex >= audioFrame.size()) {
 					audioFrameIndex -= audioFrame.size();
 
-					// Wait until we've actually got room to do so
-					while (sampleBuffer.size() + 2 > sampleBuffer.Capacity()) {
-						std::this_thread::sleep_for(std::chrono::milliseconds{1});
+					// Drop the frame if there's no room instead of stalling emulation, same as the HLE DSP
+					if (sampleBuffer.size() + audioFrame.size() <= sampleBuffer.Capacity()) {
+						sampleBuffer.push(audioFrame.data(), audioFrame.size());
 					}
-
-					sampleBuffer.push(audioFrame.data(), audioFrame.size());
 				}
 			});
 		} else {
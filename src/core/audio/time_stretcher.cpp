@@ -0,0 +1,196 @@
+#include "audio/time_stretcher.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+namespace Audio {
+	TimeStretcher::TimeStretcher() {
+		// Periodic Hann window. Two windows overlapped by half add up to exactly 1, so overlap-adding the input with no stretching gives back the
+		// input as-is
+		for (usize i = 0; i < segmentLength; i++) {
+			window[i] = float(0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * double(i) / double(segmentLength)));
+		}
+
+		reset();
+	}
+
+	void TimeStretcher::reset() {
+		inputFrames = 0;
+		analysisPosition = 0.0;
+		hasPreviousSegment = false;
+		naturalPosition = 0;
+		ratio = 1.0;
+		overlap.fill(0.0f);
+		pendingPosition = hopLength;
+		droppedFrames = 0;
+	}
+
+	void TimeStretcher::updateRatio(Samples& samples) {
+		usize bufferedFrames = samples.size() / channelCount;
+
+		// If we're too far behind, drop the oldest audio in the sample buffer, as even the max ratio isn't enough to keep up
+		if (bufferedFrames > maxLatency) {
+			std::array<s16, 512 * channelCount> discarded;
+			usize toDrop = bufferedFrames - maxLatency;
+			droppedFrames += toDrop;
+
+			while (toDrop > 0) {
+				const usize count = std::min<usize>(toDrop, discarded.size() / channelCount);
+				samples.pop(discarded.data(), count * channelCount);
+				toDrop -= count;
+			}
+
+			bufferedFrames = samples.size() / channelCount;
+		}
+
+		// Audio we pulled out of the sample buffer but haven't reached yet counts as buffered too
+		if (double(inputFrames) > analysisPosition) {
+			bufferedFrames += usize(double(inputFrames) - analysisPosition);
+		}
+
+		// The wanted ratio grows with the square of how full the buffer is compared to the target. This gives a steady state for any production
+		// rate between the min and max ratio, eg if the emulator runs at 300% speed the buffer settles at ~1.7x the target latency
+		const double fill = double(bufferedFrames) / double(targetLatency);
+		const double wantedRatio = std::clamp(fill * fill, minRatio, maxRatio);
+		ratio += (wantedRatio - ratio) * ratioSmoothing;
+	}
+
+	bool TimeStretcher::fillInput(Samples& samples, usize frames) {
+		if (inputFrames >= frames) {
+			return true;
+		}
+
+		const usize missing = frames - inputFrames;
+		if (samples.size() / channelCount < missing) {
+			return false;
+		}
+
+		std::array<s16, 512 * channelCount> buffer;
+		usize remaining = missing;
+		while (remaining > 0) {
+			const usize count = std::min<usize>(remaining, buffer.size() / channelCount);
+			samples.pop(buffer.data(), count * channelCount);
+
+			float* out = &input[inputFrames * channelCount];
+			for (usize i = 0; i < count * channelCount; i++) {
+				out[i] = float(buffer[i]);
+			}
+
+			inputFrames += count;
+			remaining -= count;
+		}
+
+		return true;
+	}
+
+	usize TimeStretcher::findBestPosition(usize nominal, usize natural) const {
+		// The first half of the new segment gets overlap-added with the second half of the previous one. The ideal candidate is the one that
+		// looks the most like the input that naturally followed the previous segment, so compare candidates against that. We compare the mono
+		// mix at every other frame, which is plenty for finding where the waveforms line up
+		const auto score = [&](usize position) {
+			double correlation = 0.0;
+			double energy = 0.0;
+
+			for (usize i = 0; i < hopLength; i += 2) {
+				const double sample = mono(position + i);
+				correlation += sample * mono(natural + i);
+				energy += sample * sample;
+			}
+
+			// Normalize by the candidate's energy, so that louder candidates aren't preferred. Keep the sign so that inverted waveforms lose
+			return correlation * std::abs(correlation) / std::max(energy, 1.0);
+		};
+
+		const usize first = nominal >= searchRadius ? nominal - searchRadius : 0;
+		const usize last = nominal + searchRadius;
+
+		// Start with the nominal position so that it wins ties, eg when the input is silent
+		usize bestPosition = nominal;
+		double bestScore = score(nominal);
+
+		for (usize position = first; position <= last; position++) {
+			const double candidateScore = score(position);
+			if (candidateScore > bestScore) {
+				bestScore = candidateScore;
+				bestPosition = position;
+			}
+		}
+
+		return bestPosition;
+	}
+
+	void TimeStretcher::processSegment() {
+		const usize nominal = usize(std::lround(analysisPosition));
+		usize position = nominal;
+
+		if (hasPreviousSegment) {
+			position = findBestPosition(nominal, naturalPosition);
+		}
+
+		const float* segment = &input[position * channelCount];
+		for (usize i = 0; i < hopLength; i++) {
+			for (usize channel = 0; channel < channelCount; channel++) {
+				const float sample = overlap[i * channelCount + channel] + segment[i * channelCount + channel] * window[i];
+				pending[i * channelCount + channel] = s16(std::clamp<long>(std::lrint(sample), -32768, 32767));
+			}
+		}
+
+		for (usize i = hopLength; i < segmentLength; i++) {
+			for (usize channel = 0; channel < channelCount; channel++) {
+				overlap[(i - hopLength) * channelCount + channel] = segment[i * channelCount + channel] * window[i];
+			}
+		}
+
+		pendingPosition = 0;
+		hasPreviousSegment = true;
+		naturalPosition = position + hopLength;
+		analysisPosition += double(hopLength) * ratio;
+
+		// Throw away the input that neither the natural continuation of this segment nor the search range of the next one can reach
+		const s64 searchStart = s64(std::floor(analysisPosition)) - s64(searchRadius);
+		const usize discarded = usize(std::clamp<s64>(searchStart, 0, s64(naturalPosition)));
+
+		if (discarded != 0) {
+			std::memmove(input.data(), &input[discarded * channelCount], (inputFrames - discarded) * channelCount * sizeof(float));
+			inputFrames -= discarded;
+			naturalPosition -= discarded;
+			analysisPosition -= double(discarded);
+		}
+	}
+
+	usize TimeStretcher::process(Samples& samples, s16* output, usize frameCount) {
+		usize written = 0;
+
+		while (written < frameCount) {
+			// Play whatever is left of the last segment first
+			if (pendingPosition < hopLength) {
+				const usize count = std::min(hopLength - pendingPosition, frameCount - written);
+				std::memcpy(&output[written * channelCount], &pending[pendingPosition * channelCount], count * channelCount * sizeof(s16));
+
+				pendingPosition += count;
+				written += count;
+				continue;
+			}
+
+			updateRatio(samples);
+
+			// We need the whole search range plus a segment's worth of input after it, as well as the input that naturally follows the
+			// previous segment, to compare candidates against
+			const usize nominal = usize(std::lround(analysisPosition));
+			usize requiredFrames = nominal + segmentLength;
+			if (hasPreviousSegment) {
+				requiredFrames = std::max(nominal + searchRadius, naturalPosition) + segmentLength;
+			}
+
+			if (!fillInput(samples, requiredFrames)) {
+				break;
+			}
+
+			processSegment();
+		}
+
+		return written;
+	}
+}  // namespace Audio
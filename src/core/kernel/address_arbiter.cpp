@@ -19,7 +19,7 @@ HorizonHandle Kernel::makeArbiter() {
 	arbiterCount++;
 
 	Handle ret = makeObject(KernelObjectType::AddressArbiter);
-	objects[ret].data = new AddressArbiter();
+	makeObjectData<AddressArbiter>(ret);
 	return ret;
 }
 
@@ -28,6 +28,7 @@ void Kernel::createAddressArbiter() {
 	logSVC("CreateAddressArbiter\n");
 	regs[0] = Result::Success;
 	regs[1] = makeArbiter();
+	objects[regs[1]].closable = true;
 }
 
 // Result ArbitrateAddress(Handle arbiter, u32 addr, ArbitrationType type, s32 value, s64 nanoseconds)
@@ -97,20 +98,13 @@ void Kernel::arbitrateAddress() {
 
 // Signal up to "threadCount" threads waiting on the arbiter indicated by "waitingAddress"
 void Kernel::signalArbiter(u32 waitingAddress, s32 threadCount) {
-	if (threadCount == 0) [[unlikely]]
-		return;
-	s32 count = 0;  // Number of threads we've woken up
-
-	// Wake threads with the highest priority threads being woken up first
-	for (auto index : threadIndices) {
-		Thread& t = threads[index];
-		if ((t.status == ThreadStatus::WaitArbiter || t.status == ThreadStatus::WaitArbiterTimeout) && t.waitingAddress == waitingAddress) {
+	// Wake threads with the highest priority threads being woken up first. If threadCount < 0 then all threads are released
+	arbiterWaitQueues.signal(
+		waitingAddress, threadCount, [&](int index) { return threads[index].priority; },
+		[&](int index) {
+			Thread& t = threads[index];
 			t.status = ThreadStatus::Ready;
 			t.gprs[0] = Result::Success;  // Return that the arbiter was actually signalled and that we didn't timeout
-			count += 1;
-
-			// Check if we've reached the max number of. If count < 0 then all threads are released.
-			if (count == threadCount && threadCount > 0) break;
 		}
-	}
+	);
 }
\ No newline at end of file
@@ -15,13 +15,19 @@ const char* Kernel::resetTypeToString(u32 type) {
 
 HorizonHandle Kernel::makeEvent(ResetType resetType, Event::CallbackType callback) {
 	Handle ret = makeObject(KernelObjectType::Event);
-	objects[ret].data = new Event(resetType, callback);
+	makeObjectData<Event>(ret, resetType, callback);
 	return ret;
 }
 
 bool Kernel::signalEvent(Handle handle) {
 	KernelObject* object = getObject(handle, KernelObjectType::Event);
 	if (object == nullptr) [[unlikely]] {
+		// Services may hold on to events the game has already closed, eg if it exits without unregistering them first
+		if (objects.isStale(handle)) {
+			Helpers::warn("Tried to signal closed event %X", handle);
+			return false;
+		}
+
 		Helpers::panic("Tried to signal non-existent event");
 		return false;
 	}
@@ -65,6 +71,7 @@ void Kernel::svcCreateEvent() {
 	logSVC("CreateEvent(handle pointer = %08X, resetType = %s)\n", outPointer, resetTypeToString(resetType));
 	regs[0] = Result::Success;
 	regs[1] = makeEvent(static_cast<ResetType>(resetType));
+	objects[regs[1]].closable = true;
 }
 
 // Result ClearEvent(Handle event)
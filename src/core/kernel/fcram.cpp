@@ -7,41 +7,71 @@ void KFcram::Region::reset(u32 start, size_t size) {
 	pages = size >> 12;
 	freePages = pages;
 
-	Block initialBlock(pages, 0);
-	blocks.clear();
-	blocks.push_back(initialBlock);
+	freeBlocks.clear();
+	freeBlocks.emplace(0, pages);
 }
 
-void KFcram::Region::alloc(std::list<FcramBlock>& out, s32 allocPages, bool linear) {
-	for (auto it = blocks.begin(); it != blocks.end(); it++) {
-		if (it->used) continue;
+void KFcram::Region::takePages(std::map<s32, s32>::iterator it, s32 count, std::list<FcramBlock>& out) {
+	const s32 pageOffset = it->first;
+	const s32 remainingPages = it->second - count;
 
-		// On linear allocations, only a single contiguous block may be used
-		if (it->pages < allocPages && linear) continue;
+	// If the block is bigger than the allocation, keep the rest of it free
+	it = freeBlocks.erase(it);
+	if (remainingPages > 0) {
+		freeBlocks.emplace_hint(it, pageOffset + count, remainingPages);
+	}
 
-		// If the current block is bigger than the allocation, split it
-		if (it->pages > allocPages) {
-			Block newBlock(it->pages - allocPages, it->pageOffset + allocPages);
-			it->pages = allocPages;
-			blocks.insert(it, newBlock);
+	freePages -= count;
+	out.push_back(FcramBlock(start + (pageOffset << 12), count));
+}
+
+void KFcram::Region::alloc(std::list<FcramBlock>& out, s32 allocPages, bool linear) {
+	if (linear) {
+		// On linear allocations, only a single contiguous block may be used
+		for (auto it = freeBlocks.begin(); it != freeBlocks.end(); it++) {
+			if (it->second >= allocPages) {
+				takePages(it, allocPages, out);
+				return;
+			}
 		}
+	} else if (allocPages <= freePages && !freeBlocks.empty()) {
+		// Otherwise, use free blocks in address order until we have enough pages
+		do {
+			auto it = freeBlocks.begin();
+			const s32 count = std::min(it->second, allocPages);
+
+			takePages(it, count, out);
+			allocPages -= count;
+		} while (allocPages > 0);
+
+		return;
+	}
 
-		// Mark the block as allocated and add it to the output list
-		it->used = true;
-		allocPages -= it->pages;
-		freePages -= it->pages;
+	// Official kernel panics here
+	Helpers::panic("Failed to allocate FCRAM, not enough guest memory");
+}
 
-		u32 paddr = start + (it->pageOffset << 12);
-		FcramBlock outBlock(paddr, it->pages);
-		out.push_back(outBlock);
+void KFcram::Region::free(u32 paddr, s32 freedPages) {
+	s32 pageOffset = s32((paddr - start) >> 12);
+	s32 count = freedPages;
+	freePages += freedPages;
 
-		if (allocPages < 1) {
+	// Merge the freed pages with the free blocks right before and after them, if any
+	auto next = freeBlocks.lower_bound(pageOffset);
+	if (next != freeBlocks.end() && next->first == pageOffset + count) {
+		count += next->second;
+		next = freeBlocks.erase(next);
+	}
+
+	if (next != freeBlocks.begin()) {
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == pageOffset) {
+			prev->second += count;
 			return;
 		}
 	}
 
-	// Official kernel panics here
-	Helpers::panic("Failed to allocate FCRAM, not enough guest memory");
+	freeBlocks.emplace_hint(next, pageOffset, count);
 }
 
 u32 KFcram::Region::getUsedCount() { return pages - freePages; }
@@ -79,19 +109,6 @@ void KFcram::incRef(FcramBlockList& list) {
 	}
 }
 
-void KFcram::decRef(FcramBlockList& list) {
-	for (auto it = list.begin(); it != list.end(); it++) {
-		for (int i = 0; i < it->pages; i++) {
-			u32 index = (it->paddr >> 12) + i;
-			refs.get()[index]--;
-
-			if (!refs.get()[index]) {
-				Helpers::panic("TODO: Freeing FCRAM");
-			}
-		}
-	}
-}
-
 u32 KFcram::getUsedCount(FcramRegion region) {
 	switch (region) {
 		case FcramRegion::App: return appRegion.getUsedCount();
@@ -234,13 +234,12 @@ void Kernel::openLinkFile(u32 messagePointer, Handle fileHandle) {
 	}
 
 	// Make clone object
-	auto handle = makeObject(KernelObjectType::File);
-	auto& cloneFile = getObjects()[handle];
+	auto handle = makeObject(KernelObjectType::File, true);
 
 	// Make a clone of the file by copying the archive/archive path/file path/file descriptor/etc of the original file
 	// TODO: Maybe we should duplicate the file handle instead of copying. This way their offsets will be separate
 	// However we do seek properly on every file access so this shouldn't matter
-	cloneFile.data = new FileSession(*file);
+	makeObjectData<FileSession>(handle, *file);
 
 	mem.write32(messagePointer, IPC::responseHeader(0x080C, 1, 2));
 	mem.write32(messagePointer + 4, Result::Success);
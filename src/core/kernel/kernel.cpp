@@ -5,10 +5,12 @@
 
 #include "cpu.hpp"
 #include "kernel_types.hpp"
+#include "profiler.hpp"
 
 Kernel::Kernel(CPU& cpu, Memory& mem, GPU& gpu, const EmulatorConfig& config, LuaManager& lua)
-	: cpu(cpu), regs(cpu.regs()), mem(mem), handleCounter(0), serviceManager(regs, mem, gpu, currentProcess, *this, config, lua), fcramManager(mem) {
+	: cpu(cpu), regs(cpu.regs()), mem(mem), serviceManager(regs, mem, gpu, currentProcess, *this, config, lua), fcramManager(mem) {
 	objects.reserve(512);  // Make room for a few objects to avoid further memory allocs later
+	secondCoreEnabled = config.secondCoreEnabled;
 	mutexHandles.reserve(8);
 	portHandles.reserve(32);
 	threadIndices.reserve(appResourceLimits.maxThreads);
@@ -30,6 +32,8 @@ Kernel::Kernel(CPU& cpu, Memory& mem, GPU& gpu, const EmulatorConfig& config, Lu
 }
 
 void Kernel::serviceSVC(u32 svc) {
+	PROFILE_SCOPE("Kernel::serviceSVC", Kernel);
+
 	switch (svc) {
 		case 0x01: controlMemory(); break;
 		case 0x02: queryMemory(); break;
@@ -82,6 +86,40 @@ void Kernel::serviceSVC(u32 svc) {
 	evalReschedule();
 }
 
+bool Kernel::serviceSVCOnCore(u32 svc, int core) {
+	switchToCore(core);
+	serviceSVC(svc);
+
+	const bool hasThread = currentThreadIndex != noThreadIndex;
+	switchToCore(0);
+	return hasThread;
+}
+
+bool Kernel::rescheduleCores() {
+	// Threads may have been woken up by the other core or by scheduler events during the last slice, so both cores always reschedule
+	rescheduleThreads();
+
+	switchToCore(1);
+	rescheduleThreads();
+	const bool hasThread = currentThreadIndex != noThreadIndex;
+	switchToCore(0);
+
+	return hasThread;
+}
+
+void Kernel::switchToCore(int core) {
+	if (core == activeCore) {
+		return;
+	}
+
+	coreThreadIndices[activeCore] = currentThreadIndex;
+	currentThreadIndex = coreThreadIndices[core];
+	activeCore = core;
+
+	cpu.setActiveCore(core);
+	regs = cpu.regs();
+}
+
 void Kernel::setVersion(u8 major, u8 minor) {
 	u16 descriptor = (u16(major) << 8) | u16(minor);
 
@@ -94,8 +132,7 @@ HorizonHandle Kernel::makeProcess(u32 id) {
 	const Handle resourceLimitHandle = makeObject(KernelObjectType::ResourceLimit);
 
 	// Allocate data
-	objects[processHandle].data = new Process(id);
-	const auto processData = objects[processHandle].getData<Process>();
+	const auto processData = makeObjectData<Process>(processHandle, id);
 
 	// Link resource limit object with its parent process
 	objects[resourceLimitHandle].data = &processData->limits;
@@ -118,33 +155,38 @@ void Kernel::deleteObjectData(KernelObject& object) {
 		return;
 	}
 
-	// Resource limit and thread objects do not allocate heap data, so we don't delete anything
+	// Resource limit and thread objects do not allocate any data, so we don't free anything
+	// Everything else goes back to the pool it was allocated from
 
 	switch (object.type) {
-		case KernelObjectType::AddressArbiter: delete object.getData<AddressArbiter>(); return;
-		case KernelObjectType::Archive: delete object.getData<ArchiveSession>(); return;
-		case KernelObjectType::Directory: delete object.getData<DirectorySession>(); return;
-		case KernelObjectType::Event: delete object.getData<Event>(); return;
-		case KernelObjectType::File: delete object.getData<FileSession>(); return;
-		case KernelObjectType::MemoryBlock: delete object.getData<MemoryBlock>(); return;
-		case KernelObjectType::Port: delete object.getData<Port>(); return;
-		case KernelObjectType::Process: delete object.getData<Process>(); return;
+		case KernelObjectType::AddressArbiter: getObjectPool<AddressArbiter>().free(object.getData<AddressArbiter>()); break;
+		case KernelObjectType::Archive: getObjectPool<ArchiveSession>().free(object.getData<ArchiveSession>()); break;
+		case KernelObjectType::Directory: getObjectPool<DirectorySession>().free(object.getData<DirectorySession>()); break;
+		case KernelObjectType::Event: getObjectPool<Event>().free(object.getData<Event>()); break;
+		case KernelObjectType::File: getObjectPool<FileSession>().free(object.getData<FileSession>()); break;
+		case KernelObjectType::MemoryBlock: getObjectPool<MemoryBlock>().free(object.getData<MemoryBlock>()); break;
+		case KernelObjectType::Port: getObjectPool<Port>().free(object.getData<Port>()); break;
+		case KernelObjectType::Process: getObjectPool<Process>().free(object.getData<Process>()); break;
 		case KernelObjectType::ResourceLimit: return;
-		case KernelObjectType::Session: delete object.getData<Session>(); return;
-		case KernelObjectType::Mutex: delete object.getData<Mutex>(); return;
-		case KernelObjectType::Semaphore: delete object.getData<Semaphore>(); return;
-		case KernelObjectType::Timer: delete object.getData<Timer>(); return;
+		case KernelObjectType::Session: getObjectPool<Session>().free(object.getData<Session>()); break;
+		case KernelObjectType::Mutex: getObjectPool<Mutex>().free(object.getData<Mutex>()); break;
+		case KernelObjectType::Semaphore: getObjectPool<Semaphore>().free(object.getData<Semaphore>()); break;
+		case KernelObjectType::Timer: getObjectPool<Timer>().free(object.getData<Timer>()); break;
 		case KernelObjectType::Thread: return;
 		case KernelObjectType::Dummy: return;
 		default: [[unlikely]] Helpers::warn("unknown object type"); return;
 	}
+
+	object.data = nullptr;
 }
 
 void Kernel::reset() {
-	handleCounter = 0;
+	activeCore = 0;
+	coreThreadIndices = {0, noThreadIndex};
 	arbiterCount = 0;
 	threadCount = 0;
 	aliveThreadCount = 0;
+	arbiterWaitQueues.clear();
 
 	for (auto& t : threads) {
 		t.status = ThreadStatus::Dead;
@@ -186,7 +228,7 @@ u32 Kernel::getTLSPointer() { return VirtualAddrs::TLSBase + currentThreadIndex
 
 // Result CloseHandle(Handle handle)
 void Kernel::svcCloseHandle() {
-	logSVC("CloseHandle(handle = %d) (Unimplemented)\n", regs[0]);
+	logSVC("CloseHandle(handle = %X)\n", regs[0]);
 	const Handle handle = regs[0];
 
 	KernelObject* object = getObject(handle);
@@ -208,12 +250,84 @@ void Kernel::svcCloseHandle() {
 
 			default: break;
 		}
+
+		// Services may still hold a reference to the object, in which case it's destroyed once they drop it
+		if (objects.release(handle) && object->closable) {
+			destroyObject(*object);
+		}
 	}
 
 	// Stub to always succeed for now
 	regs[0] = Result::Success;
 }
 
+void Kernel::retainObject(Handle handle) { objects.retain(handle); }
+
+void Kernel::releaseObject(Handle handle) {
+	KernelObject* object = getObject(handle);
+	if (object != nullptr && objects.release(handle) && object->closable) {
+		destroyObject(*object);
+	}
+}
+
+bool Kernel::destroyObject(KernelObject& object) {
+	// Waiting threads don't hold a reference, so objects that threads are still waiting on are kept alive. Closing a handle that's being
+	// waited on is a guest bug anyways
+	switch (object.type) {
+		case KernelObjectType::Event:
+		case KernelObjectType::Mutex:
+		case KernelObjectType::Semaphore:
+		case KernelObjectType::Timer:
+			if (object.getWaitlist() != 0) {
+				Helpers::warn("Closed %s object %X while threads are waiting on it", object.getTypeName(), object.handle);
+				return false;
+			}
+			break;
+
+		default: break;
+	}
+
+	const Handle handle = object.handle;
+	switch (object.type) {
+		case KernelObjectType::AddressArbiter: arbiterCount--; break;
+		case KernelObjectType::Mutex: std::erase(mutexHandles, handle); break;
+		case KernelObjectType::Timer: std::erase(timerHandles, handle); break;
+		default: break;
+	}
+
+	log("Destroyed %s object with handle %X\n", object.getTypeName(), handle);
+	deleteObjectData(object);
+	objects.free(handle);
+	return true;
+}
+
+std::array<Kernel::ObjectStats, kernelObjectTypeCount> Kernel::getObjectStats() {
+	std::array<ObjectStats, kernelObjectTypeCount> stats;
+	for (usize i = 0; i < kernelObjectTypeCount; i++) {
+		stats[i].counts = objects.getStats(static_cast<KernelObjectType>(i));
+	}
+
+	auto addPoolStats = [&](KernelObjectType type, const auto& pool) {
+		ObjectStats& typeStats = stats[static_cast<usize>(type)];
+		typeStats.poolCapacity = pool.getCapacity();
+		typeStats.poolReservedBytes = pool.getReservedBytes();
+	};
+
+	addPoolStats(KernelObjectType::AddressArbiter, getObjectPool<AddressArbiter>());
+	addPoolStats(KernelObjectType::Archive, getObjectPool<ArchiveSession>());
+	addPoolStats(KernelObjectType::Directory, getObjectPool<DirectorySession>());
+	addPoolStats(KernelObjectType::Event, getObjectPool<Event>());
+	addPoolStats(KernelObjectType::File, getObjectPool<FileSession>());
+	addPoolStats(KernelObjectType::MemoryBlock, getObjectPool<MemoryBlock>());
+	addPoolStats(KernelObjectType::Mutex, getObjectPool<Mutex>());
+	addPoolStats(KernelObjectType::Port, getObjectPool<Port>());
+	addPoolStats(KernelObjectType::Process, getObjectPool<Process>());
+	addPoolStats(KernelObjectType::Semaphore, getObjectPool<Semaphore>());
+	addPoolStats(KernelObjectType::Session, getObjectPool<Session>());
+	addPoolStats(KernelObjectType::Timer, getObjectPool<Timer>());
+	return stats;
+}
+
 // u64 GetSystemTick()
 void Kernel::getSystemTick() {
 	logSVC("GetSystemTick()\n");
@@ -189,7 +189,7 @@ void Kernel::mapMemoryBlock() {
 
 HorizonHandle Kernel::makeMemoryBlock(u32 addr, u32 size, u32 myPermission, u32 otherPermission) {
 	Handle ret = makeObject(KernelObjectType::MemoryBlock);
-	objects[ret].data = new MemoryBlock(addr, size, myPermission, otherPermission);
+	makeObjectData<MemoryBlock>(ret, addr, size, myPermission, otherPermission);
 
 	return ret;
 }
@@ -1,11 +1,12 @@
 #include <cstring>
 
+#include "ipc.hpp"
 #include "kernel.hpp"
 
 HorizonHandle Kernel::makePort(const char* name) {
 	Handle ret = makeObject(KernelObjectType::Port);
 	portHandles.push_back(ret);  // Push the port handle to our cache of port handles
-	objects[ret].data = new Port(name);
+	makeObjectData<Port>(ret, name);
 
 	return ret;
 }
@@ -18,7 +19,7 @@ HorizonHandle Kernel::makeSession(Handle portHandle) {
 
 	// Allocate data for session
 	const Handle ret = makeObject(KernelObjectType::Session);
-	objects[ret].data = new Session(portHandle);
+	makeObjectData<Session>(ret, portHandle);
 	return ret;
 }
 
@@ -129,3 +130,12 @@ void Kernel::sendSyncRequest() {
 		Helpers::panic("SendSyncRequest targetting port %s\n", portData->name);
 	}
 }
+
+IPC::Message::Message(Memory& mem, u32 messagePointer) {
+	words = static_cast<u32*>(mem.getWritePointer(messagePointer));
+
+	// Command buffers live in TLS, which is always mapped as read-write
+	if (words == nullptr) [[unlikely]] {
+		Helpers::panic("IPC message at %08X is not in writeable memory", messagePointer);
+	}
+}
@@ -14,9 +14,15 @@
 // Switch to another thread
 // newThread: Index of the newThread in the thread array (NOT a handle).
 void Kernel::switchThread(int newThreadIndex) {
-	auto& oldThread = threads[currentThreadIndex];
-	auto& newThread = threads[newThreadIndex];
-	newThread.status = ThreadStatus::Running;
+	if (newThreadIndex != noThreadIndex) {
+		auto& newThread = threads[newThreadIndex];
+
+		// A thread that was waiting on an arbiter with a timeout can only be scheduled if it timed out, as signalling makes it Ready
+		if (newThread.status == ThreadStatus::WaitArbiterTimeout) {
+			arbiterWaitQueues.remove(newThread.waitingAddress, newThreadIndex);
+		}
+		newThread.status = ThreadStatus::Running;
+	}
 	logThread("Switching from thread %d to %d\n", currentThreadIndex, newThreadIndex);
 
 	// Bail early if the new thread is actually the old thread
@@ -24,18 +30,24 @@ void Kernel::switchThread(int newThreadIndex) {
 		return;
 	}
 
-	// Backup context
-	std::memcpy(oldThread.gprs.data(), cpu.regs().data(), cpu.regs().size_bytes());  // Backup the 16 GPRs
-	std::memcpy(oldThread.fprs.data(), cpu.fprs().data(), cpu.fprs().size_bytes());  // Backup the 32 FPRs
-	oldThread.cpsr = cpu.getCPSR();                                                  // Backup CPSR
-	oldThread.fpscr = cpu.getFPSCR();                                                // Backup FPSCR
+	// Backup context. The second core might not have been running any thread
+	if (currentThreadIndex != noThreadIndex) {
+		auto& oldThread = threads[currentThreadIndex];
+		std::memcpy(oldThread.gprs.data(), cpu.regs().data(), cpu.regs().size_bytes());  // Backup the 16 GPRs
+		std::memcpy(oldThread.fprs.data(), cpu.fprs().data(), cpu.fprs().size_bytes());  // Backup the 32 FPRs
+		oldThread.cpsr = cpu.getCPSR();                                                  // Backup CPSR
+		oldThread.fpscr = cpu.getFPSCR();                                                // Backup FPSCR
+	}
 
 	// Load new context
-	std::memcpy(cpu.regs().data(), newThread.gprs.data(), cpu.regs().size_bytes());  // Load 16 GPRs
-	std::memcpy(cpu.fprs().data(), newThread.fprs.data(), cpu.fprs().size_bytes());  // Load 32 FPRs
-	cpu.setCPSR(newThread.cpsr);                                                     // Load CPSR
-	cpu.setFPSCR(newThread.fpscr);                                                   // Load FPSCR
-	cpu.setTLSBase(newThread.tlsBase);                                               // Load CP15 thread-local-storage pointer register
+	if (newThreadIndex != noThreadIndex) {
+		auto& newThread = threads[newThreadIndex];
+		std::memcpy(cpu.regs().data(), newThread.gprs.data(), cpu.regs().size_bytes());  // Load 16 GPRs
+		std::memcpy(cpu.fprs().data(), newThread.fprs.data(), cpu.fprs().size_bytes());  // Load 32 FPRs
+		cpu.setCPSR(newThread.cpsr);                                                     // Load CPSR
+		cpu.setFPSCR(newThread.fpscr);                                                   // Load FPSCR
+		cpu.setTLSBase(newThread.tlsBase);  // Load CP15 thread-local-storage pointer register
+	}
 
 	currentThreadIndex = newThreadIndex;
 }
@@ -66,8 +78,8 @@ std::optional<int> Kernel::getNextThread() {
 	for (auto index : threadIndices) {
 		const Thread& t = threads[index];
 
-		// Thread is ready, return it
-		if (canThreadRun(t)) {
+		// Thread is ready and runs on the core we're scheduling, return it
+		if (canThreadRun(t) && getThreadCore(index) == activeCore) {
 			return index;
 		}
 	}
@@ -87,14 +99,14 @@ u64 Kernel::getWakeupTick(s64 ns) {
 
 // See if there is a higher priority, ready thread and switch to that
 void Kernel::rescheduleThreads() {
-	Thread& current = threads[currentThreadIndex];  // Current running thread
-
 	// If the current thread is running and hasn't gone to sleep or whatever, set it to Ready instead of Running
 	// So that getNextThread will evaluate it properly
-	if (current.status == ThreadStatus::Running) {
-		current.status = ThreadStatus::Ready;
+	if (currentThreadIndex != noThreadIndex) {
+		Thread& current = threads[currentThreadIndex];  // Current running thread
+		if (current.status == ThreadStatus::Running) {
+			current.status = ThreadStatus::Ready;
+		}
 	}
-	ThreadStatus currentStatus = current.status;
 	std::optional<int> newThreadIndex = getNextThread();
 
 	// Case 1: A thread can run
@@ -102,9 +114,9 @@ void Kernel::rescheduleThreads() {
 		switchThread(newThreadIndex.value());
 	}
 
-	// Case 2: No other thread can run, straight to the idle thread
+	// Case 2: No other thread can run, straight to the idle thread. The second core doesn't have one, so it just stops running
 	else {
-		switchThread(idleThreadIndex);
+		switchThread(activeCore == 0 ? idleThreadIndex : noThreadIndex);
 	}
 }
 
@@ -163,11 +175,10 @@ HorizonHandle Kernel::makeThread(u32 entrypoint, u32 initialSP, u32 priority, Pr
 
 HorizonHandle Kernel::makeMutex(bool locked) {
 	Handle ret = makeObject(KernelObjectType::Mutex);
-	objects[ret].data = new Mutex(locked, ret);
+	Mutex* moo = makeObjectData<Mutex>(ret, locked, ret);
 
 	// If the mutex is initially locked, store the index of the thread that owns it and set lock count to 1
 	if (locked) {
-		Mutex* moo = objects[ret].getData<Mutex>();
 		moo->ownerThread = currentThreadIndex;
 	}
 
@@ -203,7 +214,7 @@ void Kernel::releaseMutex(Mutex* moo) {
 
 HorizonHandle Kernel::makeSemaphore(u32 initialCount, u32 maximumCount) {
 	Handle ret = makeObject(KernelObjectType::Semaphore);
-	objects[ret].data = new Semaphore(initialCount, maximumCount);
+	makeObjectData<Semaphore>(ret, initialCount, maximumCount);
 
 	return ret;
 }
@@ -212,6 +223,7 @@ void Kernel::sleepThreadOnArbiter(u32 waitingAddress) {
 	Thread& t = threads[currentThreadIndex];
 	t.status = ThreadStatus::WaitArbiter;
 	t.waitingAddress = waitingAddress;
+	arbiterWaitQueues.add(waitingAddress, currentThreadIndex);
 
 	requireReschedule();
 }
@@ -228,6 +240,7 @@ void Kernel::sleepThreadOnArbiterWithTimeout(u32 waitingAddress, s64 timeoutNs)
 	t.status = ThreadStatus::WaitArbiterTimeout;
 	t.waitingAddress = waitingAddress;
 	t.wakeupTick = getWakeupTick(timeoutNs);
+	arbiterWaitQueues.add(waitingAddress, currentThreadIndex);
 
 	addWakeupEvent(t.wakeupTick);
 	requireReschedule();
@@ -530,6 +543,13 @@ void Kernel::setThreadPriority() {
 
 void Kernel::getCurrentProcessorNumber() {
 	logSVC("GetCurrentProcessorNumber()\n");
+
+	// With the second core enabled, threads actually run on the core they asked for
+	if (secondCoreEnabled) {
+		regs[0] = static_cast<u32>(activeCore);
+		return;
+	}
+
 	const ProcessorID id = threads[currentThreadIndex].processorID;
 	s32 ret;
 
@@ -601,6 +621,7 @@ void Kernel::svcCreateMutex() {
 
 	regs[0] = Result::Success;
 	regs[1] = makeMutex(locked);
+	objects[regs[1]].closable = true;
 }
 
 void Kernel::svcReleaseMutex() {
@@ -640,6 +661,7 @@ void Kernel::svcCreateSemaphore() {
 
 	regs[0] = Result::Success;
 	regs[1] = makeSemaphore(initialCount, maxCount);
+	objects[regs[1]].closable = true;
 }
 
 void Kernel::svcReleaseSemaphore() {
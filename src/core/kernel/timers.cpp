@@ -6,7 +6,7 @@
 
 HorizonHandle Kernel::makeTimer(ResetType type) {
 	Handle ret = makeObject(KernelObjectType::Timer);
-	objects[ret].data = new Timer(type);
+	makeObjectData<Timer>(ret, type);
 
 	if (type == ResetType::Pulse) {
 		Helpers::panic("Created pulse timer");
@@ -89,6 +89,7 @@ void Kernel::svcCreateTimer() {
 	logSVC("CreateTimer (resetType = %s)\n", resetTypeToString(resetType));
 	regs[0] = Result::Success;
 	regs[1] = makeTimer(static_cast<ResetType>(resetType));
+	objects[regs[1]].closable = true;
 }
 
 void Kernel::svcSetTimer() {
@@ -0,0 +1,55 @@
+#include "loader/boot_pipeline.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+namespace Loader {
+	void TaskGroup::wait() {
+		if (jobs.empty()) {
+			return;
+		}
+
+		std::atomic<usize> nextJob = 0;
+		const auto runJobs = [&]() {
+			for (usize job = nextJob++; job < jobs.size(); job = nextJob++) {
+				jobs[job]();
+			}
+		};
+
+		// The calling thread takes part in running the jobs too
+		const usize hostThreads = std::max<usize>(std::thread::hardware_concurrency(), 1);
+		const usize threadCount = std::min({jobs.size(), hostThreads, maxThreads}) - 1;
+
+		std::vector<std::thread> threads;
+		threads.reserve(threadCount);
+		for (usize i = 0; i < threadCount; i++) {
+			threads.emplace_back(runJobs);
+		}
+
+		runJobs();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		jobs.clear();
+	}
+
+	void BootTimings::record(std::string name, Clock::time_point stageStart) {
+		const double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - stageStart).count();
+		std::unique_lock lock(mutex);
+		stages.push_back(Stage{std::move(name), milliseconds});
+	}
+
+	void BootTimings::print() {
+		const double total = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		std::unique_lock lock(mutex);
+
+		printf("Boot timings:\n");
+		for (const Stage& stage : stages) {
+			printf("  %-40s %9.3f ms\n", stage.name.c_str(), stage.milliseconds);
+		}
+		printf("  %-40s %9.3f ms\n", "Total", total);
+	}
+}  // namespace Loader
@@ -16,8 +16,14 @@ bool CartLZ77::decompress(std::vector<u8>& output, const std::vector<u8>& input)
 	u32 sizeCompressed = u32(input.size() * sizeof(u8));
 	u32 sizeDecompressed = decompressedSize(input);
 	output.resize(sizeDecompressed);
+	std::copy(input.begin(), input.end(), output.begin());
+
+	return decompressInPlace(output.data(), sizeCompressed, sizeDecompressed);
+}
 
-	const u8* compressed = (u8*)input.data();
+bool CartLZ77::decompressInPlace(u8* buffer, u32 sizeCompressed, u32 sizeDecompressed) {
+	const u8* compressed = buffer;
+	u8* output = buffer;
 	const u8* footer = compressed + sizeCompressed - 8;
 
 	u32 bufferTopAndBottom;
@@ -27,9 +33,10 @@ bool CartLZ77::decompress(std::vector<u8>& output, const std::vector<u8>& input)
 	u32 index = sizeCompressed - (Helpers::getBits<24, 8>(bufferTopAndBottom));
 	u32 stopIndex = sizeCompressed - (bufferTopAndBottom & 0xffffff);
 
-	// Set all of the decompressed buffer to 0 and copy the compressed buffer to the start of it
-	std::fill(output.begin(), output.end(), 0);
-	std::copy(input.begin(), input.end(), output.begin());
+	// Everything after the compressed data starts out as 0
+	if (sizeDecompressed > sizeCompressed) {
+		std::memset(buffer + sizeCompressed, 0, sizeDecompressed - sizeCompressed);
+	}
 
 	while (index > stopIndex) {
 		u8 control = compressed[--index];
@@ -6,12 +6,19 @@
 
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <vector>
 
 #include "loader/lz77.hpp"
 #include "memory.hpp"
 
-bool NCCH::loadFromHeader(Crypto::AESEngine &aesEngine, IOFile& file, const FSInfo &info) {
+namespace {
+	// The file handle is shared between the partitions getting loaded in parallel, so seeking and reading has to happen under a lock.
+	// Decryption happens outside of it, so that one partition can be decrypted while another is being read
+	std::mutex fileMutex;
+}
+
+bool NCCH::loadHeader(Crypto::AESEngine &aesEngine, IOFile& file, const FSInfo &info) {
     // 0x200 bytes for the NCCH header
     constexpr u64 headerSize = 0x200;
     u8 header[headerSize];
@@ -27,7 +34,8 @@ bool NCCH::loadFromHeader(Crypto::AESEngine &aesEngine, IOFile& file, const FSIn
 		return false;
 	}
 
-	codeFile.clear();
+	codeOffset = codeSize = 0;
+	iconOffset = iconSize = 0;
 	smdh.clear();
 	partitionInfo = info;
 
@@ -42,6 +50,7 @@ bool NCCH::loadFromHeader(Crypto::AESEngine &aesEngine, IOFile& file, const FSIn
 	// Read NCCH flags
 	secondaryKeySlot = header[0x188 + 3];
 	isNew3DS = header[0x188 + 4] == 2;
+	requestsNew3DSClock = false;
 	fixedCryptoKey = (header[0x188 + 7] & 0x1) == 0x1;
 	mountRomFS = (header[0x188 + 7] & 0x2) != 0x2;
 	encrypted = (header[0x188 + 7] & 0x4) != 0x4;
@@ -63,8 +72,7 @@ bool NCCH::loadFromHeader(Crypto::AESEngine &aesEngine, IOFile& file, const FSIn
 	romFS.hashRegionSize = u64(*(u32*)&header[0x1B8]) * mediaUnit;
 	romFS.encryptionInfo = std::nullopt;
 
-	// Shows whether we got the primary and secondary keys correctly
-	bool gotCryptoKeys = true;
+	gotCryptoKeys = true;
 	if (encrypted) {
 		Crypto::AESKey primaryKeyY;
 		Crypto::AESKey secondaryKeyY;
@@ -123,10 +131,14 @@ bool NCCH::loadFromHeader(Crypto::AESEngine &aesEngine, IOFile& file, const FSIn
 		}
 	}
 
+	return true;
+}
+
+bool NCCH::loadExtendedHeader(Crypto::AESEngine &aesEngine, IOFile& file) {
 	if (exheaderSize != 0) {
 		std::unique_ptr<u8[]> exheader(new u8[exheaderSize]);
 
-		auto [success, bytes] = readFromFile(file, info, &exheader[0], 0x200, exheaderSize);
+		auto [success, bytes] = readFromFile(file, partitionInfo, &exheader[0], 0x200, exheaderSize);
 		if (!success || bytes != exheaderSize) {
 			printf("Failed to read Extended NCCH header\n");
 			return false;
@@ -184,15 +196,23 @@ bool NCCH::loadFromHeader(Crypto::AESEngine &aesEngine, IOFile& file, const FSIn
 		text.extract(&exheader[0x10]);
 		rodata.extract(&exheader[0x20]);
 		data.extract(&exheader[0x30]);
+
+		// Flag 1 of the ARM11 local system capabilities. New 3DS enhanced titles set bit 1 to run the CPU at 804MHz
+		if (exheaderSize > 0x200 + 0xC) {
+			requestsNew3DSClock = (exheader[0x200 + 0xC] & 0x2) != 0;
+		}
 	}
 
 	printf("Stack size: %08X\nBSS size: %08X\n", stackSize, bssSize);
+	return true;
+}
 
+bool NCCH::loadExeFSHeader(IOFile& file) {
 	// Read ExeFS
 	if (hasExeFS()) {
 		// Offset of ExeFS in the file = exeFS offset + NCCH offset
 		// exeFS.offset has already been offset by the NCCH offset
-		printf("ExeFS offset: %08llX, size: %08llX (Offset in file = %08llX)\n", exeFS.offset - info.offset, exeFS.size, exeFS.offset);
+		printf("ExeFS offset: %08llX, size: %08llX (Offset in file = %08llX)\n", exeFS.offset - partitionInfo.offset, exeFS.size, exeFS.offset);
 		constexpr size_t exeFSHeaderSize = 0x200;
 
 		u8 exeFSHeader[exeFSHeaderSize];
@@ -218,58 +238,98 @@ bool NCCH::loadFromHeader(Crypto::AESEngine &aesEngine, IOFile& file, const FSIn
 				printf("File %d. Name: %s, Size: %08X, Offset: %08X\n", i, name, fileSize, fileOffset);
 			}
 
+			// A file offset of 0 means our file is located right after the ExeFS header
+			// So in the ROM, files are located at (file offset + exeFS offset + exeFS header size)
 			if (std::strcmp(name, ".code") == 0) {
 				if (hasCode()) {
 					Helpers::panic("Second code file in a single NCCH partition. What should this do?\n");
 				}
 
-				// All files in ExeFS use the same IV, though .code uses the secondary key for decryption
-				// whereas .icon/.banner use the primary key.
-				FSInfo info = exeFS;
-				if (encrypted && secondaryKey.has_value() && info.encryptionInfo.has_value()) {
-					info.encryptionInfo->normalKey = *secondaryKey;
-				}
-
-				if (compressCode) {
-					std::vector<u8> tmp;
-					tmp.resize(fileSize);
-
-					// A file offset of 0 means our file is located right after the ExeFS header
-					// So in the ROM, files are located at (file offset + exeFS offset + exeFS header size)
-					readFromFile(file, info, tmp.data(), fileOffset + exeFSHeaderSize, fileSize);
-					
-					// Decompress .code file from the tmp vector to the "code" vector
-					if (!CartLZ77::decompress(codeFile, tmp)) {
-						printf("Failed to decompress .code file\n");
-						return false;
-					}
-				} else {
-					codeFile.resize(fileSize);
-					readFromFile(file, info, codeFile.data(), fileOffset + exeFSHeaderSize, fileSize);
-				}
+				codeOffset = fileOffset + exeFSHeaderSize;
+				codeSize = fileSize;
 			} else if (std::strcmp(name, "icon") == 0) {
-				// Parse icon file to extract region info and more in the future (logo, etc)
-				smdh.resize(fileSize);
-				readFromFile(file, exeFS, smdh.data(), fileOffset + exeFSHeaderSize, fileSize);
-
-				if (!parseSMDH(smdh)) {
-					printf("Failed to parse SMDH!\n");
-				}
+				iconOffset = fileOffset + exeFSHeaderSize;
+				iconSize = fileSize;
 			}
 		}
 	}
 
-	// If no region has been detected for CXI, set the region to USA by default
+	if (hasRomFS()) {
+		printf("RomFS offset: %08llX, size: %08llX\n", romFS.offset, romFS.size);
+	}
+
+	initialized = true;
+	return true;
+}
+
+bool NCCH::loadIcon(IOFile& file) {
+	bool readIcon = true;
+
+	if (iconSize != 0) {
+		// Parse icon file to extract region info and more in the future (logo, etc)
+		smdh.resize(iconSize);
+		auto [success, bytes] = readFromFile(file, exeFS, smdh.data(), iconOffset, iconSize);
+		if (!success || bytes != iconSize) {
+			printf("Failed to read icon file\n");
+			smdh.clear();
+			readIcon = false;
+		} else if (!parseSMDH(smdh)) {
+			printf("Failed to parse SMDH!\n");
+		}
+	}
+
+	// If no region has been detected for CXI, set the region to USA by default. This also covers failing to read the icon
 	if (!region.has_value() && partitionIndex == 0) {
 		printf("No region detected for CXI, defaulting to USA\n");
 		region = Regions::USA;
 	}
 
-	if (hasRomFS()) {
-		printf("RomFS offset: %08llX, size: %08llX\n", romFS.offset, romFS.size);
+	return readIcon;
+}
+
+NCCH::FSInfo NCCH::getCodeFSInfo() {
+	// All files in ExeFS use the same IV, though .code uses the secondary key for decryption
+	// whereas .icon/.banner use the primary key.
+	FSInfo info = exeFS;
+	if (encrypted && secondaryKey.has_value() && info.encryptionInfo.has_value()) {
+		info.encryptionInfo->normalKey = *secondaryKey;
+	}
+
+	return info;
+}
+
+std::optional<u32> NCCH::getCodeSize(IOFile& file) {
+	if (!compressCode) {
+		return codeSize;
+	}
+
+	// The difference in size between the compressed and decompressed file is stored in the last word of the compressed file
+	if (codeSize < 8) {
+		return std::nullopt;
+	}
+
+	u32 sizeDiff;
+	auto [success, bytes] = readFromFile(file, getCodeFSInfo(), (u8*)&sizeDiff, codeOffset + codeSize - sizeof(u32), sizeof(u32));
+	if (!success || bytes != sizeof(u32)) {
+		return std::nullopt;
+	}
+
+	return codeSize + sizeDiff;
+}
+
+bool NCCH::loadCode(IOFile& file, u8* dst, u32 decompressedSize) {
+	auto [success, bytes] = readFromFile(file, getCodeFSInfo(), dst, codeOffset, codeSize);
+	if (!success || bytes != codeSize) {
+		printf("Failed to read .code file\n");
+		return false;
+	}
+
+	// Decompress .code file in place
+	if (compressCode && !CartLZ77::decompressInPlace(dst, codeSize, decompressedSize)) {
+		printf("Failed to decompress .code file\n");
+		return false;
 	}
 
-	initialized = true;
 	return true;
 }
 
@@ -392,8 +452,10 @@ std::pair<bool, std::size_t> NCCH::readFromFile(IOFile& file, const FSInfo &info
 
 	std::size_t readMaxSize = std::min(size, static_cast<std::size_t>(info.size) - offset);
 
+	std::unique_lock lock(fileMutex);
 	file.seek(info.offset + offset);
 	auto [success, bytes] = file.readBytes(dst, readMaxSize);
+	lock.unlock();
 
 	if (!success) {
 		return { success, bytes};
@@ -1,14 +1,17 @@
 #include "loader/ncsd.hpp"
 
+#include <algorithm>
 #include <cstring>
 #include <optional>
+#include <string>
 
 #include "kernel/fcram.hpp"
+#include "loader/boot_pipeline.hpp"
 #include "memory.hpp"
 
 using namespace KernelMemoryTypes;
 
-bool Memory::mapCXI(NCSD& ncsd, NCCH& cxi) {
+bool Memory::mapCXI(NCSD& ncsd, NCCH& cxi, Loader::BootTimings& timings) {
 	printf("Text address = %08X, size = %08X\n", cxi.text.address, cxi.text.size);
 	printf("Rodata address = %08X, size = %08X\n", cxi.rodata.address, cxi.rodata.size);
 	printf("Data address = %08X, size = %08X\n", cxi.data.address, cxi.data.size);
@@ -16,10 +19,6 @@ bool Memory::mapCXI(NCSD& ncsd, NCCH& cxi) {
 
 	static constexpr std::array<const char*, 7> regionNames = {"Japan", "North America", "Europe", "Australia", "China", "Korea", "Taiwan"};
 
-	// Set autodetected 3DS region to one of the values allowed by the CXI's SMDH
-	region = cxi.region.value();
-	printf("Console region autodetected to: %s\n", regionNames[static_cast<size_t>(region)]);
-
 	if (!isAligned(cxi.stackSize)) {
 		Helpers::warn("CXI has a suspicious stack size of %08X which is not a multiple of 4KB", cxi.stackSize);
 	}
@@ -34,13 +33,17 @@ bool Memory::mapCXI(NCSD& ncsd, NCCH& cxi) {
 		return false;
 	}
 
-	// Map code file to memory
-	auto& code = cxi.codeFile;
+	const std::optional<u32> codeSize = cxi.getCodeSize(ncsd.file);
+	if (!codeSize.has_value()) {
+		printf("Failed to read the size of the .code file\n");
+		return false;
+	}
+
 	u32 bssSize = (cxi.bssSize + 0xfff) & ~0xfff;  // Round BSS size up to a page boundary
 	// Total memory to allocate for loading
 	u32 totalSize = (cxi.text.pageCount + cxi.rodata.pageCount + cxi.data.pageCount) * pageSize + bssSize;
 
-	if (code.size() + bssSize < totalSize) {
+	if (*codeSize + bssSize < totalSize) {
 		Helpers::panic("Total code size as reported by the exheader is larger than the .code file");
 		return false;
 	}
@@ -59,20 +62,82 @@ bool Memory::mapCXI(NCSD& ncsd, NCCH& cxi) {
 	auto region = FcramRegion::App;
 	u32 bssAddr = dataAddr + (cxi.data.pageCount << 12);
 
+	const auto allocationStart = Loader::BootTimings::Clock::now();
 	allocMemory(textAddr, cxi.text.pageCount, region, true, false, true, MemoryState::Code);
 	allocMemory(rodataAddr, cxi.rodata.pageCount, region, true, false, false, MemoryState::Code);
 	allocMemory(dataAddr, cxi.data.pageCount, region, true, true, false, MemoryState::Private);
 	allocMemory(bssAddr, bssSize >> 12, region, true, true, false, MemoryState::Private);
+	timings.record("Allocate code memory", allocationStart);
+
+	// The .code file is .text, .rodata and .data back to back. If the pages we just allocated for them are back to back in FCRAM as well,
+	// which is usually the case, the code gets read, decrypted and decompressed straight into FCRAM
+	u8* codeHost = (u8*)getReadPointer(textAddr);
+	u32 codeHostSize = 0;
+
+	const auto checkContiguous = [&](u32 vaddr, u32 pageCount) {
+		for (u32 page = 0; page < pageCount; page++, codeHostSize += pageSize) {
+			if (codeHost != nullptr && getReadPointer(vaddr + page * pageSize) != codeHost + codeHostSize) {
+				codeHost = nullptr;
+			}
+		}
+	};
 
-	// Copy .code file to FCRAM
-	copyToVaddr(textAddr, code.data(), textSize);
-	copyToVaddr(rodataAddr, code.data() + textSize, rodataSize);
-	copyToVaddr(dataAddr, code.data() + textSize + rodataSize, cxi.data.pageCount << 12);
+	checkContiguous(textAddr, cxi.text.pageCount);
+	checkContiguous(rodataAddr, cxi.rodata.pageCount);
+	checkContiguous(dataAddr, cxi.data.pageCount);
+
+	if (*codeSize > codeHostSize) {
+		codeHost = nullptr;
+	}
+
+	// Load the code while the icons of every partition get loaded in parallel, as we need the region from the CXI's icon
+	Loader::TaskGroup tasks;
+	std::vector<u8> code;
+	bool loadedCode = false;
+
+	tasks.submit([&]() {
+		loadedCode = timings.measure(codeHost != nullptr ? "Load .code into FCRAM" : "Load .code", [&]() {
+			if (codeHost != nullptr) {
+				std::memset(codeHost + *codeSize, 0, codeHostSize - *codeSize);
+				return cxi.loadCode(ncsd.file, codeHost, *codeSize);
+			}
+
+			// Anything the .code file doesn't cover up to the end of the .data segment is zero-filled
+			code.resize(std::max(*codeSize, codeHostSize), 0);
+			return cxi.loadCode(ncsd.file, code.data(), *codeSize);
+		});
+	});
+
+	for (usize i = 0; i < ncsd.partitions.size(); i++) {
+		if (ncsd.partitions[i].length != 0) {
+			tasks.submit([&, i]() {
+				// A missing or unreadable icon isn't fatal, the region just falls back to the default
+				timings.measure("Partition " + std::to_string(i) + " icon", [&]() { ncsd.partitions[i].ncch.loadIcon(ncsd.file); });
+			});
+		}
+	}
+
+	tasks.wait();
+
+	if (!loadedCode) {
+		return false;
+	}
+
+	// Copy .code file to FCRAM, if we couldn't load it there directly
+	if (codeHost == nullptr) {
+		copyToVaddr(textAddr, code.data(), textSize);
+		copyToVaddr(rodataAddr, code.data() + textSize, rodataSize);
+		copyToVaddr(dataAddr, code.data() + textSize + rodataSize, cxi.data.pageCount << 12);
+	}
 
 	// Set BSS to zeroes
 	std::vector<u8> bss(bssSize, 0);
 	copyToVaddr(bssAddr, bss.data(), bssSize);
 
+	// Set autodetected 3DS region to one of the values allowed by the CXI's SMDH
+	this->region = cxi.region.value_or(Regions::USA);
+	printf("Console region autodetected to: %s\n", regionNames[static_cast<size_t>(this->region)]);
+
 	ncsd.entrypoint = cxi.text.address;
 
 	// Back the IOFile for accessing the ROM, as well as the ROM's CXI partition, in the memory class.
@@ -81,12 +146,62 @@ bool Memory::mapCXI(NCSD& ncsd, NCCH& cxi) {
 	return true;
 }
 
+// Loads the headers of every NCCH partition with a non-zero length. The partition info must have been filled in before this
+static bool loadPartitions(Crypto::AESEngine& aesEngine, NCSD& ncsd, Loader::BootTimings& timings) {
+	// Loading an NCCH header sets up its keys in the key slots of the AES engine, so these get loaded one at a time
+	const auto headerStart = Loader::BootTimings::Clock::now();
+	for (auto& partition : ncsd.partitions) {
+		if (partition.length != 0) {
+			NCCH::FSInfo ncchFsInfo;
+
+			ncchFsInfo.offset = partition.offset;
+			ncchFsInfo.size = partition.length;
+
+			if (!partition.ncch.loadHeader(aesEngine, ncsd.file, ncchFsInfo)) {
+				printf("Invalid NCCH partition\n");
+				return false;
+			}
+		}
+	}
+	timings.record("NCCH headers and keys", headerStart);
+
+	// The extended headers and ExeFS headers of different partitions don't depend on each other
+	Loader::TaskGroup tasks;
+	std::array<bool, 8> loaded;
+	loaded.fill(true);
+
+	for (usize i = 0; i < ncsd.partitions.size(); i++) {
+		if (ncsd.partitions[i].length != 0) {
+			tasks.submit([&, i]() {
+				NCCH& ncch = ncsd.partitions[i].ncch;
+
+				loaded[i] = timings.measure("Partition " + std::to_string(i) + " exheader and ExeFS header", [&]() {
+					return ncch.loadExtendedHeader(aesEngine, ncsd.file) && ncch.loadExeFSHeader(ncsd.file);
+				});
+			});
+		}
+	}
+
+	tasks.wait();
+
+	for (usize i = 0; i < loaded.size(); i++) {
+		if (!loaded[i]) {
+			printf("Failed to load NCCH partition %zu\n", i);
+			return false;
+		}
+	}
+
+	return true;
+}
+
 std::optional<NCSD> Memory::loadNCSD(Crypto::AESEngine& aesEngine, const std::filesystem::path& path) {
+	Loader::BootTimings timings;
 	NCSD ncsd;
 	if (!ncsd.file.open(path, "rb")) {
 		return std::nullopt;
 	}
 
+	const auto headerStart = Loader::BootTimings::Clock::now();
 	u8 magic[4];  // Must be "NCSD"
 	ncsd.file.seek(0x100);
 	auto [success, bytes] = ncsd.file.readBytes(magic, 4);
@@ -128,18 +243,12 @@ std::optional<NCSD> Memory::loadNCSD(Crypto::AESEngine& aesEngine, const std::fi
 
 		ncch.partitionIndex = i;
 		ncch.fileOffset = partition.offset;
+	}
+	timings.record("NCSD header", headerStart);
 
-		if (partition.length != 0) {  // Initialize the NCCH of each partition
-			NCCH::FSInfo ncchFsInfo;
-
-			ncchFsInfo.offset = partition.offset;
-			ncchFsInfo.size = partition.length;
-
-			if (!ncch.loadFromHeader(aesEngine, ncsd.file, ncchFsInfo)) {
-				printf("Invalid NCCH partition\n");
-				return std::nullopt;
-			}
-		}
+	// Initialize the NCCH of each partition
+	if (!loadPartitions(aesEngine, ncsd, timings)) {
+		return std::nullopt;
 	}
 
 	auto& cxi = ncsd.partitions[0].ncch;
@@ -148,17 +257,19 @@ std::optional<NCSD> Memory::loadNCSD(Crypto::AESEngine& aesEngine, const std::fi
 		return std::nullopt;
 	}
 
-	if (!mapCXI(ncsd, cxi)) {
+	if (!mapCXI(ncsd, cxi, timings)) {
 		printf("Failed to map CXI\n");
 		return std::nullopt;
 	}
 
+	timings.print();
 	return ncsd;
 }
 
 // We are lazy so we take CXI files, easily "convert" them to NCSD internally, then use our existing NCSD infrastructure
 // This is easy because NCSD is just CXI + some more NCCH partitions, which we can make empty when converting to NCSD
 std::optional<NCSD> Memory::loadCXI(Crypto::AESEngine& aesEngine, const std::filesystem::path& path) {
+	Loader::BootTimings timings;
 	NCSD ncsd;
 	if (!ncsd.file.open(path, "rb")) {
 		return std::nullopt;
@@ -186,9 +297,8 @@ std::optional<NCSD> Memory::loadCXI(Crypto::AESEngine& aesEngine, const std::fil
 
 	cxiPartition.offset = 0ull;
 	cxiPartition.length = size.value();
-	NCCH::FSInfo cxiInfo{.offset = cxiPartition.offset, .size = cxiPartition.length, .hashRegionSize = 0, .encryptionInfo = std::nullopt};
 
-	if (!cxi.loadFromHeader(aesEngine, ncsd.file, cxiInfo)) {
+	if (!loadPartitions(aesEngine, ncsd, timings)) {
 		printf("Invalid CXI partition\n");
 		return std::nullopt;
 	}
@@ -198,10 +308,11 @@ std::optional<NCSD> Memory::loadCXI(Crypto::AESEngine& aesEngine, const std::fil
 		return std::nullopt;
 	}
 
-	if (!mapCXI(ncsd, cxi)) {
+	if (!mapCXI(ncsd, cxi, timings)) {
 		printf("Failed to map CXI\n");
 		return std::nullopt;
 	}
 
+	timings.print();
 	return ncsd;
 }
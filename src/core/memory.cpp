@@ -1,5 +1,6 @@
 #include "memory.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>  // For time since epoch
 #include <cmrc/cmrc.hpp>
@@ -31,8 +32,7 @@ Memory::Memory(KFcram& fcramManager, const EmulatorConfig& config) : fcramManage
 void Memory::reset() {
 	// Mark the entire process address space as free
 	constexpr static int MAX_USER_PAGES = 0x40000000 >> 12;
-	memoryInfo.clear();
-	memoryInfo.push_back(MemoryInfo(0, MAX_USER_PAGES, 0, KernelMemoryTypes::Free));
+	memoryInfo.reset(MAX_USER_PAGES, 0, KernelMemoryTypes::Free);
 
 	// TODO: remove this, only needed to make the subsequent allocations work for now
 	fcramManager.reset(FCRAM_SIZE, FCRAM_APPLICATION_SIZE, FCRAM_SYSTEM_SIZE, FCRAM_BASE_SIZE);
@@ -305,70 +305,24 @@ void Memory::changeMemoryState(u32 vaddr, s32 pages, const Operation& op) {
 
 	if (!op.changePerms && !op.changeState) Helpers::panic("Invalid op passed to changeMemoryState!");
 
-	bool blockFound = false;
+	std::optional<u32> perms = std::nullopt;
+	std::optional<u32> state = std::nullopt;
+	if (op.changePerms) perms = (op.r ? PERMISSION_R : 0) | (op.w ? PERMISSION_W : 0) | (op.x ? PERMISSION_X : 0);
+	if (op.changeState) state = op.newState;
 
-	for (auto it = memoryInfo.begin(); it != memoryInfo.end(); it++) {
-		// Find the block that the memory region is located in
-		u32 blockStart = it->baseAddr;
-		u32 blockEnd = it->end();
-
-		u32 reqStart = vaddr;
-		u32 reqEnd = vaddr + (pages << 12);
-
-		if (!(reqStart >= blockStart && reqEnd <= blockEnd)) continue;
-
-		// Now that the block has been found, fill it with the necessary info
-		auto oldState = it->state;
-		u32 oldPerms = it->perms;
-		it->baseAddr = reqStart;
-		it->pages = pages;
-		if (op.changePerms) it->perms = (op.r ? PERMISSION_R : 0) | (op.w ? PERMISSION_W : 0) | (op.x ? PERMISSION_X : 0);
-		if (op.changeState) it->state = op.newState;
-
-		// If the requested memory region is smaller than the block found, the block must be split
-		if (blockStart < reqStart) {
-			MemoryInfo startBlock(blockStart, (reqStart - blockStart) >> 12, oldPerms, oldState);
-			memoryInfo.insert(it, startBlock);
-		}
-
-		if (reqEnd < blockEnd) {
-			auto itAfter = std::next(it);
-			MemoryInfo endBlock(reqEnd, (blockEnd - reqEnd) >> 12, oldPerms, oldState);
-			memoryInfo.insert(itAfter, endBlock);
-		}
-
-		blockFound = true;
-		break;
-	}
-
-	if (!blockFound) Helpers::panic("Unable to find block in changeMemoryState!");
-
-	// Merge all blocks with the same state and permissions
-	for (auto it = memoryInfo.begin(); it != memoryInfo.end();) {
-		auto next = std::next(it);
-		if (next == memoryInfo.end()) break;
-
-		if (it->state != next->state || it->perms != next->perms) {
-			it++;
-			continue;
-		}
-
-		next->baseAddr = it->baseAddr;
-		next->pages += it->pages;
-		it = memoryInfo.erase(it);
+	// Find the block that the memory region is located in, split it and merge it with its neighbours if they end up with the same state
+	if (!memoryInfo.change(vaddr, pages, perms, state)) {
+		Helpers::panic("Unable to find block in changeMemoryState!");
 	}
 }
 
 void Memory::queryPhysicalBlocks(FcramBlockList& outList, u32 vaddr, s32 pages) {
 	s32 srcPages = pages;
-	for (auto& alloc : memoryInfo) {
-		u32 blockStart = alloc.baseAddr;
-		u32 blockEnd = alloc.end();
-
-		if (!(vaddr >= blockStart && vaddr < blockEnd)) continue;
+	for (auto it = memoryInfo.find(vaddr); it != memoryInfo.end(); it++) {
+		u32 blockStart = it->first;
 
 		s32 blockPaddr = paddrTable[vaddr >> 12];
-		s32 blockPages = alloc.pages - ((vaddr - blockStart) >> 12);
+		s32 blockPages = it->second.pages - ((vaddr - blockStart) >> 12);
 		blockPages = std::min(srcPages, blockPages);
 		FcramBlock physicalBlock(blockPaddr, blockPages);
 		outList.push_back(physicalBlock);
@@ -520,13 +474,11 @@ void Memory::changePermissions(u32 vaddr, s32 pages, bool r, bool w, bool x) {
 }
 
 Result::HorizonResult Memory::queryMemory(MemoryInfo& out, u32 vaddr) {
-	// Check each allocation
-	for (auto& alloc : memoryInfo) {
-		// Check if the memory address belongs in this allocation and return the info if so
-		if (vaddr >= alloc.baseAddr && vaddr < alloc.end()) {
-			out = alloc;
-			return Result::Success;
-		}
+	// Find the allocation the memory address belongs in and return its info
+	auto it = memoryInfo.find(vaddr);
+	if (it != memoryInfo.end()) {
+		out = MemoryInfo(it->first, it->second.pages, it->second.perms, it->second.state);
+		return Result::Success;
 	}
 
 	// Official kernel just returns an error here
@@ -535,23 +487,21 @@ Result::HorizonResult Memory::queryMemory(MemoryInfo& out, u32 vaddr) {
 }
 
 Result::HorizonResult Memory::testMemoryState(u32 vaddr, s32 pages, MemoryState desiredState) {
-	for (auto& alloc : memoryInfo) {
-		// Don't bother checking if we're to the left of the requested region
-		if (vaddr >= alloc.end()) continue;
-		if (alloc.state != desiredState) return Result::FailurePlaceholder;  // TODO: error for state mismatch
-
-		// If the end of this block comes after the end of the requested range with no errors, it's a success
-		if (alloc.end() >= vaddr + (pages << 12)) return Result::Success;
-	}
-
-	// TODO: error for when address is outside of userland
-	return Result::FailurePlaceholder;
+	// TODO: Separate errors for state mismatches and for when the address is outside of userland
+	return memoryInfo.testState(vaddr, pages, desiredState) ? Result::Success : Result::FailurePlaceholder;
 }
 
 void Memory::copyToVaddr(u32 dstVaddr, const u8* srcHost, s32 size) {
-	// TODO: check for noncontiguous allocations
-	u8* dstHost = (u8*)readTable[dstVaddr >> 12] + (dstVaddr & 0xFFF);
-	memcpy(dstHost, srcHost, size);
+	// Copy a page at a time, as the pages of an allocation aren't necessarily contiguous in FCRAM
+	while (size > 0) {
+		const s32 count = std::min<s32>(size, pageSize - (dstVaddr & pageMask));
+		u8* dstHost = (u8*)readTable[dstVaddr >> pageShift] + (dstVaddr & pageMask);
+		memcpy(dstHost, srcHost, count);
+
+		dstVaddr += count;
+		srcHost += count;
+		size -= count;
+	}
 }
 
 u8* Memory::mapSharedMemory(Handle handle, u32 vaddr, u32 myPerms, u32 otherPerms) {
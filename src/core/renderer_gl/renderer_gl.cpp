@@ -4,7 +4,9 @@
 
 #include <algorithm>
 #include <bit>
+#include <chrono>
 #include <cmrc/cmrc.hpp>
+#include <fmt/format.h>
 
 #include "PICA/float_types.hpp"
 #include "PICA/gpu.hpp"
@@ -23,7 +25,32 @@ using namespace Floats;
 using namespace Helpers;
 using namespace PICA;
 
-RendererGL::~RendererGL() {}
+namespace {
+	using Clock = std::chrono::steady_clock;
+	double millisecondsSince(Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); }
+
+	// The ubershader gets registers [0x48, 0x200) in its u_picaRegs uniform. We upload them one register group at a time,
+	// so that eg changing the TEV configuration doesn't re-upload all the lighting registers
+	constexpr u32 ubershaderRegBase = 0x48;
+	struct UbershaderRegGroup {
+		u32 group;
+		u32 firstReg;
+		u32 endReg;
+	};
+
+	constexpr std::array<UbershaderRegGroup, 5> ubershaderRegGroups = {{
+		{PICA::DirtyRegs::Rasterizer, ubershaderRegBase, 0x80},
+		{PICA::DirtyRegs::Texturing, 0x80, 0xC0},
+		{PICA::DirtyRegs::TexEnv, 0xC0, 0x100},
+		{PICA::DirtyRegs::Framebuffer, 0x100, 0x140},
+		{PICA::DirtyRegs::Lighting, 0x140, 0x200},
+	}};
+}  // namespace
+
+RendererGL::~RendererGL() {
+	// Stop the compile workers before the rest of the renderer is destroyed, as pending jobs reference it
+	shaderCompileWorkers.stop();
+}
 
 void RendererGL::reset() {
 	depthBufferCache.reset();
@@ -31,6 +58,10 @@ void RendererGL::reset() {
 	textureCache.reset();
 
 	shaderCache.clear();
+	shaderCompileStats.pendingCompiles = 0;
+	fsConfig = std::nullopt;
+	fragmentUniformDirtyGroups = PICA::DirtyRegs::Fragment;
+	fragmentUniformsUploaded = false;
 
 	// Init the colour/depth buffer settings to some random defaults on reset
 	colourBufferLoc = 0;
@@ -79,6 +110,10 @@ void RendererGL::initGraphicsContextInternal() {
 	hwVertexBuffer = StreamBuffer::Create(GL_ARRAY_BUFFER, hwVertexBufferSize);
 	hwShaderUniformUBO = StreamBuffer::Create(GL_UNIFORM_BUFFER, hwShaderUniformUBOSize);
 	shadergenFragmentUBO = StreamBuffer::Create(GL_UNIFORM_BUFFER, shadergenFragmentUBOSize);
+	// Nothing has been uploaded to or bound from the new buffers yet
+	fragmentUniformDirtyGroups = PICA::DirtyRegs::Fragment;
+	fragmentUniformsUploaded = false;
+	hwShaderUBOBound = false;
 
 	vbo.createFixedSize(sizeof(Vertex) * vertexBufferSize * 2, GL_STREAM_DRAW);
 	vbo.bind();
@@ -184,6 +219,21 @@ void RendererGL::initGraphicsContextInternal() {
 	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, reinterpret_cast<GLint*>(&driverInfo.uboAlignment));
 	driverInfo.uboAlignment = std::max<GLuint>(driverInfo.uboAlignment, 16);
 
+	driverInfo.supportsParallelShaderCompile = (GLAD_GL_KHR_parallel_shader_compile != 0) || (GLAD_GL_ARB_parallel_shader_compile != 0);
+	if (GLAD_GL_KHR_parallel_shader_compile) {
+		// Let the driver pick how many threads to use for compiling shaders
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	} else if (GLAD_GL_ARB_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+	}
+
+	asyncShaderCompilation = emulatorConfig->asyncShaderCompilation;
+	if (asyncShaderCompilation) {
+		shaderCompileWorkers.start();
+	} else {
+		shaderCompileWorkers.stop();
+	}
+
 	// Initialize the default vertex shader used with shadergen
 	std::string defaultShadergenVSSource = fragShaderGen.getDefaultVertexShader();
 	defaultShadergenVs.create({defaultShadergenVSSource.c_str(), defaultShadergenVSSource.size()}, OpenGL::Vertex);
@@ -298,7 +348,7 @@ void RendererGL::setupStencilTest(bool stencilEnable) {
 }
 
 void RendererGL::setupUbershaderTexEnv() {
-	// TODO: Only update uniforms when the TEV config changed. Use an UBO potentially.
+	// TODO: Use an UBO potentially.
 	static constexpr std::array<u32, 6> ioBases = {
 		PICA::InternalRegs::TexEnv0Source, PICA::InternalRegs::TexEnv1Source, PICA::InternalRegs::TexEnv2Source,
 		PICA::InternalRegs::TexEnv3Source, PICA::InternalRegs::TexEnv4Source, PICA::InternalRegs::TexEnv5Source,
@@ -327,6 +377,32 @@ void RendererGL::setupUbershaderTexEnv() {
 	glUniform1uiv(ubershaderData.textureEnvScaleLoc, 6, textureEnvScaleRegs);
 }
 
+void RendererGL::uploadUbershaderRegs() {
+	if (ubershaderDirtyGroups == 0) {
+		uniformStats.skippedUpdates++;
+		return;
+	}
+
+	// The ubershader needs access to the rasterizer registers (for depth, starting from index 0x48), the texturing and the fragment lighting
+	// registers. Only upload the groups that were written to since the last upload
+	for (usize i = 0; i < ubershaderRegGroups.size(); i++) {
+		const auto& group = ubershaderRegGroups[i];
+		if (ubershaderDirtyGroups & group.group) {
+			const u32 count = group.endReg - group.firstReg;
+			glUniform1uiv(ubershaderData.picaRegGroupLocs[i], count, &regs[group.firstReg]);
+			uniformStats.bytesUploaded += count * sizeof(u32);
+		}
+	}
+
+	if (ubershaderDirtyGroups & PICA::DirtyRegs::TexEnv) {
+		setupUbershaderTexEnv();
+		uniformStats.bytesUploaded += 5 * 6 * sizeof(u32);
+	}
+
+	ubershaderDirtyGroups = 0;
+	uniformStats.updates++;
+}
+
 void RendererGL::bindTexturesToSlots() {
 	static constexpr std::array<u32, 3> ioBases = {
 		PICA::InternalRegs::Tex0BorderColor,
@@ -532,6 +608,9 @@ void RendererGL::drawVertices(PICA::PrimType primType, std::span<const Vertex> v
 }
 
 void RendererGL::display() {
+	lastFrameUniformStats = uniformStats;
+	uniformStats = {};
+
 	gl.disableScissor();
 	gl.disableBlend();
 	gl.disableDepth();
@@ -891,93 +970,149 @@ std::optional<ColourBuffer> RendererGL::getColourBuffer(u32 addr, PICA::ColorFmt
 	return colourBufferCache.add(sampleBuffer);
 }
 
-OpenGL::Program& RendererGL::getSpecializedShader() {
-	constexpr uint vsUBOBlockBinding = 1;
-	constexpr uint fsUBOBlockBinding = 2;
+OpenGL::Program* RendererGL::getSpecializedShader() {
+	if (!fsConfig.has_value()) {
+		fsConfig.emplace(regs);
+		// If we're not on GLES, ignore the logic op configuration and don't generate redundant shaders for it, since we use hw logic ops
+		if (!driverInfo.usingGLES) {
+			fsConfig->outConfig.logicOpMode = PICA::LogicOpMode(0);
+		}
+	}
+
+	auto [fragIterator, newFragShader] = shaderCache.fragmentShaderCache.try_emplace(*fsConfig);
+	CachedShader& fragEntry = fragIterator->second;
+
+	if (newFragShader) {
+		if (asyncShaderCompilation) {
+			fragEntry.status = CompileStatus::Generating;
+			shaderCompileStats.pendingCompiles++;
+
+			const auto api = driverInfo.usingGLES ? PICA::ShaderGen::API::GLES : PICA::ShaderGen::API::GL;
+			shaderCompileWorkers.submit([this, config = *fsConfig, api]() {
+				PICA::ShaderGen::FragmentGenerator generator(api, PICA::ShaderGen::Language::GLSL);
+				std::string source = generator.generate(config);
+
+				std::unique_lock lock(generatedShadersMutex);
+				generatedFragmentShaders.emplace_back(config, std::move(source));
+			});
+		} else {
+			const auto start = Clock::now();
+			std::string fs = fragShaderGen.generate(*fsConfig);
+			fragEntry.shader.create({fs.c_str(), fs.size()}, OpenGL::Fragment);
 
-	PICA::FragmentConfig fsConfig(regs);
-	// If we're not on GLES, ignore the logic op configuration and don't generate redundant shaders for it, since we use hw logic ops
-	if (!driverInfo.usingGLES) {
-		fsConfig.outConfig.logicOpMode = PICA::LogicOpMode(0);
+			shaderCompileStats.finishedCompiles++;
+			shaderCompileStats.failedCompiles += fragEntry.shader.exists() ? 0 : 1;
+			shaderCompileStats.stallTimeMs += millisecondsSince(start);
+		}
 	}
 
-	OpenGL::Shader& fragShader = shaderCache.fragmentShaderCache[fsConfig];
-	if (!fragShader.exists()) {
-		std::string fs = fragShaderGen.generate(fsConfig);
-		fragShader.create({fs.c_str(), fs.size()}, OpenGL::Fragment);
+	// Either the fragment shader is still being compiled, or it failed to compile and we'll have to stick to the ubershader for this config
+	if (fragEntry.status != CompileStatus::Ready || !fragEntry.shader.exists()) {
+		return nullptr;
 	}
 
+	OpenGL::Shader& fragShader = fragEntry.shader;
 	// Get the handle of the current vertex shader
 	OpenGL::Shader& vertexShader = usingAcceleratedShader ? *generatedVertexShader : defaultShadergenVs;
 	// And form the key for looking up a shader program
 	const u64 programKey = (u64(vertexShader.handle()) << 32) | u64(fragShader.handle());
 
-	CachedProgram& programEntry = shaderCache.programCache[programKey];
+	auto [programIterator, newProgram] = shaderCache.programCache.try_emplace(programKey);
+	CachedProgram& programEntry = programIterator->second;
 	OpenGL::Program& program = programEntry.program;
 
-	if (!program.exists()) {
-		program.create({vertexShader, fragShader});
-		gl.useProgram(program);
+	if (newProgram) {
+		programEntry.usesHwVertexShader = usingAcceleratedShader;
 
-		// Init sampler objects. Texture 0 goes in texture unit 0, texture 1 in TU 1, texture 2 in TU 2, and the light maps go in TU 3
-		glUniform1i(OpenGL::uniformLocation(program, "u_tex0"), 0);
-		glUniform1i(OpenGL::uniformLocation(program, "u_tex1"), 1);
-		glUniform1i(OpenGL::uniformLocation(program, "u_tex2"), 2);
-		glUniform1i(OpenGL::uniformLocation(program, "u_tex_luts"), 3);
+		if (asyncShaderCompilation) {
+			// Kick off linking and check up on it in pollAsyncShaders
+			program.m_handle = glCreateProgram();
+			glAttachShader(program.handle(), vertexShader.handle());
+			glAttachShader(program.handle(), fragShader.handle());
+			glLinkProgram(program.handle());
 
-		// Set up the binding for our UBOs. Sadly we can't specify it in the shader like normal people,
-		// As it's an OpenGL 4.2 feature that MacOS doesn't support...
-		uint fsUBOIndex = glGetUniformBlockIndex(program.handle(), "FragmentUniforms");
-		glUniformBlockBinding(program.handle(), fsUBOIndex, fsUBOBlockBinding);
+			programEntry.status = CompileStatus::Compiling;
+			shaderCache.linkingPrograms.push_back(&programEntry);
+			shaderCompileStats.pendingCompiles++;
+		} else {
+			const auto start = Clock::now();
+			program.create({vertexShader, fragShader});
+			if (program.exists()) {
+				setupSpecializedProgram(program, programEntry.usesHwVertexShader);
+			}
 
-		if (usingAcceleratedShader) {
-			uint vertexUBOIndex = glGetUniformBlockIndex(program.handle(), "PICAShaderUniforms");
-			glUniformBlockBinding(program.handle(), vertexUBOIndex, vsUBOBlockBinding);
+			shaderCompileStats.finishedCompiles++;
+			shaderCompileStats.failedCompiles += program.exists() ? 0 : 1;
+			shaderCompileStats.stallTimeMs += millisecondsSince(start);
 		}
 	}
 
-	// Upload uniform data to our shader's UBO
-	PICA::FragmentUniforms uniforms;
-	uniforms.alphaReference = Helpers::getBits<8, 8>(regs[InternalRegs::AlphaTestConfig]);
+	if (programEntry.status != CompileStatus::Ready || !program.exists()) {
+		return nullptr;
+	}
 
-	// Set up the texenv buffer color
-	const u32 texEnvBufferColor = regs[InternalRegs::TexEnvBufferColor];
-	uniforms.tevBufferColor[0] = float(texEnvBufferColor & 0xFF) / 255.0f;
-	uniforms.tevBufferColor[1] = float((texEnvBufferColor >> 8) & 0xFF) / 255.0f;
-	uniforms.tevBufferColor[2] = float((texEnvBufferColor >> 16) & 0xFF) / 255.0f;
-	uniforms.tevBufferColor[3] = float((texEnvBufferColor >> 24) & 0xFF) / 255.0f;
+	uploadFragmentUniforms();
+	return &program;
+}
 
-	uniforms.depthScale = f24::fromRaw(regs[PICA::InternalRegs::DepthScale] & 0xffffff).toFloat32();
-	uniforms.depthOffset = f24::fromRaw(regs[PICA::InternalRegs::DepthOffset] & 0xffffff).toFloat32();
+void RendererGL::uploadFragmentUniforms() {
+	using namespace PICA::DirtyRegs;
 
-	if (regs[InternalRegs::ClipEnable] & 1) {
-		uniforms.clipCoords[0] = f24::fromRaw(regs[PICA::InternalRegs::ClipData0] & 0xffffff).toFloat32();
-		uniforms.clipCoords[1] = f24::fromRaw(regs[PICA::InternalRegs::ClipData1] & 0xffffff).toFloat32();
-		uniforms.clipCoords[2] = f24::fromRaw(regs[PICA::InternalRegs::ClipData2] & 0xffffff).toFloat32();
-		uniforms.clipCoords[3] = f24::fromRaw(regs[PICA::InternalRegs::ClipData3] & 0xffffff).toFloat32();
-	}
+	const u32 dirtyGroups = fragmentUniformDirtyGroups;
+	fragmentUniformDirtyGroups = 0;
 
-	// Set up the constant color for the 6 TEV stages
-	for (int i = 0; i < 6; i++) {
-		static constexpr std::array<u32, 6> ioBases = {
-			PICA::InternalRegs::TexEnv0Source, PICA::InternalRegs::TexEnv1Source, PICA::InternalRegs::TexEnv2Source,
-			PICA::InternalRegs::TexEnv3Source, PICA::InternalRegs::TexEnv4Source, PICA::InternalRegs::TexEnv5Source,
-		};
+	// Recompute the uniforms derived from the register groups that have been written to. Games often rewrite registers with the same
+	// values between draws, so we compare against the previous uniforms afterwards and only upload if something actually changed
+	PICA::FragmentUniforms uniforms;
+	std::memcpy(&uniforms, &fragmentUniforms, sizeof(PICA::FragmentUniforms));
 
-		auto& vec = uniforms.constantColors[i];
-		u32 base = ioBases[i];
-		u32 color = regs[base + 3];
+	if (dirtyGroups & Framebuffer) {
+		uniforms.alphaReference = Helpers::getBits<8, 8>(regs[InternalRegs::AlphaTestConfig]);
+	}
+
+	if (dirtyGroups & Rasterizer) {
+		uniforms.depthScale = f24::fromRaw(regs[PICA::InternalRegs::DepthScale] & 0xffffff).toFloat32();
+		uniforms.depthOffset = f24::fromRaw(regs[PICA::InternalRegs::DepthOffset] & 0xffffff).toFloat32();
 
-		vec[0] = float(color & 0xFF) / 255.0f;
-		vec[1] = float((color >> 8) & 0xFF) / 255.0f;
-		vec[2] = float((color >> 16) & 0xFF) / 255.0f;
-		vec[3] = float((color >> 24) & 0xFF) / 255.0f;
+		if (regs[InternalRegs::ClipEnable] & 1) {
+			uniforms.clipCoords[0] = f24::fromRaw(regs[PICA::InternalRegs::ClipData0] & 0xffffff).toFloat32();
+			uniforms.clipCoords[1] = f24::fromRaw(regs[PICA::InternalRegs::ClipData1] & 0xffffff).toFloat32();
+			uniforms.clipCoords[2] = f24::fromRaw(regs[PICA::InternalRegs::ClipData2] & 0xffffff).toFloat32();
+			uniforms.clipCoords[3] = f24::fromRaw(regs[PICA::InternalRegs::ClipData3] & 0xffffff).toFloat32();
+		}
 	}
 
-	uniforms.fogColor = regs[PICA::InternalRegs::FogColor];
+	if (dirtyGroups & TexEnv) {
+		// Set up the texenv buffer color
+		const u32 texEnvBufferColor = regs[InternalRegs::TexEnvBufferColor];
+		uniforms.tevBufferColor[0] = float(texEnvBufferColor & 0xFF) / 255.0f;
+		uniforms.tevBufferColor[1] = float((texEnvBufferColor >> 8) & 0xFF) / 255.0f;
+		uniforms.tevBufferColor[2] = float((texEnvBufferColor >> 16) & 0xFF) / 255.0f;
+		uniforms.tevBufferColor[3] = float((texEnvBufferColor >> 24) & 0xFF) / 255.0f;
+
+		// Set up the constant color for the 6 TEV stages
+		for (int i = 0; i < 6; i++) {
+			static constexpr std::array<u32, 6> ioBases = {
+				PICA::InternalRegs::TexEnv0Source, PICA::InternalRegs::TexEnv1Source, PICA::InternalRegs::TexEnv2Source,
+				PICA::InternalRegs::TexEnv3Source, PICA::InternalRegs::TexEnv4Source, PICA::InternalRegs::TexEnv5Source,
+			};
+
+			auto& vec = uniforms.constantColors[i];
+			u32 base = ioBases[i];
+			u32 color = regs[base + 3];
+
+			vec[0] = float(color & 0xFF) / 255.0f;
+			vec[1] = float((color >> 8) & 0xFF) / 255.0f;
+			vec[2] = float((color >> 16) & 0xFF) / 255.0f;
+			vec[3] = float((color >> 24) & 0xFF) / 255.0f;
+		}
 
-	// Append lighting uniforms
-	if (fsConfig.lighting.enable) {
+		uniforms.fogColor = regs[PICA::InternalRegs::FogColor];
+	}
+
+	// Lighting uniforms. These are only read by the shader if lighting is enabled, but we keep them up to date regardless so that
+	// toggling lighting doesn't require recomputing them
+	if (dirtyGroups & Lighting) {
 		uniforms.globalAmbientLight = regs[InternalRegs::LightGlobalAmbient];
 		for (int i = 0; i < 8; i++) {
 			auto& light = uniforms.lightUniforms[i];
@@ -1018,27 +1153,221 @@ OpenGL::Program& RendererGL::getSpecializedShader() {
 		}
 	}
 
-	// Upload fragment uniforms to UBO
-	shadergenFragmentUBO->Bind();
-	auto uboRes = shadergenFragmentUBO->Map(driverInfo.uboAlignment, sizeof(PICA::FragmentUniforms));
-	std::memcpy(uboRes.pointer, &uniforms, sizeof(PICA::FragmentUniforms));
-	shadergenFragmentUBO->Unmap(sizeof(PICA::FragmentUniforms));
+	if (fragmentUniformsUploaded && std::memcmp(&uniforms, &fragmentUniforms, sizeof(PICA::FragmentUniforms)) == 0) {
+		uniformStats.skippedUpdates++;
+	} else {
+		std::memcpy(&fragmentUniforms, &uniforms, sizeof(PICA::FragmentUniforms));
+		fragmentUniformsUploaded = true;
 
-	// Bind our UBOs
-	glBindBufferRange(
-		GL_UNIFORM_BUFFER, fsUBOBlockBinding, shadergenFragmentUBO->GetGLBufferId(), uboRes.buffer_offset, sizeof(PICA::FragmentUniforms)
-	);
+		// Upload fragment uniforms to a fresh slice of the UBO ring
+		shadergenFragmentUBO->Bind();
+		auto uboRes = shadergenFragmentUBO->Map(driverInfo.uboAlignment, sizeof(PICA::FragmentUniforms));
+		std::memcpy(uboRes.pointer, &fragmentUniforms, sizeof(PICA::FragmentUniforms));
+		shadergenFragmentUBO->Unmap(sizeof(PICA::FragmentUniforms));
 
-	if (usingAcceleratedShader) {
+		// All specialized programs share the same binding point, so the range stays bound until the next time the uniforms change
 		glBindBufferRange(
-			GL_UNIFORM_BUFFER, vsUBOBlockBinding, hwShaderUniformUBO->GetGLBufferId(), hwShaderUniformUBOOffset, PICAShader::totalUniformSize()
+			GL_UNIFORM_BUFFER, fsUBOBlockBinding, shadergenFragmentUBO->GetGLBufferId(), uboRes.buffer_offset, sizeof(PICA::FragmentUniforms)
 		);
+
+		uniformStats.updates++;
+		uniformStats.bytesUploaded += sizeof(PICA::FragmentUniforms);
+	}
+}
+
+void RendererGL::setupSpecializedProgram(OpenGL::Program& program, bool usesHwVertexShader) {
+	gl.useProgram(program);
+
+	// Init sampler objects. Texture 0 goes in texture unit 0, texture 1 in TU 1, texture 2 in TU 2, and the light maps go in TU 3
+	glUniform1i(OpenGL::uniformLocation(program, "u_tex0"), 0);
+	glUniform1i(OpenGL::uniformLocation(program, "u_tex1"), 1);
+	glUniform1i(OpenGL::uniformLocation(program, "u_tex2"), 2);
+	glUniform1i(OpenGL::uniformLocation(program, "u_tex_luts"), 3);
+
+	// Set up the binding for our UBOs. Sadly we can't specify it in the shader like normal people,
+	// As it's an OpenGL 4.2 feature that MacOS doesn't support...
+	uint fsUBOIndex = glGetUniformBlockIndex(program.handle(), "FragmentUniforms");
+	glUniformBlockBinding(program.handle(), fsUBOIndex, fsUBOBlockBinding);
+
+	if (usesHwVertexShader) {
+		uint vertexUBOIndex = glGetUniformBlockIndex(program.handle(), "PICAShaderUniforms");
+		glUniformBlockBinding(program.handle(), vertexUBOIndex, vsUBOBlockBinding);
+	}
+}
+
+OpenGL::Shader* RendererGL::getAcceleratedVertexShader(ShaderUnit& shaderUnit) {
+	PICA::VertConfig vertexConfig(shaderUnit.vs, regs, false);
+	auto [iterator, newShader] = shaderCache.vertexShaderCache.try_emplace(vertexConfig);
+	CachedShader& entry = iterator->second;
+
+	// If the shader is not in the cache, we have never tried to recompile it before. Try to recompile it and see if it works.
+	if (newShader) {
+		const auto api = driverInfo.usingGLES ? PICA::ShaderGen::API::GLES : PICA::ShaderGen::API::GL;
+		const PICA::ShaderGen::DecompilerConfig decompilerConfig = {.accurateShaderMul = emulatorConfig->accurateShaderMul};
+
+		if (asyncShaderCompilation) {
+			entry.status = CompileStatus::Generating;
+			shaderCompileStats.pendingCompiles++;
+
+			// The PICA shader keeps changing under us while the worker is running, so give the worker its own copy
+			auto shader = std::make_shared<PICAShader>(shaderUnit.vs);
+
+			shaderCompileWorkers.submit([this, vertexConfig, shader, decompilerConfig, api]() {
+				std::string source =
+					PICA::ShaderGen::decompileShader(*shader, decompilerConfig, shader->entrypoint, api, PICA::ShaderGen::Language::GLSL);
+				if (!source.empty()) {
+					PICA::ShaderGen::FragmentGenerator generator(api, PICA::ShaderGen::Language::GLSL);
+					source = generator.getVertexShaderAccelerated(source, vertexConfig, false);
+				}
+
+				std::unique_lock lock(generatedShadersMutex);
+				generatedVertexShaders.emplace_back(vertexConfig, std::move(source));
+			});
+		} else {
+			const auto start = Clock::now();
+			std::string picaShaderSource =
+				PICA::ShaderGen::decompileShader(shaderUnit.vs, decompilerConfig, shaderUnit.vs.entrypoint, api, PICA::ShaderGen::Language::GLSL);
+
+			// Empty source means compilation error, if the source is not empty then we convert the recompiled PICA code into a valid shader and
+			// upload it to the GPU
+			if (!picaShaderSource.empty()) {
+				std::string vertexShaderSource = fragShaderGen.getVertexShaderAccelerated(picaShaderSource, vertexConfig, false);
+				entry.shader.create({vertexShaderSource}, OpenGL::Vertex);
+			}
+
+			shaderCompileStats.finishedCompiles++;
+			shaderCompileStats.failedCompiles += entry.shader.exists() ? 0 : 1;
+			shaderCompileStats.stallTimeMs += millisecondsSince(start);
+		}
+	}
+
+	if (entry.status != CompileStatus::Ready || !entry.shader.exists()) {
+		return nullptr;
 	}
 
-	return program;
+	return &entry.shader;
+}
+
+void RendererGL::compileShaderAsync(CachedShader& entry, const std::string& source, GLenum type) {
+	// Same as OpenGL::Shader::create, minus checking the compile status, which would force the driver to finish compiling
+	const GLuint handle = glCreateShader(type);
+	const GLchar* const sources[1] = {source.c_str()};
+
+	glShaderSource(handle, 1, sources, nullptr);
+	glCompileShader(handle);
+
+	entry.shader.m_handle = handle;
+	entry.status = CompileStatus::Compiling;
+	shaderCache.compilingShaders.push_back(&entry);
+}
+
+void RendererGL::pollAsyncShaders() {
+	if (shaderCompileStats.pendingCompiles == 0) {
+		return;
+	}
+
+	const auto start = Clock::now();
+	decltype(generatedVertexShaders) vertexShaders;
+	decltype(generatedFragmentShaders) fragmentShaders;
+	{
+		std::unique_lock lock(generatedShadersMutex);
+		vertexShaders.swap(generatedVertexShaders);
+		fragmentShaders.swap(generatedFragmentShaders);
+	}
+
+	const auto finish = [this](CompileStatus& status, bool success) {
+		status = CompileStatus::Ready;
+		shaderCompileStats.pendingCompiles--;
+		shaderCompileStats.finishedCompiles++;
+		shaderCompileStats.failedCompiles += success ? 0 : 1;
+	};
+
+	const auto startCompiling = [&](auto& cache, auto& generated, GLenum type) {
+		for (auto& [config, source] : generated) {
+			auto it = cache.find(config);
+			// Skip shaders that were thrown away while they were being generated, eg because the emulator got reset
+			if (it == cache.end() || it->second.status != CompileStatus::Generating) {
+				continue;
+			}
+
+			if (source.empty()) {
+				finish(it->second.status, false);
+			} else {
+				compileShaderAsync(it->second, source, type);
+			}
+		}
+	};
+
+	startCompiling(shaderCache.vertexShaderCache, vertexShaders, GL_VERTEX_SHADER);
+	startCompiling(shaderCache.fragmentShaderCache, fragmentShaders, GL_FRAGMENT_SHADER);
+
+	// Without parallel shader compilation, there's no way to check if the driver is done without blocking, so we just wait for it
+	const bool canPoll = driverInfo.supportsParallelShaderCompile;
+
+	std::erase_if(shaderCache.compilingShaders, [&](CachedShader* entry) {
+		const GLuint handle = entry->shader.handle();
+		GLint status;
+
+		if (canPoll) {
+			glGetShaderiv(handle, GL_COMPLETION_STATUS_KHR, &status);
+			if (status == GL_FALSE) {
+				return false;
+			}
+		}
+
+		glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
+		if (status == GL_FALSE) {
+			char buf[4096];
+			glGetShaderInfoLog(handle, 4096, nullptr, buf);
+			fprintf(stderr, "Failed to compile shader\nError: %s\n", buf);
+			entry->shader.free();
+		}
+
+		finish(entry->status, status != GL_FALSE);
+		return true;
+	});
+
+	std::erase_if(shaderCache.linkingPrograms, [&](CachedProgram* entry) {
+		const GLuint handle = entry->program.handle();
+		GLint status;
+
+		if (canPoll) {
+			glGetProgramiv(handle, GL_COMPLETION_STATUS_KHR, &status);
+			if (status == GL_FALSE) {
+				return false;
+			}
+		}
+
+		glGetProgramiv(handle, GL_LINK_STATUS, &status);
+		if (status == GL_FALSE) {
+			char buf[4096];
+			glGetProgramInfoLog(handle, 4096, nullptr, buf);
+			fprintf(stderr, "Failed to link program\nError: %s\n", buf);
+			entry->program.free();
+		} else {
+			setupSpecializedProgram(entry->program, entry->usesHwVertexShader);
+		}
+
+		finish(entry->status, status != GL_FALSE);
+		return true;
+	});
+
+	shaderCompileStats.stallTimeMs += millisecondsSince(start);
 }
 
 bool RendererGL::prepareForDraw(ShaderUnit& shaderUnit, PICA::DrawAcceleration* accel) {
+	// Invalidate state derived from the fragment pipeline registers if any of them changed since the last draw
+	if (const u32 dirtyGroups = gpu.getDirtyRegGroups() & PICA::DirtyRegs::Fragment; dirtyGroups != 0) {
+		fsConfig = std::nullopt;
+		ubershaderDirtyGroups |= dirtyGroups;
+		fragmentUniformDirtyGroups |= dirtyGroups;
+	}
+
+	// Pick up any specialized shaders that finished compiling in the background
+	if (asyncShaderCompilation) {
+		pollAsyncShaders();
+	}
+
 	// First we figure out if we will be using an ubershader
 	bool usingUbershader = emulatorConfig->useUbershaders;
 	if (usingUbershader) {
@@ -1057,57 +1386,26 @@ bool RendererGL::prepareForDraw(ShaderUnit& shaderUnit, PICA::DrawAcceleration*
 	usingAcceleratedShader = emulatorConfig->accelerateShaders && !usingUbershader && accel != nullptr && accel->canBeAccelerated;
 
 	if (usingAcceleratedShader) {
-		PICA::VertConfig vertexConfig(shaderUnit.vs, regs, usingUbershader);
-
-		std::optional<OpenGL::Shader>& shader = shaderCache.vertexShaderCache[vertexConfig];
-		// If the optional is false, we have never tried to recompile the shader before. Try to recompile it and see if it works.
-		if (!shader.has_value()) {
-			// Initialize shader to a "null" shader (handle == 0)
-			shader = OpenGL::Shader();
-
-			std::string picaShaderSource = PICA::ShaderGen::decompileShader(
-				shaderUnit.vs, *emulatorConfig, shaderUnit.vs.entrypoint,
-				driverInfo.usingGLES ? PICA::ShaderGen::API::GLES : PICA::ShaderGen::API::GL, PICA::ShaderGen::Language::GLSL
-			);
+		generatedVertexShader = getAcceleratedVertexShader(shaderUnit);
+		// Shader generation did not work out or isn't done yet, so set usingAcceleratedShader to false
+		usingAcceleratedShader = generatedVertexShader != nullptr;
+	}
 
-			// Empty source means compilation error, if the source is not empty then we convert the recompiled PICA code into a valid shader and
-			// upload it to the GPU
-			if (!picaShaderSource.empty()) {
-				std::string vertexShaderSource = fragShaderGen.getVertexShaderAccelerated(picaShaderSource, vertexConfig, usingUbershader);
-				shader->create({vertexShaderSource}, OpenGL::Vertex);
-			}
-		}
+	if (!usingUbershader) {
+		OpenGL::Program* program = getSpecializedShader();
 
-		// Shader generation did not work out, so set usingAcceleratedShader to false
-		if (!shader->exists()) {
-			usingAcceleratedShader = false;
+		if (program != nullptr) {
+			gl.useProgram(*program);
 		} else {
-			generatedVertexShader = &(*shader);
-			hwShaderUniformUBO->Bind();
-
-			// Upload shader uniforms to our UBO
-			if (shaderUnit.vs.uniformsDirty) {
-				shaderUnit.vs.uniformsDirty = false;
-				auto uboRes = hwShaderUniformUBO->Map(driverInfo.uboAlignment, PICAShader::totalUniformSize());
-				std::memcpy(uboRes.pointer, shaderUnit.vs.getUniformPointer(), PICAShader::totalUniformSize());
-				hwShaderUniformUBO->Unmap(PICAShader::totalUniformSize());
-
-				hwShaderUniformUBOOffset = uboRes.buffer_offset;
-			}
-
-			performIndexedRender = accel->indexed;
-			minimumIndex = GLsizei(accel->minimumIndex);
-			maximumIndex = GLsizei(accel->maximumIndex);
-
-			// Upload vertex data and index buffer data to our GPU
-			accelerateVertexUpload(shaderUnit, accel);
+			// The specialized program is still being compiled, so render with the ubershader until it's ready.
+			// The ubershader doesn't support accelerated vertex shaders yet, so run the vertex shader on the CPU in the meantime
+			usingUbershader = true;
+			usingAcceleratedShader = false;
+			shaderCompileStats.fallbackDraws++;
 		}
 	}
 
-	if (!usingUbershader) {
-		OpenGL::Program& program = getSpecializedShader();
-		gl.useProgram(program);
-	} else {  // Bind ubershader & load ubershader uniforms
+	if (usingUbershader) {  // Bind ubershader & load ubershader uniforms
 		gl.useProgram(triangleProgram);
 
 		const float depthScale = f24::fromRaw(regs[PICA::InternalRegs::DepthScale] & 0xffffff).toFloat32();
@@ -1129,10 +1427,38 @@ bool RendererGL::prepareForDraw(ShaderUnit& shaderUnit, PICA::DrawAcceleration*
 			glUniform1i(ubershaderData.depthmapEnableLoc, depthMapEnable);
 		}
 
-		// Upload PICA Registers as a single uniform. The shader needs access to the rasterizer registers (for depth, starting from index 0x48)
-		// The texturing and the fragment lighting registers. Therefore we upload them all in one go to avoid multiple slow uniform updates
-		glUniform1uiv(ubershaderData.picaRegLoc, 0x200 - 0x48, &regs[0x48]);
-		setupUbershaderTexEnv();
+		uploadUbershaderRegs();
+	}
+
+	if (usingAcceleratedShader) {
+		hwShaderUniformUBO->Bind();
+
+		// Upload shader uniforms to our UBO
+		if (shaderUnit.vs.uniformsDirty) {
+			shaderUnit.vs.uniformsDirty = false;
+			auto uboRes = hwShaderUniformUBO->Map(driverInfo.uboAlignment, PICAShader::totalUniformSize());
+			std::memcpy(uboRes.pointer, shaderUnit.vs.getUniformPointer(), PICAShader::totalUniformSize());
+			hwShaderUniformUBO->Unmap(PICAShader::totalUniformSize());
+
+			hwShaderUniformUBOOffset = uboRes.buffer_offset;
+			hwShaderUBOBound = false;
+			uniformStats.bytesUploaded += PICAShader::totalUniformSize();
+		}
+
+		if (!hwShaderUBOBound) {
+			hwShaderUBOBound = true;
+			glBindBufferRange(
+				GL_UNIFORM_BUFFER, vsUBOBlockBinding, hwShaderUniformUBO->GetGLBufferId(), hwShaderUniformUBOOffset,
+				PICAShader::totalUniformSize()
+			);
+		}
+
+		performIndexedRender = accel->indexed;
+		minimumIndex = GLsizei(accel->minimumIndex);
+		maximumIndex = GLsizei(accel->maximumIndex);
+
+		// Upload vertex data and index buffer data to our GPU
+		accelerateVertexUpload(shaderUnit, accel);
 	}
 
 	return usingAcceleratedShader;
@@ -1168,7 +1494,12 @@ void RendererGL::deinitGraphicsContext() {
 	textureCache.reset();
 	depthBufferCache.reset();
 	colourBufferCache.reset();
+
+	shaderCompileWorkers.stop();
+	generatedVertexShaders.clear();
+	generatedFragmentShaders.clear();
 	shaderCache.clear();
+	shaderCompileStats.pendingCompiles = 0;
 
 	// All other GL objects should be invalidated automatically and be recreated by the next call to initGraphicsContext
 	// TODO: Make it so that depth and colour buffers get written back to 3DS memory
@@ -1199,6 +1530,8 @@ void RendererGL::setUbershader(const std::string& shader) {
 
 void RendererGL::initUbershader(OpenGL::Program& program) {
 	gl.useProgram(program);
+	// Newly created programs need all their register uniforms uploaded
+	ubershaderDirtyGroups = PICA::DirtyRegs::Fragment;
 
 	ubershaderData.textureEnvSourceLoc = OpenGL::uniformLocation(program, "u_textureEnvSource");
 	ubershaderData.textureEnvOperandLoc = OpenGL::uniformLocation(program, "u_textureEnvOperand");
@@ -1210,6 +1543,10 @@ void RendererGL::initUbershader(OpenGL::Program& program) {
 	ubershaderData.depthOffsetLoc = OpenGL::uniformLocation(program, "u_depthOffset");
 	ubershaderData.depthmapEnableLoc = OpenGL::uniformLocation(program, "u_depthmapEnable");
 	ubershaderData.picaRegLoc = OpenGL::uniformLocation(program, "u_picaRegs");
+	for (usize i = 0; i < ubershaderRegGroups.size(); i++) {
+		const std::string name = fmt::format("u_picaRegs[{}]", ubershaderRegGroups[i].firstReg - ubershaderRegBase);
+		ubershaderData.picaRegGroupLocs[i] = OpenGL::uniformLocation(program, name.c_str());
+	}
 
 	// Init sampler objects. Texture 0 goes in texture unit 0, texture 1 in TU 1, texture 2 in TU 2 and the LUTs go in TU 3
 	glUniform1i(OpenGL::uniformLocation(program, "u_tex0"), 0);
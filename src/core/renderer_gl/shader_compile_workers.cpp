@@ -0,0 +1,65 @@
+#include "renderer_gl/shader_compile_workers.hpp"
+
+#include <algorithm>
+
+void ShaderCompileWorkers::start(usize threadCount) {
+	stop();
+
+	if (threadCount == 0) {
+		// Leave most cores to the emulator, GPU and audio threads. Shader generation is rare enough that a couple of workers are plenty
+		threadCount = std::clamp<usize>(std::thread::hardware_concurrency() / 4, 1, 4);
+	}
+
+	exiting = false;
+	for (usize i = 0; i < threadCount; i++) {
+		threads.emplace_back(&ShaderCompileWorkers::threadLoop, this);
+	}
+}
+
+void ShaderCompileWorkers::stop() {
+	if (threads.empty()) {
+		return;
+	}
+
+	{
+		std::unique_lock lock(mutex);
+		exiting = true;
+		jobs.clear();
+	}
+
+	wakeup.notify_all();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	threads.clear();
+}
+
+void ShaderCompileWorkers::submit(Job job) {
+	{
+		std::unique_lock lock(mutex);
+		jobs.push_back(std::move(job));
+	}
+
+	wakeup.notify_one();
+}
+
+void ShaderCompileWorkers::threadLoop() {
+	while (true) {
+		Job job;
+
+		{
+			std::unique_lock lock(mutex);
+			wakeup.wait(lock, [this]() { return exiting || !jobs.empty(); });
+
+			if (exiting) {
+				return;
+			}
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		job();
+	}
+}
@@ -1,10 +1,15 @@
 #include "renderer_vk/renderer_vk.hpp"
 
+#include <stb_image_write.h>
+
+#include <algorithm>
 #include <cmrc/cmrc.hpp>
+#include <cstring>
 #include <limits>
 #include <span>
 #include <unordered_set>
 
+#include "PICA/gpu.hpp"
 #include "SDL_vulkan.h"
 #include "helpers.hpp"
 #include "renderer_vk/vk_debug.hpp"
@@ -267,6 +272,7 @@ RendererVK::Texture& RendererVK::getColorRenderTexture(u32 addr, PICA::ColorFmt
 	newTexture.loc = addr;
 	newTexture.sizePerPixel = PICA::sizePerPixel(format);
 	newTexture.size = {width, height};
+	newTexture.colorFormat = format;
 
 	newTexture.format = Vulkan::colorFormatToVulkan(format);
 
@@ -1530,7 +1536,116 @@ void RendererVK::displayTransfer(u32 inputAddr, u32 outputAddr, u32 inputSize, u
 	);
 }
 
-void RendererVK::textureCopy(u32 inputAddr, u32 outputAddr, u32 totalBytes, u32 inputSize, u32 outputSize, u32 flags) {}
+void RendererVK::textureCopy(u32 inputAddr, u32 outputAddr, u32 totalBytes, u32 inputSize, u32 outputSize, u32 flags) {
+	// Texture copy size is aligned to 16 byte units
+	const u32 copySize = totalBytes & ~0xf;
+	if (copySize == 0) {
+		printf("TextureCopy total bytes less than 16!\n");
+		return;
+	}
+
+	// The width and gap are provided in 16-byte units.
+	const u32 inputWidth = (inputSize & 0xffff) << 4;
+	const u32 inputGap = (inputSize >> 16) << 4;
+	const u32 outputWidth = (outputSize & 0xffff) << 4;
+	const u32 outputGap = (outputSize >> 16) << 4;
+
+	if (inputWidth != outputWidth || inputWidth == 0) {
+		doSoftwareTextureCopy(inputAddr, outputAddr, copySize, inputWidth, inputGap, outputWidth, outputGap);
+		return;
+	}
+
+	// Texture copy is a raw data copy, so we don't know the format or tiling of the surfaces involved. Same as the GL renderer, we assume the
+	// common case of a tiled surface, where inputWidth is the width of a row of 8x8 tiles in bytes.
+	// If the source isn't a colour render-texture we know about, its data lives in emulated memory and we copy it on the CPU instead.
+	Texture* srcFramebuffer = findRenderTexture(inputAddr);
+	if (!srcFramebuffer || *vk::componentName(srcFramebuffer->format, 0) == 'D') {
+		doSoftwareTextureCopy(inputAddr, outputAddr, copySize, inputWidth, inputGap, outputWidth, outputGap);
+		return;
+	}
+
+	const u32 bpp = srcFramebuffer->sizePerPixel;
+	const u32 copyWidth = inputWidth / (8 * bpp);
+	// inputHeight/outputHeight are typically zero, so compute the height from the number of tile rows that are copied
+	const u32 copyHeight = (copySize / inputWidth) * 8;
+
+	if (copyWidth == 0 || copyHeight == 0) {
+		doSoftwareTextureCopy(inputAddr, outputAddr, copySize, inputWidth, inputGap, outputWidth, outputGap);
+		return;
+	}
+
+	const Math::Rect<u32> srcRect = srcFramebuffer->getSubRect(inputAddr, copyWidth, copyHeight);
+	if (srcRect.right > srcFramebuffer->size[0] || srcRect.bottom > srcFramebuffer->size[1]) {
+		doSoftwareTextureCopy(inputAddr, outputAddr, copySize, inputWidth, inputGap, outputWidth, outputGap);
+		return;
+	}
+
+	// Assume the destination surface has the same format as the source, otherwise a raw copy between them doesn't make sense
+	Texture& destFramebuffer = getColorRenderTexture(outputAddr, srcFramebuffer->colorFormat, copyWidth, copyHeight);
+	const Math::Rect<u32> destRect = destFramebuffer.getSubRect(outputAddr, copyWidth, copyHeight);
+
+	// Copying a surface onto itself needs the General layout, which isn't worth handling for the rare game that does this
+	if (destFramebuffer.image.get() == srcFramebuffer->image.get()) {
+		doSoftwareTextureCopy(inputAddr, outputAddr, copySize, inputWidth, inputGap, outputWidth, outputGap);
+		return;
+	}
+
+	const vk::CommandBuffer& copyCommandBuffer = getCurrentCommandBuffer();
+
+	static const std::array<float, 4> textureCopyColor = {{0.0f, 1.0f, 1.0f, 1.0f}};
+	Vulkan::DebugLabelScope scope(
+		copyCommandBuffer, textureCopyColor,
+		"TextureCopy inputAddr 0x%08X outputAddr 0x%08X totalBytes %d inputWidth %d inputGap %d outputWidth %d outputGap %d", inputAddr, outputAddr,
+		totalBytes, inputWidth, inputGap, outputWidth, outputGap
+	);
+
+	copyCommandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {}, {},
+		{
+			vk::ImageMemoryBarrier(
+				vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferRead, vk::ImageLayout::eShaderReadOnlyOptimal,
+				vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcFramebuffer->image.get(),
+				vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1)
+			),
+			vk::ImageMemoryBarrier(
+				vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eShaderReadOnlyOptimal,
+				vk::ImageLayout::eTransferDstOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, destFramebuffer.image.get(),
+				vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1)
+			),
+		}
+	);
+
+	// Both surfaces have the same format, so this is a straight copy without any filtering
+	const vk::ImageCopy copyRegion(
+		vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1), vk::Offset3D{(int)srcRect.left, (int)srcRect.top, 0},
+		vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1), vk::Offset3D{(int)destRect.left, (int)destRect.top, 0},
+		vk::Extent3D{
+			std::min(copyWidth, destFramebuffer.size[0] - std::min(destRect.left, destFramebuffer.size[0])),
+			std::min(copyHeight, destFramebuffer.size[1] - std::min(destRect.top, destFramebuffer.size[1])), 1
+		}
+	);
+
+	copyCommandBuffer.copyImage(
+		srcFramebuffer->image.get(), vk::ImageLayout::eTransferSrcOptimal, destFramebuffer.image.get(), vk::ImageLayout::eTransferDstOptimal,
+		{copyRegion}
+	);
+
+	copyCommandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllGraphics, vk::DependencyFlags(), {}, {},
+		{
+			vk::ImageMemoryBarrier(
+				vk::AccessFlagBits::eTransferRead, vk::AccessFlagBits::eColorAttachmentWrite, vk::ImageLayout::eTransferSrcOptimal,
+				vk::ImageLayout::eShaderReadOnlyOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, srcFramebuffer->image.get(),
+				vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1)
+			),
+			vk::ImageMemoryBarrier(
+				vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eColorAttachmentWrite, vk::ImageLayout::eTransferDstOptimal,
+				vk::ImageLayout::eShaderReadOnlyOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, destFramebuffer.image.get(),
+				vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1)
+			),
+		}
+	);
+}
 
 void RendererVK::drawVertices(PICA::PrimType primType, std::span<const PICA::Vertex> vertices) {
 	using namespace Helpers;
@@ -1591,12 +1706,196 @@ void RendererVK::drawVertices(PICA::PrimType primType, std::span<const PICA::Ver
 	commandBuffer.endRenderPass();
 }
 
-void RendererVK::screenshot(const std::string& name) {}
+void RendererVK::flushCommandBuffer() {
+	const vk::CommandBuffer& commandBuffer = getCurrentCommandBuffer();
+
+	if (const vk::Result endResult = commandBuffer.end(); endResult != vk::Result::eSuccess) {
+		Helpers::panic("Error ending command buffer recording: %s\n", vk::to_string(endResult).c_str());
+	}
+
+	vk::SubmitInfo submitInfo = {};
+	submitInfo.setCommandBuffers(commandBuffer);
+
+	// The fence of the current frame is signaled at this point (display() waited on it before we started recording), so we can borrow it
+	device->resetFences({frameFinishedFences[frameBufferingIndex].get()});
+
+	if (const vk::Result submitResult = graphicsQueue.submit({submitInfo}, frameFinishedFences[frameBufferingIndex].get());
+		submitResult != vk::Result::eSuccess) {
+		Helpers::panic("Error submitting to graphics queue: %s\n", vk::to_string(submitResult).c_str());
+	}
+
+	if (auto waitResult = device->waitForFences({frameFinishedFences[frameBufferingIndex].get()}, true, std::numeric_limits<u64>::max());
+		waitResult != vk::Result::eSuccess) {
+		Helpers::panic("Error waiting on command buffer fence: %s\n", vk::to_string(waitResult).c_str());
+	}
+
+	frameFramebuffers[frameBufferingIndex].clear();
+	commandBuffer.reset();
+
+	vk::CommandBufferBeginInfo beginInfo = {};
+	beginInfo.flags = vk::CommandBufferUsageFlagBits::eSimultaneousUse;
+
+	if (const vk::Result beginResult = commandBuffer.begin(beginInfo); beginResult != vk::Result::eSuccess) {
+		Helpers::panic("Error beginning command buffer recording: %s\n", vk::to_string(beginResult).c_str());
+	}
+}
+
+std::vector<u8> RendererVK::readbackImage(vk::Image image, u32 width, u32 height, usize bytesPerPixel) {
+	const usize readbackSize = usize(width) * height * bytesPerPixel;
+
+	vk::BufferCreateInfo bufferInfo = {};
+	bufferInfo.size = readbackSize;
+	bufferInfo.usage = vk::BufferUsageFlagBits::eTransferDst;
+	bufferInfo.sharingMode = vk::SharingMode::eExclusive;
+
+	vk::UniqueBuffer readbackBuffer;
+	if (auto createResult = device->createBufferUnique(bufferInfo); createResult.result == vk::Result::eSuccess) {
+		readbackBuffer = std::move(createResult.value);
+	} else {
+		Helpers::panic("Error creating readback buffer: %s\n", vk::to_string(createResult.result).c_str());
+	}
+
+	vk::UniqueDeviceMemory readbackMemory;
+	if (auto [result, bufferMemory] = Vulkan::commitBufferHeap(
+			device.get(), physicalDevice, {&readbackBuffer.get(), 1}, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+		);
+		result == vk::Result::eSuccess) {
+		readbackMemory = std::move(bufferMemory);
+	} else {
+		Helpers::panic("Error allocating readback buffer memory: %s\n", vk::to_string(result).c_str());
+	}
+
+	const vk::CommandBuffer& commandBuffer = getCurrentCommandBuffer();
+
+	commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {}, {},
+		{
+			// image: ShaderReadOnlyOptimal -> TransferSrc
+			vk::ImageMemoryBarrier(
+				vk::AccessFlagBits::eColorAttachmentWrite, vk::AccessFlagBits::eTransferRead, vk::ImageLayout::eShaderReadOnlyOptimal,
+				vk::ImageLayout::eTransferSrcOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image,
+				vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1)
+			),
+		}
+	);
+
+	const vk::BufferImageCopy copyRegion(
+		0, 0, 0, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1), vk::Offset3D{}, vk::Extent3D{width, height, 1}
+	);
+	commandBuffer.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, readbackBuffer.get(), {copyRegion});
+
+	commandBuffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllGraphics | vk::PipelineStageFlagBits::eHost, vk::DependencyFlags(), {},
+		{
+			// readbackBuffer: Make the copy visible to the host
+			vk::BufferMemoryBarrier(
+				vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+				readbackBuffer.get(), 0, VK_WHOLE_SIZE
+			),
+		},
+		{
+			// image: TransferSrc -> ShaderReadOnlyOptimal
+			vk::ImageMemoryBarrier(
+				vk::AccessFlagBits::eTransferRead, vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eTransferSrcOptimal,
+				vk::ImageLayout::eShaderReadOnlyOptimal, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, image,
+				vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1)
+			),
+		}
+	);
+
+	flushCommandBuffer();
+
+	std::vector<u8> pixels(readbackSize);
+	if (auto mapResult = device->mapMemory(readbackMemory.get(), 0, readbackSize); mapResult.result == vk::Result::eSuccess) {
+		std::memcpy(pixels.data(), mapResult.value, readbackSize);
+		device->unmapMemory(readbackMemory.get());
+	} else {
+		Helpers::panic("Error mapping readback buffer memory: %s\n", vk::to_string(mapResult.result).c_str());
+	}
+
+	return pixels;
+}
+
+void RendererVK::writebackRenderTextures() {
+	static constexpr u32 xOffsets[] = {0, 1, 4, 5, 16, 17, 20, 21};
+	static constexpr u32 yOffsets[] = {0, 2, 8, 10, 32, 34, 40, 42};
+
+	for (auto& [hash, texture] : textureCache) {
+		// Depth and stencil surfaces are never read back by the CPU in practice, so only colour surfaces are written back
+		if (*vk::componentName(texture.format, 0) == 'D') {
+			continue;
+		}
+
+		const u32 width = texture.size[0];
+		const u32 height = texture.size[1];
+		// RGB8 surfaces are backed by an RGBA8 image, so the host pixel size can differ from the PICA one
+		const usize hostBpp = vk::blockSize(texture.format);
+		const u32 guestBpp = texture.sizePerPixel;
+
+		u8* dest = gpu.getPointerPhys<u8>(texture.loc, width * height * guestBpp);
+		if (dest == nullptr) {
+			continue;
+		}
+
+		const std::vector<u8> pixels = readbackImage(texture.image.get(), width, height, hostBpp);
+
+		for (u32 y = 0; y < height; y++) {
+			for (u32 x = 0; x < width; x++) {
+				// Offset of the 8x8 tile the pixel belongs to, plus the Morton-order offset inside the tile
+				const u32 swizzledPixel = ((x & ~7) * 8) + ((y & ~7) * width) + xOffsets[x & 7] + yOffsets[y & 7];
+				const u8* source = &pixels[(usize(y) * width + x) * hostBpp];
+				u8* pixel = dest + swizzledPixel * guestBpp;
+
+				switch (texture.colorFormat) {
+					// PICA stores these as ABGR and BGR bytes respectively
+					case PICA::ColorFmt::RGBA8:
+						pixel[0] = source[3];
+						pixel[1] = source[2];
+						pixel[2] = source[1];
+						pixel[3] = source[0];
+						break;
+
+					case PICA::ColorFmt::RGB8:
+						pixel[0] = source[2];
+						pixel[1] = source[1];
+						pixel[2] = source[0];
+						break;
+
+					// The packed 16-bit Vulkan formats have the same bit layout as the PICA ones
+					default: std::memcpy(pixel, source, 2); break;
+				}
+			}
+		}
+	}
+}
+
+void RendererVK::screenshot(const std::string& name) {
+	constexpr u32 width = 400;
+	constexpr u32 height = 2 * 240;
+
+	if (screenTexture.empty()) {
+		return;
+	}
+
+	// Read back the screen texture of the frame that was last presented. It's RGBA8 with a top-left origin, so it can be written out as-is
+	const u64 lastFrameIndex = (frameBufferingIndex + frameBufferingCount - 1) % frameBufferingCount;
+	std::vector<u8> pixels = readbackImage(screenTexture[lastFrameIndex].get(), width, height, 4);
+
+	// Set alpha to 0xFF
+	for (usize i = 3; i < pixels.size(); i += 4) {
+		pixels[i] = 0xFF;
+	}
+
+	stbi_write_png(name.c_str(), width, height, 4, pixels.data(), 0);
+}
 
 void RendererVK::deinitGraphicsContext() {
+	if (device) {
+		writebackRenderTextures();
+	}
+
 	// Invalidate the entire texture cache since they'll no longer be valid
 	textureCache.clear();
 
-	// TODO: Make it so that depth and colour buffers get written back to 3DS memory
 	printf("RendererVK::DeinitGraphicsContext called\n");
 }
@@ -47,113 +47,114 @@ void APTService::reset() {
 }
 
 void APTService::handleSyncRequest(u32 messagePointer) {
-	const u32 command = mem.read32(messagePointer);
+	IPC::Message message(mem, messagePointer);
+	const u32 command = message.header();
 	switch (command) {
-		case APTCommands::AppletUtility: appletUtility(messagePointer); break;
-		case APTCommands::CheckNew3DS: checkNew3DS(messagePointer); break;
-		case APTCommands::CheckNew3DSApp: checkNew3DSApp(messagePointer); break;
-		case APTCommands::Enable: enable(messagePointer); break;
-		case APTCommands::GetAppletInfo: getAppletInfo(messagePointer); break;
-		case APTCommands::GetSharedFont: getSharedFont(messagePointer); break;
-		case APTCommands::Initialize: initialize(messagePointer); break;
-		case APTCommands::InquireNotification: [[likely]] inquireNotification(messagePointer); break;
-		case APTCommands::IsRegistered: isRegistered(messagePointer); break;
-		case APTCommands::GetApplicationCpuTimeLimit: getApplicationCpuTimeLimit(messagePointer); break;
-		case APTCommands::GetLockHandle: getLockHandle(messagePointer); break;
-		case APTCommands::GetWirelessRebootInfo: getWirelessRebootInfo(messagePointer); break;
-		case APTCommands::GlanceParameter: glanceParameter(messagePointer); break;
-		case APTCommands::NotifyToWait: notifyToWait(messagePointer); break;
-		case APTCommands::PreloadLibraryApplet: preloadLibraryApplet(messagePointer); break;
-		case APTCommands::PrepareToStartLibraryApplet: prepareToStartLibraryApplet(messagePointer); break;
-		case APTCommands::StartLibraryApplet: startLibraryApplet(messagePointer); break;
-		case APTCommands::ReceiveParameter: [[likely]] receiveParameter(messagePointer); break;
-		case APTCommands::ReplySleepQuery: replySleepQuery(messagePointer); break;
-		case APTCommands::SetApplicationCpuTimeLimit: setApplicationCpuTimeLimit(messagePointer); break;
-		case APTCommands::SendParameter: sendParameter(messagePointer); break;
-		case APTCommands::SetScreencapPostPermission: setScreencapPostPermission(messagePointer); break;
-		case APTCommands::TheSmashBrosFunction: theSmashBrosFunction(messagePointer); break;
+		case APTCommands::AppletUtility: appletUtility(message); break;
+		case APTCommands::CheckNew3DS: checkNew3DS(message); break;
+		case APTCommands::CheckNew3DSApp: checkNew3DSApp(message); break;
+		case APTCommands::Enable: enable(message); break;
+		case APTCommands::GetAppletInfo: getAppletInfo(message); break;
+		case APTCommands::GetSharedFont: getSharedFont(message); break;
+		case APTCommands::Initialize: initialize(message); break;
+		case APTCommands::InquireNotification: [[likely]] inquireNotification(message); break;
+		case APTCommands::IsRegistered: isRegistered(message); break;
+		case APTCommands::GetApplicationCpuTimeLimit: getApplicationCpuTimeLimit(message); break;
+		case APTCommands::GetLockHandle: getLockHandle(message); break;
+		case APTCommands::GetWirelessRebootInfo: getWirelessRebootInfo(message); break;
+		case APTCommands::GlanceParameter: glanceParameter(message); break;
+		case APTCommands::NotifyToWait: notifyToWait(message); break;
+		case APTCommands::PreloadLibraryApplet: preloadLibraryApplet(message); break;
+		case APTCommands::PrepareToStartLibraryApplet: prepareToStartLibraryApplet(message); break;
+		case APTCommands::StartLibraryApplet: startLibraryApplet(message); break;
+		case APTCommands::ReceiveParameter: [[likely]] receiveParameter(message); break;
+		case APTCommands::ReplySleepQuery: replySleepQuery(message); break;
+		case APTCommands::SetApplicationCpuTimeLimit: setApplicationCpuTimeLimit(message); break;
+		case APTCommands::SendParameter: sendParameter(message); break;
+		case APTCommands::SetScreencapPostPermission: setScreencapPostPermission(message); break;
+		case APTCommands::TheSmashBrosFunction: theSmashBrosFunction(message); break;
 		default:
 			Helpers::panicDev("APT service requested. Command: %08X\n", command);
-			mem.write32(messagePointer + 4, Result::Success);
+			message.write32(1, Result::Success);
 			break;
 	}
 }
 
-void APTService::appletUtility(u32 messagePointer) {
-	u32 utility = mem.read32(messagePointer + 4);
-	u32 inputSize = mem.read32(messagePointer + 8);
-	u32 outputSize = mem.read32(messagePointer + 12);
-	u32 inputPointer = mem.read32(messagePointer + 20);
+void APTService::appletUtility(IPC::Message message) {
+	u32 utility = message.read32(1);
+	u32 inputSize = message.read32(2);
+	u32 outputSize = message.read32(3);
+	u32 inputPointer = message.readStaticBuffer(4).address;
 
 	log("APT::AppletUtility(utility = %d, input size = %x, output size = %x, inputPointer = %08X)\n", utility, inputSize, outputSize, inputPointer);
 
 	std::vector<u8> out(outputSize);
-	const u32 outputBuffer = mem.read32(messagePointer + 0x104);
+	const u32 outputBuffer = message.getReceiveBuffer(0).address;
 
 	if (outputSize >= 1 && utility == 6) {
 		// TryLockTransition expects a bool indicating success in the output buffer. Set it to true to avoid games panicking (Thanks to Citra)
 		out[0] = true;
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x4B, 2, 2));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write32(messagePointer + 8, Result::Success);
+	message.respond(0x4B, 2, 2);
+	message.write32(1, Result::Success);
+	message.write32(2, Result::Success);
 
 	for (u32 i = 0; i < outputSize; i++) {
 		mem.write8(outputBuffer + i, out[i]);
 	}
 }
 
-void APTService::getAppletInfo(u32 messagePointer) {
-	const u32 appID = mem.read32(messagePointer + 4);
+void APTService::getAppletInfo(IPC::Message message) {
+	const u32 appID = message.read32(1);
 	Helpers::warn("APT::GetAppletInfo (appID = %X)\n", appID);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x06, 7, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x06, 7, 0);
+	message.write32(1, Result::Success);
 
-	mem.write8(messagePointer + 20, 1);  // 1 = registered
-	mem.write8(messagePointer + 24, 1);  // 1 = loaded
+	message.write8(5, 1);  // 1 = registered
+	message.write8(6, 1);  // 1 = loaded
 
 	// TODO: The rest of this
 }
 
-void APTService::isRegistered(u32 messagePointer) {
-	const u32 appID = mem.read32(messagePointer + 4);
+void APTService::isRegistered(IPC::Message message) {
+	const u32 appID = message.read32(1);
 	Helpers::warn("APT::IsRegistered (appID = %X)", appID);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x09, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write8(messagePointer + 8, 1);  // Return that the app is always registered. This might break with home menu?
+	message.respond(0x09, 2, 0);
+	message.write32(1, Result::Success);
+	message.write8(2, 1);  // Return that the app is always registered. This might break with home menu?
 }
 
-void APTService::preloadLibraryApplet(u32 messagePointer) {
-	const u32 appID = mem.read32(messagePointer + 4);
+void APTService::preloadLibraryApplet(IPC::Message message) {
+	const u32 appID = message.read32(1);
 	log("APT::PreloadLibraryApplet (app ID = %X) (stubbed)\n", appID);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x16, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x16, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void APTService::prepareToStartLibraryApplet(u32 messagePointer) {
-	const u32 appID = mem.read32(messagePointer + 4);
+void APTService::prepareToStartLibraryApplet(IPC::Message message) {
+	const u32 appID = message.read32(1);
 	log("APT::PrepareToStartLibraryApplet (app ID = %X) (stubbed)\n", appID);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x16, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x16, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void APTService::startLibraryApplet(u32 messagePointer) {
-	const u32 appID = mem.read32(messagePointer + 4);
-	const u32 bufferSize = mem.read32(messagePointer + 8);
-	const Handle parameters = mem.read32(messagePointer + 16);
-	const u32 buffer = mem.read32(messagePointer + 24);
+void APTService::startLibraryApplet(IPC::Message message) {
+	const u32 appID = message.read32(1);
+	const u32 bufferSize = message.read32(2);
+	const Handle parameters = message.read32(4);
+	const u32 buffer = message.readStaticBuffer(5).address;
 	log("APT::StartLibraryApplet (app ID = %X)\n", appID);
 
 	Applets::AppletBase* destApplet = appletManager.getApplet(appID);
 	if (destApplet == nullptr) {
 		Helpers::warn("APT::StartLibraryApplet: Unimplemented dest applet ID");
-		mem.write32(messagePointer, IPC::responseHeader(0x1E, 1, 0));
-		mem.write32(messagePointer + 4, Result::Success);
+		message.respond(0x1E, 1, 0);
+		message.write32(1, Result::Success);
 	} else {
 		KernelObject* sharedMemObject = kernel.getObject(parameters);
 
@@ -170,30 +171,30 @@ void APTService::startLibraryApplet(u32 messagePointer) {
 			kernel.signalEvent(resumeEvent.value());
 		}
 
-		mem.write32(messagePointer, IPC::responseHeader(0x1E, 1, 0));
-		mem.write32(messagePointer + 4, result);
+		message.respond(0x1E, 1, 0);
+		message.write32(1, result);
 	}
 }
 
-void APTService::checkNew3DS(u32 messagePointer) {
+void APTService::checkNew3DS(IPC::Message message) {
 	log("APT::CheckNew3DS\n");
-	mem.write32(messagePointer, IPC::responseHeader(0x102, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write8(messagePointer + 8, (model == ConsoleModel::New3DS) ? 1 : 0);  // u8, Status (0 = Old 3DS, 1 = New 3DS)
+	message.respond(0x102, 2, 0);
+	message.write32(1, Result::Success);
+	message.write8(2, (model == ConsoleModel::New3DS) ? 1 : 0);  // u8, Status (0 = Old 3DS, 1 = New 3DS)
 }
 
 // TODO: Figure out the slight way this differs from APT::CheckNew3DS
-void APTService::checkNew3DSApp(u32 messagePointer) {
+void APTService::checkNew3DSApp(IPC::Message message) {
 	log("APT::CheckNew3DSApp\n");
-	mem.write32(messagePointer, IPC::responseHeader(0x101, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write8(messagePointer + 8, (model == ConsoleModel::New3DS) ? 1 : 0);  // u8, Status (0 = Old 3DS, 1 = New 3DS)
+	message.respond(0x101, 2, 0);
+	message.write32(1, Result::Success);
+	message.write8(2, (model == ConsoleModel::New3DS) ? 1 : 0);  // u8, Status (0 = Old 3DS, 1 = New 3DS)
 }
 
-void APTService::enable(u32 messagePointer) {
+void APTService::enable(IPC::Message message) {
 	log("APT::Enable\n");
-	mem.write32(messagePointer, IPC::responseHeader(0x3, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x3, 1, 0);
+	message.write32(1, Result::Success);
 
 	// Some apps like Home Menu and Game Notes seem to rely on resume event being triggered here. Doesn't seem to break anything, so
 	if (resumeEvent.has_value()) {
@@ -201,7 +202,7 @@ void APTService::enable(u32 messagePointer) {
 	}
 }
 
-void APTService::initialize(u32 messagePointer) {
+void APTService::initialize(IPC::Message message) {
 	log("APT::Initialize\n");
 
 	if (!notificationEvent.has_value() || !resumeEvent.has_value()) {
@@ -211,22 +212,22 @@ void APTService::initialize(u32 messagePointer) {
 		kernel.signalEvent(resumeEvent.value());  // Seems to be signalled on startup
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x2, 1, 3));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write32(messagePointer + 8, 0x04000000);                  // Translation descriptor
-	mem.write32(messagePointer + 12, notificationEvent.value());  // Notification Event Handle
-	mem.write32(messagePointer + 16, resumeEvent.value());        // Resume Event Handle
+	message.respond(0x2, 1, 3);
+	message.write32(1, Result::Success);
+	message.write32(2, IPC::copyHandleDescriptor(2));  // Translation descriptor
+	message.write32(3, notificationEvent.value());     // Notification Event Handle
+	message.write32(4, resumeEvent.value());           // Resume Event Handle
 }
 
-void APTService::inquireNotification(u32 messagePointer) {
+void APTService::inquireNotification(IPC::Message message) {
 	log("APT::InquireNotification\n");
 
-	mem.write32(messagePointer, IPC::responseHeader(0xB, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write32(messagePointer + 8, static_cast<u32>(NotificationType::None));
+	message.respond(0xB, 2, 0);
+	message.write32(1, Result::Success);
+	message.write32(2, static_cast<u32>(NotificationType::None));
 }
 
-void APTService::getLockHandle(u32 messagePointer) {
+void APTService::getLockHandle(IPC::Message message) {
 	log("APT::GetLockHandle\n");
 
 	// Create a lock handle if none exists
@@ -234,33 +235,33 @@ void APTService::getLockHandle(u32 messagePointer) {
 		lockHandle = kernel.makeMutex();
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x1, 3, 2));
-	mem.write32(messagePointer + 4, Result::Success);      // Result code
-	mem.write32(messagePointer + 8, 0);                    // AppletAttr
-	mem.write32(messagePointer + 12, 0);                   // APT State (bit0 = Power Button State, bit1 = Order To Close State)
-	mem.write32(messagePointer + 16, 0);                   // Translation descriptor
-	mem.write32(messagePointer + 20, lockHandle.value());  // Lock handle
+	message.respond(0x1, 3, 2);
+	message.write32(1, Result::Success);               // Result code
+	message.write32(2, 0);                             // AppletAttr
+	message.write32(3, 0);                             // APT State (bit0 = Power Button State, bit1 = Order To Close State)
+	message.write32(4, IPC::copyHandleDescriptor(1));  // Translation descriptor
+	message.write32(5, lockHandle.value());            // Lock handle
 }
 
 // This apparently does nothing on the original kernel either?
-void APTService::notifyToWait(u32 messagePointer) {
+void APTService::notifyToWait(IPC::Message message) {
 	log("APT::NotifyToWait\n");
-	mem.write32(messagePointer, IPC::responseHeader(0x43, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x43, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void APTService::sendParameter(u32 messagePointer) {
-	const u32 sourceAppID = mem.read32(messagePointer + 4);
-	const u32 destAppID = mem.read32(messagePointer + 8);
-	const u32 cmd = mem.read32(messagePointer + 12);
-	const u32 paramSize = mem.read32(messagePointer + 16);
+void APTService::sendParameter(IPC::Message message) {
+	const u32 sourceAppID = message.read32(1);
+	const u32 destAppID = message.read32(2);
+	const u32 cmd = message.read32(3);
+	const u32 paramSize = message.read32(4);
 
-	const u32 parameterHandle = mem.read32(messagePointer + 24);  // What dis?
-	const u32 parameterPointer = mem.read32(messagePointer + 32);
+	const u32 parameterHandle = message.read32(6);  // What dis?
+	const u32 parameterPointer = message.readStaticBuffer(7).address;
 	log("APT::SendParameter (source app = %X, dest app = %X, cmd = %X, size = %X)", sourceAppID, destAppID, cmd, paramSize);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x0C, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x0C, 1, 0);
+	message.write32(1, Result::Success);
 
 	if (sourceAppID != Applets::AppletIDs::Application) {
 		Helpers::warn("APT::SendParameter: Unimplemented source applet ID");
@@ -292,11 +293,11 @@ void APTService::sendParameter(u32 messagePointer) {
 	}
 }
 
-void APTService::receiveParameter(u32 messagePointer) {
-	const u32 app = mem.read32(messagePointer + 4);
-	const u32 size = mem.read32(messagePointer + 8);
-	// Parameter data pointer is in the thread static buffer, which starts 0x100 bytes after the command buffer
-	const u32 buffer = mem.read32(messagePointer + 0x100 + 4);
+void APTService::receiveParameter(IPC::Message message) {
+	const u32 app = message.read32(1);
+	const u32 size = message.read32(2);
+	// Parameter data goes to the static buffer the thread set up to receive it
+	const u32 buffer = message.getReceiveBuffer(0).address;
 	log("APT::ReceiveParameter(app ID = %X, size = %04X)\n", app, size);
 
 	if (size > 0x1000) {
@@ -304,17 +305,17 @@ void APTService::receiveParameter(u32 messagePointer) {
 	}
 	auto parameter = appletManager.receiveParameter();
 
-	mem.write32(messagePointer, IPC::responseHeader(0xD, 4, 4));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0xD, 4, 4);
+	message.write32(1, Result::Success);
 	// Sender App ID
-	mem.write32(messagePointer + 8, parameter.senderID);
+	message.write32(2, parameter.senderID);
 	// Command
-	mem.write32(messagePointer + 12, parameter.signal);
+	message.write32(3, parameter.signal);
 	// Size of parameter data
-	mem.write32(messagePointer + 16, parameter.data.size());
-	mem.write32(messagePointer + 20, 0x10);
-	mem.write32(messagePointer + 24, parameter.object);
-	mem.write32(messagePointer + 28, 0);
+	message.write32(4, parameter.data.size());
+	message.write32(5, IPC::moveHandleDescriptor(1));
+	message.write32(6, parameter.object);
+	message.write32(7, 0);
 
 	const u32 transferSize = std::min<u32>(size, parameter.data.size());
 	for (u32 i = 0; i < transferSize; i++) {
@@ -322,11 +323,11 @@ void APTService::receiveParameter(u32 messagePointer) {
 	}
 }
 
-void APTService::glanceParameter(u32 messagePointer) {
-	const u32 app = mem.read32(messagePointer + 4);
-	const u32 size = mem.read32(messagePointer + 8);
-	// Parameter data pointer is in the thread static buffer, which starts 0x100 bytes after the command buffer
-	const u32 buffer = mem.read32(messagePointer + 0x100 + 4);
+void APTService::glanceParameter(IPC::Message message) {
+	const u32 app = message.read32(1);
+	const u32 size = message.read32(2);
+	// Parameter data goes to the static buffer the thread set up to receive it
+	const u32 buffer = message.getReceiveBuffer(0).address;
 	log("APT::GlanceParameter(app ID = %X, size = %04X)\n", app, size);
 
 	if (size > 0x1000) {
@@ -335,17 +336,17 @@ void APTService::glanceParameter(u32 messagePointer) {
 	auto parameter = appletManager.glanceParameter();
 
 	// TODO: Properly implement this. We currently stub it similar
-	mem.write32(messagePointer, IPC::responseHeader(0xE, 4, 4));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0xE, 4, 4);
+	message.write32(1, Result::Success);
 	// Sender App ID
-	mem.write32(messagePointer + 8, parameter.senderID);
+	message.write32(2, parameter.senderID);
 	// Command
-	mem.write32(messagePointer + 12, parameter.signal);
+	message.write32(3, parameter.signal);
 	// Size of parameter data
-	mem.write32(messagePointer + 16, parameter.data.size());
-	mem.write32(messagePointer + 20, 0);
-	mem.write32(messagePointer + 24, parameter.object);
-	mem.write32(messagePointer + 28, 0);
+	message.write32(4, parameter.data.size());
+	message.write32(5, 0);
+	message.write32(6, parameter.object);
+	message.write32(7, 0);
 
 	const u32 transferSize = std::min<u32>(size, parameter.data.size());
 	for (u32 i = 0; i < transferSize; i++) {
@@ -353,77 +354,79 @@ void APTService::glanceParameter(u32 messagePointer) {
 	}
 }
 
-void APTService::replySleepQuery(u32 messagePointer) {
+void APTService::replySleepQuery(IPC::Message message) {
 	log("APT::ReplySleepQuery (Stubbed)\n");
-	mem.write32(messagePointer, IPC::responseHeader(0x3E, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x3E, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void APTService::setApplicationCpuTimeLimit(u32 messagePointer) {
-	u32 fixed = mem.read32(messagePointer + 4);       // MUST be 1.
-	u32 percentage = mem.read32(messagePointer + 8);  // CPU time percentage between 5% and 89%
+void APTService::setApplicationCpuTimeLimit(IPC::Message message) {
+	u32 fixed = message.read32(1);       // MUST be 1.
+	u32 percentage = message.read32(2);  // CPU time percentage between 5% and 89%
 	log("APT::SetApplicationCpuTimeLimit (percentage = %d%%)\n", percentage);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x4F, 1, 0));
+	message.respond(0x4F, 1, 0);
 
 	// If called with invalid parameters, the current time limit is left unchanged, and OS::NotImplemented is returned
 	if (percentage < 5 || percentage > 89 || fixed != 1) {
 		Helpers::warn("Invalid parameter passed to APT::SetApplicationCpuTimeLimit: (percentage, fixed) = (%d, %d)\n", percentage, fixed);
-		mem.write32(messagePointer + 4, Result::OS::NotImplemented);
+		message.write32(1, Result::OS::NotImplemented);
 	} else {
-		mem.write32(messagePointer + 4, Result::Success);
+		message.write32(1, Result::Success);
 		cpuTimeLimit = percentage;
 	}
 }
 
-void APTService::getApplicationCpuTimeLimit(u32 messagePointer) {
+void APTService::getApplicationCpuTimeLimit(IPC::Message message) {
 	log("APT::GetApplicationCpuTimeLimit\n");
-	mem.write32(messagePointer, IPC::responseHeader(0x50, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write32(messagePointer + 8, cpuTimeLimit);
+	message.respond(0x50, 2, 0);
+	message.write32(1, Result::Success);
+	message.write32(2, cpuTimeLimit);
 }
 
-void APTService::setScreencapPostPermission(u32 messagePointer) {
-	u32 perm = mem.read32(messagePointer + 4);
+void APTService::setScreencapPostPermission(IPC::Message message) {
+	u32 perm = message.read32(1);
 	log("APT::SetScreencapPostPermission (perm = %d)\n", perm);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x55, 1, 0));
+	message.respond(0x55, 1, 0);
 	// Apparently only 1-3 are valid values, but I see 0 used in some games like Pokemon Rumble
-	mem.write32(messagePointer + 4, Result::Success);
+	message.write32(1, Result::Success);
 	screencapPostPermission = perm;
 }
 
-void APTService::getSharedFont(u32 messagePointer) {
+void APTService::getSharedFont(IPC::Message message) {
 	log("APT::GetSharedFont\n");
 
 	const u32 fontVaddr = kernel.getSharedFontVaddr();
-	mem.write32(messagePointer, IPC::responseHeader(0x44, 2, 2));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write32(messagePointer + 8, fontVaddr);
-	mem.write32(messagePointer + 16, KernelHandles::FontSharedMemHandle);
+	message.respond(0x44, 2, 2);
+	message.write32(1, Result::Success);
+	message.write32(2, fontVaddr);
+	message.write32(3, IPC::copyHandleDescriptor(1));
+	message.write32(4, KernelHandles::FontSharedMemHandle);
 }
 
 // This function is entirely undocumented. We know Smash Bros uses it and that it normally writes 2 to cmdreply[2] on New 3DS
 // And that writing 1 stops it from accessing the ir:USER service for New 3DS HID use
-void APTService::theSmashBrosFunction(u32 messagePointer) {
+void APTService::theSmashBrosFunction(IPC::Message message) {
 	log("APT: Called the elusive Smash Bros function\n");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x103, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write32(messagePointer + 8, (model == ConsoleModel::New3DS) ? 2 : 1);
+	message.respond(0x103, 2, 0);
+	message.write32(1, Result::Success);
+	message.write32(2, (model == ConsoleModel::New3DS) ? 2 : 1);
 }
 
-void APTService::getWirelessRebootInfo(u32 messagePointer) {
-	const u32 size = mem.read32(messagePointer + 4);  // Size of data to read
+void APTService::getWirelessRebootInfo(IPC::Message message) {
+	const u32 size = message.read32(1);  // Size of data to read
 	log("APT::GetWirelessRebootInfo (size = %X)\n", size);
 
 	if (size > 0x10) {
 		Helpers::panic("APT::GetWirelessInfo with size > 0x10 bytes");
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x45, 1, 2));
-	mem.write32(messagePointer + 4, Result::Success);
+	const u32 buffer = message.getReceiveBuffer(0).address;
+	message.respond(0x45, 1, 2);
+	message.write32(1, Result::Success);
 	for (u32 i = 0; i < size; i++) {
-		mem.write8(messagePointer + 0x104 + i, 0);  // Temporarily stub this until we add SetWirelessRebootInfo
+		mem.write8(buffer + i, 0);  // Temporarily stub this until we add SetWirelessRebootInfo
 	}
 }
@@ -1,15 +1,23 @@
 #include "services/cam.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <vector>
 
+#include "config.hpp"
 #include "ipc.hpp"
 #include "kernel.hpp"
+#include "services/camera_simd.hpp"
 
 namespace CAMCommands {
 	enum : u32 {
 		StartCapture = 0x00010040,
+		StopCapture = 0x00020040,
+		IsBusy = 0x00030040,
 		GetBufferErrorInterruptEvent = 0x00060040,
 		SetReceiving = 0x00070102,
+		IsFinishedReceiving = 0x00080040,
 		DriverInitialize = 0x00390000,
 		DriverFinalize = 0x003A0000,
 		SetTransferLines = 0x00090100,
@@ -18,14 +26,41 @@ namespace CAMCommands {
 		GetTransferBytes = 0x000C0040,
 		GetMaxBytes = 0x000D0080,
 		SetTrimming = 0x000E0080,
+		SetTrimmingParams = 0x00100140,
 		SetTrimmingParamsCenter = 0x00120140,
+		Activate = 0x00130040,
 		SetSize = 0x001F00C0,  // Set size has different headers between cam:u and New3DS QTM module
 		SetFrameRate = 0x00200080,
 		SetContrast = 0x00230080,
+		SetOutputFormat = 0x002500C0,
 		GetSuitableY2rStandardCoefficient = 0x00360000,
 	};
 }
 
+namespace CAMConstants {
+	struct Resolution {
+		u16 width;
+		u16 height;
+	};
+
+	// Indexed by the size values passed to CAM::SetSize
+	static constexpr std::array<Resolution, 8> resolutions = {{
+		{640, 480},  // VGA
+		{320, 240},  // QVGA
+		{160, 120},  // QQVGA
+		{352, 288},  // CIF
+		{176, 144},  // QCIF
+		{256, 192},  // DS LCD
+		{512, 384},  // DS LCD x4
+		{400, 240},  // CTR top LCD
+	}};
+
+	// Indexed by the frame rate values passed to CAM::SetFrameRate. Variable frame rate modes (eg 15 to 5 FPS) are treated as their maximum
+	static constexpr std::array<float, 13> frameRates = {
+		15.0f, 15.0f, 15.0f, 10.0f, 8.5f, 5.0f, 20.0f, 20.0f, 30.0f, 30.0f, 15.0f, 20.0f, 30.0f,
+	};
+}  // namespace CAMConstants
+
 // Helper struct for working with camera ports
 class PortSelect {
 	u32 value;
@@ -67,11 +102,26 @@ void CAMService::reset() {
 	for (auto& port : ports) {
 		port.reset();
 	}
+
+	for (auto& camera : cameras) {
+		camera = CameraSettings();
+	}
+
+	// Port 1 is fed by either the outer right camera or the inner camera, depending on which is activated. Port 2 is always fed by the outer left
+	ports[0].camera = CameraIndex::Outer1;
+	ports[1].camera = CameraIndex::Outer2;
+	source.reset();
+}
+
+u32 CAMService::getCameraMask(u32 cameraSelect) {
+	// CameraSelect bits happen to be laid out the same way as our camera indices: bit 0 is OUT1, bit 1 is IN, bit 2 is OUT2
+	return cameraSelect & 0b111;
 }
 
 void CAMService::handleSyncRequest(u32 messagePointer) {
 	const u32 command = mem.read32(messagePointer);
 	switch (command) {
+		case CAMCommands::Activate: activate(messagePointer); break;
 		case CAMCommands::DriverInitialize: driverInitialize(messagePointer); break;
 		case CAMCommands::DriverFinalize: driverFinalize(messagePointer); break;
 		case CAMCommands::GetBufferErrorInterruptEvent: getBufferErrorInterruptEvent(messagePointer); break;
@@ -79,14 +129,19 @@ void CAMService::handleSyncRequest(u32 messagePointer) {
 		case CAMCommands::GetMaxLines: getMaxLines(messagePointer); break;
 		case CAMCommands::GetSuitableY2rStandardCoefficient: getSuitableY2RCoefficients(messagePointer); break;
 		case CAMCommands::GetTransferBytes: getTransferBytes(messagePointer); break;
+		case CAMCommands::IsBusy: isBusy(messagePointer); break;
+		case CAMCommands::IsFinishedReceiving: isFinishedReceiving(messagePointer); break;
 		case CAMCommands::SetContrast: setContrast(messagePointer); break;
 		case CAMCommands::SetFrameRate: setFrameRate(messagePointer); break;
+		case CAMCommands::SetOutputFormat: setOutputFormat(messagePointer); break;
 		case CAMCommands::SetReceiving: setReceiving(messagePointer); break;
 		case CAMCommands::SetSize: setSize(messagePointer); break;
 		case CAMCommands::SetTransferLines: setTransferLines(messagePointer); break;
 		case CAMCommands::SetTrimming: setTrimming(messagePointer); break;
+		case CAMCommands::SetTrimmingParams: setTrimmingParams(messagePointer); break;
 		case CAMCommands::SetTrimmingParamsCenter: setTrimmingParamsCenter(messagePointer); break;
 		case CAMCommands::StartCapture: startCapture(messagePointer); break;
+		case CAMCommands::StopCapture: stopCapture(messagePointer); break;
 
 		default:
 			Helpers::warn("Unimplemented CAM service requested. Command: %08X\n", command);
@@ -97,16 +152,41 @@ void CAMService::handleSyncRequest(u32 messagePointer) {
 
 void CAMService::driverInitialize(u32 messagePointer) {
 	log("CAM::DriverInitialize\n");
+	// (Re)create the image source here, so that changing the camera settings takes effect the next time a game initializes the cameras
+	source = Camera::makeSource(config.cameraSource, config.cameraImagePath);
+
 	mem.write32(messagePointer, IPC::responseHeader(0x39, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
 }
 
 void CAMService::driverFinalize(u32 messagePointer) {
 	log("CAM::DriverFinalize\n");
+	for (auto& port : ports) {
+		port.capturing = false;
+		port.receiving = false;
+	}
+	scheduleNextFrame();
+
 	mem.write32(messagePointer, IPC::responseHeader(0x3A, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
 }
 
+void CAMService::activate(u32 messagePointer) {
+	const u32 cameraSelect = mem.read32(messagePointer + 4);
+	log("CAM::Activate (camera select = %d)\n", cameraSelect);
+
+	// Port 1 is shared between the inner camera and the outer right camera, so route it to whichever one got activated
+	const u32 mask = getCameraMask(cameraSelect);
+	if (mask & (1 << CameraIndex::Inner)) {
+		ports[0].camera = CameraIndex::Inner;
+	} else if (mask & (1 << CameraIndex::Outer1)) {
+		ports[0].camera = CameraIndex::Outer1;
+	}
+
+	mem.write32(messagePointer, IPC::responseHeader(0x13, 1, 0));
+	mem.write32(messagePointer + 4, Result::Success);
+}
+
 void CAMService::setContrast(u32 messagePointer) {
 	const u32 cameraSelect = mem.read32(messagePointer + 4);
 	const u32 contrast = mem.read32(messagePointer + 8);
@@ -166,7 +246,18 @@ void CAMService::setFrameRate(u32 messagePointer) {
 	const u32 cameraSelect = mem.read32(messagePointer + 4);
 	const u32 framerate = mem.read32(messagePointer + 8);
 
-	log("CAM::SetPhotoMode (camera select = %d, framerate = %d)\n", cameraSelect, framerate);
+	log("CAM::SetFrameRate (camera select = %d, framerate = %d)\n", cameraSelect, framerate);
+
+	if (framerate < CAMConstants::frameRates.size()) {
+		const u32 mask = getCameraMask(cameraSelect);
+		for (usize i = 0; i < cameraCount; i++) {
+			if (mask & (1 << i)) {
+				cameras[i].frameRate = framerate;
+			}
+		}
+	} else {
+		Helpers::warn("CAM::SetFrameRate: Invalid frame rate %d\n", framerate);
+	}
 
 	mem.write32(messagePointer, IPC::responseHeader(0x20, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
@@ -179,29 +270,113 @@ void CAMService::setSize(u32 messagePointer) {
 
 	log("CAM::SetSize (camera select = %d, size = %d, context = %d)\n", cameraSelect, size, context);
 
+	if (size < CAMConstants::resolutions.size()) {
+		const u32 mask = getCameraMask(cameraSelect);
+		for (usize i = 0; i < cameraCount; i++) {
+			if (mask & (1 << i)) {
+				// Context select: Bit 0 is context A, bit 1 is context B
+				for (int ctx = 0; ctx < 2; ctx++) {
+					if (context & (1 << ctx)) {
+						cameras[i].contexts[ctx].size = size;
+					}
+				}
+			}
+		}
+	} else {
+		Helpers::warn("CAM::SetSize: Invalid size %d\n", size);
+	}
+
 	mem.write32(messagePointer, IPC::responseHeader(0x1F, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
 }
 
+void CAMService::setOutputFormat(u32 messagePointer) {
+	const u32 cameraSelect = mem.read32(messagePointer + 4);
+	const u32 format = mem.read32(messagePointer + 8);
+	const u32 context = mem.read32(messagePointer + 12);
+
+	log("CAM::SetOutputFormat (camera select = %d, format = %d, context = %d)\n", cameraSelect, format, context);
+
+	const u32 mask = getCameraMask(cameraSelect);
+	for (usize i = 0; i < cameraCount; i++) {
+		if (mask & (1 << i)) {
+			for (int ctx = 0; ctx < 2; ctx++) {
+				if (context & (1 << ctx)) {
+					cameras[i].contexts[ctx].outputFormat = (format == 0) ? OutputFormat::YUV422 : OutputFormat::RGB565;
+				}
+			}
+		}
+	}
+
+	mem.write32(messagePointer, IPC::responseHeader(0x25, 1, 0));
+	mem.write32(messagePointer + 4, Result::Success);
+}
+
 void CAMService::setTrimming(u32 messagePointer) {
-	const u32 port = mem.read8(messagePointer + 4);
+	const u32 portIndex = mem.read8(messagePointer + 4);
 	const bool trim = mem.read8(messagePointer + 8) != 0;
+	const PortSelect port(portIndex);
 
-	log("CAM::SetTrimming (port = %d, trimming = %s)\n", port, trim ? "enabled" : "disabled");
+	log("CAM::SetTrimming (port = %d, trimming = %s)\n", portIndex, trim ? "enabled" : "disabled");
+
+	if (port.isValid()) {
+		for (int i : port.getPortIndices()) {
+			ports[i].trimming = trim;
+		}
+	} else {
+		Helpers::warn("CAM::SetTrimming: Invalid port\n");
+	}
 
 	mem.write32(messagePointer, IPC::responseHeader(0x0E, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
 }
 
+void CAMService::setTrimmingParams(u32 messagePointer) {
+	const u32 portIndex = mem.read8(messagePointer + 4);
+	const s16 x0 = s16(mem.read16(messagePointer + 8));
+	const s16 y0 = s16(mem.read16(messagePointer + 12));
+	const s16 x1 = s16(mem.read16(messagePointer + 16));
+	const s16 y1 = s16(mem.read16(messagePointer + 20));
+	const PortSelect port(portIndex);
+
+	log("CAM::SetTrimmingParams (port = %d), start = (%d, %d), end = (%d, %d)\n", portIndex, x0, y0, x1, y1);
+
+	if (port.isValid()) {
+		for (int i : port.getPortIndices()) {
+			ports[i].trimX0 = x0;
+			ports[i].trimY0 = y0;
+			ports[i].trimX1 = x1;
+			ports[i].trimY1 = y1;
+		}
+	} else {
+		Helpers::warn("CAM::SetTrimmingParams: Invalid port\n");
+	}
+
+	mem.write32(messagePointer, IPC::responseHeader(0x10, 1, 0));
+	mem.write32(messagePointer + 4, Result::Success);
+}
+
 void CAMService::setTrimmingParamsCenter(u32 messagePointer) {
-	const u32 port = mem.read8(messagePointer + 4);
+	const u32 portIndex = mem.read8(messagePointer + 4);
 	const s16 trimWidth = s16(mem.read16(messagePointer + 8));
 	const s16 trimHeight = s16(mem.read16(messagePointer + 12));
 	const s16 cameraWidth = s16(mem.read16(messagePointer + 16));
 	const s16 cameraHeight = s16(mem.read16(messagePointer + 20));
+	const PortSelect port(portIndex);
 
-	log("CAM::SetTrimmingParamsCenter (port = %d), trim size = (%d, %d), camera size = (%d, %d)\n", port, trimWidth, trimHeight, cameraWidth,
-		cameraHeight);
+	log("CAM::SetTrimmingParamsCenter (port = %d), trim size = (%d, %d), camera size = (%d, %d)\n", portIndex, trimWidth, trimHeight,
+		cameraWidth, cameraHeight);
+
+	if (port.isValid()) {
+		for (int i : port.getPortIndices()) {
+			ports[i].trimX0 = s16((cameraWidth - trimWidth) / 2);
+			ports[i].trimY0 = s16((cameraHeight - trimHeight) / 2);
+			ports[i].trimX1 = s16(ports[i].trimX0 + trimWidth);
+			ports[i].trimY1 = s16(ports[i].trimY0 + trimHeight);
+		}
+	} else {
+		Helpers::warn("CAM::SetTrimmingParamsCenter: Invalid port\n");
+	}
 
 	mem.write32(messagePointer, IPC::responseHeader(0x12, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
@@ -320,7 +495,12 @@ void CAMService::setReceiving(u32 messagePointer) {
 	mem.write32(messagePointer, IPC::responseHeader(0x7, 1, 2));
 
 	if (port.isSinglePort()) {
-		auto& event = ports[port.getSingleIndex()].receiveEvent;
+		Port& p = ports[port.getSingleIndex()];
+		p.receiving = true;
+		p.destination = destination;
+		p.destinationSize = size;
+
+		auto& event = p.receiveEvent;
 		if (!event.has_value()) {
 			event = kernel.makeEvent(ResetType::OneShot);
 		}
@@ -333,6 +513,39 @@ void CAMService::setReceiving(u32 messagePointer) {
 	}
 }
 
+void CAMService::isFinishedReceiving(u32 messagePointer) {
+	const u32 portIndex = mem.read8(messagePointer + 4);
+	const PortSelect port(portIndex);
+	log("CAM::IsFinishedReceiving (port = %d)\n", portIndex);
+
+	mem.write32(messagePointer, IPC::responseHeader(0x8, 2, 0));
+	mem.write32(messagePointer + 4, Result::Success);
+
+	if (port.isSinglePort()) {
+		mem.write8(messagePointer + 8, ports[port.getSingleIndex()].receiving ? 0 : 1);
+	} else {
+		Helpers::warn("CAM::IsFinishedReceiving: Invalid port index");
+		mem.write8(messagePointer + 8, 0);
+	}
+}
+
+void CAMService::isBusy(u32 messagePointer) {
+	const u32 portIndex = mem.read8(messagePointer + 4);
+	const PortSelect port(portIndex);
+	log("CAM::IsBusy (port = %d)\n", portIndex);
+
+	bool busy = false;
+	if (port.isValid()) {
+		for (int i : port.getPortIndices()) {
+			busy |= ports[i].capturing;
+		}
+	}
+
+	mem.write32(messagePointer, IPC::responseHeader(0x3, 2, 0));
+	mem.write32(messagePointer + 4, Result::Success);
+	mem.write8(messagePointer + 8, busy ? 1 : 0);
+}
+
 void CAMService::startCapture(u32 messagePointer) {
 	const u32 portIndex = mem.read8(messagePointer + 4);
 	const PortSelect port(portIndex);
@@ -342,15 +555,148 @@ void CAMService::startCapture(u32 messagePointer) {
 	mem.write32(messagePointer + 4, Result::Success);
 
 	if (port.isValid()) {
-		for (int i : port.getPortIndices()) {
-			auto& event = ports[i].receiveEvent;
+		const u64 currentTimestamp = kernel.getScheduler().currentTimestamp;
 
-			// Until we properly implement cameras, immediately signal the receive event
-			if (event.has_value()) {
-				kernel.signalEvent(event.value());
+		for (int i : port.getPortIndices()) {
+			Port& p = ports[i];
+			if (!p.capturing) {
+				p.capturing = true;
+				p.nextFrameTimestamp = currentTimestamp + getFramePeriod(p);
 			}
 		}
+
+		scheduleNextFrame();
 	} else {
 		Helpers::warn("CAM::StartCapture: Invalid port index");
 	}
 }
+
+void CAMService::stopCapture(u32 messagePointer) {
+	const u32 portIndex = mem.read8(messagePointer + 4);
+	const PortSelect port(portIndex);
+	log("CAM::StopCapture (port = %d)\n", portIndex);
+
+	if (port.isValid()) {
+		for (int i : port.getPortIndices()) {
+			ports[i].capturing = false;
+		}
+
+		scheduleNextFrame();
+	} else {
+		Helpers::warn("CAM::StopCapture: Invalid port index");
+	}
+
+	mem.write32(messagePointer, IPC::responseHeader(0x02, 1, 0));
+	mem.write32(messagePointer + 4, Result::Success);
+}
+
+u64 CAMService::getFramePeriod(const Port& port) const {
+	const float fps = CAMConstants::frameRates[cameras[port.camera].frameRate];
+	return u64(double(Scheduler::arm11Clock) / double(fps));
+}
+
+void CAMService::scheduleNextFrame() {
+	Scheduler& scheduler = kernel.getScheduler();
+	bool anyCapturing = false;
+	u64 nextTimestamp = std::numeric_limits<u64>::max();
+
+	for (const auto& port : ports) {
+		if (port.capturing) {
+			anyCapturing = true;
+			nextTimestamp = std::min(nextTimestamp, port.nextFrameTimestamp);
+		}
+	}
+
+	if (anyCapturing) {
+		scheduler.rescheduleEvent(Scheduler::EventType::UpdateCamera, nextTimestamp);
+	} else {
+		scheduler.removeEvent(Scheduler::EventType::UpdateCamera);
+	}
+}
+
+void CAMService::updateCapture() {
+	const u64 currentTimestamp = kernel.getScheduler().currentTimestamp;
+
+	for (auto& port : ports) {
+		if (port.capturing && currentTimestamp >= port.nextFrameTimestamp) {
+			deliverFrame(port);
+
+			// If we fell behind by more than a frame (eg after a long stall), don't try to catch up by delivering a burst of frames
+			port.nextFrameTimestamp += getFramePeriod(port);
+			if (port.nextFrameTimestamp <= currentTimestamp) {
+				port.nextFrameTimestamp = currentTimestamp + getFramePeriod(port);
+			}
+		}
+	}
+
+	scheduleNextFrame();
+}
+
+void CAMService::deliverFrame(Port& port) {
+	// If the game hasn't set up a buffer to receive into, the frame is dropped
+	if (!port.receiving) {
+		return;
+	}
+
+	if (!source) {
+		source = Camera::makeSource(config.cameraSource, config.cameraImagePath);
+	}
+
+	const Context& context = cameras[port.camera].contexts[0];
+	const auto resolution = CAMConstants::resolutions[context.size];
+	const u32 width = resolution.width;
+	const u32 height = resolution.height;
+
+	// Figure out the window of the camera image the game wants, based on the port's trimming settings
+	u32 cropX = 0, cropY = 0, cropWidth = width, cropHeight = height;
+	if (port.trimming) {
+		const s32 x0 = std::clamp<s32>(port.trimX0, 0, width);
+		const s32 y0 = std::clamp<s32>(port.trimY0, 0, height);
+		const s32 x1 = std::clamp<s32>(port.trimX1, x0, width);
+		const s32 y1 = std::clamp<s32>(port.trimY1, y0, height);
+
+		cropX = u32(x0);
+		cropY = u32(y0);
+		cropWidth = u32(x1 - x0);
+		cropHeight = u32(y1 - y0);
+	}
+
+	const Camera::Frame& frame = source->nextFrame(width, height);
+	Camera::scaleAndCrop(frame, width, height, cropX, cropY, cropWidth, cropHeight, scaledFrame);
+
+	// Both output formats are 16 bits per pixel
+	const usize pixelCount = usize(cropWidth) * cropHeight;
+	convertedFrame.resize(pixelCount * sizeof(u16));
+
+	switch (context.outputFormat) {
+		case OutputFormat::YUV422: Camera::Convert::toYUV422(scaledFrame.data(), convertedFrame.data(), pixelCount); break;
+		case OutputFormat::RGB565:
+			Camera::Convert::toRGB565(scaledFrame.data(), reinterpret_cast<u16*>(convertedFrame.data()), pixelCount);
+			break;
+	}
+
+	writeToGuest(port.destination, convertedFrame.data(), std::min<u32>(port.destinationSize, u32(convertedFrame.size())));
+	port.receiving = false;
+
+	if (port.receiveEvent.has_value()) {
+		kernel.signalEvent(port.receiveEvent.value());
+	}
+}
+
+// Guest buffers are only virtually contiguous, so copy them page by page
+void CAMService::writeToGuest(u32 vaddr, const u8* data, u32 size) {
+	while (size > 0) {
+		const u32 bytesInPage = std::min<u32>(size, Memory::pageSize - (vaddr & Memory::pageMask));
+		u8* pointer = static_cast<u8*>(mem.getWritePointer(vaddr));
+
+		if (pointer == nullptr) [[unlikely]] {
+			Helpers::warn("CAM: Tried to write frame to unmapped address %08X\n", vaddr);
+			return;
+		}
+
+		std::memcpy(pointer, data, bytesInPage);
+		vaddr += bytesInPage;
+		data += bytesInPage;
+		size -= bytesInPage;
+	}
+}
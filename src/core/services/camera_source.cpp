@@ -0,0 +1,178 @@
+#include "services/camera_source.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <stb_image.h>
+#include <unordered_map>
+
+namespace Camera {
+	SourceType sourceTypeFromString(std::string inString) {
+		// Transform to lower-case to make the setting case-insensitive
+		std::transform(inString.begin(), inString.end(), inString.begin(), [](unsigned char c) { return std::tolower(c); });
+
+		static const std::unordered_map<std::string, SourceType> map = {
+			{"blank", SourceType::Blank},
+			{"pattern", SourceType::Pattern},
+			{"image", SourceType::Image},
+		};
+
+		if (auto search = map.find(inString); search != map.end()) {
+			return search->second;
+		}
+
+		// Default to the test pattern
+		return SourceType::Pattern;
+	}
+
+	const char* sourceTypeToString(SourceType type) {
+		switch (type) {
+			case SourceType::Blank: return "blank";
+			case SourceType::Image: return "image";
+
+			case SourceType::Pattern:
+			default: return "pattern";
+		}
+	}
+
+	const Frame& BlankSource::nextFrame(u32 requestedWidth, u32 requestedHeight) {
+		if (frame.width != requestedWidth || frame.height != requestedHeight) {
+			frame.width = requestedWidth;
+			frame.height = requestedHeight;
+			frame.pixels.assign(usize(requestedWidth) * requestedHeight, 0xff000000);
+		}
+
+		return frame;
+	}
+
+	// SMPTE-like colour bars, scrolling horizontally by a few pixels every frame so that games waiting for the image to change make progress
+	const Frame& PatternSource::nextFrame(u32 requestedWidth, u32 requestedHeight) {
+		static constexpr std::array<u32, 8> bars = {
+			0xffffffff, 0xff00ffff, 0xffffff00, 0xff00ff00, 0xffff00ff, 0xff0000ff, 0xffff0000, 0xff000000,
+		};
+
+		frame.width = requestedWidth;
+		frame.height = requestedHeight;
+		frame.pixels.resize(usize(requestedWidth) * requestedHeight);
+
+		const u32 barWidth = std::max<u32>(1, requestedWidth / u32(bars.size()));
+		const u32 scroll = frameCounter * 4;
+		// The bottom quarter of the image is a greyscale ramp, which is useful for checking the YUV conversion
+		const u32 rampStart = requestedHeight - requestedHeight / 4;
+
+		u32* pixels = frame.pixels.data();
+		for (u32 y = 0; y < requestedHeight; y++) {
+			for (u32 x = 0; x < requestedWidth; x++) {
+				if (y < rampStart) {
+					*pixels++ = bars[((x + scroll) / barWidth) % bars.size()];
+				} else {
+					const u32 grey = (x * 255) / std::max<u32>(1, requestedWidth - 1);
+					*pixels++ = 0xff000000 | (grey << 16) | (grey << 8) | grey;
+				}
+			}
+		}
+
+		frameCounter++;
+		return frame;
+	}
+
+	static bool loadImage(const std::filesystem::path& path, Frame& frame) {
+		int width, height, channels;
+		u8* data = stbi_load(path.string().c_str(), &width, &height, &channels, 4);
+		if (data == nullptr) {
+			return false;
+		}
+
+		frame.width = u32(width);
+		frame.height = u32(height);
+		frame.pixels.resize(usize(width) * height);
+		std::memcpy(frame.pixels.data(), data, frame.pixels.size() * sizeof(u32));
+
+		stbi_image_free(data);
+		return true;
+	}
+
+	ImageSource::ImageSource(const std::filesystem::path& path) {
+		std::error_code error;
+
+		if (std::filesystem::is_directory(path, error)) {
+			// Treat directories as an image sequence, played back in lexicographic order
+			std::vector<std::filesystem::path> paths;
+			for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+				if (entry.is_regular_file()) {
+					paths.push_back(entry.path());
+				}
+			}
+
+			std::sort(paths.begin(), paths.end());
+			for (const auto& imagePath : paths) {
+				Frame frame;
+				if (loadImage(imagePath, frame)) {
+					frames.push_back(std::move(frame));
+				}
+			}
+		} else {
+			Frame frame;
+			if (loadImage(path, frame)) {
+				frames.push_back(std::move(frame));
+			}
+		}
+
+		if (frames.empty()) {
+			Helpers::warn("Camera: Failed to load any images from %s, falling back to a blank image\n", path.string().c_str());
+		}
+	}
+
+	const Frame& ImageSource::nextFrame(u32 requestedWidth, u32 requestedHeight) {
+		if (frames.empty()) {
+			return fallback.nextFrame(requestedWidth, requestedHeight);
+		}
+
+		const Frame& frame = frames[currentFrame];
+		currentFrame = (currentFrame + 1) % frames.size();
+		return frame;
+	}
+
+	std::unique_ptr<FrameSource> makeSource(SourceType type, const std::filesystem::path& imagePath) {
+		switch (type) {
+			case SourceType::Blank: return std::make_unique<BlankSource>();
+			case SourceType::Image: return std::make_unique<ImageSource>(imagePath);
+
+			case SourceType::Pattern:
+			default: return std::make_unique<PatternSource>();
+		}
+	}
+
+	void scaleAndCrop(
+		const Frame& frame, u32 outWidth, u32 outHeight, u32 cropX, u32 cropY, u32 cropWidth, u32 cropHeight, std::vector<u32>& output
+	) {
+		output.resize(usize(cropWidth) * cropHeight);
+		if (!frame.isValid() || outWidth == 0 || outHeight == 0) {
+			std::fill(output.begin(), output.end(), 0xff000000);
+			return;
+		}
+
+		// 16.16 fixed point step sizes for nearest-neighbour sampling
+		const u32 stepX = u32((u64(frame.width) << 16) / outWidth);
+		const u32 stepY = u32((u64(frame.height) << 16) / outHeight);
+		u32* out = output.data();
+
+		for (u32 y = 0; y < cropHeight; y++) {
+			const u32 srcY = std::min<u32>(u32((u64(y + cropY) * stepY) >> 16), frame.height - 1);
+			const u32* srcRow = &frame.pixels[usize(srcY) * frame.width];
+
+			// Fast path for when the source already has the right width, which is always the case for the pattern and blank sources
+			if (frame.width == outWidth) {
+				std::copy_n(srcRow + cropX, cropWidth, out);
+				out += cropWidth;
+				continue;
+			}
+
+			for (u32 x = 0; x < cropWidth; x++) {
+				const u32 srcX = std::min<u32>(u32((u64(x + cropX) * stepX) >> 16), frame.width - 1);
+				*out++ = srcRow[srcX];
+			}
+		}
+	}
+}  // namespace Camera
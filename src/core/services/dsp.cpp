@@ -56,42 +56,43 @@ void DSPService::reset() {
 }
 
 void DSPService::handleSyncRequest(u32 messagePointer) {
-	const u32 command = mem.read32(messagePointer);
+	IPC::Message message(mem, messagePointer);
+	const u32 command = message.header();
 	switch (command) {
-		case DSPCommands::ConvertProcessAddressFromDspDram: convertProcessAddressFromDspDram(messagePointer); break;
-		case DSPCommands::FlushDataCache: flushDataCache(messagePointer); break;
-		case DSPCommands::InvalidateDataCache: invalidateDCache(messagePointer); break;
-		case DSPCommands::ForceHeadphoneOut: forceHeadphoneOut(messagePointer); break;
-		case DSPCommands::GetHeadphoneStatus: getHeadphoneStatus(messagePointer); break;
-		case DSPCommands::GetSemaphoreEventHandle: getSemaphoreEventHandle(messagePointer); break;
-		case DSPCommands::LoadComponent: loadComponent(messagePointer); break;
-		case DSPCommands::ReadPipeIfPossible: readPipeIfPossible(messagePointer); break;
-		case DSPCommands::RecvData: [[likely]] recvData(messagePointer); break;
-		case DSPCommands::RecvDataIsReady: [[likely]] recvDataIsReady(messagePointer); break;
-		case DSPCommands::RegisterInterruptEvents: registerInterruptEvents(messagePointer); break;
-		case DSPCommands::SetSemaphore: setSemaphore(messagePointer); break;
-		case DSPCommands::SetSemaphoreMask: setSemaphoreMask(messagePointer); break;
-		case DSPCommands::UnloadComponent: unloadComponent(messagePointer); break;
-		case DSPCommands::WriteProcessPipe: [[likely]] writeProcessPipe(messagePointer); break;
+		case DSPCommands::ConvertProcessAddressFromDspDram: convertProcessAddressFromDspDram(message); break;
+		case DSPCommands::FlushDataCache: flushDataCache(message); break;
+		case DSPCommands::InvalidateDataCache: invalidateDCache(message); break;
+		case DSPCommands::ForceHeadphoneOut: forceHeadphoneOut(message); break;
+		case DSPCommands::GetHeadphoneStatus: getHeadphoneStatus(message); break;
+		case DSPCommands::GetSemaphoreEventHandle: getSemaphoreEventHandle(message); break;
+		case DSPCommands::LoadComponent: loadComponent(message); break;
+		case DSPCommands::ReadPipeIfPossible: readPipeIfPossible(message); break;
+		case DSPCommands::RecvData: [[likely]] recvData(message); break;
+		case DSPCommands::RecvDataIsReady: [[likely]] recvDataIsReady(message); break;
+		case DSPCommands::RegisterInterruptEvents: registerInterruptEvents(message); break;
+		case DSPCommands::SetSemaphore: setSemaphore(message); break;
+		case DSPCommands::SetSemaphoreMask: setSemaphoreMask(message); break;
+		case DSPCommands::UnloadComponent: unloadComponent(message); break;
+		case DSPCommands::WriteProcessPipe: [[likely]] writeProcessPipe(message); break;
 		default: Helpers::panic("DSP service requested. Command: %08X\n", command);
 	}
 }
 
-void DSPService::convertProcessAddressFromDspDram(u32 messagePointer) {
-	const u32 address = mem.read32(messagePointer + 4);
+void DSPService::convertProcessAddressFromDspDram(IPC::Message message) {
+	const u32 address = message.read32(1);
 	log("DSP::ConvertProcessAddressFromDspDram (address = %08X)\n", address);
 	const u32 converted = (address << 1) + 0x1FF40000;
 
-	mem.write32(messagePointer, IPC::responseHeader(0xC, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write32(messagePointer + 8, converted);  // Converted address
+	message.respond(0xC, 2, 0);
+	message.write32(1, Result::Success);
+	message.write32(2, converted);  // Converted address
 }
 
-void DSPService::loadComponent(u32 messagePointer) {
-	u32 size = mem.read32(messagePointer + 4);
-	u32 programMask = mem.read32(messagePointer + 8);
-	u32 dataMask = mem.read32(messagePointer + 12);
-	u32 buffer = mem.read32(messagePointer + 20);
+void DSPService::loadComponent(IPC::Message message) {
+	u32 size = message.read32(1);
+	u32 programMask = message.read32(2);
+	u32 dataMask = message.read32(3);
+	u32 buffer = message.readMappedBuffer(4).address;
 
 	loadedComponent.resize(size);
 
@@ -106,59 +107,58 @@ void DSPService::loadComponent(u32 messagePointer) {
 		printFirmwareInfo();
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x11, 2, 2));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write32(messagePointer + 8, 1);  // Component loaded
-	mem.write32(messagePointer + 12, (size << 4) | 0xA);
-	mem.write32(messagePointer + 16, mem.read32(messagePointer + 20));  // Component buffer
+	message.respond(0x11, 2, 2);
+	message.write32(1, Result::Success);
+	message.write32(2, 1);                          // Component loaded
+	message.writeMappedBuffer(3, 1, size, buffer);  // Component buffer, mapped as read-only
 }
 
-void DSPService::unloadComponent(u32 messagePointer) {
+void DSPService::unloadComponent(IPC::Message message) {
 	log("DSP::UnloadComponent\n");
 	dsp->unloadComponent();
 
-	mem.write32(messagePointer, IPC::responseHeader(0x12, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x12, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void DSPService::readPipeIfPossible(u32 messagePointer) {
-	u32 channel = mem.read32(messagePointer + 4);
-	u32 peer = mem.read32(messagePointer + 8);
-	u16 size = mem.read16(messagePointer + 12);
-	u32 buffer = mem.read32(messagePointer + 0x100 + 4);
+void DSPService::readPipeIfPossible(IPC::Message message) {
+	u32 channel = message.read32(1);
+	u32 peer = message.read32(2);
+	u16 size = message.read16(3);
+	u32 buffer = message.getReceiveBuffer(0).address;
 	log("DSP::ReadPipeIfPossible (channel = %d, peer = %d, size = %04X, buffer = %08X)\n", channel, peer, size, buffer);
-	mem.write32(messagePointer, IPC::responseHeader(0x10, 2, 2));
+	message.respond(0x10, 2, 2);
 
 	std::vector<u8> data = dsp->readPipe(channel, peer, size, buffer);
 	for (uint i = 0; i < data.size(); i++) {
 		mem.write8(buffer + i, data[i]);
 	}
 
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write16(messagePointer + 8, u16(data.size()));  // Number of bytes read
+	message.write32(1, Result::Success);
+	message.write16(2, u16(data.size()));  // Number of bytes read
 }
 
-void DSPService::recvData(u32 messagePointer) {
-	const u32 registerIndex = mem.read32(messagePointer + 4);
+void DSPService::recvData(IPC::Message message) {
+	const u32 registerIndex = message.read32(1);
 	log("DSP::RecvData (register = %d)\n", registerIndex);
 	if (registerIndex != 0) Helpers::panic("Unknown register in DSP::RecvData");
 
 	const u16 data = dsp->recvData(registerIndex);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x01, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write16(messagePointer + 8, data);
+	message.respond(0x01, 2, 0);
+	message.write32(1, Result::Success);
+	message.write16(2, data);
 }
 
-void DSPService::recvDataIsReady(u32 messagePointer) {
-	const u32 registerIndex = mem.read32(messagePointer + 4);
+void DSPService::recvDataIsReady(IPC::Message message) {
+	const u32 registerIndex = message.read32(1);
 	log("DSP::RecvDataIsReady (register = %d)\n", registerIndex);
 
 	bool isReady = dsp->recvDataIsReady(registerIndex);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x02, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write32(messagePointer + 8, isReady ? 1 : 0);
+	message.respond(0x02, 2, 0);
+	message.write32(1, Result::Success);
+	message.write32(2, isReady ? 1 : 0);
 }
 
 DSPService::DSPEvent& DSPService::getEventRef(u32 type, u32 pipe) {
@@ -174,10 +174,10 @@ DSPService::DSPEvent& DSPService::getEventRef(u32 type, u32 pipe) {
 	}
 }
 
-void DSPService::registerInterruptEvents(u32 messagePointer) {
-	const u32 interrupt = mem.read32(messagePointer + 4);
-	const u32 channel = mem.read32(messagePointer + 8);
-	const u32 eventHandle = mem.read32(messagePointer + 16);
+void DSPService::registerInterruptEvents(IPC::Message message) {
+	const u32 interrupt = message.read32(1);
+	const u32 channel = message.read32(2);
+	const u32 eventHandle = message.read32(4);
 	log("DSP::RegisterInterruptEvents (interrupt = %d, channel = %d, event = %d)\n", interrupt, channel, eventHandle);
 
 	// The event handle being 0 means we're removing an event
@@ -185,6 +185,7 @@ void DSPService::registerInterruptEvents(u32 messagePointer) {
 		DSPEvent& e = getEventRef(interrupt, channel);  // Get event
 		if (e.has_value()) {                            // Remove if it exists
 			totalEventCount--;
+			kernel.releaseObject(e.value());
 			e = std::nullopt;
 		}
 	} else {
@@ -193,98 +194,107 @@ void DSPService::registerInterruptEvents(u32 messagePointer) {
 			Helpers::panic("DSP::DSP::RegisterInterruptEvents with invalid event handle");
 		}
 
+		// Replacing an event drops our reference to the old one
+		DSPEvent& e = getEventRef(interrupt, channel);
+		if (e.has_value()) {
+			totalEventCount--;
+			kernel.releaseObject(e.value());
+			e = std::nullopt;
+		}
+
 		if (totalEventCount >= maxEventCount)
 			Helpers::panic("DSP::RegisterInterruptEvents overflowed total number of allowed events");
 		else {
-			getEventRef(interrupt, channel) = eventHandle;
-			mem.write32(messagePointer, IPC::responseHeader(0x15, 1, 0));
-			mem.write32(messagePointer + 4, Result::Success);
+			e = eventHandle;
+			kernel.retainObject(eventHandle);
+			message.respond(0x15, 1, 0);
+			message.write32(1, Result::Success);
 
 			totalEventCount++;
 		}
 	}
 }
 
-void DSPService::getHeadphoneStatus(u32 messagePointer) {
+void DSPService::getHeadphoneStatus(IPC::Message message) {
 	log("DSP::GetHeadphoneStatus\n");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x1F, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x1F, 2, 0);
+	message.write32(1, Result::Success);
 	// This should be toggleable for shits and giggles
-	mem.write32(messagePointer + 8, headphonesInserted ? Result::HeadphonesInserted : Result::HeadphonesNotInserted);
+	message.write32(2, headphonesInserted ? Result::HeadphonesInserted : Result::HeadphonesNotInserted);
 }
 
-void DSPService::getSemaphoreEventHandle(u32 messagePointer) {
+void DSPService::getSemaphoreEventHandle(IPC::Message message) {
 	log("DSP::GetSemaphoreEventHandle\n");
 
 	if (!semaphoreEvent.has_value()) {
 		semaphoreEvent = kernel.makeEvent(ResetType::OneShot, Event::CallbackType::DSPSemaphore);
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x16, 1, 2));
-	mem.write32(messagePointer + 4, Result::Success);
-	// TODO: Translation descriptor here?
-	mem.write32(messagePointer + 12, semaphoreEvent.value());  // Semaphore event handle
+	message.respond(0x16, 1, 2);
+	message.write32(1, Result::Success);
+	message.write32(2, IPC::copyHandleDescriptor(1));
+	message.write32(3, semaphoreEvent.value());  // Semaphore event handle
 	kernel.signalEvent(semaphoreEvent.value());
 }
 
-void DSPService::setSemaphore(u32 messagePointer) {
-	const u16 value = mem.read16(messagePointer + 4);
+void DSPService::setSemaphore(IPC::Message message) {
+	const u16 value = message.read16(1);
 	log("DSP::SetSemaphore(value = %04X)\n", value);
 
 	dsp->setSemaphore(value);
-	mem.write32(messagePointer, IPC::responseHeader(0x7, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x7, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void DSPService::setSemaphoreMask(u32 messagePointer) {
-	const u16 mask = mem.read16(messagePointer + 4);
+void DSPService::setSemaphoreMask(IPC::Message message) {
+	const u16 mask = message.read16(1);
 	log("DSP::SetSemaphoreMask(mask = %04X)\n", mask);
 
 	dsp->setSemaphoreMask(mask);
 	semaphoreMask = mask;
 
-	mem.write32(messagePointer, IPC::responseHeader(0x17, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x17, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void DSPService::writeProcessPipe(u32 messagePointer) {
-	const u32 channel = mem.read32(messagePointer + 4);
-	const u32 size = mem.read32(messagePointer + 8);
-	const u32 buffer = mem.read32(messagePointer + 16);
+void DSPService::writeProcessPipe(IPC::Message message) {
+	const u32 channel = message.read32(1);
+	const u32 size = message.read32(2);
+	const u32 buffer = message.readStaticBuffer(3).address;
 	log("DSP::writeProcessPipe (channel = %d, size = %X, buffer = %08X)\n", channel, size, buffer);
 
 	dsp->writeProcessPipe(channel, size, buffer);
-	mem.write32(messagePointer, IPC::responseHeader(0xD, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0xD, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void DSPService::flushDataCache(u32 messagePointer) {
-	const u32 address = mem.read32(messagePointer + 4);
-	const u32 size = mem.read32(messagePointer + 8);
-	const Handle process = mem.read32(messagePointer + 16);
+void DSPService::flushDataCache(IPC::Message message) {
+	const u32 address = message.read32(1);
+	const u32 size = message.read32(2);
+	const Handle process = message.read32(4);
 
 	log("DSP::FlushDataCache (addr = %08X, size = %08X, process = %X)\n", address, size, process);
-	mem.write32(messagePointer, IPC::responseHeader(0x13, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x13, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void DSPService::invalidateDCache(u32 messagePointer) {
-	const u32 address = mem.read32(messagePointer + 4);
-	const u32 size = mem.read32(messagePointer + 8);
-	const Handle process = mem.read32(messagePointer + 16);
+void DSPService::invalidateDCache(IPC::Message message) {
+	const u32 address = message.read32(1);
+	const u32 size = message.read32(2);
+	const Handle process = message.read32(4);
 
 	log("DSP::InvalidateDataCache (addr = %08X, size = %08X, process = %X)\n", address, size, process);
-	mem.write32(messagePointer, IPC::responseHeader(0x14, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x14, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void DSPService::forceHeadphoneOut(u32 messagePointer) {
-	headphonesInserted = mem.read8(messagePointer + 4) != 0;
+void DSPService::forceHeadphoneOut(IPC::Message message) {
+	headphonesInserted = message.read8(1) != 0;
 
 	log("DSP::ForceHeadphoneOut\n");
-	mem.write32(messagePointer, IPC::responseHeader(0x20, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x20, 1, 0);
+	message.write32(1, Result::Success);
 }
 
 DSPService::ComponentDumpResult DSPService::dumpComponent(const std::filesystem::path& path) {
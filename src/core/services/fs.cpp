@@ -107,10 +107,8 @@ ArchiveBase* FSService::getArchiveFromID(u32 id, const FSPath& archivePath) {
 std::optional<HorizonHandle> FSService::openFileHandle(ArchiveBase* archive, const FSPath& path, const FSPath& archivePath, const FilePerms& perms) {
 	FileDescriptor opened = archive->openFile(path, perms);
 	if (opened.has_value()) {  // If opened doesn't have a value, we failed to open the file
-		auto handle = kernel.makeObject(KernelObjectType::File);
-
-		auto& file = kernel.getObjects()[handle];
-		file.data = new FileSession(archive, path, archivePath, opened.value());
+		auto handle = kernel.makeObject(KernelObjectType::File, true);
+		kernel.makeObjectData<FileSession>(handle, archive, path, archivePath, opened.value());
 
 		return handle;
 	} else {
@@ -121,9 +119,8 @@ std::optional<HorizonHandle> FSService::openFileHandle(ArchiveBase* archive, con
 Rust::Result<HorizonHandle, Result::HorizonResult> FSService::openDirectoryHandle(ArchiveBase* archive, const FSPath& path) {
 	Rust::Result<DirectorySession, Result::HorizonResult> opened = archive->openDirectory(path);
 	if (opened.isOk()) {  // If opened doesn't have a value, we failed to open the directory
-		auto handle = kernel.makeObject(KernelObjectType::Directory);
-		auto& object = kernel.getObjects()[handle];
-		object.data = new DirectorySession(opened.unwrap());
+		auto handle = kernel.makeObject(KernelObjectType::Directory, true);
+		kernel.makeObjectData<DirectorySession>(handle, opened.unwrap());
 
 		return Ok(handle);
 	} else {
@@ -142,8 +139,7 @@ Rust::Result<HorizonHandle, Result::HorizonResult> FSService::openArchiveHandle(
 	Rust::Result<ArchiveBase*, Result::HorizonResult> res = archive->openArchive(path);
 	if (res.isOk()) {
 		auto handle = kernel.makeObject(KernelObjectType::Archive);
-		auto& archiveObject = kernel.getObjects()[handle];
-		archiveObject.data = new ArchiveSession(res.unwrap(), path);
+		kernel.makeObjectData<ArchiveSession>(handle, res.unwrap(), path);
 
 		return Ok(handle);
 	} else {
@@ -161,113 +157,114 @@ FSPath FSService::readPath(u32 type, u32 pointer, u32 size) {
 }
 
 void FSService::handleSyncRequest(u32 messagePointer) {
-	const u32 command = mem.read32(messagePointer);
+	IPC::Message message(mem, messagePointer);
+	const u32 command = message.header();
 	switch (command) {
-		case FSCommands::CardSlotIsInserted: cardSlotIsInserted(messagePointer); break;
-		case FSCommands::CreateDirectory: createDirectory(messagePointer); break;
-		case FSCommands::CreateExtSaveData: createExtSaveData(messagePointer); break;
-		case FSCommands::CreateFile: createFile(messagePointer); break;
-		case FSCommands::ControlArchive: controlArchive(messagePointer); break;
-		case FSCommands::CloseArchive: closeArchive(messagePointer); break;
-		case FSCommands::DeleteDirectory: deleteDirectory(messagePointer); break;
-		case FSCommands::DeleteExtSaveData: deleteExtSaveData(messagePointer); break;
-		case FSCommands::DeleteFile: deleteFile(messagePointer); break;
-		case FSCommands::FormatSaveData: formatSaveData(messagePointer); break;
-		case FSCommands::FormatThisUserSaveData: formatThisUserSaveData(messagePointer); break;
-		case FSCommands::GetArchiveResource: getArchiveResource(messagePointer); break;
-		case FSCommands::GetFreeBytes: getFreeBytes(messagePointer); break;
-		case FSCommands::GetFormatInfo: getFormatInfo(messagePointer); break;
-		case FSCommands::GetPriority: getPriority(messagePointer); break;
-		case FSCommands::GetSdmcArchiveResource: getSdmcArchiveResource(messagePointer); break;
-		case FSCommands::GetThisSaveDataSecureValue: getThisSaveDataSecureValue(messagePointer); break;
-		case FSCommands::Initialize: initialize(messagePointer); break;
-		case FSCommands::InitializeWithSdkVersion: initializeWithSdkVersion(messagePointer); break;
-		case FSCommands::IsSdmcDetected: isSdmcDetected(messagePointer); break;
-		case FSCommands::IsSdmcWritable: isSdmcWritable(messagePointer); break;
-		case FSCommands::OpenArchive: openArchive(messagePointer); break;
-		case FSCommands::OpenDirectory: openDirectory(messagePointer); break;
-		case FSCommands::OpenFile: [[likely]] openFile(messagePointer); break;
-		case FSCommands::OpenFileDirectly: [[likely]] openFileDirectly(messagePointer); break;
-		case FSCommands::RenameFile: renameFile(messagePointer); break;
-		case FSCommands::SetArchivePriority: setArchivePriority(messagePointer); break;
-		case FSCommands::SetPriority: setPriority(messagePointer); break;
-		case FSCommands::SetThisSaveDataSecureValue: setThisSaveDataSecureValue(messagePointer); break;
-		case FSCommands::AbnegateAccessRight: abnegateAccessRight(messagePointer); break;
-		case FSCommands::TheGameboyVCFunction: theGameboyVCFunction(messagePointer); break;
+		case FSCommands::CardSlotIsInserted: cardSlotIsInserted(message); break;
+		case FSCommands::CreateDirectory: createDirectory(message); break;
+		case FSCommands::CreateExtSaveData: createExtSaveData(message); break;
+		case FSCommands::CreateFile: createFile(message); break;
+		case FSCommands::ControlArchive: controlArchive(message); break;
+		case FSCommands::CloseArchive: closeArchive(message); break;
+		case FSCommands::DeleteDirectory: deleteDirectory(message); break;
+		case FSCommands::DeleteExtSaveData: deleteExtSaveData(message); break;
+		case FSCommands::DeleteFile: deleteFile(message); break;
+		case FSCommands::FormatSaveData: formatSaveData(message); break;
+		case FSCommands::FormatThisUserSaveData: formatThisUserSaveData(message); break;
+		case FSCommands::GetArchiveResource: getArchiveResource(message); break;
+		case FSCommands::GetFreeBytes: getFreeBytes(message); break;
+		case FSCommands::GetFormatInfo: getFormatInfo(message); break;
+		case FSCommands::GetPriority: getPriority(message); break;
+		case FSCommands::GetSdmcArchiveResource: getSdmcArchiveResource(message); break;
+		case FSCommands::GetThisSaveDataSecureValue: getThisSaveDataSecureValue(message); break;
+		case FSCommands::Initialize: initialize(message); break;
+		case FSCommands::InitializeWithSdkVersion: initializeWithSdkVersion(message); break;
+		case FSCommands::IsSdmcDetected: isSdmcDetected(message); break;
+		case FSCommands::IsSdmcWritable: isSdmcWritable(message); break;
+		case FSCommands::OpenArchive: openArchive(message); break;
+		case FSCommands::OpenDirectory: openDirectory(message); break;
+		case FSCommands::OpenFile: [[likely]] openFile(message); break;
+		case FSCommands::OpenFileDirectly: [[likely]] openFileDirectly(message); break;
+		case FSCommands::RenameFile: renameFile(message); break;
+		case FSCommands::SetArchivePriority: setArchivePriority(message); break;
+		case FSCommands::SetPriority: setPriority(message); break;
+		case FSCommands::SetThisSaveDataSecureValue: setThisSaveDataSecureValue(message); break;
+		case FSCommands::AbnegateAccessRight: abnegateAccessRight(message); break;
+		case FSCommands::TheGameboyVCFunction: theGameboyVCFunction(message); break;
 
 		default:
 			Helpers::warn("Unimplemented FS service requested. Command: %08X\n", command);
-			mem.write32(messagePointer + 4, Result::Success);
+			message.write32(1, Result::Success);
 			break;
 	}
 }
 
-void FSService::initialize(u32 messagePointer) {
+void FSService::initialize(IPC::Message message) {
 	log("FS::Initialize\n");
-	mem.write32(messagePointer, IPC::responseHeader(0x801, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x801, 1, 0);
+	message.write32(1, Result::Success);
 }
 
 // TODO: Figure out how this is different from Initialize
-void FSService::initializeWithSdkVersion(u32 messagePointer) {
-	const auto version = mem.read32(messagePointer + 4);
+void FSService::initializeWithSdkVersion(IPC::Message message) {
+	const auto version = message.read32(1);
 	log("FS::InitializeWithSDKVersion(version = %d)\n", version);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x861, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x861, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void FSService::closeArchive(u32 messagePointer) {
-	const Handle handle = static_cast<u32>(mem.read64(messagePointer + 4));  // TODO: archive handles should be 64-bit
+void FSService::closeArchive(IPC::Message message) {
+	const Handle handle = static_cast<u32>(message.read64(1));  // TODO: archive handles should be 64-bit
 	const auto object = kernel.getObject(handle, KernelObjectType::Archive);
 	log("FSService::CloseArchive(handle = %X)\n", handle);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x80E, 1, 0));
+	message.respond(0x80E, 1, 0);
 
 	if (object == nullptr) {
 		log("FSService::CloseArchive: Tried to close invalid archive %X\n", handle);
-		mem.write32(messagePointer + 4, Result::FailurePlaceholder);
+		message.write32(1, Result::FailurePlaceholder);
 	} else {
 		object->getData<ArchiveSession>()->isOpen = false;
-		mem.write32(messagePointer + 4, Result::Success);
+		message.write32(1, Result::Success);
 	}
 }
 
-void FSService::openArchive(u32 messagePointer) {
-	const u32 archiveID = mem.read32(messagePointer + 4);
-	const u32 archivePathType = mem.read32(messagePointer + 8);
-	const u32 archivePathSize = mem.read32(messagePointer + 12);
-	const u32 archivePathPointer = mem.read32(messagePointer + 20);
+void FSService::openArchive(IPC::Message message) {
+	const u32 archiveID = message.read32(1);
+	const u32 archivePathType = message.read32(2);
+	const u32 archivePathSize = message.read32(3);
+	const u32 archivePathPointer = message.readStaticBuffer(4).address;
 
 	auto archivePath = readPath(archivePathType, archivePathPointer, archivePathSize);
 	log("FS::OpenArchive(archive ID = %d, archive path type = %d)\n", archiveID, archivePathType);
 
 	Rust::Result<Handle, Result::HorizonResult> res = openArchiveHandle(archiveID, archivePath);
-	mem.write32(messagePointer, IPC::responseHeader(0x80C, 3, 0));
+	message.respond(0x80C, 3, 0);
 	if (res.isOk()) {
-		mem.write32(messagePointer + 4, Result::Success);
-		mem.write64(messagePointer + 8, res.unwrap());
+		message.write32(1, Result::Success);
+		message.write64(2, res.unwrap());
 	} else {
 		log("FS::OpenArchive: Failed to open archive with id = %d. Error %08X\n", archiveID, (u32)res.unwrapErr());
-		mem.write32(messagePointer + 4, res.unwrapErr());
-		mem.write64(messagePointer + 8, 0);
+		message.write32(1, res.unwrapErr());
+		message.write64(2, 0);
 	}
 }
 
-void FSService::openFile(u32 messagePointer) {
-	const Handle archiveHandle = Handle(mem.read64(messagePointer + 8));
-	const u32 filePathType = mem.read32(messagePointer + 16);
-	const u32 filePathSize = mem.read32(messagePointer + 20);
-	const u32 openFlags = mem.read32(messagePointer + 24);
-	const u32 attributes = mem.read32(messagePointer + 28);
-	const u32 filePathPointer = mem.read32(messagePointer + 36);
+void FSService::openFile(IPC::Message message) {
+	const Handle archiveHandle = Handle(message.read64(2));
+	const u32 filePathType = message.read32(4);
+	const u32 filePathSize = message.read32(5);
+	const u32 openFlags = message.read32(6);
+	const u32 attributes = message.read32(7);
+	const u32 filePathPointer = message.readStaticBuffer(8).address;
 
 	log("FS::OpenFile\n");
 
 	auto archiveObject = kernel.getObject(archiveHandle, KernelObjectType::Archive);
 	if (archiveObject == nullptr) [[unlikely]] {
 		log("FS::OpenFile: Invalid archive handle %d\n", archiveHandle);
-		mem.write32(messagePointer + 4, Result::FailurePlaceholder);
+		message.write32(1, Result::FailurePlaceholder);
 		return;
 	}
 
@@ -278,29 +275,29 @@ void FSService::openFile(u32 messagePointer) {
 	const FilePerms perms(openFlags);
 
 	std::optional<Handle> handle = openFileHandle(archive, filePath, archivePath, perms);
-	mem.write32(messagePointer, IPC::responseHeader(0x802, 1, 2));
+	message.respond(0x802, 1, 2);
 	if (!handle.has_value()) {
 		printf("OpenFile failed\n");
-		mem.write32(messagePointer + 4, Result::FS::FileNotFound);
+		message.write32(1, Result::FS::FileNotFound);
 	} else {
-		mem.write32(messagePointer + 4, Result::Success);
-		mem.write32(messagePointer + 8, 0x10);  // "Move handle descriptor"
-		mem.write32(messagePointer + 12, handle.value());
+		message.write32(1, Result::Success);
+		message.write32(2, IPC::moveHandleDescriptor(1));
+		message.write32(3, handle.value());
 	}
 }
 
-void FSService::createDirectory(u32 messagePointer) {
+void FSService::createDirectory(IPC::Message message) {
 	log("FS::CreateDirectory\n");
 
-	const Handle archiveHandle = (Handle)mem.read64(messagePointer + 8);
-	const u32 pathType = mem.read32(messagePointer + 16);
-	const u32 pathSize = mem.read32(messagePointer + 20);
-	const u32 pathPointer = mem.read32(messagePointer + 32);
+	const Handle archiveHandle = (Handle)message.read64(2);
+	const u32 pathType = message.read32(4);
+	const u32 pathSize = message.read32(5);
+	const u32 pathPointer = message.readStaticBuffer(7).address;
 
 	KernelObject* archiveObject = kernel.getObject(archiveHandle, KernelObjectType::Archive);
 	if (archiveObject == nullptr) [[unlikely]] {
 		log("FS::CreateDirectory: Invalid archive handle %d\n", archiveHandle);
-		mem.write32(messagePointer + 4, Result::FailurePlaceholder);
+		message.write32(1, Result::FailurePlaceholder);
 		return;
 	}
 
@@ -308,21 +305,21 @@ void FSService::createDirectory(u32 messagePointer) {
 	const auto dirPath = readPath(pathType, pathPointer, pathSize);
 	const Result::HorizonResult res = archive->createDirectory(dirPath);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x809, 1, 0));
-	mem.write32(messagePointer + 4, static_cast<u32>(res));
+	message.respond(0x809, 1, 0);
+	message.write32(1, static_cast<u32>(res));
 }
 
-void FSService::openDirectory(u32 messagePointer) {
+void FSService::openDirectory(IPC::Message message) {
 	log("FS::OpenDirectory\n");
-	const Handle archiveHandle = (Handle)mem.read64(messagePointer + 4);
-	const u32 pathType = mem.read32(messagePointer + 12);
-	const u32 pathSize = mem.read32(messagePointer + 16);
-	const u32 pathPointer = mem.read32(messagePointer + 24);
+	const Handle archiveHandle = (Handle)message.read64(1);
+	const u32 pathType = message.read32(3);
+	const u32 pathSize = message.read32(4);
+	const u32 pathPointer = message.readStaticBuffer(5).address;
 
 	KernelObject* archiveObject = kernel.getObject(archiveHandle, KernelObjectType::Archive);
 	if (archiveObject == nullptr) [[unlikely]] {
 		log("FS::OpenDirectory: Invalid archive handle %d\n", archiveHandle);
-		mem.write32(messagePointer + 4, Result::FailurePlaceholder);
+		message.write32(1, Result::FailurePlaceholder);
 		return;
 	}
 
@@ -330,26 +327,27 @@ void FSService::openDirectory(u32 messagePointer) {
 	const auto dirPath = readPath(pathType, pathPointer, pathSize);
 	auto dir = openDirectoryHandle(archive, dirPath);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x80B, 1, 2));
+	message.respond(0x80B, 1, 2);
 	if (dir.isOk()) {
-		mem.write32(messagePointer + 4, Result::Success);
-		mem.write32(messagePointer + 12, dir.unwrap());
+		message.write32(1, Result::Success);
+		message.write32(2, IPC::moveHandleDescriptor(1));
+		message.write32(3, dir.unwrap());
 	} else {
 		printf("FS::OpenDirectory failed\n");
-		mem.write32(messagePointer + 4, static_cast<u32>(dir.unwrapErr()));
+		message.write32(1, static_cast<u32>(dir.unwrapErr()));
 	}
 }
 
-void FSService::openFileDirectly(u32 messagePointer) {
-	const u32 archiveID = mem.read32(messagePointer + 8);
-	const u32 archivePathType = mem.read32(messagePointer + 12);
-	const u32 archivePathSize = mem.read32(messagePointer + 16);
-	const u32 filePathType = mem.read32(messagePointer + 20);
-	const u32 filePathSize = mem.read32(messagePointer + 24);
-	const u32 openFlags = mem.read32(messagePointer + 28);
-	const u32 attributes = mem.read32(messagePointer + 32);
-	const u32 archivePathPointer = mem.read32(messagePointer + 40);
-	const u32 filePathPointer = mem.read32(messagePointer + 48);
+void FSService::openFileDirectly(IPC::Message message) {
+	const u32 archiveID = message.read32(2);
+	const u32 archivePathType = message.read32(3);
+	const u32 archivePathSize = message.read32(4);
+	const u32 filePathType = message.read32(5);
+	const u32 filePathSize = message.read32(6);
+	const u32 openFlags = message.read32(7);
+	const u32 attributes = message.read32(8);
+	const u32 archivePathPointer = message.readStaticBuffer(9).address;
+	const u32 filePathPointer = message.readStaticBuffer(11).address;
 	log("FS::OpenFileDirectly\n");
 
 	auto archivePath = readPath(archivePathType, archivePathPointer, archivePathSize);
@@ -368,30 +366,31 @@ void FSService::openFileDirectly(u32 messagePointer) {
 	archive = res.unwrap();
 
 	std::optional<Handle> handle = openFileHandle(archive, filePath, archivePath, perms);
-	mem.write32(messagePointer, IPC::responseHeader(0x803, 1, 2));
+	message.respond(0x803, 1, 2);
 	if (!handle.has_value()) {
 		printf("OpenFileDirectly failed\n");
-		mem.write32(messagePointer + 4, Result::FS::FileNotFound);
+		message.write32(1, Result::FS::FileNotFound);
 	} else {
-		mem.write32(messagePointer + 4, Result::Success);
-		mem.write32(messagePointer + 12, handle.value());
+		message.write32(1, Result::Success);
+		message.write32(2, IPC::moveHandleDescriptor(1));
+		message.write32(3, handle.value());
 	}
 }
 
-void FSService::createFile(u32 messagePointer) {
-	const Handle archiveHandle = Handle(mem.read64(messagePointer + 8));
-	const u32 filePathType = mem.read32(messagePointer + 16);
-	const u32 filePathSize = mem.read32(messagePointer + 20);
-	const u32 attributes = mem.read32(messagePointer + 24);
-	const u64 size = mem.read64(messagePointer + 28);
-	const u32 filePathPointer = mem.read32(messagePointer + 40);
+void FSService::createFile(IPC::Message message) {
+	const Handle archiveHandle = Handle(message.read64(2));
+	const u32 filePathType = message.read32(4);
+	const u32 filePathSize = message.read32(5);
+	const u32 attributes = message.read32(6);
+	const u64 size = message.read64(7);
+	const u32 filePathPointer = message.readStaticBuffer(9).address;
 
 	log("FS::CreateFile\n");
 
 	auto archiveObject = kernel.getObject(archiveHandle, KernelObjectType::Archive);
 	if (archiveObject == nullptr) [[unlikely]] {
 		log("FS::OpenFile: Invalid archive handle %d\n", archiveHandle);
-		mem.write32(messagePointer + 4, Result::FailurePlaceholder);
+		message.write32(1, Result::FailurePlaceholder);
 		return;
 	}
 
@@ -399,21 +398,21 @@ void FSService::createFile(u32 messagePointer) {
 	auto filePath = readPath(filePathType, filePathPointer, filePathSize);
 
 	Result::HorizonResult res = archive->createFile(filePath, size);
-	mem.write32(messagePointer, IPC::responseHeader(0x808, 1, 0));
-	mem.write32(messagePointer + 4, res);
+	message.respond(0x808, 1, 0);
+	message.write32(1, res);
 }
 
-void FSService::deleteFile(u32 messagePointer) {
-	const Handle archiveHandle = Handle(mem.read64(messagePointer + 8));
-	const u32 filePathType = mem.read32(messagePointer + 16);
-	const u32 filePathSize = mem.read32(messagePointer + 20);
-	const u32 filePathPointer = mem.read32(messagePointer + 28);
+void FSService::deleteFile(IPC::Message message) {
+	const Handle archiveHandle = Handle(message.read64(2));
+	const u32 filePathType = message.read32(4);
+	const u32 filePathSize = message.read32(5);
+	const u32 filePathPointer = message.readStaticBuffer(6).address;
 
 	log("FS::DeleteFile\n");
 	auto archiveObject = kernel.getObject(archiveHandle, KernelObjectType::Archive);
 	if (archiveObject == nullptr) [[unlikely]] {
 		log("FS::DeleteFile: Invalid archive handle %d\n", archiveHandle);
-		mem.write32(messagePointer + 4, Result::FailurePlaceholder);
+		message.write32(1, Result::FailurePlaceholder);
 		return;
 	}
 
@@ -421,27 +420,27 @@ void FSService::deleteFile(u32 messagePointer) {
 	auto filePath = readPath(filePathType, filePathPointer, filePathSize);
 
 	Result::HorizonResult res = archive->deleteFile(filePath);
-	mem.write32(messagePointer, IPC::responseHeader(0x804, 1, 0));
-	mem.write32(messagePointer + 4, static_cast<u32>(res));
+	message.respond(0x804, 1, 0);
+	message.write32(1, static_cast<u32>(res));
 }
 
-void FSService::deleteDirectory(u32 messagePointer) {
-	const Handle archiveHandle = Handle(mem.read64(messagePointer + 8));
-	const u32 filePathType = mem.read32(messagePointer + 16);
-	const u32 filePathSize = mem.read32(messagePointer + 20);
-	const u32 filePathPointer = mem.read32(messagePointer + 28);
+void FSService::deleteDirectory(IPC::Message message) {
+	const Handle archiveHandle = Handle(message.read64(2));
+	const u32 filePathType = message.read32(4);
+	const u32 filePathSize = message.read32(5);
+	const u32 filePathPointer = message.readStaticBuffer(6).address;
 	log("FS::DeleteDirectory\n");
 
 	Helpers::warn("Stubbed FS::DeleteDirectory call!");
-	mem.write32(messagePointer, IPC::responseHeader(0x806, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x806, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void FSService::getFormatInfo(u32 messagePointer) {
-	const u32 archiveID = mem.read32(messagePointer + 4);
-	const u32 pathType = mem.read32(messagePointer + 8);
-	const u32 pathSize = mem.read32(messagePointer + 12);
-	const u32 pathPointer = mem.read32(messagePointer + 20);
+void FSService::getFormatInfo(IPC::Message message) {
+	const u32 archiveID = message.read32(1);
+	const u32 pathType = message.read32(2);
+	const u32 pathSize = message.read32(3);
+	const u32 pathPointer = message.readStaticBuffer(4).address;
 
 	const auto path = readPath(pathType, pathPointer, pathSize);
 	log("FS::GetFormatInfo(archive ID = %d, archive path type = %d)\n", archiveID, pathType);
@@ -451,47 +450,47 @@ void FSService::getFormatInfo(u32 messagePointer) {
 		Helpers::panic("OpenArchive: Tried to open unknown archive %d.", archiveID);
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x845, 5, 0));
+	message.respond(0x845, 5, 0);
 	Rust::Result<ArchiveBase::FormatInfo, Result::HorizonResult> res = archive->getFormatInfo(path);
 
 	// If the FormatInfo was returned, write them to the output buffer. Otherwise, write an error code.
 	if (res.isOk()) {
 		ArchiveBase::FormatInfo info = res.unwrap();
-		mem.write32(messagePointer + 4, Result::Success);
-		mem.write32(messagePointer + 8, info.size);
-		mem.write32(messagePointer + 12, info.numOfDirectories);
-		mem.write32(messagePointer + 16, info.numOfFiles);
-		mem.write8(messagePointer + 20, info.duplicateData ? 1 : 0);
+		message.write32(1, Result::Success);
+		message.write32(2, info.size);
+		message.write32(3, info.numOfDirectories);
+		message.write32(4, info.numOfFiles);
+		message.write8(5, info.duplicateData ? 1 : 0);
 	} else {
-		mem.write32(messagePointer + 4, static_cast<u32>(res.unwrapErr()));
+		message.write32(1, static_cast<u32>(res.unwrapErr()));
 	}
 }
 
-void FSService::formatSaveData(u32 messagePointer) {
+void FSService::formatSaveData(IPC::Message message) {
 	log("FS::FormatSaveData\n");
 
-	const u32 archiveID = mem.read32(messagePointer + 4);
+	const u32 archiveID = message.read32(1);
 	if (archiveID != ArchiveID::SaveData) {
 		Helpers::panic("FS::FormatSaveData: Archive is not SaveData");
 	}
 
 	// Read path and path info
-	const u32 pathType = mem.read32(messagePointer + 8);
-	const u32 pathSize = mem.read32(messagePointer + 12);
-	const u32 pathPointer = mem.read32(messagePointer + 44);
+	const u32 pathType = message.read32(2);
+	const u32 pathSize = message.read32(3);
+	const u32 pathPointer = message.readStaticBuffer(10).address;
 	auto path = readPath(pathType, pathPointer, pathSize);
 	// Size of a block. Seems to always be 0x200
-	const u32 blockSize = mem.read32(messagePointer + 16);
+	const u32 blockSize = message.read32(4);
 
 	if (blockSize != 0x200 && blockSize != 0x1000) {
 		Helpers::panic("FS::FormatSaveData: Invalid SaveData block size");
 	}
 
-	const u32 directoryNum = mem.read32(messagePointer + 20);        // Max number of directories
-	const u32 fileNum = mem.read32(messagePointer + 24);             // Max number of files
-	const u32 directoryBucketNum = mem.read32(messagePointer + 28);  // Not sure what a directory bucket is...?
-	const u32 fileBucketNum = mem.read32(messagePointer + 32);       // Same here
-	const bool duplicateData = mem.read8(messagePointer + 36) != 0;
+	const u32 directoryNum = message.read32(5);        // Max number of directories
+	const u32 fileNum = message.read32(6);             // Max number of files
+	const u32 directoryBucketNum = message.read32(7);  // Not sure what a directory bucket is...?
+	const u32 fileBucketNum = message.read32(8);       // Same here
+	const bool duplicateData = message.read8(9) != 0;
 
 	ArchiveBase::FormatInfo info{
 		.size = blockSize * 0x200,
@@ -501,120 +500,120 @@ void FSService::formatSaveData(u32 messagePointer) {
 	};
 
 	saveData.format(path, info);
-	mem.write32(messagePointer, IPC::responseHeader(0x84C, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x84C, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void FSService::deleteExtSaveData(u32 messagePointer) {
+void FSService::deleteExtSaveData(IPC::Message message) {
 	Helpers::warn("Stubbed call to FS::DeleteExtSaveData!");
 	// First 4 words of parameters are the ExtSaveData info
 	// https://www.3dbrew.org/wiki/Filesystem_services#ExtSaveDataInfo
-	const u8 mediaType = mem.read8(messagePointer + 4);
-	const u64 saveID = mem.read64(messagePointer + 8);
+	const u8 mediaType = message.read8(1);
+	const u64 saveID = message.read64(2);
 	log("FS::DeleteExtSaveData (media type = %d, saveID = %llx) (stubbed)\n", mediaType, saveID);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x0852, 1, 0));
+	message.respond(0x0852, 1, 0);
 	// TODO: We can't properly implement this yet until we properly support title/save IDs. We will stub this and insert a warning for now. Required
 	// for Planet Robobot When we properly implement it, it will just be a recursive directory deletion
-	mem.write32(messagePointer + 4, Result::Success);
+	message.write32(1, Result::Success);
 }
 
-void FSService::createExtSaveData(u32 messagePointer) {
+void FSService::createExtSaveData(IPC::Message message) {
 	Helpers::warn("Stubbed call to FS::CreateExtSaveData!");
 	// First 4 words of parameters are the ExtSaveData info
 	// https://www.3dbrew.org/wiki/Filesystem_services#ExtSaveDataInfo
 	// This creates the ExtSaveData with the specified saveid in the specified media type. It stores the SMDH as "icon" in the root of the created
 	// directory.
-	const u8 mediaType = mem.read8(messagePointer + 4);
-	const u64 saveID = mem.read64(messagePointer + 8);
-	const u32 numOfDirectories = mem.read32(messagePointer + 20);
-	const u32 numOfFiles = mem.read32(messagePointer + 24);
-	const u64 sizeLimit = mem.read64(messagePointer + 28);
-	const u32 smdhSize = mem.read32(messagePointer + 36);
-	const u32 smdhPointer = mem.read32(messagePointer + 44);
+	const u8 mediaType = message.read8(1);
+	const u64 saveID = message.read64(2);
+	const u32 numOfDirectories = message.read32(5);
+	const u32 numOfFiles = message.read32(6);
+	const u64 sizeLimit = message.read64(7);
+	const u32 smdhSize = message.read32(9);
+	const u32 smdhPointer = message.readMappedBuffer(10).address;
 
 	log("FS::CreateExtSaveData (stubbed)\n");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x0851, 1, 0));
+	message.respond(0x0851, 1, 0);
 	// TODO: Similar to DeleteExtSaveData, we need to refactor how our ExtSaveData stuff works before properly implementing this
-	mem.write32(messagePointer + 4, Result::Success);
+	message.write32(1, Result::Success);
 }
 
-void FSService::formatThisUserSaveData(u32 messagePointer) {
+void FSService::formatThisUserSaveData(IPC::Message message) {
 	log("FS::FormatThisUserSaveData\n");
 
-	const u32 blockSize = mem.read32(messagePointer + 4);
-	const u32 directoryNum = mem.read32(messagePointer + 8);         // Max number of directories
-	const u32 fileNum = mem.read32(messagePointer + 12);             // Max number of files
-	const u32 directoryBucketNum = mem.read32(messagePointer + 16);  // Not sure what a directory bucket is...?
-	const u32 fileBucketNum = mem.read32(messagePointer + 20);       // Same here
-	const bool duplicateData = mem.read8(messagePointer + 24) != 0;
+	const u32 blockSize = message.read32(1);
+	const u32 directoryNum = message.read32(2);        // Max number of directories
+	const u32 fileNum = message.read32(3);             // Max number of files
+	const u32 directoryBucketNum = message.read32(4);  // Not sure what a directory bucket is...?
+	const u32 fileBucketNum = message.read32(5);       // Same here
+	const bool duplicateData = message.read8(6) != 0;
 
 	ArchiveBase::FormatInfo info{.size = blockSize * 0x200, .numOfDirectories = directoryNum, .numOfFiles = fileNum, .duplicateData = duplicateData};
 	FSPath emptyPath;
 
-	mem.write32(messagePointer, IPC::responseHeader(0x080F, 1, 0));
+	message.respond(0x080F, 1, 0);
 	saveData.format(emptyPath, info);
 }
 
-void FSService::controlArchive(u32 messagePointer) {
-	const Handle archiveHandle = Handle(mem.read64(messagePointer + 4));
-	const u32 action = mem.read32(messagePointer + 12);
-	const u32 inputSize = mem.read32(messagePointer + 16);
-	const u32 outputSize = mem.read32(messagePointer + 20);
-	const u32 input = mem.read32(messagePointer + 28);
-	const u32 output = mem.read32(messagePointer + 36);
+void FSService::controlArchive(IPC::Message message) {
+	const Handle archiveHandle = Handle(message.read64(1));
+	const u32 action = message.read32(3);
+	const u32 inputSize = message.read32(4);
+	const u32 outputSize = message.read32(5);
+	const u32 input = message.readMappedBuffer(6).address;
+	const u32 output = message.readMappedBuffer(8).address;
 
 	log("FS::ControlArchive (action = %X, handle = %X)\n", action, archiveHandle);
 
 	auto archiveObject = kernel.getObject(archiveHandle, KernelObjectType::Archive);
-	mem.write32(messagePointer, IPC::responseHeader(0x80D, 1, 0));
+	message.respond(0x80D, 1, 0);
 	if (archiveObject == nullptr) [[unlikely]] {
 		log("FS::ControlArchive: Invalid archive handle %d\n", archiveHandle);
-		mem.write32(messagePointer + 4, Result::FailurePlaceholder);
+		message.write32(1, Result::FailurePlaceholder);
 		return;
 	}
 
 	switch (action) {
 		case 0:  // Commit save data changes. Shouldn't need us to do anything
-			mem.write32(messagePointer + 4, Result::Success);
+			message.write32(1, Result::Success);
 			break;
 
 		case 1:  // Retrieves a file's last-modified timestamp. Seen in DDLC, stubbed for the moment
 			Helpers::warn("FS::ControlArchive: Tried to retrieve a file's last-modified timestamp");
-			mem.write32(messagePointer + 4, Result::Success);
+			message.write32(1, Result::Success);
 			break;
 
 		default: Helpers::panic("Unimplemented action for ControlArchive (action = %X)\n", action); break;
 	}
 }
 
-void FSService::getFreeBytes(u32 messagePointer) {
+void FSService::getFreeBytes(IPC::Message message) {
 	log("FS::GetFreeBytes\n");
-	const Handle archiveHandle = (Handle)mem.read64(messagePointer + 4);
+	const Handle archiveHandle = (Handle)message.read64(1);
 	auto session = kernel.getObject(archiveHandle, KernelObjectType::Archive);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x812, 3, 0));
+	message.respond(0x812, 3, 0);
 	if (session == nullptr) [[unlikely]] {
 		log("FS::GetFreeBytes: Invalid archive handle %d\n", archiveHandle);
-		mem.write32(messagePointer + 4, Result::FailurePlaceholder);
+		message.write32(1, Result::FailurePlaceholder);
 		return;
 	}
 
 	const u64 bytes = session->getData<ArchiveSession>()->archive->getFreeBytes();
-	mem.write64(messagePointer + 8, bytes);
+	message.write64(2, bytes);
 }
 
-void FSService::getPriority(u32 messagePointer) {
+void FSService::getPriority(IPC::Message message) {
 	log("FS::GetPriority\n");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x863, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write32(messagePointer + 8, priority);
+	message.respond(0x863, 2, 0);
+	message.write32(1, Result::Success);
+	message.write32(2, priority);
 }
 
-void FSService::getArchiveResource(u32 messagePointer) {
-	const u32 mediaType = mem.read32(messagePointer + 4);
+void FSService::getArchiveResource(IPC::Message message) {
+	const u32 mediaType = message.read32(1);
 	log("FS::GetArchiveResource (media type = %d) (stubbed)\n");
 
 	// For the time being, return the same stubbed archive resource for every media type
@@ -625,120 +624,120 @@ void FSService::getArchiveResource(u32 messagePointer) {
 		.freeSpaceInClusters = 0x80000,          // Same here
 	};
 
-	mem.write32(messagePointer, IPC::responseHeader(0x849, 5, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x849, 5, 0);
+	message.write32(1, Result::Success);
 
-	mem.write32(messagePointer + 8, resource.sectorSize);
-	mem.write32(messagePointer + 12, resource.clusterSize);
-	mem.write32(messagePointer + 16, resource.partitionCapacityInClusters);
-	mem.write32(messagePointer + 20, resource.freeSpaceInClusters);
+	message.write32(2, resource.sectorSize);
+	message.write32(3, resource.clusterSize);
+	message.write32(4, resource.partitionCapacityInClusters);
+	message.write32(5, resource.freeSpaceInClusters);
 }
 
-void FSService::setArchivePriority(u32 messagePointer) {
-	Handle archive = mem.read64(messagePointer + 4);
-	const u32 value = mem.read32(messagePointer + 12);
+void FSService::setArchivePriority(IPC::Message message) {
+	Handle archive = message.read64(1);
+	const u32 value = message.read32(3);
 	log("FS::SetArchivePriority (priority = %d, archive handle = %X)\n", value, handle);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x85A, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x85A, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void FSService::setPriority(u32 messagePointer) {
-	const u32 value = mem.read32(messagePointer + 4);
+void FSService::setPriority(IPC::Message message) {
+	const u32 value = message.read32(1);
 	log("FS::SetPriority (priority = %d)\n", value);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x862, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x862, 1, 0);
+	message.write32(1, Result::Success);
 	priority = value;
 }
 
-void FSService::abnegateAccessRight(u32 messagePointer) {
-	const u32 right = mem.read32(messagePointer + 4);
+void FSService::abnegateAccessRight(IPC::Message message) {
+	const u32 right = message.read32(1);
 	log("FS::AbnegateAccessRight (right = %d)\n", right);
 
 	if (right >= 0x38) {
 		Helpers::warn("FS::AbnegateAccessRight: Invalid access right");
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x840, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x840, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void FSService::getThisSaveDataSecureValue(u32 messagePointer) {
+void FSService::getThisSaveDataSecureValue(IPC::Message message) {
 	Helpers::warn("Unimplemented FS::GetThisSaveDataSecureValue");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x86F, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write8(messagePointer + 8, 0);    // Secure value does not exist
-	mem.write8(messagePointer + 12, 1);   // TODO: What is this?
-	mem.write64(messagePointer + 16, 0);  // Secure value
+	message.respond(0x86F, 1, 0);
+	message.write32(1, Result::Success);
+	message.write8(2, 0);   // Secure value does not exist
+	message.write8(3, 1);   // TODO: What is this?
+	message.write64(4, 0);  // Secure value
 }
 
-void FSService::setThisSaveDataSecureValue(u32 messagePointer) {
-	const u64 value = mem.read32(messagePointer + 4);
-	const u32 slot = mem.read32(messagePointer + 12);
-	const u32 id = mem.read32(messagePointer + 16);
-	const u8 variation = mem.read8(messagePointer + 20);
+void FSService::setThisSaveDataSecureValue(IPC::Message message) {
+	const u64 value = message.read32(1);
+	const u32 slot = message.read32(3);
+	const u32 id = message.read32(4);
+	const u8 variation = message.read8(5);
 
 	// TODO: Actually do something with this.
 	Helpers::warn("Unimplemented FS::SetThisSaveDataSecureValue");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x86E, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x86E, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void FSService::theGameboyVCFunction(u32 messagePointer) {
+void FSService::theGameboyVCFunction(IPC::Message message) {
 	Helpers::warn("Unimplemented FS: function: 0x08750180");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x875, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x875, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void FSService::isSdmcDetected(u32 messagePointer) {
+void FSService::isSdmcDetected(IPC::Message message) {
 	log("FS::IsSdmcDetected\n");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x817, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write8(messagePointer + 8, config.sdCardInserted ? 1 : 0);
+	message.respond(0x817, 2, 0);
+	message.write32(1, Result::Success);
+	message.write8(2, config.sdCardInserted ? 1 : 0);
 }
 
 // We consider our SD card to always be writable if one is inserted for now
 // However we do make sure to respect the configs and properly return the correct value here
-void FSService::isSdmcWritable(u32 messagePointer) {
+void FSService::isSdmcWritable(IPC::Message message) {
 	log("FS::isSdmcWritable\n");
 	const bool writeProtected = (!config.sdCardInserted) || (config.sdCardInserted && config.sdWriteProtected);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x818, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write8(messagePointer + 8, writeProtected ? 0 : 1);
+	message.respond(0x818, 2, 0);
+	message.write32(1, Result::Success);
+	message.write8(2, writeProtected ? 0 : 1);
 }
 
-void FSService::cardSlotIsInserted(u32 messagePointer) {
+void FSService::cardSlotIsInserted(IPC::Message message) {
 	log("FS::CardSlotIsInserted\n");
 	constexpr bool cardInserted = false;
 
-	mem.write32(messagePointer, IPC::responseHeader(0x821, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write8(messagePointer + 8, cardInserted ? 1 : 0);
+	message.respond(0x821, 2, 0);
+	message.write32(1, Result::Success);
+	message.write8(2, cardInserted ? 1 : 0);
 }
 
-void FSService::renameFile(u32 messagePointer) {
+void FSService::renameFile(IPC::Message message) {
 	log("FS::RenameFile\n");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x805, 1, 0));
+	message.respond(0x805, 1, 0);
 
-	const Handle sourceArchiveHandle = mem.read64(messagePointer + 8);
-	const Handle destArchiveHandle = mem.read64(messagePointer + 24);
+	const Handle sourceArchiveHandle = message.read64(2);
+	const Handle destArchiveHandle = message.read64(6);
 
 	// Read path info
-	const u32 sourcePathType = mem.read32(messagePointer + 16);
-	const u32 sourcePathSize = mem.read32(messagePointer + 20);
-	const u32 sourcePathPointer = mem.read32(messagePointer + 44);
+	const u32 sourcePathType = message.read32(4);
+	const u32 sourcePathSize = message.read32(5);
+	const u32 sourcePathPointer = message.readStaticBuffer(10).address;
 	const FSPath sourcePath = readPath(sourcePathType, sourcePathPointer, sourcePathSize);
 
-	const u32 destPathType = mem.read32(messagePointer + 32);
-	const u32 destPathSize = mem.read32(messagePointer + 36);
-	const u32 destPathPointer = mem.read32(messagePointer + 52);
+	const u32 destPathType = message.read32(8);
+	const u32 destPathSize = message.read32(9);
+	const u32 destPathPointer = message.readStaticBuffer(12).address;
 	const FSPath destPath = readPath(destPathType, destPathPointer, destPathSize);
 
 	const auto sourceArchiveObject = kernel.getObject(sourceArchiveHandle, KernelObjectType::Archive);
@@ -761,10 +760,10 @@ void FSService::renameFile(u32 messagePointer) {
 
 	// Everything is OK, let's do the rename. Both archives should match so we don't need the dest anymore
 	const HorizonResult res = sourceArchive->archive->renameFile(sourcePath, destPath);
-	mem.write32(messagePointer + 4, static_cast<u32>(res));
+	message.write32(1, static_cast<u32>(res));
 }
 
-void FSService::getSdmcArchiveResource(u32 messagePointer) {
+void FSService::getSdmcArchiveResource(IPC::Message message) {
 	log("FS::GetSdmcArchiveResource");  // For the time being, return the same stubbed archive resource for every media type
 
 	static constexpr ArchiveResource resource = {
@@ -774,11 +773,11 @@ void FSService::getSdmcArchiveResource(u32 messagePointer) {
 		.freeSpaceInClusters = 0x80000,          // Same here
 	};
 
-	mem.write32(messagePointer, IPC::responseHeader(0x814, 5, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x814, 5, 0);
+	message.write32(1, Result::Success);
 
-	mem.write32(messagePointer + 8, resource.sectorSize);
-	mem.write32(messagePointer + 12, resource.clusterSize);
-	mem.write32(messagePointer + 16, resource.partitionCapacityInClusters);
-	mem.write32(messagePointer + 20, resource.freeSpaceInClusters);
+	message.write32(2, resource.sectorSize);
+	message.write32(3, resource.clusterSize);
+	message.write32(4, resource.partitionCapacityInClusters);
+	message.write32(5, resource.freeSpaceInClusters);
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "services/gsp_gpu.hpp"
 
+#include <algorithm>
+
 #include "PICA/regs.hpp"
 #include "ipc.hpp"
 #include "kernel.hpp"
@@ -39,43 +41,79 @@ namespace GXCommands {
 	};
 }
 
+GPUService::~GPUService() { gpuThread.stop(); }
+
 void GPUService::reset() {
 	privilegedProcess = 0xFFFFFFFF;  // Set the privileged process to an invalid handle
-	interruptEvent = std::nullopt;
+	interruptEvents.fill(std::nullopt);
+	gspThreadPIDs.fill(0);
 	gspThreadCount = 0;
+	activeGSPThread = noGSPThread;
+	executingGSPThread = 0;
 	sharedMem = nullptr;
+
+	gpuThread.stop();
+	hazards.clear();
+	completedInterrupts.clear();
+	syncEventScheduled = false;
+
+	// The OpenGL and Metal renderers can only be driven from the thread that owns their context, so GX commands need to run on the emulator thread
+	const bool rendererSupportsAsync = config.rendererType != RendererType::OpenGL && config.rendererType != RendererType::Metal;
+	asyncCommands = config.asyncGXCommands && rendererSupportsAsync;
+
+	if (config.asyncGXCommands && !rendererSupportsAsync) {
+		Helpers::warn("Async GX commands are not supported with the %s renderer, ignoring\n", Renderer::typeToString(config.rendererType));
+	}
+
+	if (asyncCommands) {
+		gpuThread.start([this](const GPUThreadCommand& command) { executeThreadCommand(command); });
+	}
 }
 
 void GPUService::handleSyncRequest(u32 messagePointer) {
-	const u32 command = mem.read32(messagePointer);
+	IPC::Message message(mem, messagePointer);
+	const u32 command = message.header();
+	// Commands that read or modify GPU state need to wait for in-flight GX commands first. Register writes get recorded to the GPU thread's
+	// command ring instead, while cache operations only wait for commands that touch the affected memory
 	switch (command) {
-		case ServiceCommands::TriggerCmdReqQueue: [[likely]] triggerCmdReqQueue(messagePointer); break;
-		case ServiceCommands::AcquireRight: acquireRight(messagePointer); break;
-		case ServiceCommands::FlushDataCache: flushDataCache(messagePointer); break;
-		case ServiceCommands::ImportDisplayCaptureInfo: importDisplayCaptureInfo(messagePointer); break;
-		case ServiceCommands::RegisterInterruptRelayQueue: registerInterruptRelayQueue(messagePointer); break;
-		case ServiceCommands::ReleaseRight: releaseRight(messagePointer); break;
-		case ServiceCommands::RestoreVramSysArea: restoreVramSysArea(messagePointer); break;
-		case ServiceCommands::SaveVramSysArea: saveVramSysArea(messagePointer); break;
-		case ServiceCommands::SetAxiConfigQoSMode: setAxiConfigQoSMode(messagePointer); break;
-		case ServiceCommands::SetBufferSwap: setBufferSwap(messagePointer); break;
-		case ServiceCommands::SetInternalPriorities: setInternalPriorities(messagePointer); break;
-		case ServiceCommands::SetLCDForceBlack: setLCDForceBlack(messagePointer); break;
-		case ServiceCommands::StoreDataCache: storeDataCache(messagePointer); break;
-		case ServiceCommands::ReadHwRegs: readHwRegs(messagePointer); break;
-		case ServiceCommands::WriteHwRegs: writeHwRegs(messagePointer); break;
-		case ServiceCommands::WriteHwRegsWithMask: writeHwRegsWithMask(messagePointer); break;
-		case ServiceCommands::InvalidateDataCache: invalidateDataCache(messagePointer); break;
+		case ServiceCommands::TriggerCmdReqQueue:
+		case ServiceCommands::WriteHwRegs:
+		case ServiceCommands::WriteHwRegsWithMask:
+		case ServiceCommands::FlushDataCache:
+		case ServiceCommands::InvalidateDataCache:
+		case ServiceCommands::StoreDataCache: break;
+
+		default: syncCommands(); break;
+	}
+
+	switch (command) {
+		case ServiceCommands::TriggerCmdReqQueue: [[likely]] triggerCmdReqQueue(message); break;
+		case ServiceCommands::AcquireRight: acquireRight(message); break;
+		case ServiceCommands::FlushDataCache: flushDataCache(message); break;
+		case ServiceCommands::ImportDisplayCaptureInfo: importDisplayCaptureInfo(message); break;
+		case ServiceCommands::RegisterInterruptRelayQueue: registerInterruptRelayQueue(message); break;
+		case ServiceCommands::ReleaseRight: releaseRight(message); break;
+		case ServiceCommands::RestoreVramSysArea: restoreVramSysArea(message); break;
+		case ServiceCommands::SaveVramSysArea: saveVramSysArea(message); break;
+		case ServiceCommands::SetAxiConfigQoSMode: setAxiConfigQoSMode(message); break;
+		case ServiceCommands::SetBufferSwap: setBufferSwap(message); break;
+		case ServiceCommands::SetInternalPriorities: setInternalPriorities(message); break;
+		case ServiceCommands::SetLCDForceBlack: setLCDForceBlack(message); break;
+		case ServiceCommands::StoreDataCache: storeDataCache(message); break;
+		case ServiceCommands::ReadHwRegs: readHwRegs(message); break;
+		case ServiceCommands::WriteHwRegs: writeHwRegs(message); break;
+		case ServiceCommands::WriteHwRegsWithMask: writeHwRegsWithMask(message); break;
+		case ServiceCommands::InvalidateDataCache: invalidateDataCache(message); break;
 		default:
 			Helpers::warn("GPU service requested. Command: %08X\n", command);
-			mem.write32(messagePointer + 4, Result::Success);
+			message.write32(1, Result::Success);
 			break;
 	}
 }
 
-void GPUService::acquireRight(u32 messagePointer) {
-	const u32 flag = mem.read32(messagePointer + 4);
-	const u32 pid = mem.read32(messagePointer + 12);
+void GPUService::acquireRight(IPC::Message message) {
+	const u32 flag = message.read32(1);
+	const u32 pid = message.read32(3);
 	log("GSP::GPU::AcquireRight (flag = %X, pid = %X)\n", flag, pid);
 
 	if (flag != 0) {
@@ -88,46 +126,65 @@ void GPUService::acquireRight(u32 messagePointer) {
 		privilegedProcess = pid;
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x16, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	// Rights are usually acquired before the process registers its thread, in which case the thread becomes active once it registers
+	activeGSPThread = findGSPThread(privilegedProcess);
+
+	message.respond(0x16, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void GPUService::releaseRight(u32 messagePointer) {
+void GPUService::releaseRight(IPC::Message message) {
 	log("GSP::GPU::ReleaseRight\n");
 	if (privilegedProcess == currentPID) {
 		privilegedProcess = 0xFFFFFFFF;
+		activeGSPThread = noGSPThread;
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x17, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x17, 1, 0);
+	message.write32(1, Result::Success);
 }
 
 // TODO: What is the flags field meant to be?
-// What is the "GSP module thread index" meant to be?
-// How does the shared memory handle thing work?
-void GPUService::registerInterruptRelayQueue(u32 messagePointer) {
-	// Detect if this function is called a 2nd time because we'll likely need to impl threads properly for the GSP
-	if (gspThreadCount >= 1) {
-		Helpers::panic("RegisterInterruptRelayQueue called a second time. Need to implement GSP threads properly");
-	}
-	gspThreadCount += 1;
-
-	const u32 flags = mem.read32(messagePointer + 4);
-	const u32 eventHandle = mem.read32(messagePointer + 12);
+void GPUService::registerInterruptRelayQueue(IPC::Message message) {
+	const u32 flags = message.read32(1);
+	const u32 eventHandle = message.read32(3);
 	log("GSP::GPU::RegisterInterruptRelayQueue (flags = %X, event handle = %X)\n", flags, eventHandle);
 
+	if (gspThreadCount >= maxGSPThreads) {
+		Helpers::panic("GSP::GPU::RegisterInterruptRelayQueue: Too many GSP threads registered");
+	}
+
 	const auto event = kernel.getObject(eventHandle, KernelObjectType::Event);
 	if (event == nullptr) {  // Check if interrupt event is invalid
 		Helpers::panic("Invalid event passed to GSP::GPU::RegisterInterruptRelayQueue");
-	} else {
-		interruptEvent = eventHandle;
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x13, 2, 2));
-	mem.write32(messagePointer + 4, Result::GSP::SuccessRegisterIRQ);  // First init returns a unique result
-	mem.write32(messagePointer + 8, 0);                                // TODO: GSP module thread index
-	mem.write32(messagePointer + 12, 0);                               // Translation descriptor
-	mem.write32(messagePointer + 16, KernelHandles::GSPSharedMemHandle);
+	// The thread index tells the caller where its interrupt queue, framebuffer info and command queue are located in shared memory
+	const u32 threadIndex = gspThreadCount++;
+	interruptEvents[threadIndex] = eventHandle;
+	kernel.retainObject(eventHandle);
+	gspThreadPIDs[threadIndex] = currentPID;
+
+	if (activeGSPThread == noGSPThread && privilegedProcess == currentPID) {
+		activeGSPThread = threadIndex;
+	}
+
+	message.respond(0x13, 2, 2);
+	// The first thread to register gets a unique result code
+	message.write32(1, threadIndex == 0 ? Result::GSP::SuccessRegisterIRQ : Result::Success);
+	message.write32(2, threadIndex);
+	message.write32(3, IPC::copyHandleDescriptor(1));  // Translation descriptor
+	message.write32(4, KernelHandles::GSPSharedMemHandle);
+}
+
+u32 GPUService::findGSPThread(u32 pid) const {
+	for (u32 t = 0; t < gspThreadCount; t++) {
+		if (gspThreadPIDs[t] == pid) {
+			return t;
+		}
+	}
+
+	return noGSPThread;
 }
 
 void GPUService::requestInterrupt(GPUInterrupt type) {
@@ -135,21 +192,25 @@ void GPUService::requestInterrupt(GPUInterrupt type) {
 		return;
 	}
 
-	// TODO: Add support for multiple GSP threads
-	u8 index = sharedMem[0];  // The interrupt block is normally located at sharedMem + processGSPIndex*0x40
-	u8& interruptCount = sharedMem[1];
-	u8 flagIndex = (index + interruptCount) % 0x34;
-	interruptCount++;
+	const bool isVBlank = type == GPUInterrupt::VBlank0 || type == GPUInterrupt::VBlank1;
+	if (!isVBlank) {
+		// Other interrupts are only for the thread that holds the GPU rights
+		if (activeGSPThread != noGSPThread) {
+			relayInterrupt(type, activeGSPThread);
+		}
+		return;
+	}
 
-	sharedMem[2] = 0;                                    // Set error code to 0
-	sharedMem[0xC + flagIndex] = static_cast<u8>(type);  // Write interrupt type to queue
+	// VBlank handling writes to the framebuffer registers, so make sure no GX commands are still in flight
+	syncCommands();
 
 	// Update framebuffer info in shared memory
 	// Most new games check to make sure that the "flag" byte of the framebuffer info header is set to 0
 	// Not emulating this causes Yoshi's Wooly World, Captain Toad, Metroid 2 et al to hang
-	if (type == GPUInterrupt::VBlank0 || type == GPUInterrupt::VBlank1) {
+	const u32 framebufferThread = getFramebufferThread();
+	if (framebufferThread < gspThreadCount) {
 		int screen = static_cast<u32>(type) - static_cast<u32>(GPUInterrupt::VBlank0);  // 0 for top screen, 1 for bottom
-		FramebufferUpdate* update = getFramebufferInfo(screen);
+		FramebufferUpdate* update = getFramebufferInfo(screen, framebufferThread);
 
 		if (update->dirtyFlag & 1) {
 			setBufferSwapImpl(screen, update->framebufferInfo[update->index]);
@@ -157,16 +218,35 @@ void GPUService::requestInterrupt(GPUInterrupt type) {
 		}
 	}
 
-	// Signal interrupt event
-	if (interruptEvent.has_value()) {
-		kernel.signalEvent(interruptEvent.value());
+	// The VBlank interrupts are fired for every thread, even the ones without GPU rights
+	for (u32 t = 0; t < gspThreadCount; t++) {
+		relayInterrupt(type, t);
 	}
 }
 
-void GPUService::readHwRegs(u32 messagePointer) {
-	u32 ioAddr = mem.read32(messagePointer + 4);      // GPU address based at 0x1EB00000, word aligned
-	const u32 size = mem.read32(messagePointer + 8);  // Size in bytes
-	const u32 initialDataPointer = mem.read32(messagePointer + 0x104);
+void GPUService::relayInterrupt(GPUInterrupt type, u32 threadIndex) {
+	if (sharedMem == nullptr || threadIndex >= gspThreadCount) [[unlikely]] {
+		return;
+	}
+
+	// Each thread has its own interrupt queue in shared memory
+	u8* interruptInfo = &sharedMem[interruptInfoOffset + threadIndex * interruptInfoSize];
+	u8 index = interruptInfo[0];
+	u8& interruptCount = interruptInfo[1];
+	u8 flagIndex = (index + interruptCount) % 0x34;
+	interruptCount++;
+
+	interruptInfo[2] = 0;                                    // Set error code to 0
+	interruptInfo[0xC + flagIndex] = static_cast<u8>(type);  // Write interrupt type to queue
+
+	// Signal interrupt event
+	kernel.signalEvent(interruptEvents[threadIndex].value());
+}
+
+void GPUService::readHwRegs(IPC::Message message) {
+	u32 ioAddr = message.read32(1);      // GPU address based at 0x1EB00000, word aligned
+	const u32 size = message.read32(2);  // Size in bytes
+	const u32 initialDataPointer = message.getReceiveBuffer(0).address;
 	u32 dataPointer = initialDataPointer;
 	log("GSP::GPU::ReadHwRegs (GPU address = %08X, size = %X, data address = %08X)\n", ioAddr, size, dataPointer);
 
@@ -192,17 +272,15 @@ void GPUService::readHwRegs(u32 messagePointer) {
 		ioAddr += 4;
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x4, 1, 2));
-	mem.write32(messagePointer + 4, Result::Success);
-	// Translation descriptor. TODO: Make a more generic interface for this
-	mem.write32(messagePointer + 8, u32(size << 14) | 2);
-	mem.write32(messagePointer + 12, initialDataPointer);
+	message.respond(0x4, 1, 2);
+	message.write32(1, Result::Success);
+	message.writeStaticBuffer(2, 0, size, initialDataPointer);
 }
 
-void GPUService::writeHwRegs(u32 messagePointer) {
-	u32 ioAddr = mem.read32(messagePointer + 4);      // GPU address based at 0x1EB00000, word aligned
-	const u32 size = mem.read32(messagePointer + 8);  // Size in bytes
-	u32 dataPointer = mem.read32(messagePointer + 16);
+void GPUService::writeHwRegs(IPC::Message message) {
+	u32 ioAddr = message.read32(1);      // GPU address based at 0x1EB00000, word aligned
+	const u32 size = message.read32(2);  // Size in bytes
+	u32 dataPointer = message.readStaticBuffer(3).address;
 	log("GSP::GPU::writeHwRegs (GPU address = %08X, size = %X, data address = %08X)\n", ioAddr, size, dataPointer);
 
 	// Check for alignment
@@ -221,23 +299,28 @@ void GPUService::writeHwRegs(u32 messagePointer) {
 	ioAddr += 0x1EB00000;
 	for (u32 i = 0; i < size; i += 4) {
 		const u32 value = mem.read32(dataPointer);
-		gpu.writeReg(ioAddr, value);
+		if (asyncCommands) {
+			queueRegisterWrite(ioAddr, value, 0xFFFFFFFF);
+		} else {
+			gpu.writeReg(ioAddr, value);
+		}
+
 		dataPointer += 4;
 		ioAddr += 4;
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x1, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x1, 1, 0);
+	message.write32(1, Result::Success);
 }
 
 // Update sequential GPU registers using an array of data and mask values using this formula
 // GPU register = (register & ~mask) | (data & mask).
-void GPUService::writeHwRegsWithMask(u32 messagePointer) {
-	u32 ioAddr = mem.read32(messagePointer + 4);      // GPU address based at 0x1EB00000, word aligned
-	const u32 size = mem.read32(messagePointer + 8);  // Size in bytes
+void GPUService::writeHwRegsWithMask(IPC::Message message) {
+	u32 ioAddr = message.read32(1);      // GPU address based at 0x1EB00000, word aligned
+	const u32 size = message.read32(2);  // Size in bytes
 
-	u32 dataPointer = mem.read32(messagePointer + 16);  // Data pointer
-	u32 maskPointer = mem.read32(messagePointer + 24);  // Mask pointer
+	u32 dataPointer = message.readStaticBuffer(3).address;  // Data pointer
+	u32 maskPointer = message.readStaticBuffer(5).address;  // Mask pointer
 
 	log("GSP::GPU::writeHwRegsWithMask (GPU address = %08X, size = %X, data address = %08X, mask address = %08X)\n", ioAddr, size, dataPointer,
 		maskPointer);
@@ -257,100 +340,108 @@ void GPUService::writeHwRegsWithMask(u32 messagePointer) {
 
 	ioAddr += 0x1EB00000;
 	for (u32 i = 0; i < size; i += 4) {
-		const u32 current = gpu.readReg(ioAddr);
 		const u32 data = mem.read32(dataPointer);
 		const u32 mask = mem.read32(maskPointer);
 
-		u32 newValue = (current & ~mask) | (data & mask);
+		if (asyncCommands) {
+			// The GPU thread performs the read-modify-write itself, so we don't need to wait for it to get the current register value
+			queueRegisterWrite(ioAddr, data, mask);
+		} else {
+			const u32 current = gpu.readReg(ioAddr);
+			u32 newValue = (current & ~mask) | (data & mask);
+			gpu.writeReg(ioAddr, newValue);
+		}
 
-		gpu.writeReg(ioAddr, newValue);
 		maskPointer += 4;
 		dataPointer += 4;
 		ioAddr += 4;
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0x2, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x2, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void GPUService::flushDataCache(u32 messagePointer) {
-	u32 address = mem.read32(messagePointer + 4);
-	u32 size = mem.read32(messagePointer + 8);
-	u32 processHandle = handle = mem.read32(messagePointer + 16);
+void GPUService::flushDataCache(IPC::Message message) {
+	u32 address = message.read32(1);
+	u32 size = message.read32(2);
+	u32 processHandle = handle = message.read32(4);
 	log("GSP::GPU::FlushDataCache(address = %08X, size = %X, process = %X)\n", address, size, processHandle);
+	syncRange(address, size);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x8, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x8, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void GPUService::invalidateDataCache(u32 messagePointer) {
-	u32 address = mem.read32(messagePointer + 4);
-	u32 size = mem.read32(messagePointer + 8);
-	u32 processHandle = handle = mem.read32(messagePointer + 16);
+void GPUService::invalidateDataCache(IPC::Message message) {
+	u32 address = message.read32(1);
+	u32 size = message.read32(2);
+	u32 processHandle = handle = message.read32(4);
 	log("GSP::GPU::InvalidateDataCache(address = %08X, size = %X, process = %X)\n", address, size, processHandle);
+	syncRange(address, size);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x9, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x9, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void GPUService::storeDataCache(u32 messagePointer) {
-	u32 address = mem.read32(messagePointer + 4);
-	u32 size = mem.read32(messagePointer + 8);
-	u32 processHandle = handle = mem.read32(messagePointer + 16);
+void GPUService::storeDataCache(IPC::Message message) {
+	u32 address = message.read32(1);
+	u32 size = message.read32(2);
+	u32 processHandle = handle = message.read32(4);
 	log("GSP::GPU::StoreDataCache(address = %08X, size = %X, process = %X)\n", address, size, processHandle);
+	syncRange(address, size);
 
-	mem.write32(messagePointer, IPC::responseHeader(0x1F, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x1F, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void GPUService::setLCDForceBlack(u32 messagePointer) {
-	u32 flag = mem.read32(messagePointer + 4);
+void GPUService::setLCDForceBlack(IPC::Message message) {
+	u32 flag = message.read32(1);
 	log("GSP::GPU::SetLCDForceBlank(flag = %d)\n", flag);
 
 	if (flag != 0) {
 		printf("Filled both LCDs with black\n");
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0xB, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0xB, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void GPUService::triggerCmdReqQueue(u32 messagePointer) {
+void GPUService::triggerCmdReqQueue(IPC::Message message) {
 	processCommandBuffer();
-	mem.write32(messagePointer, IPC::responseHeader(0xC, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0xC, 1, 0);
+	message.write32(1, Result::Success);
 }
 
 // Seems to be completely undocumented, probably not very important or useful
-void GPUService::setAxiConfigQoSMode(u32 messagePointer) {
+void GPUService::setAxiConfigQoSMode(IPC::Message message) {
 	log("GSP::GPU::SetAxiConfigQoSMode\n");
-	mem.write32(messagePointer, IPC::responseHeader(0x10, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x10, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void GPUService::setBufferSwap(u32 messagePointer) {
+void GPUService::setBufferSwap(IPC::Message message) {
 	FramebufferInfo info{};
-	const u32 screenId = mem.read32(messagePointer + 4);  // Selects either PDC0 or PDC1
-	info.activeFb = mem.read32(messagePointer + 8);
-	info.leftFramebufferVaddr = mem.read32(messagePointer + 12);
-	info.rightFramebufferVaddr = mem.read32(messagePointer + 16);
-	info.stride = mem.read32(messagePointer + 20);
-	info.format = mem.read32(messagePointer + 24);
-	info.displayFb = mem.read32(messagePointer + 28);  // Selects either framebuffer A or B
+	const u32 screenId = message.read32(1);  // Selects either PDC0 or PDC1
+	info.activeFb = message.read32(2);
+	info.leftFramebufferVaddr = message.read32(3);
+	info.rightFramebufferVaddr = message.read32(4);
+	info.stride = message.read32(5);
+	info.format = message.read32(6);
+	info.displayFb = message.read32(7);  // Selects either framebuffer A or B
 
 	log("GSP::GPU::SetBufferSwap\n");
 	Helpers::warn("Untested GSP::GPU::SetBufferSwap call");
 
 	setBufferSwapImpl(screenId, info);
-	mem.write32(messagePointer, IPC::responseHeader(0x05, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x05, 1, 0);
+	message.write32(1, Result::Success);
 }
 
 // Seems to also be completely undocumented
-void GPUService::setInternalPriorities(u32 messagePointer) {
+void GPUService::setInternalPriorities(IPC::Message message) {
 	log("GSP::GPU::SetInternalPriorities\n");
-	mem.write32(messagePointer, IPC::responseHeader(0x1E, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x1E, 1, 0);
+	message.write32(1, Result::Success);
 }
 
 void GPUService::processCommandBuffer() {
@@ -358,33 +449,140 @@ void GPUService::processCommandBuffer() {
 		return;
 	}
 
-	constexpr int threadCount = 1;  // TODO: More than 1 thread can have GSP commands at a time
-	for (int t = 0; t < threadCount; t++) {
-		u8* cmdBuffer = &sharedMem[0x800 + t * 0x200];
+	bool queuedCommands = false;
+	// More than 1 thread can have GSP commands pending at a time, so go through the command queue of every registered thread
+	for (u32 t = 0; t < std::max<u32>(gspThreadCount, 1); t++) {
+		u8* cmdBuffer = &sharedMem[commandQueueOffset + t * commandQueueSize];
+		u8& currentIndex = cmdBuffer[0];
 		u8& commandsLeft = cmdBuffer[1];
-		// Commands start at byte 0x20 of the command buffer, each being 0x20 bytes long
-		u32* cmd = reinterpret_cast<u32*>(&cmdBuffer[0x20]);
 
-		log("Processing %d GPU commands\n", commandsLeft);
+		if (commandsLeft != 0) {
+			log("Processing %d GPU commands for GSP thread %d\n", commandsLeft, t);
+		}
 
 		while (commandsLeft != 0) {
-			const u32 cmdID = cmd[0] & 0xff;
-			switch (cmdID) {
-				case GXCommands::ProcessCommandList: processCommandList(cmd); break;
-				case GXCommands::MemoryFill: memoryFill(cmd); break;
-				case GXCommands::TriggerDisplayTransfer: triggerDisplayTransfer(cmd); break;
-				case GXCommands::TriggerDMARequest: triggerDMARequest(cmd); break;
-				case GXCommands::TriggerTextureCopy: triggerTextureCopy(cmd); break;
-				case GXCommands::FlushCacheRegions: flushCacheRegions(cmd); break;
-				default: Helpers::panic("GSP::GPU::ProcessCommands: Unknown cmd ID %d", cmdID);
+			// Commands start at byte 0x20 of the command buffer, each being 0x20 bytes long. The queue is a ring buffer of 15 commands
+			u32* cmd = reinterpret_cast<u32*>(&cmdBuffer[0x20 + (currentIndex % commandQueueSlots) * 0x20]);
+
+			if (asyncCommands) {
+				queueGXCommand(cmd, t);
+				queuedCommands = true;
+			} else {
+				executingGSPThread = t;
+				executeCommand(cmd);
 			}
 
+			currentIndex = (currentIndex + 1) % commandQueueSlots;
 			commandsLeft--;
 		}
 	}
+
+	if (queuedCommands) {
+		// Schedule a sync point if there isn't one already. We don't push back an existing one, so that a game constantly submitting commands
+		// still gets its interrupts in a timely manner
+		if (!syncEventScheduled) {
+			Scheduler& scheduler = kernel.getScheduler();
+			scheduler.addEvent(Scheduler::EventType::SyncGX, scheduler.currentTimestamp + gxCommandLatency);
+			syncEventScheduled = true;
+		}
+	}
 }
 
-static u32 VaddrToPaddr(u32 addr) {
+void GPUService::executeCommand(u32* cmd) {
+	const u32 cmdID = cmd[0] & 0xff;
+	switch (cmdID) {
+		case GXCommands::ProcessCommandList: processCommandList(cmd); break;
+		case GXCommands::MemoryFill: memoryFill(cmd); break;
+		case GXCommands::TriggerDisplayTransfer: triggerDisplayTransfer(cmd); break;
+		case GXCommands::TriggerDMARequest: triggerDMARequest(cmd); break;
+		case GXCommands::TriggerTextureCopy: triggerTextureCopy(cmd); break;
+		case GXCommands::FlushCacheRegions: flushCacheRegions(cmd); break;
+		default: Helpers::panic("GSP::GPU::ProcessCommands: Unknown cmd ID %d", cmdID);
+	}
+}
+
+void GPUService::commandFinished(GPUInterrupt type) {
+	if (asyncCommands) {
+		// We're on the GPU thread, so we can't touch the kernel. Buffer the interrupt until the emulator thread syncs with us
+		std::scoped_lock lock(interruptMutex);
+		completedInterrupts.push_back({type, executingGSPThread});
+	} else {
+		relayInterrupt(type, executingGSPThread);
+	}
+}
+
+void GPUService::queueGXCommand(const u32* cmd, u32 threadIndex) {
+	// Copy the command out of shared memory, as the guest is free to reuse the slot once we've popped it from the queue
+	GPUThreadCommand command;
+	command.type = GPUThreadCommand::Type::GX;
+	command.gspThread = threadIndex;
+	std::memcpy(command.payload.data(), cmd, sizeof(command.payload));
+
+	const u64 sequence = gpuThread.push(command);
+	trackHazards(cmd, sequence);
+}
+
+void GPUService::queueRegisterWrite(u32 address, u32 value, u32 mask) {
+	GPUThreadCommand command;
+	command.type = GPUThreadCommand::Type::WriteRegister;
+	command.gspThread = 0;
+	command.payload = {address, value, mask};
+
+	gpuThread.push(command);
+}
+
+void GPUService::executeThreadCommand(const GPUThreadCommand& command) {
+	switch (command.type) {
+		case GPUThreadCommand::Type::GX: {
+			auto cmd = command.payload;
+			executingGSPThread = command.gspThread;
+			executeCommand(cmd.data());
+			break;
+		}
+
+		case GPUThreadCommand::Type::WriteRegister: {
+			const u32 address = command.payload[0];
+			const u32 value = command.payload[1];
+			const u32 mask = command.payload[2];
+
+			if (mask == 0xFFFFFFFF) {
+				gpu.writeReg(address, value);
+			} else {
+				gpu.writeReg(address, (gpu.readReg(address) & ~mask) | (value & mask));
+			}
+			break;
+		}
+	}
+}
+
+void GPUService::syncCommands() {
+	if (!asyncCommands) {
+		return;
+	}
+
+	gpuThread.waitIdle();
+	hazards.clear();
+
+	std::vector<CompletedInterrupt> interrupts;
+	{
+		std::scoped_lock lock(interruptMutex);
+		interrupts.swap(completedInterrupts);
+	}
+
+	// If we got here before the sync event fired, we've already done its job
+	if (syncEventScheduled) {
+		kernel.getScheduler().removeEvent(Scheduler::EventType::SyncGX);
+		syncEventScheduled = false;
+	}
+
+	// Relay the interrupts in the order the commands completed
+	for (const CompletedInterrupt& interrupt : interrupts) {
+		relayInterrupt(interrupt.type, interrupt.gspThread);
+	}
+}
+
+// Translate a virtual address in VRAM or the linear heap to a physical address. Other addresses can't be used by the GPU
+static std::optional<u32> linearVaddrToPaddr(u32 addr) {
 	if (addr >= VirtualAddrs::VramStart && addr < (VirtualAddrs::VramStart + VirtualAddrs::VramSize)) [[likely]] {
 		return addr - VirtualAddrs::VramStart + PhysicalAddrs::VRAM;
 	}
@@ -401,11 +599,86 @@ static u32 VaddrToPaddr(u32 addr) {
 		return 0;
 	}
 
+	return std::nullopt;
+}
+
+static u32 VaddrToPaddr(u32 addr) {
+	if (auto paddr = linearVaddrToPaddr(addr); paddr.has_value()) [[likely]] {
+		return paddr.value();
+	}
+
 	Helpers::warn("[GSP::GPU VaddrToPaddr] Unknown virtual address %08X", addr);
 	// Obviously garbage address
 	return 0xF3310932;
 }
 
+// Record the memory a queued GX command is going to access. For command lists we can only know about the command list itself, as the buffers
+// it uses are only known once the GPU thread executes it. That's fine, as render targets only get written back to memory via display transfers
+void GPUService::trackHazards(const u32* cmd, u64 sequence) {
+	const auto track = [&](u32 vaddr, u32 size) {
+		if (auto paddr = linearVaddrToPaddr(vaddr); paddr.has_value() && vaddr != 0) {
+			hazards.add(paddr.value(), size, sequence);
+		}
+	};
+
+	// Size of a display transfer surface, from its dimensions register and pixel format
+	const auto surfaceSize = [](u32 dimensions, u32 format) {
+		const u32 width = dimensions & 0xffff;
+		const u32 height = dimensions >> 16;
+		return u32(width * height * PICA::sizePerPixel(static_cast<PICA::ColorFmt>(format)));
+	};
+
+	// Size of a texture copy region, from its total size and line width/gap register
+	const auto copySize = [](u32 totalBytes, u32 lineConfig) {
+		const u32 width = (lineConfig & 0xffff) * 16;
+		const u32 gap = (lineConfig >> 16) * 16;
+		return (width == 0) ? totalBytes : u32(u64(totalBytes) * (width + gap) / width);
+	};
+
+	switch (cmd[0] & 0xff) {
+		case GXCommands::ProcessCommandList: track(cmd[1] & ~7, cmd[2] & ~3); break;
+
+		case GXCommands::MemoryFill:
+			track(cmd[1], cmd[3] - cmd[1]);
+			track(cmd[4], cmd[6] - cmd[4]);
+			break;
+
+		case GXCommands::TriggerDisplayTransfer:
+			track(cmd[1], surfaceSize(cmd[3], Helpers::getBits<8, 3>(cmd[5])));
+			track(cmd[2], surfaceSize(cmd[4], Helpers::getBits<12, 3>(cmd[5])));
+			break;
+
+		case GXCommands::TriggerTextureCopy:
+			track(cmd[1], copySize(cmd[3], cmd[4]));
+			track(cmd[2], copySize(cmd[3], cmd[5]));
+			break;
+
+		case GXCommands::TriggerDMARequest:
+			track(cmd[1], cmd[3]);
+			track(cmd[2], cmd[3]);
+			break;
+
+		default: break;
+	}
+}
+
+void GPUService::syncRange(u32 vaddr, u32 size) {
+	if (!asyncCommands) {
+		return;
+	}
+
+	hazards.retire(gpuThread.getCompleted());
+	auto paddr = linearVaddrToPaddr(vaddr);
+	if (!paddr.has_value()) {
+		return;
+	}
+
+	if (const u64 sequence = hazards.findHazard(paddr.value(), size); sequence != 0) {
+		gpuThread.waitFor(sequence);
+		hazards.retire(sequence);
+	}
+}
+
 // Fill 2 GPU framebuffers, buf0 and buf1, using a specific word value
 void GPUService::memoryFill(u32* cmd) {
 	u32 control = cmd[7];
@@ -424,12 +697,12 @@ void GPUService::memoryFill(u32* cmd) {
 
 	if (start0 != 0) {
 		gpu.clearBuffer(VaddrToPaddr(start0), VaddrToPaddr(end0), value0, control0);
-		requestInterrupt(GPUInterrupt::PSC0);
+		commandFinished(GPUInterrupt::PSC0);
 	}
 
 	if (start1 != 0) {
 		gpu.clearBuffer(VaddrToPaddr(start1), VaddrToPaddr(end1), value1, control1);
-		requestInterrupt(GPUInterrupt::PSC1);
+		commandFinished(GPUInterrupt::PSC1);
 	}
 }
 
@@ -442,7 +715,7 @@ void GPUService::triggerDisplayTransfer(u32* cmd) {
 
 	log("GSP::GPU::TriggerDisplayTransfer (Stubbed)\n");
 	gpu.displayTransfer(inputAddr, outputAddr, inputSize, outputSize, flags);
-	requestInterrupt(GPUInterrupt::PPF);  // Send "Display transfer finished" interrupt
+	commandFinished(GPUInterrupt::PPF);  // Send "Display transfer finished" interrupt
 }
 
 void GPUService::triggerDMARequest(u32* cmd) {
@@ -453,7 +726,7 @@ void GPUService::triggerDMARequest(u32* cmd) {
 
 	log("GSP::GPU::TriggerDMARequest (source = %08X, dest = %08X, size = %08X)\n", source, dest, size);
 	gpu.fireDMA(dest, source, size);
-	requestInterrupt(GPUInterrupt::DMA);
+	commandFinished(GPUInterrupt::DMA);
 }
 
 void GPUService::flushCacheRegions(u32* cmd) { log("GSP::GPU::FlushCacheRegions (Stubbed)\n"); }
@@ -491,7 +764,7 @@ void GPUService::processCommandList(u32* cmd) {
 
 	log("GPU::GSP::processCommandList. Address: %08X, size in bytes: %08X\n", address, size);
 	gpu.startCommandList(address, size);
-	requestInterrupt(GPUInterrupt::P3D);  // Send an IRQ when command list processing is over
+	commandFinished(GPUInterrupt::P3D);  // Send an IRQ when command list processing is over
 }
 
 // TODO: Emulate the transfer engine & its registers
@@ -508,31 +781,31 @@ void GPUService::triggerTextureCopy(u32* cmd) {
 	gpu.textureCopy(inputAddr, outputAddr, totalBytes, inputSize, outputSize, flags);
 	// This uses the transfer engine and thus needs to fire a PPF interrupt.
 	// NSMB2 relies on this
-	requestInterrupt(GPUInterrupt::PPF);
+	commandFinished(GPUInterrupt::PPF);
 }
 
 // Used when transitioning from the app to an OS applet, such as software keyboard, mii maker, mii selector, etc
 // Stubbed until we decide to support LLE applets
-void GPUService::saveVramSysArea(u32 messagePointer) {
+void GPUService::saveVramSysArea(IPC::Message message) {
 	Helpers::warn("GSP::GPU::SaveVramSysArea (stubbed)");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x19, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x19, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void GPUService::restoreVramSysArea(u32 messagePointer) {
+void GPUService::restoreVramSysArea(IPC::Message message) {
 	Helpers::warn("GSP::GPU::RestoreVramSysArea (stubbed)");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x1A, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x1A, 1, 0);
+	message.write32(1, Result::Success);
 }
 
 // Used in similar fashion to the SaveVramSysArea function
-void GPUService::importDisplayCaptureInfo(u32 messagePointer) {
+void GPUService::importDisplayCaptureInfo(IPC::Message message) {
 	Helpers::warn("GSP::GPU::ImportDisplayCaptureInfo (stubbed)");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x18, 9, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x18, 9, 0);
+	message.write32(1, Result::Success);
 
 	if (sharedMem == nullptr) {
 		Helpers::warn("GSP::GPU::ImportDisplayCaptureInfo called without GSP module being properly initialized!");
@@ -557,13 +830,13 @@ void GPUService::importDisplayCaptureInfo(u32 messagePointer) {
 		.stride = bottomScreen->framebufferInfo[bottomScreen->index].stride,
 	};
 
-	mem.write32(messagePointer + 8, topScreenCapture.leftFramebuffer);
-	mem.write32(messagePointer + 12, topScreenCapture.rightFramebuffer);
-	mem.write32(messagePointer + 16, topScreenCapture.format);
-	mem.write32(messagePointer + 20, topScreenCapture.stride);
+	message.write32(2, topScreenCapture.leftFramebuffer);
+	message.write32(3, topScreenCapture.rightFramebuffer);
+	message.write32(4, topScreenCapture.format);
+	message.write32(5, topScreenCapture.stride);
 
-	mem.write32(messagePointer + 24, bottomScreenCapture.leftFramebuffer);
-	mem.write32(messagePointer + 28, bottomScreenCapture.rightFramebuffer);
-	mem.write32(messagePointer + 32, bottomScreenCapture.format);
-	mem.write32(messagePointer + 36, bottomScreenCapture.stride);
+	message.write32(6, bottomScreenCapture.leftFramebuffer);
+	message.write32(7, bottomScreenCapture.rightFramebuffer);
+	message.write32(8, bottomScreenCapture.format);
+	message.write32(9, bottomScreenCapture.stride);
 }
\ No newline at end of file
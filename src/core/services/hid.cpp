@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <unordered_map>
 
 #include "ipc.hpp"
@@ -46,88 +47,84 @@ void HIDService::reset() {
 }
 
 void HIDService::handleSyncRequest(u32 messagePointer) {
-	const u32 command = mem.read32(messagePointer);
+	IPC::Message message(mem, messagePointer);
+	const u32 command = message.header();
 	switch (command) {
-		case HIDCommands::DisableAccelerometer: disableAccelerometer(messagePointer); break;
-		case HIDCommands::DisableGyroscopeLow: disableGyroscopeLow(messagePointer); break;
-		case HIDCommands::EnableAccelerometer: enableAccelerometer(messagePointer); break;
-		case HIDCommands::EnableGyroscopeLow: enableGyroscopeLow(messagePointer); break;
-		case HIDCommands::GetGyroscopeLowCalibrateParam: getGyroscopeLowCalibrateParam(messagePointer); break;
-		case HIDCommands::GetGyroscopeLowRawToDpsCoefficient: getGyroscopeCoefficient(messagePointer); break;
-		case HIDCommands::GetIPCHandles: getIPCHandles(messagePointer); break;
-		case HIDCommands::GetSoundVolume: getSoundVolume(messagePointer); break;
+		case HIDCommands::DisableAccelerometer: disableAccelerometer(message); break;
+		case HIDCommands::DisableGyroscopeLow: disableGyroscopeLow(message); break;
+		case HIDCommands::EnableAccelerometer: enableAccelerometer(message); break;
+		case HIDCommands::EnableGyroscopeLow: enableGyroscopeLow(message); break;
+		case HIDCommands::GetGyroscopeLowCalibrateParam: getGyroscopeLowCalibrateParam(message); break;
+		case HIDCommands::GetGyroscopeLowRawToDpsCoefficient: getGyroscopeCoefficient(message); break;
+		case HIDCommands::GetIPCHandles: getIPCHandles(message); break;
+		case HIDCommands::GetSoundVolume: getSoundVolume(message); break;
 		default: Helpers::panic("HID service requested. Command: %08X\n", command);
 	}
 }
 
-void HIDService::enableAccelerometer(u32 messagePointer) {
+void HIDService::enableAccelerometer(IPC::Message message) {
 	log("HID::EnableAccelerometer\n");
 	accelerometerEnabled = true;
 
-	mem.write32(messagePointer, IPC::responseHeader(0x11, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x11, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void HIDService::disableAccelerometer(u32 messagePointer) {
+void HIDService::disableAccelerometer(IPC::Message message) {
 	log("HID::DisableAccelerometer\n");
 	accelerometerEnabled = false;
 
-	mem.write32(messagePointer, IPC::responseHeader(0x12, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x12, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void HIDService::enableGyroscopeLow(u32 messagePointer) {
+void HIDService::enableGyroscopeLow(IPC::Message message) {
 	log("HID::EnableGyroscopeLow\n");
 	gyroEnabled = true;
 
-	mem.write32(messagePointer, IPC::responseHeader(0x13, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x13, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void HIDService::disableGyroscopeLow(u32 messagePointer) {
+void HIDService::disableGyroscopeLow(IPC::Message message) {
 	log("HID::DisableGyroscopeLow\n");
 	gyroEnabled = false;
 
-	mem.write32(messagePointer, IPC::responseHeader(0x14, 1, 0));
-	mem.write32(messagePointer + 4, Result::Success);
+	message.respond(0x14, 1, 0);
+	message.write32(1, Result::Success);
 }
 
-void HIDService::getGyroscopeLowCalibrateParam(u32 messagePointer) {
+void HIDService::getGyroscopeLowCalibrateParam(IPC::Message message) {
 	log("HID::GetGyroscopeLowCalibrateParam\n");
 	constexpr s16 unit = 6700;  // Approximately from Citra which took it from hardware
 
-	mem.write32(messagePointer, IPC::responseHeader(0x16, 6, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	// Fill calibration data (for x/y/z depending on i)
-	for (int i = 0; i < 3; i++) {
-		const u32 pointer = messagePointer + 8 + i * 3 * sizeof(u16);  // Pointer to write the calibration info for the current coordinate
-
-		mem.write16(pointer, 0);                        // Zero point
-		mem.write16(pointer + 1 * sizeof(u16), unit);   // Positive unit point
-		mem.write16(pointer + 2 * sizeof(u16), -unit);  // Negative unit point
-	}
+	message.respond(0x16, 6, 0);
+	message.write32(1, Result::Success);
+	// Fill calibration data for x/y/z. Each coordinate has a zero point, a positive unit point and a negative unit point
+	const std::array<s16, 9> calibration = {0, unit, -unit, 0, unit, -unit, 0, unit, -unit};
+	std::memcpy(message.getPointer(2), calibration.data(), sizeof(calibration));
 }
 
-void HIDService::getGyroscopeCoefficient(u32 messagePointer) {
+void HIDService::getGyroscopeCoefficient(IPC::Message message) {
 	log("HID::GetGyroscopeLowRawToDpsCoefficient\n");
 
-	mem.write32(messagePointer, IPC::responseHeader(0x15, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write32(messagePointer + 8, Helpers::bit_cast<u32, float>(gyroscopeCoeff));
+	message.respond(0x15, 2, 0);
+	message.write32(1, Result::Success);
+	message.write32(2, Helpers::bit_cast<u32, float>(gyroscopeCoeff));
 }
 
 // The volume here is in the range [0, 0x3F]
 // It is read directly from I2C Device 3 register 0x09
-void HIDService::getSoundVolume(u32 messagePointer) {
+void HIDService::getSoundVolume(IPC::Message message) {
 	log("HID::GetSoundVolume\n");
 	constexpr u8 volume = 0x30;
 
-	mem.write32(messagePointer, IPC::responseHeader(0x17, 2, 0));
-	mem.write32(messagePointer + 4, Result::Success);
-	mem.write8(messagePointer + 8, volume);
+	message.respond(0x17, 2, 0);
+	message.write32(1, Result::Success);
+	message.write8(2, volume);
 }
 
-void HIDService::getIPCHandles(u32 messagePointer) {
+void HIDService::getIPCHandles(IPC::Message message) {
 	log("HID::GetIPCHandles\n");
 
 	// Initialize HID events
@@ -139,14 +136,14 @@ void HIDService::getIPCHandles(u32 messagePointer) {
 		}
 	}
 
-	mem.write32(messagePointer, IPC::responseHeader(0xA, 1, 7));
-	mem.write32(messagePointer + 4, Result::Success);                     // Result code
-	mem.write32(messagePointer + 8, 0x14000000);                          // Translation descriptor
-	mem.write32(messagePointer + 12, KernelHandles::HIDSharedMemHandle);  // Shared memory handle
+	message.respond(0xA, 1, 7);
+	message.write32(1, Result::Success);                    // Result code
+	message.write32(2, IPC::copyHandleDescriptor(6));       // Translation descriptor
+	message.write32(3, KernelHandles::HIDSharedMemHandle);  // Shared memory handle
 
 	// Write HID event handles
 	for (int i = 0; i < events.size(); i++) {
-		mem.write32(messagePointer + 16 + sizeof(Handle) * i, events[i].value());
+		message.write32(4 + i, events[i].value());
 	}
 }
 
@@ -0,0 +1,72 @@
+#include "services/ipc_stats.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+
+usize IPCStats::getBucket(u64 nanoseconds) {
+	const u64 microseconds = nanoseconds / 1000;
+	return std::min<usize>(std::bit_width(microseconds), bucketCount - 1);
+}
+
+void IPCStats::record(Handle handle, u32 header, u64 nanoseconds) {
+	const u64 key = (u64(handle) << 32) | header;
+	std::unique_lock lock(mutex);
+
+	CommandStats& stats = commands[key];
+	stats.calls++;
+	stats.totalNanoseconds += nanoseconds;
+	stats.maxNanoseconds = std::max(stats.maxNanoseconds, nanoseconds);
+	stats.histogram[getBucket(nanoseconds)]++;
+}
+
+void IPCStats::reset() {
+	std::unique_lock lock(mutex);
+	commands.clear();
+}
+
+std::vector<IPCStats::Entry> IPCStats::snapshot() const {
+	std::vector<Entry> entries;
+	{
+		std::unique_lock lock(mutex);
+		entries.reserve(commands.size());
+
+		for (const auto& [key, stats] : commands) {
+			entries.push_back(Entry{Handle(key >> 32), u32(key), stats});
+		}
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.stats.totalNanoseconds > b.stats.totalNanoseconds; });
+	return entries;
+}
+
+std::string IPCStats::report() const {
+	const std::vector<Entry> entries = snapshot();
+	std::string result = "IPC statistics (sorted by total time)\n";
+	char line[256];
+
+	std::snprintf(line, sizeof(line), "%-12s %-10s %10s %12s %10s %10s  %s\n", "Service", "Command", "Calls", "Total (us)", "Avg (us)", "Max (us)",
+				  "Histogram (<1us, <2us, <4us, ...)");
+	result += line;
+
+	for (const Entry& entry : entries) {
+		const CommandStats& stats = entry.stats;
+		std::snprintf(line, sizeof(line), "%-12s 0x%08X %10llu %12.1f %10.2f %10.1f  ", KernelHandles::getServiceName(entry.handle), entry.header,
+					  (unsigned long long)stats.calls, double(stats.totalNanoseconds) / 1000.0,
+					  double(stats.totalNanoseconds) / 1000.0 / double(stats.calls), double(stats.maxNanoseconds) / 1000.0);
+		result += line;
+
+		// Skip trailing empty buckets to keep the lines short
+		usize lastBucket = bucketCount;
+		while (lastBucket > 1 && stats.histogram[lastBucket - 1] == 0) {
+			lastBucket--;
+		}
+
+		for (usize i = 0; i < lastBucket; i++) {
+			result += (i == 0 ? "" : " ") + std::to_string(stats.histogram[i]);
+		}
+		result += '\n';
+	}
+
+	return result;
+}
@@ -1,7 +1,13 @@
 #include "services/ldr_ro.hpp"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "ipc.hpp"
 #include "kernel.hpp"
@@ -60,12 +66,6 @@ namespace CROHeader {
 }
 
 namespace SegmentTable {
-	enum : u32 {
-		Offset = 0,
-		Size = 4,
-		ID = 8,
-	};
-
 	namespace SegmentID {
 		enum : u32 {
 			TEXT,
@@ -76,66 +76,49 @@ namespace SegmentTable {
 	}
 }  // namespace SegmentTable
 
-namespace NamedExportTable {
+namespace RelocationPatch {
 	enum : u32 {
-		NameOffset = 0,
-		SegmentOffset = 4,
+		IsResolved = 6,
 	};
-};
 
-namespace IndexedExportTable {
-	enum : u32 {
-		SegmentOffset = 0,
+	namespace RelocationPatchType {
+		enum : u32 {
+			AbsoluteAddress = 2,
+		};
 	};
+};  // namespace RelocationPatch
+
+// Table entries, laid out the same as in the CRO so that whole tables can be copied in and out of guest memory at once
+struct NamedExportEntry {
+	u32 nameOffset;
+	u32 segmentTag;
 };
 
-namespace NamedImportTable {
-	enum : u32 {
-		NameOffset = 0,
-		RelocationOffset = 4,
-	};
+struct NamedImportEntry {
+	u32 nameOffset;
+	u32 relocationOffset;
 };
 
-namespace IndexedImportTable {
-	enum : u32 {
-		Index = 0,
-		RelocationOffset = 4,
-	};
+struct IndexedImportEntry {
+	u32 index;
+	u32 relocationOffset;
 };
 
-namespace AnonymousImportTable {
-	enum : u32 {
-		SegmentOffset = 0,
-		RelocationOffset = 4,
-	};
+struct AnonymousImportEntry {
+	u32 segmentTag;
+	u32 relocationOffset;
 };
 
-namespace ImportModuleTable {
-	enum : u32 {
-		NameOffset = 0,
-		IndexedOffset = 4,
-		IndexedNum = 8,
-		AnonymousOffset = 12,
-		AnonymousNum = 16,
-	};
+struct ImportModuleEntry {
+	u32 nameOffset;
+	u32 indexedOffset;
+	u32 indexedNum;
+	u32 anonymousOffset;
+	u32 anonymousNum;
 };
 
-namespace RelocationPatch {
-	enum : u32 {
-		SegmentOffset = 0,
-		PatchType = 4,
-		IsLastEntry = 5,   // For import patches
-		SegmentIndex = 5,  // For relocation patches
-		IsResolved = 6,
-		Addend = 8,
-	};
-
-	namespace RelocationPatchType {
-		enum : u32 {
-			AbsoluteAddress = 2,
-		};
-	};
-};  // namespace RelocationPatch
+static_assert(sizeof(NamedExportEntry) == 8 && sizeof(NamedImportEntry) == 8 && sizeof(IndexedImportEntry) == 8);
+static_assert(sizeof(AnonymousImportEntry) == 8 && sizeof(ImportModuleEntry) == 20);
 
 struct CROHeaderEntry {
 	u32 offset, size;
@@ -148,25 +131,44 @@ static const std::string CRO_MAGIC_FIXED("FIXD");
 static const std::string CRR_MAGIC("CRR0");
 
 using namespace KernelMemoryTypes;
+using ModuleMap = std::unordered_map<u32, LDR::Module>;
 
 class CRO {
 	Memory& mem;
+	ModuleMap& modules;
 
 	u32 croPointer;  // Origin address of CRO in RAM
 	u32 oldDataSegmentOffset;
 
 	bool isCRO;  // False if CRS
 
+	// Relocations usually patch addresses close to each other, so keep the host pointer of the last page we patched around
+	u32 patchPage = 0xFFFFFFFF;
+	u8* patchPagePointer = nullptr;
+	usize relocationCount = 0;
+
+	// A string table, read out of guest memory in one go
+	struct StringTable {
+		u32 address;
+		std::vector<char> data;
+	};
+
   public:
-	CRO(Memory& mem, u32 croPointer, bool isCRO) : mem(mem), croPointer(croPointer), oldDataSegmentOffset(0), isCRO(isCRO) {}
+	CRO(Memory& mem, ModuleMap& modules, u32 croPointer, bool isCRO)
+		: mem(mem), modules(modules), croPointer(croPointer), oldDataSegmentOffset(0), isCRO(isCRO) {}
 	~CRO() = default;
 
-	std::string getModuleName() {
-		const CROHeaderEntry moduleName = getHeaderEntry(CROHeader::ModuleNameOffset);
+	LDR::Module& getModule() {
+		auto it = modules.find(croPointer);
+		if (it == modules.end()) {
+			Helpers::panic("LDR_RO: CRO at %08X has not been loaded", croPointer);
+		}
 
-		return mem.readString(moduleName.offset, moduleName.size);
+		return it->second;
 	}
 
+	const std::string& getModuleName() { return getModule().name; }
+
 	u32 getNextCRO() { return mem.read32(croPointer + CROHeader::NextCRO); }
 
 	u32 getPrevCRO() { return mem.read32(croPointer + CROHeader::PrevCRO); }
@@ -176,22 +178,114 @@ class CRO {
 	void setNextCRO(u32 nextCRO) { mem.write32(croPointer + CROHeader::NextCRO, nextCRO); }
 	void setPrevCRO(u32 prevCRO) { mem.write32(croPointer + CROHeader::PrevCRO, prevCRO); }
 	u32 getSize() { return mem.read32(croPointer + CROHeader::FileSize); }
+	usize getRelocationCount() const { return relocationCount; }
 
-	void write32(u32 addr, u32 value) {
+	u8* getHostPointer(u32 addr) {
 		// Note: some games export symbols to the static module, which doesn't contain any segments.
 		// Instead, its segments point to ROM segments. We need this special write handler for writes to .text, which
 		// can't be accessed via mem.write32()
 		auto writePointer = mem.getWritePointer(addr);
 		if (writePointer) {
-			*(u32*)writePointer = value;
-		} else {
-			auto readPointer = mem.getReadPointer(addr);
-			if (readPointer) {
-				*(u32*)readPointer = value;
-			} else {
-				Helpers::panic("LDR_RO write to invalid address = %X\n", addr);
+			return (u8*)writePointer;
+		}
+
+		auto readPointer = mem.getReadPointer(addr);
+		if (readPointer) {
+			return (u8*)readPointer;
+		}
+
+		Helpers::panic("LDR_RO write to invalid address = %X\n", addr);
+	}
+
+	void write32(u32 addr, u32 value) {
+		const u32 page = addr >> Memory::pageShift;
+		if (page != patchPage) {
+			patchPage = page;
+			patchPagePointer = getHostPointer(addr & ~Memory::pageMask);
+		}
+
+		std::memcpy(patchPagePointer + (addr & Memory::pageMask), &value, sizeof(u32));
+	}
+
+	// Copy to and from guest memory a page at a time, as the pages of a CRO aren't necessarily contiguous in host memory
+	void readBlock(u32 addr, void* dest, usize size) {
+		u8* out = (u8*)dest;
+
+		while (size > 0) {
+			const usize count = std::min<usize>(size, Memory::pageSize - (addr & Memory::pageMask));
+			const void* pointer = mem.getReadPointer(addr);
+			if (pointer == nullptr) {
+				Helpers::panic("LDR_RO read from invalid address = %X\n", addr);
+			}
+
+			std::memcpy(out, pointer, count);
+			addr += u32(count);
+			out += count;
+			size -= count;
+		}
+	}
+
+	void writeBlock(u32 addr, const void* src, usize size) {
+		const u8* in = (const u8*)src;
+
+		while (size > 0) {
+			const usize count = std::min<usize>(size, Memory::pageSize - (addr & Memory::pageMask));
+			std::memcpy(getHostPointer(addr), in, count);
+			addr += u32(count);
+			in += count;
+			size -= count;
+		}
+	}
+
+	template <typename Entry>
+	std::vector<Entry> readTable(const CROHeaderEntry& table) {
+		std::vector<Entry> entries(table.size);
+		readBlock(table.offset, entries.data(), entries.size() * sizeof(Entry));
+		return entries;
+	}
+
+	template <typename Entry>
+	void writeTable(const CROHeaderEntry& table, const std::vector<Entry>& entries) {
+		writeBlock(table.offset, entries.data(), entries.size() * sizeof(Entry));
+	}
+
+	// Adds delta to the specified offset fields of every entry in a table, leaving null offsets alone
+	template <typename Entry, typename... Fields>
+	void rebaseTable(u32 tableHeaderOffset, u32 delta, Fields... fields) {
+		const CROHeaderEntry table = getHeaderEntry(tableHeaderOffset);
+		std::vector<Entry> entries = readTable<Entry>(table);
+
+		const auto rebaseField = [delta](u32& field) {
+			if (field != 0) {
+				field += delta;
 			}
+		};
+
+		for (Entry& entry : entries) {
+			(rebaseField(entry.*fields), ...);
 		}
+
+		writeTable(table, entries);
+	}
+
+	StringTable readStringTable(u32 tableHeaderOffset) {
+		const CROHeaderEntry table = getHeaderEntry(tableHeaderOffset);
+		StringTable strings{.address = table.offset, .data = std::vector<char>(table.size)};
+		readBlock(table.offset, strings.data.data(), strings.data.size());
+
+		return strings;
+	}
+
+	std::string readString(const StringTable& strings, u32 addr) {
+		const usize size = strings.data.size();
+		if (addr < strings.address || addr - strings.address >= size) {
+			// Not in the string table, read it from guest memory instead
+			return mem.readString(addr, u32(size));
+		}
+
+		const char* string = &strings.data[addr - strings.address];
+		const char* end = std::find(string, strings.data.data() + size, '\0');
+		return std::string(string, end);
 	}
 
 	// Returns CRO header offset-size pair
@@ -199,47 +293,73 @@ class CRO {
 		return CROHeaderEntry{.offset = mem.read32(croPointer + entry), .size = mem.read32(croPointer + entry + 4)};
 	}
 
-	u32 getSegmentAddr(u32 segmentOffset) {
-		// "Decoded" segment tag
-		const u32 segmentIndex = segmentOffset & 0xF;
-		const u32 offset = segmentOffset >> 4;
+	u32 getSegmentAddr(u32 segmentOffset) { return getModule().getSegmentAddr(segmentOffset); }
 
-		const CROHeaderEntry segmentTable = getHeaderEntry(CROHeader::SegmentTableOffset);
+	u32 getOnUnresolvedAddr() { return getSegmentAddr(getModule().onUnresolved); }
+
+	u32 getNamedExportSymbolAddr(const std::string& symbolName) {
+		// Note: The CRO contains a trie for fast symbol lookup. We use our own hash map of the named export table instead
+		const LDR::Module& module = getModule();
+		auto it = module.namedExports.find(symbolName);
 
-		if (segmentIndex >= segmentTable.size) {
-			return 0;
+		if (it != module.namedExports.end()) {
+			return module.getSegmentAddr(it->second);
 		}
 
-		// Get segment table entry
-		const u32 entryOffset = mem.read32(segmentTable.offset + 12 * segmentIndex + SegmentTable::Offset);
-		const u32 entrySize = mem.read32(segmentTable.offset + 12 * segmentIndex + SegmentTable::Size);
+		return 0;
+	}
+
+	// Parses the tables we need for linking into our module, after the CRO has been rebased
+	void parseTables() {
+		LDR::Module& module = modules[croPointer];
+		module = LDR::Module();
 
-		if (offset >= entrySize) {
-			return 0;
+		const CROHeaderEntry moduleName = getHeaderEntry(CROHeader::ModuleNameOffset);
+		module.name = mem.readString(moduleName.offset, moduleName.size);
+		module.segments = readTable<LDR::Segment>(getHeaderEntry(CROHeader::SegmentTableOffset));
+		module.onUnresolved = mem.read32(croPointer + CROHeader::OnUnresolved);
+		module.oldDataSegmentOffset = oldDataSegmentOffset;
+
+		const StringTable exportStrings = readStringTable(CROHeader::ExportStringTableOffset);
+		const auto namedExports = readTable<NamedExportEntry>(getHeaderEntry(CROHeader::NamedExportTableOffset));
+		module.namedExports.reserve(namedExports.size());
+
+		for (const NamedExportEntry& namedExport : namedExports) {
+			// If a symbol is exported more than once, the first one wins
+			module.namedExports.try_emplace(readString(exportStrings, namedExport.nameOffset), namedExport.segmentTag);
 		}
 
-		return entryOffset + offset;
-	}
+		module.indexedExports = readTable<u32>(getHeaderEntry(CROHeader::IndexedExportTableOffset));
 
-	u32 getOnUnresolvedAddr() { return getSegmentAddr(mem.read32(croPointer + CROHeader::OnUnresolved)); }
+		const CROHeaderEntry importPatchTable = getHeaderEntry(CROHeader::ImportPatchTableOffset);
+		module.importPatchTable = importPatchTable.offset;
+		module.importPatches = readTable<LDR::Relocation>(importPatchTable);
 
-	u32 getNamedExportSymbolAddr(const std::string& symbolName) {
-		// Note: The CRO contains a trie for fast symbol lookup. For simplicity,
-		// we won't use it and instead look up the symbol in the named export symbol table
+		const StringTable importStrings = readStringTable(CROHeader::ImportStringTableOffset);
+		for (const NamedImportEntry& namedImport : readTable<NamedImportEntry>(getHeaderEntry(CROHeader::NamedImportTableOffset))) {
+			module.namedImports.push_back({readString(importStrings, namedImport.nameOffset), namedImport.relocationOffset});
+		}
 
-		const u32 exportStringSize = mem.read32(croPointer + CROHeader::ExportStringSize);
-		const CROHeaderEntry namedExportTable = getHeaderEntry(CROHeader::NamedExportTableOffset);
+		for (const ImportModuleEntry& entry : readTable<ImportModuleEntry>(getHeaderEntry(CROHeader::ImportModuleTableOffset))) {
+			LDR::ImportModule& importModule = module.importModules.emplace_back();
+			importModule.name = readString(importStrings, entry.nameOffset);
 
-		for (u32 namedExport = 0; namedExport < namedExportTable.size; namedExport++) {
-			const u32 nameOffset = mem.read32(namedExportTable.offset + 8 * namedExport + NamedExportTable::NameOffset);
-			const std::string exportSymbolName = mem.readString(nameOffset, exportStringSize);
+			if (entry.indexedNum != 0 && entry.indexedOffset == 0) {
+				Helpers::panic("Indexed symbol offset is NULL");
+			}
 
-			if (symbolName.compare(exportSymbolName) == 0) {
-				return getSegmentAddr(mem.read32(namedExportTable.offset + 8 * namedExport + NamedExportTable::SegmentOffset));
+			if (entry.anonymousNum != 0 && entry.anonymousOffset == 0) {
+				Helpers::panic("Anonymous symbol offset is NULL");
 			}
-		}
 
-		return 0;
+			for (const IndexedImportEntry& indexedImport : readTable<IndexedImportEntry>({entry.indexedOffset, entry.indexedNum})) {
+				importModule.indexedImports.push_back({indexedImport.index, indexedImport.relocationOffset});
+			}
+
+			for (const AnonymousImportEntry& anonymousImport : readTable<AnonymousImportEntry>({entry.anonymousOffset, entry.anonymousNum})) {
+				importModule.anonymousImports.push_back({anonymousImport.segmentTag, anonymousImport.relocationOffset});
+			}
+		}
 	}
 
 	// Patches one symbol
@@ -249,20 +369,23 @@ class CRO {
 			default: Helpers::panic("Unhandled relocation type = %X\n", patchType);
 		}
 
+		relocationCount++;
 		return true;
 	}
 
 	// Patches symbol batches
 	bool patchBatch(u32 batchAddr, u32 symbolAddr, bool makeUnresolved = false) {
-		u32 relocationPatch = batchAddr;
+		const LDR::Module& module = getModule();
+		const u32 batchOffset = batchAddr - module.importPatchTable;
+		usize index = batchOffset / sizeof(LDR::Relocation);
 
-		while (true) {
-			const u32 segmentOffset = mem.read32(relocationPatch + RelocationPatch::SegmentOffset);
-			const u8 patchType = mem.read8(relocationPatch + RelocationPatch::PatchType);
-			const u8 isLastBatch = mem.read8(relocationPatch + RelocationPatch::IsLastEntry);
-			const u32 addend = mem.read32(relocationPatch + RelocationPatch::Addend);
+		if ((batchOffset % sizeof(LDR::Relocation)) != 0 || index >= module.importPatches.size()) {
+			Helpers::panic("Relocation batch %08X is not in the import patch table", batchAddr);
+		}
 
-			const u32 relocationTarget = getSegmentAddr(segmentOffset);
+		while (true) {
+			const LDR::Relocation& relocation = module.importPatches[index];
+			const u32 relocationTarget = getSegmentAddr(relocation.segmentTag);
 
 			if (relocationTarget == 0) {
 				Helpers::panic("Relocation target is NULL");
@@ -270,21 +393,23 @@ class CRO {
 
 			if (makeUnresolved) {
 				write32(relocationTarget, symbolAddr);
+				relocationCount++;
 			} else {
-				patchSymbol(relocationTarget, patchType, addend, symbolAddr);
+				patchSymbol(relocationTarget, relocation.patchType, relocation.addend, symbolAddr);
 			}
 
-			if (isLastBatch != 0) {
+			if (relocation.isLastEntry != 0 || index + 1 == module.importPatches.size()) {
 				break;
 			}
 
-			relocationPatch += 12;
+			index++;
 		}
 
+		const u32 lastEntryAddr = module.importPatchTable + u32(index * sizeof(LDR::Relocation));
 		if (makeUnresolved) {
-			mem.write8(relocationPatch + RelocationPatch::IsResolved, 0);
+			mem.write8(lastEntryAddr + RelocationPatch::IsResolved, 0);
 		} else {
-			mem.write8(relocationPatch + RelocationPatch::IsResolved, 1);
+			mem.write8(lastEntryAddr + RelocationPatch::IsResolved, 1);
 		}
 
 		return true;
@@ -321,7 +446,7 @@ class CRO {
 
 	// Modifies CRO offsets to point at virtual addresses
 	bool rebase(u32 loadedCRS, u32 dataVaddr, u32 bssVaddr) {
-		rebaseHeader();
+		rebaseHeader(croPointer);
 
 		u32 oldDataVaddr = 0;
 
@@ -331,11 +456,8 @@ class CRO {
 			rebaseSegmentTable(dataVaddr, bssVaddr, &oldDataVaddr);
 		}
 
-		rebaseNamedExportTable();
-		rebaseImportModuleTable();
-		rebaseNamedImportTable();
-		rebaseIndexedImportTable();
-		rebaseAnonymousImportTable();
+		rebaseTables(croPointer);
+		parseTables();
 
 		// Note: Citra relocates static anonymous symbols and exit symbols only if the file is not a CRS
 		if (isCRO) {
@@ -348,11 +470,7 @@ class CRO {
 	}
 
 	bool unrebase() {
-		unrebaseAnonymousImportTable();
-		unrebaseIndexedImportTable();
-		unrebaseNamedImportTable();
-		unrebaseImportModuleTable();
-		unrebaseNamedExportTable();
+		rebaseTables(0 - croPointer);
 
 		// Note: Citra unrebases the segment table only if the file is not a CRS.
 		// Presumably because CRS files don't contain segments?
@@ -360,7 +478,7 @@ class CRO {
 			unrebaseSegmentTable();
 		}
 
-		unrebaseHeader();
+		rebaseHeader(0 - croPointer);
 
 		setNextCRO(0);
 		setPrevCRO(0);
@@ -368,7 +486,8 @@ class CRO {
 		return true;
 	}
 
-	bool rebaseHeader() {
+	// Adds delta to every offset in the header. Used with the CRO address for rebasing, and its negation for unrebasing
+	bool rebaseHeader(u32 delta) {
 		constexpr u32 headerOffsets[] = {
 			CROHeader::NameOffset,
 			CROHeader::CodeOffset,
@@ -390,300 +509,98 @@ class CRO {
 			CROHeader::StaticAnonymousPatchTableOffset,
 		};
 
-		for (u32 offset : headerOffsets) {
-			mem.write32(croPointer + offset, mem.read32(croPointer + offset) + croPointer);
-		}
-
-		return true;
-	}
-
-	bool unrebaseHeader() {
-		constexpr u32 headerOffsets[] = {
-			CROHeader::NameOffset,
-			CROHeader::CodeOffset,
-			CROHeader::DataOffset,
-			CROHeader::ModuleNameOffset,
-			CROHeader::SegmentTableOffset,
-			CROHeader::NamedExportTableOffset,
-			CROHeader::IndexedExportTableOffset,
-			CROHeader::ExportStringTableOffset,
-			CROHeader::ExportTreeOffset,
-			CROHeader::ImportModuleTableOffset,
-			CROHeader::ImportPatchTableOffset,
-			CROHeader::NamedImportTableOffset,
-			CROHeader::IndexedImportTableOffset,
-			CROHeader::AnonymousImportTableOffset,
-			CROHeader::ImportStringTableOffset,
-			CROHeader::StaticAnonymousSymbolTableOffset,
-			CROHeader::RelocationPatchTableOffset,
-			CROHeader::StaticAnonymousPatchTableOffset,
-		};
+		std::array<u32, CRO_HEADER_SIZE / sizeof(u32)> header;
+		readBlock(croPointer, header.data(), CRO_HEADER_SIZE);
 
 		for (u32 offset : headerOffsets) {
-			mem.write32(croPointer + offset, mem.read32(croPointer + offset) - croPointer);
+			header[offset / sizeof(u32)] += delta;
 		}
 
+		writeBlock(croPointer, header.data(), CRO_HEADER_SIZE);
 		return true;
 	}
 
 	bool rebaseSegmentTable(u32 dataVaddr, u32 bssVaddr, u32* oldDataVaddr) {
 		const CROHeaderEntry segmentTable = getHeaderEntry(CROHeader::SegmentTableOffset);
+		std::vector<LDR::Segment> segments = readTable<LDR::Segment>(segmentTable);
 
-		for (u32 segment = 0; segment < segmentTable.size; segment++) {
-			u32 segmentOffset = mem.read32(segmentTable.offset + 12 * segment + SegmentTable::Offset);
-
-			const u32 segmentID = mem.read32(segmentTable.offset + 12 * segment + SegmentTable::ID);
-			switch (segmentID) {
+		for (LDR::Segment& segment : segments) {
+			switch (segment.id) {
 				case SegmentTable::SegmentID::DATA:
-					*oldDataVaddr = segmentOffset + croPointer;
-					oldDataSegmentOffset = segmentOffset;
-					segmentOffset = dataVaddr;
+					*oldDataVaddr = segment.offset + croPointer;
+					oldDataSegmentOffset = segment.offset;
+					segment.offset = dataVaddr;
 					break;
-				case SegmentTable::SegmentID::BSS: segmentOffset = bssVaddr; break;
+				case SegmentTable::SegmentID::BSS: segment.offset = bssVaddr; break;
 				case SegmentTable::SegmentID::TEXT:
 				case SegmentTable::SegmentID::RODATA:
-					if (segmentOffset != 0) segmentOffset += croPointer;
+					if (segment.offset != 0) segment.offset += croPointer;
 					break;
-				default: Helpers::panic("Unknown segment ID = %u", segmentID);
+				default: Helpers::panic("Unknown segment ID = %u", segment.id);
 			}
-
-			mem.write32(segmentTable.offset + 12 * segment + SegmentTable::Offset, segmentOffset);
 		}
 
+		writeTable(segmentTable, segments);
 		return true;
 	}
 
 	bool unrebaseSegmentTable() {
 		const CROHeaderEntry segmentTable = getHeaderEntry(CROHeader::SegmentTableOffset);
+		std::vector<LDR::Segment> segments = readTable<LDR::Segment>(segmentTable);
 
-		for (u32 segment = 0; segment < segmentTable.size; segment++) {
-			u32 segmentOffset = mem.read32(segmentTable.offset + 12 * segment + SegmentTable::Offset);
-
-			const u32 segmentID = mem.read32(segmentTable.offset + 12 * segment + SegmentTable::ID);
-			switch (segmentID) {
-				case SegmentTable::SegmentID::DATA: segmentOffset = oldDataSegmentOffset; break;
-				case SegmentTable::SegmentID::BSS: segmentOffset = 0; break;
+		for (LDR::Segment& segment : segments) {
+			switch (segment.id) {
+				case SegmentTable::SegmentID::DATA: segment.offset = getModule().oldDataSegmentOffset; break;
+				case SegmentTable::SegmentID::BSS: segment.offset = 0; break;
 				case SegmentTable::SegmentID::TEXT:
 				case SegmentTable::SegmentID::RODATA:
-					if (segmentOffset != 0) segmentOffset -= croPointer;
+					if (segment.offset != 0) segment.offset -= croPointer;
 					break;
-				default: Helpers::panic("Unknown segment ID = %u", segmentID);
+				default: Helpers::panic("Unknown segment ID = %u", segment.id);
 			}
-
-			mem.write32(segmentTable.offset + 12 * segment + SegmentTable::Offset, segmentOffset);
 		}
 
+		writeTable(segmentTable, segments);
 		return true;
 	}
 
-	bool rebaseNamedExportTable() {
-		const CROHeaderEntry namedExportTable = getHeaderEntry(CROHeader::NamedExportTableOffset);
-
-		for (u32 namedExport = 0; namedExport < namedExportTable.size; namedExport++) {
-			u32 nameOffset = mem.read32(namedExportTable.offset + 8 * namedExport);
-
-			if (nameOffset != 0) {
-				mem.write32(namedExportTable.offset + 8 * namedExport, nameOffset + croPointer);
-			}
-		}
-
-		return true;
-	}
-
-	bool unrebaseNamedExportTable() {
-		const CROHeaderEntry namedExportTable = getHeaderEntry(CROHeader::NamedExportTableOffset);
-
-		for (u32 namedExport = 0; namedExport < namedExportTable.size; namedExport++) {
-			u32 nameOffset = mem.read32(namedExportTable.offset + 8 * namedExport);
-
-			if (nameOffset != 0) {
-				mem.write32(namedExportTable.offset + 8 * namedExport, nameOffset - croPointer);
-			}
-		}
-
-		return true;
-	}
-
-	bool rebaseImportModuleTable() {
-		const CROHeaderEntry importModuleTable = getHeaderEntry(CROHeader::ImportModuleTableOffset);
-
-		for (u32 importModule = 0; importModule < importModuleTable.size; importModule++) {
-			u32 nameOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::NameOffset);
-
-			if (nameOffset != 0) {
-				mem.write32(importModuleTable.offset + 20 * importModule + ImportModuleTable::NameOffset, nameOffset + croPointer);
-			}
-
-			u32 indexedOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedOffset);
-
-			if (indexedOffset != 0) {
-				mem.write32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedOffset, indexedOffset + croPointer);
-			}
-
-			u32 anonymousOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousOffset);
-
-			if (anonymousOffset != 0) {
-				mem.write32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousOffset, anonymousOffset + croPointer);
-			}
-		}
-
-		return true;
-	}
-
-	bool unrebaseImportModuleTable() {
-		const CROHeaderEntry importModuleTable = getHeaderEntry(CROHeader::ImportModuleTableOffset);
-
-		for (u32 importModule = 0; importModule < importModuleTable.size; importModule++) {
-			u32 nameOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::NameOffset);
-
-			if (nameOffset != 0) {
-				mem.write32(importModuleTable.offset + 20 * importModule + ImportModuleTable::NameOffset, nameOffset - croPointer);
-			}
-
-			u32 indexedOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedOffset);
-
-			if (indexedOffset != 0) {
-				mem.write32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedOffset, indexedOffset - croPointer);
-			}
-
-			u32 anonymousOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousOffset);
-
-			if (anonymousOffset != 0) {
-				mem.write32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousOffset, anonymousOffset - croPointer);
-			}
-		}
-
-		return true;
-	}
-
-	bool rebaseNamedImportTable() {
-		const CROHeaderEntry namedImportTable = getHeaderEntry(CROHeader::NamedImportTableOffset);
-
-		for (u32 namedImport = 0; namedImport < namedImportTable.size; namedImport++) {
-			u32 nameOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::NameOffset);
-
-			if (nameOffset != 0) {
-				mem.write32(namedImportTable.offset + 8 * namedImport + NamedImportTable::NameOffset, nameOffset + croPointer);
-			}
-
-			u32 relocationOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::RelocationOffset);
-
-			if (relocationOffset != 0) {
-				mem.write32(namedImportTable.offset + 8 * namedImport + NamedImportTable::RelocationOffset, relocationOffset + croPointer);
-			}
-		}
-
-		return true;
-	}
-
-	bool unrebaseNamedImportTable() {
-		const CROHeaderEntry namedImportTable = getHeaderEntry(CROHeader::NamedImportTableOffset);
-
-		for (u32 namedImport = 0; namedImport < namedImportTable.size; namedImport++) {
-			u32 nameOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::NameOffset);
-
-			if (nameOffset != 0) {
-				mem.write32(namedImportTable.offset + 8 * namedImport + NamedImportTable::NameOffset, nameOffset - croPointer);
-			}
-
-			u32 relocationOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::RelocationOffset);
-
-			if (relocationOffset != 0) {
-				mem.write32(namedImportTable.offset + 8 * namedImport + NamedImportTable::RelocationOffset, relocationOffset - croPointer);
-			}
-		}
-
-		return true;
-	}
-
-	bool rebaseIndexedImportTable() {
-		const CROHeaderEntry indexedImportTable = getHeaderEntry(CROHeader::IndexedImportTableOffset);
-
-		for (u32 indexedImport = 0; indexedImport < indexedImportTable.size; indexedImport++) {
-			u32 relocationOffset = mem.read32(indexedImportTable.offset + 8 * indexedImport + IndexedImportTable::RelocationOffset);
-
-			if (relocationOffset != 0) {
-				mem.write32(indexedImportTable.offset + 8 * indexedImport + IndexedImportTable::RelocationOffset, relocationOffset + croPointer);
-			}
-		}
-
-		return true;
-	}
-
-	bool unrebaseIndexedImportTable() {
-		const CROHeaderEntry indexedImportTable = getHeaderEntry(CROHeader::IndexedImportTableOffset);
-
-		for (u32 indexedImport = 0; indexedImport < indexedImportTable.size; indexedImport++) {
-			u32 relocationOffset = mem.read32(indexedImportTable.offset + 8 * indexedImport + IndexedImportTable::RelocationOffset);
-
-			if (relocationOffset != 0) {
-				mem.write32(indexedImportTable.offset + 8 * indexedImport + IndexedImportTable::RelocationOffset, relocationOffset - croPointer);
-			}
-		}
-
-		return true;
-	}
-
-	bool rebaseAnonymousImportTable() {
-		const CROHeaderEntry anonymousImportTable = getHeaderEntry(CROHeader::AnonymousImportTableOffset);
-
-		for (u32 anonymousImport = 0; anonymousImport < anonymousImportTable.size; anonymousImport++) {
-			u32 relocationOffset = mem.read32(anonymousImportTable.offset + 8 * anonymousImport + AnonymousImportTable::RelocationOffset);
-
-			if (relocationOffset != 0) {
-				mem.write32(
-					anonymousImportTable.offset + 8 * anonymousImport + AnonymousImportTable::RelocationOffset, relocationOffset + croPointer
-				);
-			}
-		}
-
-		return true;
-	}
-
-	bool unrebaseAnonymousImportTable() {
-		const CROHeaderEntry anonymousImportTable = getHeaderEntry(CROHeader::AnonymousImportTableOffset);
-
-		for (u32 anonymousImport = 0; anonymousImport < anonymousImportTable.size; anonymousImport++) {
-			u32 relocationOffset = mem.read32(anonymousImportTable.offset + 8 * anonymousImport + AnonymousImportTable::RelocationOffset);
-
-			if (relocationOffset != 0) {
-				mem.write32(
-					anonymousImportTable.offset + 8 * anonymousImport + AnonymousImportTable::RelocationOffset, relocationOffset - croPointer
-				);
-			}
-		}
+	// Adds delta to the offsets in the export and import tables
+	bool rebaseTables(u32 delta) {
+		rebaseTable<NamedExportEntry>(CROHeader::NamedExportTableOffset, delta, &NamedExportEntry::nameOffset);
+		rebaseTable<ImportModuleEntry>(
+			CROHeader::ImportModuleTableOffset, delta, &ImportModuleEntry::nameOffset, &ImportModuleEntry::indexedOffset,
+			&ImportModuleEntry::anonymousOffset
+		);
+		rebaseTable<NamedImportEntry>(CROHeader::NamedImportTableOffset, delta, &NamedImportEntry::nameOffset, &NamedImportEntry::relocationOffset);
+		rebaseTable<IndexedImportEntry>(CROHeader::IndexedImportTableOffset, delta, &IndexedImportEntry::relocationOffset);
+		rebaseTable<AnonymousImportEntry>(CROHeader::AnonymousImportTableOffset, delta, &AnonymousImportEntry::relocationOffset);
 
 		return true;
 	}
 
 	bool relocateInternalSymbols(u32 oldDataVaddr) {
-		const u8* header = (u8*)mem.getReadPointer(croPointer);
-
-		const CROHeaderEntry relocationPatchTable = getHeaderEntry(CROHeader::RelocationPatchTableOffset);
-		const CROHeaderEntry segmentTable = getHeaderEntry(CROHeader::SegmentTableOffset);
+		const LDR::Module& module = getModule();
+		const auto relocations = readTable<LDR::Relocation>(getHeaderEntry(CROHeader::RelocationPatchTableOffset));
 
-		for (u32 relocationPatch = 0; relocationPatch < relocationPatchTable.size; relocationPatch++) {
-			const u32 segmentOffset = mem.read32(relocationPatchTable.offset + 12 * relocationPatch + RelocationPatch::SegmentOffset);
-			const u8 patchType = mem.read8(relocationPatchTable.offset + 12 * relocationPatch + RelocationPatch::PatchType);
-			const u8 segmentIndex = mem.read8(relocationPatchTable.offset + 12 * relocationPatch + RelocationPatch::SegmentIndex);
-			const u32 addend = mem.read32(relocationPatchTable.offset + 12 * relocationPatch + RelocationPatch::Addend);
+		for (const LDR::Relocation& relocation : relocations) {
+			const u32 segmentIndex = relocation.segmentTag & 0xF;
+			u32 relocationTarget = module.getSegmentAddr(relocation.segmentTag);
 
-			const u32 segmentAddr = getSegmentAddr(segmentOffset);
-			const u32 entryID = mem.read32(segmentTable.offset + 12 * (segmentOffset & 0xF) + SegmentTable::ID);
-
-			u32 relocationTarget = segmentAddr;
-			if (entryID == SegmentTable::SegmentID::DATA) {
+			if (segmentIndex < module.segments.size() && module.segments[segmentIndex].id == SegmentTable::SegmentID::DATA) {
 				// Recompute relocation target for .data
-				relocationTarget = oldDataVaddr + (segmentOffset >> 4);
+				relocationTarget = oldDataVaddr + (relocation.segmentTag >> 4);
 			}
 
 			if (relocationTarget == 0) {
 				Helpers::panic("Relocation target is NULL");
 			}
 
-			const u32 symbolOffset = mem.read32(segmentTable.offset + 12 * segmentIndex + SegmentTable::Offset);
+			if (relocation.segmentIndex >= module.segments.size()) {
+				Helpers::panic("Relocation symbol is in invalid segment %u", relocation.segmentIndex);
+			}
 
-			patchSymbol(relocationTarget, patchType, addend, symbolOffset);
+			const u32 symbolOffset = module.segments[relocation.segmentIndex].offset;
+			patchSymbol(relocationTarget, relocation.patchType, relocation.addend, symbolOffset);
 		}
 
 		return true;
@@ -705,25 +622,16 @@ class CRO {
 			Helpers::panic("CRS not loaded");
 		}
 
-		const u32 importStringSize = mem.read32(croPointer + CROHeader::ImportStringSize);
-
-		const CROHeaderEntry namedImportTable = getHeaderEntry(CROHeader::NamedImportTableOffset);
-
-		for (u32 namedImport = 0; namedImport < namedImportTable.size; namedImport++) {
-			const u32 nameOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::NameOffset);
-			const u32 relocationOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::RelocationOffset);
-
-			const std::string symbolName = mem.readString(nameOffset, importStringSize);
-
-			if (symbolName.compare(std::string("__aeabi_atexit")) == 0) {
+		for (const LDR::NamedImport& namedImport : getModule().namedImports) {
+			if (namedImport.name == "__aeabi_atexit") {
 				// Find exit symbol in other CROs
 				u32 currentCROPointer = loadedCRS;
 				while (currentCROPointer != 0) {
-					CRO cro(mem, currentCROPointer, true);
+					CRO cro(mem, modules, currentCROPointer, true);
 
-					const u32 exportSymbolAddr = cro.getNamedExportSymbolAddr(std::string("nnroAeabiAtexit_"));
+					const u32 exportSymbolAddr = cro.getNamedExportSymbolAddr("nnroAeabiAtexit_");
 					if (exportSymbolAddr != 0) {
-						patchBatch(relocationOffset, exportSymbolAddr);
+						patchBatch(namedImport.batch, exportSymbolAddr);
 
 						return true;
 					}
@@ -743,28 +651,18 @@ class CRO {
 			Helpers::panic("CRS not loaded");
 		}
 
-		const u32 importStringSize = mem.read32(croPointer + CROHeader::ImportStringSize);
-
-		const CROHeaderEntry namedImportTable = getHeaderEntry(CROHeader::NamedImportTableOffset);
-
-		for (u32 namedImport = 0; namedImport < namedImportTable.size; namedImport++) {
-			const u32 relocationOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::RelocationOffset);
-
-			u8 isResolved = mem.read8(relocationOffset + RelocationPatch::IsResolved);
+		for (const LDR::NamedImport& namedImport : getModule().namedImports) {
+			u8 isResolved = mem.read8(namedImport.batch + RelocationPatch::IsResolved);
 
 			if (isResolved == 0) {
-				const u32 nameOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::NameOffset);
-
-				const std::string symbolName = mem.readString(nameOffset, importStringSize);
-
-				// Check every loaded CRO for the symbol (the pain)
+				// Check every loaded CRO for the symbol
 				u32 currentCROPointer = loadedCRS;
 				while (currentCROPointer != 0) {
-					CRO cro(mem, currentCROPointer, true);
+					CRO cro(mem, modules, currentCROPointer, true);
 
-					const u32 exportSymbolAddr = cro.getNamedExportSymbolAddr(symbolName);
+					const u32 exportSymbolAddr = cro.getNamedExportSymbolAddr(namedImport.name);
 					if (exportSymbolAddr != 0) {
-						patchBatch(relocationOffset, exportSymbolAddr);
+						patchBatch(namedImport.batch, exportSymbolAddr);
 
 						isResolved = 1;
 						break;
@@ -774,7 +672,7 @@ class CRO {
 				}
 
 				if (isResolved == 0) {
-					Helpers::panic("Failed to resolve symbol %s", symbolName.c_str());
+					Helpers::panic("Failed to resolve symbol %s", namedImport.name.c_str());
 				}
 			}
 		}
@@ -785,12 +683,8 @@ class CRO {
 	bool clearNamedSymbols() {
 		const u32 onUnresolvedAddr = getOnUnresolvedAddr();
 
-		const CROHeaderEntry namedImportTable = getHeaderEntry(CROHeader::NamedImportTableOffset);
-
-		for (u32 namedImport = 0; namedImport < namedImportTable.size; namedImport++) {
-			const u32 relocationOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::RelocationOffset);
-
-			patchBatch(relocationOffset, onUnresolvedAddr, true);
+		for (const LDR::NamedImport& namedImport : getModule().namedImports) {
+			patchBatch(namedImport.batch, onUnresolvedAddr, true);
 		}
 
 		return true;
@@ -801,53 +695,27 @@ class CRO {
 			Helpers::panic("CRS not loaded");
 		}
 
-		const u32 importStringSize = mem.read32(croPointer + CROHeader::ImportStringSize);
-
-		const CROHeaderEntry importModuleTable = getHeaderEntry(CROHeader::ImportModuleTableOffset);
-
-		for (u32 importModule = 0; importModule < importModuleTable.size; importModule++) {
-			const u32 nameOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::NameOffset);
-
-			const std::string importModuleName = mem.readString(nameOffset, importStringSize);
-
+		for (const LDR::ImportModule& importModule : getModule().importModules) {
 			// Find import module
 			u32 currentCROPointer = loadedCRS;
 			while (currentCROPointer != 0) {
-				CRO cro(mem, currentCROPointer, true);
+				CRO cro(mem, modules, currentCROPointer, true);
+				const LDR::Module& exportModule = cro.getModule();
 
-				if (importModuleName.compare(cro.getModuleName()) == 0) {
+				if (importModule.name == exportModule.name) {
 					// Import indexed symbols
-					const CROHeaderEntry indexedExportTable = cro.getHeaderEntry(CROHeader::IndexedExportTableOffset);
-
-					const u32 indexedOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedOffset);
-					const u32 indexedNum = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedNum);
-
-					for (u32 indexedImport = 0; indexedImport < indexedNum; indexedImport++) {
-						if (indexedOffset == 0) {
-							Helpers::panic("Indexed symbol offset is NULL");
+					for (const LDR::IndexedImport& indexedImport : importModule.indexedImports) {
+						if (indexedImport.exportIndex >= exportModule.indexedExports.size()) {
+							Helpers::panic("Indexed symbol %u is not exported by \"%s\"", indexedImport.exportIndex, exportModule.name.c_str());
 						}
 
-						const u32 importIndex = mem.read32(indexedOffset + 8 * indexedImport + IndexedImportTable::Index);
-
-						const u32 segmentOffset = mem.read32(indexedExportTable.offset + 4 * importIndex + IndexedExportTable::SegmentOffset);
-						const u32 relocationOffset = mem.read32(indexedOffset + 8 * indexedImport + IndexedImportTable::RelocationOffset);
-
-						patchBatch(relocationOffset, cro.getSegmentAddr(segmentOffset));
+						const u32 segmentOffset = exportModule.indexedExports[indexedImport.exportIndex];
+						patchBatch(indexedImport.batch, exportModule.getSegmentAddr(segmentOffset));
 					}
 
 					// Import anonymous symbols
-					const u32 anonymousOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousOffset);
-					const u32 anonymousNum = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousNum);
-
-					for (u32 anonymousImport = 0; anonymousImport < anonymousNum; anonymousImport++) {
-						if (anonymousOffset == 0) {
-							Helpers::panic("Anonymous symbol offset is NULL");
-						}
-
-						const u32 segmentOffset = mem.read32(anonymousOffset + 8 * anonymousImport + AnonymousImportTable::SegmentOffset);
-						const u32 relocationOffset = mem.read32(anonymousOffset + 8 * anonymousImport + AnonymousImportTable::RelocationOffset);
-
-						patchBatch(relocationOffset, cro.getSegmentAddr(segmentOffset));
+					for (const LDR::AnonymousImport& anonymousImport : importModule.anonymousImports) {
+						patchBatch(anonymousImport.batch, exportModule.getSegmentAddr(anonymousImport.segmentTag));
 					}
 
 					break;
@@ -857,7 +725,7 @@ class CRO {
 			}
 
 			if (currentCROPointer == 0) {
-				Helpers::warn("Unable to find import module \"%s\"", importModuleName.c_str());
+				Helpers::warn("Unable to find import module \"%s\"", importModule.name.c_str());
 			}
 		}
 
@@ -867,35 +735,15 @@ class CRO {
 	bool clearModules() {
 		const u32 onUnresolvedAddr = getOnUnresolvedAddr();
 
-		const CROHeaderEntry importModuleTable = getHeaderEntry(CROHeader::ImportModuleTableOffset);
-
-		for (u32 importModule = 0; importModule < importModuleTable.size; importModule++) {
+		for (const LDR::ImportModule& importModule : getModule().importModules) {
 			// Clear indexed symbol imports
-			const u32 indexedOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedOffset);
-			const u32 indexedNum = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedNum);
-
-			for (u32 indexedImport = 0; indexedImport < indexedNum; indexedImport++) {
-				if (indexedOffset == 0) {
-					Helpers::panic("Indexed symbol offset is NULL");
-				}
-
-				const u32 relocationOffset = mem.read32(indexedOffset + 8 * indexedImport + IndexedImportTable::RelocationOffset);
-
-				patchBatch(relocationOffset, onUnresolvedAddr, true);
+			for (const LDR::IndexedImport& indexedImport : importModule.indexedImports) {
+				patchBatch(indexedImport.batch, onUnresolvedAddr, true);
 			}
 
 			// Clear anonymous import symbols
-			const u32 anonymousOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousOffset);
-			const u32 anonymousNum = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousNum);
-
-			for (u32 anonymousImport = 0; anonymousImport < anonymousNum; anonymousImport++) {
-				if (anonymousOffset == 0) {
-					Helpers::panic("Anonymous symbol offset is NULL");
-				}
-
-				const u32 relocationOffset = mem.read32(anonymousOffset + 8 * anonymousImport + AnonymousImportTable::RelocationOffset);
-
-				patchBatch(relocationOffset, onUnresolvedAddr, true);
+			for (const LDR::AnonymousImport& anonymousImport : importModule.anonymousImports) {
+				patchBatch(anonymousImport.batch, onUnresolvedAddr, true);
 			}
 		}
 
@@ -907,72 +755,47 @@ class CRO {
 			Helpers::panic("CRS not loaded");
 		}
 
+		const std::string& moduleName = getModuleName();
+
 		u32 currentCROPointer = loadedCRS;
 		while (currentCROPointer != 0) {
-			CRO cro(mem, currentCROPointer, true);
+			CRO cro(mem, modules, currentCROPointer, true);
+			const LDR::Module& importingModule = cro.getModule();
 
 			// Export named symbols
-			const u32 importStringSize = mem.read32(currentCROPointer + CROHeader::ImportStringSize);
-
-			const CROHeaderEntry namedImportTable = cro.getHeaderEntry(CROHeader::NamedImportTableOffset);
-
-			for (u32 namedImport = 0; namedImport < namedImportTable.size; namedImport++) {
-				const u32 relocationOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::RelocationOffset);
-
-				u8 isResolved = mem.read8(relocationOffset + RelocationPatch::IsResolved);
+			for (const LDR::NamedImport& namedImport : importingModule.namedImports) {
+				u8 isResolved = mem.read8(namedImport.batch + RelocationPatch::IsResolved);
 
 				if (isResolved == 0) {
-					const u32 nameOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::NameOffset);
-
-					const std::string symbolName = mem.readString(nameOffset, importStringSize);
-
 					// Check our current CRO for the symbol
-					const u32 exportSymbolAddr = getNamedExportSymbolAddr(symbolName);
+					const u32 exportSymbolAddr = getNamedExportSymbolAddr(namedImport.name);
 					if (exportSymbolAddr == 0) {
 						continue;
 					}
 
-					cro.patchBatch(relocationOffset, exportSymbolAddr);
+					cro.patchBatch(namedImport.batch, exportSymbolAddr);
 				}
 			}
 
 			// Export indexed and anonymous symbols
-			const CROHeaderEntry importModuleTable = cro.getHeaderEntry(CROHeader::ImportModuleTableOffset);
-
-			for (u32 importModule = 0; importModule < importModuleTable.size; importModule++) {
+			for (const LDR::ImportModule& importModule : importingModule.importModules) {
 				// Check if other CROs request module imports from this CRO
-				const u32 nameOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::NameOffset);
-
-				const std::string moduleName = mem.readString(nameOffset, importStringSize);
-
-				if (moduleName.compare(getModuleName()) != 0) {
+				if (importModule.name != moduleName) {
 					continue;
 				}
 
 				// Export indexed symbols
-				const u32 indexedOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedOffset);
-				const u32 indexedNum = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedNum);
-
-				for (u32 indexedImport = 0; indexedImport < indexedNum; indexedImport++) {
+				if (!importModule.indexedImports.empty()) {
 					Helpers::panic("TODO: indexed exports");
 				}
 
 				// Export anonymous symbols
-				const u32 anonymousOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousOffset);
-				const u32 anonymousNum = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousNum);
-
-				for (u32 anonymousImport = 0; anonymousImport < anonymousNum; anonymousImport++) {
-					if (anonymousOffset == 0) {
-						Helpers::panic("Anonymous symbol offset is NULL");
-					}
-
-					const u32 segmentOffset = mem.read32(anonymousOffset + 8 * anonymousImport + AnonymousImportTable::SegmentOffset);
-					const u32 relocationOffset = mem.read32(anonymousOffset + 8 * anonymousImport + AnonymousImportTable::RelocationOffset);
-
-					cro.patchBatch(relocationOffset, getSegmentAddr(segmentOffset));
+				for (const LDR::AnonymousImport& anonymousImport : importModule.anonymousImports) {
+					cro.patchBatch(anonymousImport.batch, getSegmentAddr(anonymousImport.segmentTag));
 				}
 			}
 
+			relocationCount += cro.getRelocationCount();
 			currentCROPointer = cro.getNextCRO();
 		}
 
@@ -984,70 +807,45 @@ class CRO {
 			Helpers::panic("CRS not loaded");
 		}
 
+		const std::string& moduleName = getModuleName();
+
 		u32 currentCROPointer = loadedCRS;
 		while (currentCROPointer != 0) {
-			CRO cro(mem, currentCROPointer, true);
+			CRO cro(mem, modules, currentCROPointer, true);
+			const LDR::Module& importingModule = cro.getModule();
 
 			const u32 onUnresolvedAddr = cro.getOnUnresolvedAddr();
 
-			const u32 importStringSize = mem.read32(currentCROPointer + CROHeader::ImportStringSize);
-
 			// Clear named symbol exports
-			const CROHeaderEntry namedImportTable = cro.getHeaderEntry(CROHeader::NamedImportTableOffset);
-
-			for (u32 namedImport = 0; namedImport < namedImportTable.size; namedImport++) {
-				const u32 relocationOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::RelocationOffset);
-
-				u8 isResolved = mem.read8(relocationOffset + RelocationPatch::IsResolved);
+			for (const LDR::NamedImport& namedImport : importingModule.namedImports) {
+				u8 isResolved = mem.read8(namedImport.batch + RelocationPatch::IsResolved);
 
 				if (isResolved != 0) {
-					const u32 nameOffset = mem.read32(namedImportTable.offset + 8 * namedImport + NamedImportTable::NameOffset);
-
-					const std::string symbolName = mem.readString(nameOffset, importStringSize);
-
 					// Check our current CRO for the symbol
-					const u32 exportSymbolAddr = getNamedExportSymbolAddr(symbolName);
+					const u32 exportSymbolAddr = getNamedExportSymbolAddr(namedImport.name);
 					if (exportSymbolAddr == 0) {
 						continue;
 					}
 
-					cro.patchBatch(relocationOffset, onUnresolvedAddr, true);
+					cro.patchBatch(namedImport.batch, onUnresolvedAddr, true);
 				}
 			}
 
 			// Clear indexed and anonymous symbol exports
-			const CROHeaderEntry importModuleTable = cro.getHeaderEntry(CROHeader::ImportModuleTableOffset);
-
-			for (u32 importModule = 0; importModule < importModuleTable.size; importModule++) {
+			for (const LDR::ImportModule& importModule : importingModule.importModules) {
 				// Check if other CROs request module imports from this CRO
-				const u32 nameOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::NameOffset);
-
-				const std::string moduleName = mem.readString(nameOffset, importStringSize);
-
-				if (moduleName.compare(getModuleName()) != 0) {
+				if (importModule.name != moduleName) {
 					continue;
 				}
 
 				// Export indexed symbols
-				const u32 indexedOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedOffset);
-				const u32 indexedNum = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::IndexedNum);
-
-				for (u32 indexedImport = 0; indexedImport < indexedNum; indexedImport++) {
+				if (!importModule.indexedImports.empty()) {
 					Helpers::panic("TODO: clear indexed exports");
 				}
 
 				// Export anonymous symbols
-				const u32 anonymousOffset = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousOffset);
-				const u32 anonymousNum = mem.read32(importModuleTable.offset + 20 * importModule + ImportModuleTable::AnonymousNum);
-
-				for (u32 anonymousImport = 0; anonymousImport < anonymousNum; anonymousImport++) {
-					if (anonymousOffset == 0) {
-						Helpers::panic("Anonymous symbol offset is NULL");
-					}
-
-					const u32 relocationOffset = mem.read32(anonymousOffset + 8 * anonymousImport + AnonymousImportTable::RelocationOffset);
-
-					cro.patchBatch(relocationOffset, onUnresolvedAddr, true);
+				for (const LDR::AnonymousImport& anonymousImport : importModule.anonymousImports) {
+					cro.patchBatch(anonymousImport.batch, onUnresolvedAddr, true);
 				}
 			}
 
@@ -1063,18 +861,17 @@ class CRO {
 			Helpers::panic("CRS not loaded");
 		}
 
-		const CROHeaderEntry segmentTable = getHeaderEntry(CROHeader::SegmentTableOffset);
+		std::vector<LDR::Segment>& segments = getModule().segments;
 
 		// Fix data segment offset (LoadCRO_New)
 		// Note: the old LoadCRO does *not* fix .data
-		u32 dataVaddr;
-		if (isNew) {
-			if (segmentTable.size > 1) {
-				// Note: ldr:ro assumes that segment index 2 is .data
-				dataVaddr = mem.read32(segmentTable.offset + 24 + SegmentTable::Offset);
-
-				mem.write32(segmentTable.offset + 24 + SegmentTable::Offset, mem.read32(croPointer + CROHeader::DataOffset));
-			}
+		// Linking only looks at our copy of the segment table, so there's no need to patch the one in guest memory
+		u32 dataVaddr = 0;
+		const bool fixData = isNew && segments.size() > 2;
+		if (fixData) {
+			// Note: ldr:ro assumes that segment index 2 is .data
+			dataVaddr = segments[2].offset;
+			segments[2].offset = mem.read32(croPointer + CROHeader::DataOffset);
 		}
 
 		importNamedSymbols(loadedCRS);
@@ -1082,10 +879,8 @@ class CRO {
 		exportSymbols(loadedCRS);
 
 		// Restore .data segment offset (LoadCRO_New)
-		if (isNew) {
-			if (segmentTable.size > 1) {
-				mem.write32(segmentTable.offset + 24 + SegmentTable::Offset, dataVaddr);
-			}
+		if (fixData) {
+			segments[2].offset = dataVaddr;
 		}
 
 		return true;
@@ -1109,7 +904,7 @@ class CRO {
 			Helpers::panic("CRS not loaded");
 		}
 
-		CRO crs(mem, loadedCRS, false);
+		CRO crs(mem, modules, loadedCRS, false);
 
 		u32 headAddr = crs.getPrevCRO();
 		if (autoLink) {
@@ -1127,8 +922,8 @@ class CRO {
 			}
 		} else {
 			// Register new CRO
-			CRO head(mem, headAddr, true);
-			CRO tail(mem, head.getPrevCRO(), true);
+			CRO head(mem, modules, headAddr, true);
+			CRO tail(mem, modules, head.getPrevCRO(), true);
 
 			if (tail.getNextCRO() != 0) {
 				Helpers::panic("Invalid CRO tail");
@@ -1147,13 +942,13 @@ class CRO {
 			Helpers::panic("CRS not loaded");
 		}
 
-		CRO crs(mem, loadedCRS, false);
+		CRO crs(mem, modules, loadedCRS, false);
 
-		CRO next(mem, getNextCRO(), true);
-		CRO prev(mem, getPrevCRO(), true);
+		CRO next(mem, modules, getNextCRO(), true);
+		CRO prev(mem, modules, getPrevCRO(), true);
 
-		CRO nextHead(mem, crs.getNextCRO(), true);
-		CRO prevHead(mem, crs.getPrevCRO(), true);
+		CRO nextHead(mem, modules, crs.getNextCRO(), true);
+		CRO prevHead(mem, modules, crs.getPrevCRO(), true);
 
 		if ((croPointer == nextHead.croPointer) || (croPointer == prevHead.croPointer)) {
 			// Our current CRO is the head, remove it
@@ -1193,7 +988,92 @@ class CRO {
 	}
 };
 
-void LDRService::reset() { loadedCRS = 0; }
+void LDR::Linker::reset() {
+	loadedCRS = 0;
+	modules.clear();
+}
+
+const LDR::Module* LDR::Linker::getModule(u32 address) const {
+	auto it = modules.find(address);
+	return it != modules.end() ? &it->second : nullptr;
+}
+
+void LDR::Linker::loadCRS(u32 address) {
+	if (loadedCRS != 0) {
+		Helpers::panic("CRS already loaded\n");
+	}
+
+	CRO crs(mem, modules, address, false);
+
+	if (!crs.load()) {
+		Helpers::panic("Failed to load CRS");
+	}
+
+	if (!crs.rebase(0, 0, 0)) {
+		Helpers::panic("Failed to rebase CRS");
+	}
+
+	loadedCRS = address;
+}
+
+const LDR::Module& LDR::Linker::loadCRO(u32 address, u32 dataVaddr, u32 bssVaddr, bool autoLink, u32 fixLevel, bool isNew) {
+	const auto startTime = std::chrono::steady_clock::now();
+	CRO cro(mem, modules, address, true);
+
+	if (!cro.load()) {
+		Helpers::panic("Failed to load CRO");
+	}
+
+	if (!cro.rebase(loadedCRS, dataVaddr, bssVaddr)) {
+		Helpers::panic("Failed to rebase CRO");
+	}
+
+	if (!cro.link(loadedCRS, isNew)) {
+		Helpers::panic("Failed to link CRO");
+	}
+
+	cro.registerCRO(loadedCRS, autoLink);
+
+	// TODO: add fixing
+	cro.fix(fixLevel);
+
+	Module& module = cro.getModule();
+	module.loadMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+	module.relocationCount = cro.getRelocationCount();
+	return module;
+}
+
+void LDR::Linker::linkCRO(u32 address) {
+	if (loadedCRS == 0) {
+		Helpers::panic("CRS not loaded");
+	}
+
+	CRO cro(mem, modules, address, true);
+
+	// TODO: check if CRO has been loaded prior to calling this
+
+	if (!cro.link(loadedCRS, false)) {
+		Helpers::panic("Failed to link CRO");
+	}
+}
+
+void LDR::Linker::unloadCRO(u32 address) {
+	// TODO: is CRO loaded?
+	CRO cro(mem, modules, address, true);
+	cro.unregisterCRO(loadedCRS);
+
+	if (!cro.unlink(loadedCRS)) {
+		Helpers::panic("Failed to unlink CRO");
+	}
+
+	if (!cro.unrebase()) {
+		Helpers::panic("Failed to unrebase CRO");
+	}
+
+	modules.erase(address);
+}
+
+void LDRService::reset() { linker.reset(); }
 
 void LDRService::handleSyncRequest(u32 messagePointer) {
 	const u32 command = mem.read32(messagePointer);
@@ -1217,10 +1097,6 @@ void LDRService::initialize(u32 messagePointer) {
 	log("LDR_RO::Initialize (buffer = %08X, size = %08X, vaddr = %08X, process = %X)\n", crsPointer, size, mapVaddr, process);
 
 	// Sanity checks
-	if (loadedCRS != 0) {
-		Helpers::panic("CRS already loaded\n");
-	}
-
 	if (size < CRO_HEADER_SIZE) {
 		Helpers::panic("CRS too small\n");
 	}
@@ -1247,18 +1123,8 @@ void LDRService::initialize(u32 messagePointer) {
 		Helpers::panic("Failed to map CRS");
 	}
 
-	CRO crs(mem, mapVaddr, false);
-
-	if (!crs.load()) {
-		Helpers::panic("Failed to load CRS");
-	}
-
-	if (!crs.rebase(0, 0, 0)) {
-		Helpers::panic("Failed to rebase CRS");
-	}
-
+	linker.loadCRS(mapVaddr);
 	kernel.clearInstructionCacheRange(mapVaddr, size);
-	loadedCRS = mapVaddr;
 
 	mem.write32(messagePointer, IPC::responseHeader(0x1, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
@@ -1270,21 +1136,11 @@ void LDRService::linkCRO(u32 messagePointer) {
 
 	log("LDR_RO::LinkCRO (vaddr = %X, process = %X)\n", mapVaddr, process);
 
-	if (loadedCRS == 0) {
-		Helpers::panic("CRS not loaded");
-	}
-
 	if (!mem.isAligned(mapVaddr)) {
 		Helpers::panic("Unaligned CRO vaddr\n");
 	}
 
-	CRO cro(mem, mapVaddr, true);
-
-	// TODO: check if CRO has been loaded prior to calling this
-
-	if (!cro.link(loadedCRS, false)) {
-		Helpers::panic("Failed to link CRO");
-	}
+	linker.linkCRO(mapVaddr);
 
 	mem.write32(messagePointer, IPC::responseHeader(0x6, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
@@ -1343,26 +1199,12 @@ void LDRService::loadCRO(u32 messagePointer, bool isNew) {
 		Helpers::panic("Failed to map CRO");
 	}
 
-	CRO cro(mem, mapVaddr, true);
-
-	if (!cro.load()) {
-		Helpers::panic("Failed to load CRO");
-	}
-
-	if (!cro.rebase(loadedCRS, dataVaddr, bssVaddr)) {
-		Helpers::panic("Failed to rebase CRO");
-	}
-
-	if (!cro.link(loadedCRS, isNew)) {
-		Helpers::panic("Failed to link CRO");
-	}
-
-	cro.registerCRO(loadedCRS, autoLink);
-
-	// TODO: add fixing
-	cro.fix(fixLevel);
+	const LDR::Module& module = linker.loadCRO(mapVaddr, dataVaddr, bssVaddr, autoLink, fixLevel, isNew);
 	kernel.clearInstructionCacheRange(mapVaddr, size);
 
+	log("LDR_RO::LoadCRO: Loaded \"%s\" in %llu us (%zu relocations, %zu named exports)\n", module.name.c_str(),
+		(unsigned long long)module.loadMicroseconds, module.relocationCount, module.namedExports.size());
+
 	if (isNew) {
 		mem.write32(messagePointer, IPC::responseHeader(0x9, 2, 0));
 	} else {
@@ -1380,8 +1222,6 @@ void LDRService::unloadCRO(u32 messagePointer) {
 
 	log("LDR_RO::UnloadCRO (vaddr = %08X, buffer = %08X, process = %X)\n", mapVaddr, croPointer, process);
 
-	// TODO: is CRO loaded?
-
 	if (!mem.isAligned(croPointer)) {
 		Helpers::panic("Unaligned CRO pointer\n");
 	}
@@ -1390,18 +1230,10 @@ void LDRService::unloadCRO(u32 messagePointer) {
 		Helpers::panic("Unaligned CRO output vaddr\n");
 	}
 
-	CRO cro(mem, mapVaddr, true);
-	cro.unregisterCRO(loadedCRS);
-
-	if (!cro.unlink(loadedCRS)) {
-		Helpers::panic("Failed to unlink CRO");
-	}
-
-	if (!cro.unrebase()) {
-		Helpers::panic("Failed to unrebase CRO");
-	}
+	linker.unloadCRO(mapVaddr);
 
-	u32 size = cro.getSize();
+	const u32 size = mem.read32(mapVaddr + CROHeader::FileSize);
+	const u32 fixedSize = mem.read32(mapVaddr + CROHeader::FixedSize);
 	bool succeeded = mem.mapVirtualMemory(
 		mapVaddr, croPointer, size >> 12, false, false, false, MemoryState::Locked, MemoryState::AliasCode, MemoryState::Free, MemoryState::Private,
 		false
@@ -1411,7 +1243,7 @@ void LDRService::unloadCRO(u32 messagePointer) {
 		Helpers::panic("Failed to unmap CRO");
 	}
 
-	kernel.clearInstructionCacheRange(mapVaddr, cro.getFixedSize());
+	kernel.clearInstructionCacheRange(mapVaddr, fixedSize);
 
 	mem.write32(messagePointer, IPC::responseHeader(0x5, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
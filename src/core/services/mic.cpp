@@ -1,5 +1,9 @@
 #include "services/mic.hpp"
 
+#include <algorithm>
+#include <cstring>
+
+#include "config.hpp"
 #include "ipc.hpp"
 #include "kernel/kernel.hpp"
 
@@ -28,6 +32,19 @@ void MICService::reset() {
 	gain = 0;
 
 	eventHandle = std::nullopt;
+	sharedMemory = std::nullopt;
+	source.reset();
+	sourceSamples.clear();
+}
+
+u32 MICService::getSampleRate(SampleRate rate) {
+	switch (rate) {
+		case SampleRate::Rate32730: return 32730;
+		case SampleRate::Rate16360: return 16360;
+		case SampleRate::Rate10910: return 10910;
+		case SampleRate::Rate8180: return 8180;
+		default: return 32730;
+	}
 }
 
 void MICService::handleSyncRequest(u32 messagePointer) {
@@ -54,13 +71,24 @@ void MICService::mapSharedMem(u32 messagePointer) {
 	u32 size = mem.read32(messagePointer + 4);
 	u32 handle = mem.read32(messagePointer + 12);
 
-	log("MIC::MapSharedMem (size = %08X, handle = %X) (stubbed)\n", size, handle);
+	log("MIC::MapSharedMem (size = %08X, handle = %X)\n", size, handle);
+
+	KernelObject* object = kernel.getObject(handle, KernelObjectType::MemoryBlock);
+	if (object != nullptr) {
+		sharedMemory = *object->getData<MemoryBlock>();
+		sharedMemory->size = size;
+	} else {
+		Helpers::warn("MIC::MapSharedMem: Shared memory object does not exist");
+	}
+
 	mem.write32(messagePointer, IPC::responseHeader(0x1, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
 }
 
 void MICService::unmapSharedMem(u32 messagePointer) {
-	log("MIC::UnmapSharedMem (stubbed)\n");
+	log("MIC::UnmapSharedMem\n");
+	stopSamplingInternal();
+	sharedMemory = std::nullopt;
 
 	mem.write32(messagePointer, IPC::responseHeader(0x2, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
@@ -122,23 +150,54 @@ void MICService::setClamp(u32 messagePointer) {
 }
 
 void MICService::startSampling(u32 messagePointer) {
-	u8 encoding = mem.read8(messagePointer + 4);
-	u8 sampleRate = mem.read8(messagePointer + 8);
-	u32 offset = mem.read32(messagePointer + 12);
-	u32 dataSize = mem.read32(messagePointer + 16);
-	bool loop = mem.read8(messagePointer + 20);
+	const u8 encodingRaw = mem.read8(messagePointer + 4);
+	const u8 sampleRateRaw = mem.read8(messagePointer + 8);
+	const u32 offset = mem.read32(messagePointer + 12);
+	const u32 dataSize = mem.read32(messagePointer + 16);
+	const bool shouldLoop = mem.read8(messagePointer + 20);
+
+	log("MIC::StartSampling (encoding = %d, sample rate = %d, offset = %08X, size = %08X, loop: %s)\n", encodingRaw, sampleRateRaw, offset,
+		dataSize, shouldLoop ? "yes" : "no");
+
+	// The sample buffer has to fit in the shared memory block, before the word at the end that holds the offset of the latest sample
+	if (sharedMemory.has_value()) {
+		const u64 bufferLimit = sharedMemory->size >= sizeof(u32) ? sharedMemory->size - sizeof(u32) : 0;
+		if (u64(offset) + u64(dataSize) > bufferLimit) {
+			Helpers::warn("MIC::StartSampling: Buffer (offset = %08X, size = %08X) is out of the shared memory bounds", offset, dataSize);
+
+			mem.write32(messagePointer, IPC::responseHeader(0x3, 1, 0));
+			mem.write32(messagePointer + 4, Result::OS::OutOfRange);
+			return;
+		}
+	}
+
+	encoding = static_cast<Encoding>(encodingRaw & 3);
+	sampleRate = getSampleRate(static_cast<SampleRate>(sampleRateRaw & 3));
+	loop = shouldLoop;
 
-	log("MIC::StartSampling (encoding = %d, sample rate = %d, offset = %08X, size = %08X, loop: %s) (stubbed)\n", encoding, sampleRate, offset,
-		dataSize, loop ? "yes" : "no");
+	// Make sure we never split a sample across the end of the ring buffer
+	bufferOffset = offset;
+	bufferSize = dataSize - (dataSize % getSampleSize(encoding));
+	writeOffset = bufferOffset;
 
+	// Recreate the sample source on every StartSampling, so WAV files restart from the beginning and we only hold on to the host's recording
+	// device while the game is actually sampling
+	source = Microphone::makeSource(config.micSource, config.micWavPath);
+	interpolationState = {};
+	sourceSamples.clear();
+
+	samplingStartTimestamp = kernel.getScheduler().currentTimestamp;
+	samplesProduced = 0;
 	currentlySampling = true;
+	scheduleNextUpdate();
+
 	mem.write32(messagePointer, IPC::responseHeader(0x3, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
 }
 
 void MICService::stopSampling(u32 messagePointer) {
 	log("MIC::StopSampling\n");
-	currentlySampling = false;
+	stopSamplingInternal();
 
 	mem.write32(messagePointer, IPC::responseHeader(0x5, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
@@ -171,4 +230,142 @@ void MICService::theCaptainToadFunction(u32 messagePointer) {
 
 	mem.write32(messagePointer, IPC::responseHeader(0x10, 1, 0));
 	mem.write32(messagePointer + 4, Result::Success);
+}
+
+void MICService::stopSamplingInternal() {
+	if (currentlySampling) {
+		currentlySampling = false;
+		kernel.getScheduler().removeEvent(Scheduler::EventType::UpdateMic);
+	}
+
+	source.reset();
+}
+
+void MICService::scheduleNextUpdate() {
+	// We produce one DSP frame's worth of samples per update
+	Scheduler& scheduler = kernel.getScheduler();
+	const u64 samples = samplesProduced + Audio::samplesInFrame;
+	const u64 timestamp = samplingStartTimestamp + samples * Scheduler::arm11Clock / sampleRate;
+
+	scheduler.rescheduleEvent(Scheduler::EventType::UpdateMic, timestamp);
+}
+
+void MICService::updateSampling() {
+	if (!currentlySampling) {
+		return;
+	}
+
+	// The shared memory can get remapped with a different size after StartSampling checked the buffer against it
+	if (!sharedMemory.has_value() || bufferSize == 0 || sharedMemory->size < sizeof(u32) ||
+		u64(bufferOffset) + u64(bufferSize) > sharedMemory->size - sizeof(u32)) {
+		Helpers::warn("MIC: Sampling without a valid shared memory buffer\n");
+		stopSamplingInternal();
+		return;
+	}
+
+	// Pull samples from the source and resample them to the rate the game asked for
+	Audio::Interpolation::StereoFrame16 frame;
+	usize outputIndex = 0;
+	const float rate = float(source->getSampleRate()) / float(sampleRate);
+
+	while (outputIndex < frame.size()) {
+		const usize needed = usize(rate * float(frame.size() - outputIndex)) + 3;
+
+		if (sourceSamples.size() < needed) {
+			const usize count = needed - sourceSamples.size();
+			sourceScratch.resize(count);
+
+			const usize samplesRead = source->read(sourceScratch.data(), count);
+			for (usize i = 0; i < samplesRead; i++) {
+				sourceSamples.push_back({sourceScratch[i], sourceScratch[i]});
+			}
+		}
+
+		Audio::Interpolation::linear(interpolationState, sourceSamples, rate, frame, outputIndex);
+	}
+
+	// Encode samples in the format the game requested
+	const u32 sampleSize = getSampleSize(encoding);
+	encodedSamples.resize(frame.size() * sampleSize);
+	u8* out = encodedSamples.data();
+
+	for (const auto& sample : frame) {
+		const s16 value = sample[0];
+
+		switch (encoding) {
+			case Encoding::PCM8: *out++ = u8((value >> 8) + 128); break;
+			case Encoding::PCM8Signed: *out++ = u8(s8(value >> 8)); break;
+
+			case Encoding::PCM16: {
+				const u16 unsignedValue = u16(s32(value) + 32768);
+				*out++ = u8(unsignedValue);
+				*out++ = u8(unsignedValue >> 8);
+				break;
+			}
+
+			case Encoding::PCM16Signed:
+				*out++ = u8(value);
+				*out++ = u8(u16(value) >> 8);
+				break;
+		}
+	}
+
+	// Write the samples into the ring buffer in shared memory, handling wraparound
+	const u32 bufferEnd = bufferOffset + bufferSize;
+	const u8* data = encodedSamples.data();
+	u32 remaining = u32(encodedSamples.size());
+	bool bufferFull = false;
+
+	while (remaining > 0) {
+		const u32 bytesToWrite = std::min(remaining, bufferEnd - writeOffset);
+		writeToSharedMemory(writeOffset, data, bytesToWrite);
+
+		data += bytesToWrite;
+		remaining -= bytesToWrite;
+		writeOffset += bytesToWrite;
+
+		if (writeOffset >= bufferEnd) {
+			if (eventHandle.has_value()) {
+				kernel.signalEvent(eventHandle.value());
+			}
+
+			if (loop) {
+				writeOffset = bufferOffset;
+			} else {
+				bufferFull = true;
+				break;
+			}
+		}
+	}
+
+	// The last 4 bytes of the shared memory block hold the offset of the latest sample written
+	// https://www.3dbrew.org/wiki/MIC_Shared_Memory
+	mem.write32(sharedMemory->addr + sharedMemory->size - sizeof(u32), writeOffset);
+
+	if (bufferFull) {
+		stopSamplingInternal();
+	} else {
+		samplesProduced += frame.size();
+		scheduleNextUpdate();
+	}
+}
+
+// The shared memory block is only virtually contiguous, so copy page by page
+void MICService::writeToSharedMemory(u32 offset, const u8* data, u32 size) {
+	u32 vaddr = sharedMemory->addr + offset;
+
+	while (size > 0) {
+		const u32 bytesInPage = std::min<u32>(size, Memory::pageSize - (vaddr & Memory::pageMask));
+		u8* pointer = static_cast<u8*>(mem.getWritePointer(vaddr));
+
+		if (pointer == nullptr) [[unlikely]] {
+			Helpers::warn("MIC: Tried to write samples to unmapped address %08X\n", vaddr);
+			return;
+		}
+
+		std::memcpy(pointer, data, bytesInPage);
+		vaddr += bytesInPage;
+		data += bytesInPage;
+		size -= bytesInPage;
+	}
 }
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include "services/mic_source.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <unordered_map>
+
+#include "io_file.hpp"
+#include "miniaudio.h"
+
+namespace Microphone {
+	SourceType sourceTypeFromString(std::string inString) {
+		// Transform to lower-case to make the setting case-insensitive
+		std::transform(inString.begin(), inString.end(), inString.begin(), [](unsigned char c) { return std::tolower(c); });
+
+		static const std::unordered_map<std::string, SourceType> map = {
+			{"silence", SourceType::Silence},
+			{"wav", SourceType::WAV},
+			{"host", SourceType::Host},
+		};
+
+		if (auto search = map.find(inString); search != map.end()) {
+			return search->second;
+		}
+
+		// Default to silence
+		return SourceType::Silence;
+	}
+
+	const char* sourceTypeToString(SourceType type) {
+		switch (type) {
+			case SourceType::WAV: return "wav";
+			case SourceType::Host: return "host";
+
+			case SourceType::Silence:
+			default: return "silence";
+		}
+	}
+
+	usize SilenceSource::read(s16* output, usize count) {
+		std::fill_n(output, count, s16(0));
+		return count;
+	}
+
+	WAVSource::WAVSource(const std::filesystem::path& path) {
+		if (!load(path)) {
+			Helpers::warn("Microphone: Failed to load WAV file %s, falling back to silence\n", path.string().c_str());
+			samples.clear();
+		}
+	}
+
+	// Minimal RIFF WAVE parser. Supports 8-bit unsigned and 16-bit signed PCM with any number of channels, which get downmixed to mono
+	bool WAVSource::load(const std::filesystem::path& path) {
+		IOFile file(path, "rb");
+		if (!file.isOpen()) {
+			return false;
+		}
+
+		auto size = file.size();
+		if (!size.has_value() || size.value() < 12) {
+			file.close();
+			return false;
+		}
+
+		std::vector<u8> data(size.value());
+		auto [success, bytesRead] = file.readBytes(data.data(), data.size());
+		file.close();
+
+		if (!success || bytesRead != data.size()) {
+			return false;
+		}
+
+		if (std::memcmp(&data[0], "RIFF", 4) != 0 || std::memcmp(&data[8], "WAVE", 4) != 0) {
+			return false;
+		}
+
+		const auto read16 = [&](usize offset) { return u16(data[offset] | (data[offset + 1] << 8)); };
+		const auto read32 = [&](usize offset) { return u32(read16(offset) | (u32(read16(offset + 2)) << 16)); };
+
+		u16 format = 0;
+		u16 channels = 0;
+		u16 bitsPerSample = 0;
+		bool foundFormat = false;
+
+		usize offset = 12;
+		while (offset + 8 <= data.size()) {
+			const u32 chunkSize = read32(offset + 4);
+			const usize chunkStart = offset + 8;
+			const usize chunkEnd = std::min<usize>(chunkStart + chunkSize, data.size());
+
+			if (std::memcmp(&data[offset], "fmt ", 4) == 0 && chunkSize >= 16) {
+				format = read16(chunkStart);
+				channels = read16(chunkStart + 2);
+				sampleRate = read32(chunkStart + 4);
+				bitsPerSample = read16(chunkStart + 14);
+				foundFormat = true;
+			} else if (std::memcmp(&data[offset], "data", 4) == 0) {
+				// 1 = PCM. 0xFFFE = WAVE_FORMAT_EXTENSIBLE, which we assume is PCM as well
+				if (!foundFormat || (format != 1 && format != 0xFFFE) || channels == 0 || sampleRate == 0) {
+					return false;
+				}
+
+				if (bitsPerSample != 8 && bitsPerSample != 16) {
+					return false;
+				}
+
+				const usize bytesPerFrame = usize(channels) * (bitsPerSample / 8);
+				const usize frameCount = (chunkEnd - chunkStart) / bytesPerFrame;
+				samples.resize(frameCount);
+
+				for (usize i = 0; i < frameCount; i++) {
+					const usize frameOffset = chunkStart + i * bytesPerFrame;
+					s32 sum = 0;
+
+					for (usize channel = 0; channel < channels; channel++) {
+						if (bitsPerSample == 8) {
+							sum += (s32(data[frameOffset + channel]) - 128) << 8;
+						} else {
+							sum += s16(read16(frameOffset + channel * 2));
+						}
+					}
+
+					samples[i] = s16(sum / s32(channels));
+				}
+
+				return !samples.empty();
+			}
+
+			// Chunks are padded to an even size
+			offset = chunkStart + chunkSize + (chunkSize & 1);
+		}
+
+		return false;
+	}
+
+	usize WAVSource::read(s16* output, usize count) {
+		if (samples.empty()) {
+			std::fill_n(output, count, s16(0));
+			return count;
+		}
+
+		// Loop the file forever
+		usize samplesRead = 0;
+		while (samplesRead < count) {
+			const usize samplesToCopy = std::min(count - samplesRead, samples.size() - position);
+			std::copy_n(&samples[position], samplesToCopy, output + samplesRead);
+
+			samplesRead += samplesToCopy;
+			position += samplesToCopy;
+			if (position == samples.size()) {
+				position = 0;
+			}
+		}
+
+		return samplesRead;
+	}
+
+	HostSource::HostSource() : device(std::make_unique<ma_device>()) {
+		ma_device_config config = ma_device_config_init(ma_device_type_capture);
+		config.capture.format = ma_format_s16;
+		config.capture.channels = 1;
+		config.sampleRate = sampleRate;
+		config.pUserData = this;
+
+		config.dataCallback = [](ma_device* device, void* output, const void* input, ma_uint32 frameCount) {
+			auto self = reinterpret_cast<HostSource*>(device->pUserData);
+			// If the emulator is not consuming samples fast enough, this will just drop the newest ones
+			self->ringBuffer.push(input, frameCount);
+		};
+
+		if (ma_device_init(nullptr, &config, device.get()) != MA_SUCCESS) {
+			Helpers::warn("Microphone: Failed to initialize host capture device, falling back to silence\n");
+			return;
+		}
+
+		if (ma_device_start(device.get()) != MA_SUCCESS) {
+			Helpers::warn("Microphone: Failed to start host capture device, falling back to silence\n");
+			ma_device_uninit(device.get());
+			return;
+		}
+
+		initialized = true;
+	}
+
+	HostSource::~HostSource() {
+		if (initialized) {
+			ma_device_uninit(device.get());
+		}
+	}
+
+	usize HostSource::read(s16* output, usize count) {
+		usize samplesRead = initialized ? ringBuffer.pop(output, count) : 0;
+
+		// Pad with silence on underrun, as the MIC service needs to produce samples at a constant rate
+		std::fill_n(output + samplesRead, count - samplesRead, s16(0));
+		return count;
+	}
+
+	std::unique_ptr<SampleSource> makeSource(SourceType type, const std::filesystem::path& wavPath) {
+		switch (type) {
+			case SourceType::WAV: return std::make_unique<WAVSource>(wavPath);
+			case SourceType::Host: return std::make_unique<HostSource>();
+
+			case SourceType::Silence:
+			default: return std::make_unique<SilenceSource>();
+		}
+	}
+}  // namespace Microphone
@@ -1,18 +1,20 @@
 #include "services/service_manager.hpp"
 
+#include <chrono>
 #include <set>
 
 #include "ipc.hpp"
 #include "kernel.hpp"
+#include "profiler.hpp"
 #include "services/service_map.hpp"
 
 ServiceManager::ServiceManager(
 	std::span<u32, 16> regs, Memory& mem, GPU& gpu, u32& currentPID, Kernel& kernel, const EmulatorConfig& config, LuaManager& lua
 )
-	: regs(regs), mem(mem), kernel(kernel), lua(lua), ac(mem), am(mem), boss(mem), act(mem), apt(mem, kernel), cam(mem, kernel), cecd(mem, kernel),
+	: regs(regs), mem(mem), kernel(kernel), lua(lua), ac(mem), am(mem), boss(mem), act(mem), apt(mem, kernel), cam(mem, kernel, config), cecd(mem, kernel),
 	  cfg(mem, config), csnd(mem, kernel), dlp_srvr(mem), dsp(mem, kernel, config), hid(mem, kernel), http(mem), ir_user(mem, hid, config, kernel),
-	  frd(mem), fs(mem, kernel, config), gsp_gpu(mem, gpu, kernel, currentPID), gsp_lcd(mem), ldr(mem, kernel), mcu_hwc(mem, config),
-	  mic(mem, kernel), nfc(mem, kernel), nim(mem), ndm(mem), news_u(mem), ns(mem), nwm_uds(mem, kernel), ptm(mem, config), soc(mem), ssl(mem),
+	  frd(mem), fs(mem, kernel, config), gsp_gpu(mem, gpu, kernel, config, currentPID), gsp_lcd(mem), ldr(mem, kernel), mcu_hwc(mem, config),
+	  mic(mem, kernel, config), nfc(mem, kernel), nim(mem), ndm(mem), news_u(mem), ns(mem), nwm_uds(mem, kernel), ptm(mem, config), soc(mem), ssl(mem),
 	  y2r(mem, kernel) {}
 
 static constexpr int MAX_NOTIFICATION_COUNT = 16;
@@ -220,12 +222,28 @@ void ServiceManager::publishToSubscriber(u32 messagePointer) {
 }
 
 void ServiceManager::sendCommandToService(u32 messagePointer, Handle handle) {
+	PROFILE_SCOPE(KernelHandles::getServiceName(handle), Service);
+
 	if (haveServiceIntercepts) [[unlikely]] {
 		if (checkForIntercept(messagePointer, handle)) [[unlikely]] {
 			return;
 		}
 	}
 
+	if (ipcStats.isEnabled()) [[unlikely]] {
+		// Read the header before dispatching, as the service overwrites it with the response header
+		const u32 header = mem.read32(messagePointer);
+		const auto start = std::chrono::steady_clock::now();
+		dispatchToService(messagePointer, handle);
+		const auto end = std::chrono::steady_clock::now();
+
+		ipcStats.record(handle, header, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+	} else {
+		dispatchToService(messagePointer, handle);
+	}
+}
+
+void ServiceManager::dispatchToService(u32 messagePointer, Handle handle) {
 	switch (handle) {
 		// Breaking alphabetical order a bit to place the ones I think are most common at the top
 		case KernelHandles::GPU: [[likely]] gsp_gpu.handleSyncRequest(messagePointer); break;
@@ -4,8 +4,12 @@
 #include <SDL_filesystem.h>
 #endif
 
+#include <algorithm>
 #include <fstream>
 
+#include "io_file.hpp"
+#include "logger.hpp"
+#include "profiler.hpp"
 #include "renderdoc.hpp"
 
 #ifdef _WIN32
@@ -42,10 +46,13 @@ Emulator::Emulator()
 
 	reloadSettings();
 	reset(ReloadOption::NoReload);
+	Log::startWorker();
 }
 
 Emulator::~Emulator() {
 	config.save();
+	dumpIPCStats();
+	Log::stopWorker();
 	lua.close();
 	audioDevice.close();
 
@@ -55,6 +62,8 @@ Emulator::~Emulator() {
 }
 
 void Emulator::reset(ReloadOption reload) {
+	// Make sure the GX thread isn't using the GPU while we reset it
+	kernel.getServiceManager().syncGPUCommands();
 	cpu.reset();
 	gpu.reset();
 	memory.reset();
@@ -118,6 +127,7 @@ void Emulator::step() {}
 // Only resume if a ROM is properly loaded
 void Emulator::resume() {
 	running = (romType != ROMType::None);
+	framePacer.reset();
 
 	if (running && config.audioEnabled) {
 		audioDevice.start();
@@ -133,13 +143,22 @@ void Emulator::togglePause() { running ? pause() : resume(); }
 
 void Emulator::runFrame() {
 	if (running) {
+		const bool present = framePacer.beginFrame();
+		gpu.setSkipDraws(!present && config.skipRenderingSkippedFrames);
+
 		cpu.runFrame();  // Run 1 frame of instructions
-		gpu.display();   // Display graphics
+		kernel.getServiceManager().syncGPUCommands();
+		if (present) {
+			gpu.display();  // Display graphics
+		}
 
 		// Run cheats if any are loaded
 		if (cheats.haveCheats()) [[unlikely]] {
 			cheats.run();
 		}
+
+		framePacer.endFrame();
+		PROFILE_END_FRAME();
 	} else if (romType != ROMType::None) {
 		// If the emulator is not running and a game is loaded, we still want to display the framebuffer otherwise we will get weird
 		// double-buffering issues
@@ -171,19 +190,23 @@ void Emulator::pollScheduler() {
 					srv.sendGPUInterrupt(GPUInterrupt::VBlank1);
 
 					// Queue next VBlank event
-					scheduler.addEvent(Scheduler::EventType::VBlank, time + CPU::ticksPerSec / 60);
+					scheduler.addEvent(Scheduler::EventType::VBlank, time + Scheduler::ticksPerFrame);
 					break;
 				}
 
 			case Scheduler::EventType::ThreadWakeup: kernel.pollThreadWakeups(); break;
 			case Scheduler::EventType::UpdateTimers: kernel.pollTimers(); break;
 			case Scheduler::EventType::RunDSP: {
+				PROFILE_SCOPE("DSPCore::runAudioFrame", DSP);
 				dsp->runAudioFrame(time);
 				break;
 			}
 
 			case Scheduler::EventType::SignalY2R: kernel.getServiceManager().getY2R().signalConversionDone(); break;
 			case Scheduler::EventType::UpdateIR: kernel.getServiceManager().getIRUser().updateCirclePadPro(); break;
+			case Scheduler::EventType::UpdateCamera: kernel.getServiceManager().getCAM().updateCapture(); break;
+			case Scheduler::EventType::UpdateMic: kernel.getServiceManager().getMIC().updateSampling(); break;
+			case Scheduler::EventType::SyncGX: kernel.getServiceManager().syncGPUCommands(); break;
 
 			default: {
 				Helpers::panic("Scheduler: Unimplemented event type received: %d\n", static_cast<int>(eventType));
@@ -279,6 +302,8 @@ bool Emulator::loadROM(const std::filesystem::path& path) {
 		kernel.setMainThreadEntrypointAndSP(cpu.getReg(15), cpu.getReg(13));
 	}
 
+	updateCPUClock();
+
 	resume();  // Start the emulator
 	return success;
 }
@@ -458,14 +483,56 @@ void Emulator::loadRenderdoc() {
 	Renderdoc::setOutputDir(capturePath, "");
 }
 
+void Emulator::dumpIPCStats() {
+	const IPCStats& ipcStats = kernel.getServiceManager().getIPCStats();
+	if (!ipcStats.isEnabled()) {
+		return;
+	}
+
+	const std::string report = ipcStats.report();
+	const std::filesystem::path path = getAppDataRoot() / "ipc_stats.txt";
+
+	IOFile file(path, "w");
+	if (file.isOpen()) {
+		file.writeBytes(report.data(), report.size());
+		file.close();
+		printf("Wrote IPC statistics to %s\n", path.string().c_str());
+	}
+}
+
+void Emulator::updateCPUClock() {
+	u32 clockPercent = config.cpuClockPercent;
+
+	NCCH* cxi = memory.getCXI();
+	if (config.autoNew3DSClock && cxi != nullptr && cxi->requestsNew3DSClock) {
+		clockPercent = std::max(clockPercent, EmulatorConfig::new3DSClockPercent);
+	}
+
+	if (clockPercent != cpu.getClockPercent()) {
+		printf("Setting CPU clock to %u%% (%.0fMHz)\n", clockPercent, double(Scheduler::arm11Clock) * clockPercent / 100.0 / 1000000.0);
+		cpu.setClockPercent(clockPercent);
+	}
+}
+
 void Emulator::reloadSettings() {
 	setAudioEnabled(config.audioEnabled);
+	updateCPUClock();
+
+	framePacer.setTargetSpeed(config.targetSpeed);
+	framePacer.setFastForwardSpeed(config.fastForwardSpeed);
+	framePacer.setTurboSpeed(config.turboSpeed);
+	framePacer.setMaxFrameSkip(config.maxFrameSkip);
 
 	if (Renderdoc::isSupported() && config.enableRenderdoc && !Renderdoc::isLoaded()) {
 		loadRenderdoc();
 	}
 
 	gpu.getRenderer()->setHashTextures(config.hashTextures);
+	kernel.getServiceManager().getIPCStats().setEnabled(config.ipcStatistics);
+
+	if (!config.logFilter.empty() && !Log::applyFilter(config.logFilter)) {
+		Helpers::warn("Invalid entries in log filter \"%s\"", config.logFilter.c_str());
+	}
 
 #ifdef PANDA3DS_ENABLE_DISCORD_RPC
 	// Reload RPC setting if we're compiling with RPC support
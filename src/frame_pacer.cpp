@@ -0,0 +1,141 @@
+#include "frame_pacer.hpp"
+
+#include <algorithm>
+#include <thread>
+
+FramePacer::Duration FramePacer::getCurrentPeriod() const {
+	u32 speed = targetSpeed;
+	if (turbo) {
+		speed = turboSpeed;
+	} else if (fastForward) {
+		speed = fastForwardSpeed;
+	}
+
+	// Unlimited speed
+	if (speed == 0) {
+		return Duration::zero();
+	}
+
+	return framePeriod * 100 / speed;
+}
+
+bool FramePacer::shouldPresent(Clock::time_point now) {
+	if (!enabled) {
+		return true;
+	}
+
+	bool present = true;
+	const Duration period = getCurrentPeriod();
+
+	// At unlimited speed there's no deadline to fall behind of, so this is handled like fast-forwarding
+	if (isFastForwarding() || period == Duration::zero()) {
+		// There's no point presenting more frames than the display can show, so only present once a display refresh worth of time passed
+		present = now - lastPresent >= presentInterval;
+	} else if (skippedInARow < maxFrameSkip) {
+		// If this frame is starting more than a frame late, we're running behind. Skip presenting it to catch up
+		present = now - deadline < period;
+	}
+
+	if (present) {
+		lastPresent = now;
+		skippedInARow = 0;
+	} else {
+		skippedInARow++;
+	}
+
+	return present;
+}
+
+bool FramePacer::beginFrame(Clock::time_point now) {
+	if (!started) {
+		started = true;
+		deadline = now;
+		lastPresent = now - presentInterval;
+		skippedInARow = 0;
+		// No previous frame to measure the interval from, so leave this frame out of the FPS
+		frameInterval = Duration::zero();
+	} else {
+		frameInterval = now - frameStart;
+	}
+
+	frameStart = now;
+	presenting = shouldPresent(now);
+
+	std::scoped_lock lock(statsMutex);
+	stats.framesEmulated++;
+	if (presenting) {
+		stats.framesPresented++;
+	} else {
+		stats.framesSkipped++;
+	}
+
+	return presenting;
+}
+
+FramePacer::Clock::time_point FramePacer::finishFrame(Clock::time_point now) {
+	updateStats(now - frameStart, frameInterval);
+
+	const Duration period = getCurrentPeriod();
+	if (!enabled || period == Duration::zero()) {
+		deadline = now;
+		return now;
+	}
+
+	deadline += period;
+	if (now - deadline > period * maxFramesBehind) {
+		deadline = now;
+	}
+
+	return deadline;
+}
+
+void FramePacer::endFrame() {
+	const auto nextFrame = finishFrame(Clock::now());
+	if (enabled) {
+		waitUntil(nextFrame);
+	}
+}
+
+void FramePacer::waitUntil(Clock::time_point time) {
+	const auto now = Clock::now();
+	if (time - now > spinThreshold) {
+		std::this_thread::sleep_for(time - now - spinThreshold);
+	}
+
+	while (Clock::now() < time) {
+		std::this_thread::yield();
+	}
+}
+
+void FramePacer::updateStats(Duration frameTime, Duration interval) {
+	std::scoped_lock lock(statsMutex);
+	frameTimes[statIndex] = frameTime;
+	frameIntervals[statIndex] = interval;
+	statIndex = (statIndex + 1) % statWindow;
+	statCount = std::min(statCount + 1, statWindow);
+
+	Duration totalTime = Duration::zero();
+	Duration totalInterval = Duration::zero();
+	Duration maxTime = Duration::zero();
+	usize intervalCount = 0;
+
+	for (usize i = 0; i < statCount; i++) {
+		totalTime += frameTimes[i];
+		maxTime = std::max(maxTime, frameTimes[i]);
+
+		if (frameIntervals[i] != Duration::zero()) {
+			totalInterval += frameIntervals[i];
+			intervalCount++;
+		}
+	}
+
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+	stats.averageFrameTime = Milliseconds(totalTime).count() / double(statCount);
+	stats.maxFrameTime = Milliseconds(maxTime).count();
+
+	if (intervalCount != 0) {
+		const double averageInterval = std::chrono::duration<double>(totalInterval).count() / double(intervalCount);
+		stats.fps = 1.0 / averageInterval;
+		stats.speed = stats.fps * 100.0 * std::chrono::duration<double>(framePeriod).count();
+	}
+}
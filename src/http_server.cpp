@@ -236,12 +236,24 @@ std::string HttpServer::status() {
 	stringStream << "Panda3DS\n";
 	stringStream << "Status: " << (paused ? "Paused" : "Running") << "\n";
 
+	const FramePacer::Stats frameStats = emulator->getFramePacer().getStats();
+	stringStream << "FPS: " << frameStats.fps << "\n";
+	stringStream << "Speed: " << frameStats.speed << "%\n";
+	stringStream << "Frame time: " << frameStats.averageFrameTime << "ms (max " << frameStats.maxFrameTime << "ms)\n";
+	stringStream << "Frames skipped: " << frameStats.framesSkipped << "/" << frameStats.framesEmulated << "\n";
+
 	// TODO: This currently doesn't work for N3DS buttons
 	auto keyPressed = [](const HIDService& hid, u32 mask) { return (hid.getOldButtons() & mask) != 0; };
 	for (auto& [keyStr, value] : keyMap) {
 		stringStream << keyStr << ": " << keyPressed(hid, value) << "\n";
 	}
 
+	// Reading the statistics is thread-safe, so we don't have to go through the action queue
+	const IPCStats& ipcStats = emulator->getServiceManager().getIPCStats();
+	if (ipcStats.isEnabled()) {
+		stringStream << "\n" << ipcStats.report();
+	}
+
 	return stringStream.str();
 }
 
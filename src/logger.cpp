@@ -0,0 +1,411 @@
+#include "logger.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#endif
+
+namespace Log {
+	namespace {
+		constexpr Level defaultLevel(Category category) {
+			// outputDebugString output is on by default
+			return category == Category::DebugString ? Level::Debug : Level::Off;
+		}
+
+		template <usize... Indices>
+		constexpr std::array<std::atomic<Level>, categoryCount> defaultLevels(std::index_sequence<Indices...>) {
+			return {{defaultLevel(static_cast<Category>(Indices))...}};
+		}
+	}  // namespace
+
+	// Constant-initialized, so that logging works even during static initialization
+	constinit std::array<std::atomic<Level>, categoryCount> categoryLevels = defaultLevels(std::make_index_sequence<categoryCount>());
+
+	namespace {
+		constexpr std::array<const char*, categoryCount> categoryNames = {
+			"Kernel", "DebugString", "Error", "FileIO", "SVC", "Thread", "GPU", "Renderer", "ShaderJIT", "DSP",
+			// Services
+			"AC", "ACT", "AM", "APT", "BOSS", "CAM", "CECD", "CFG", "CSND", "DSPService", "DLPSrvr", "FRD", "FS", "HID", "HTTP", "IRUser",
+			"GSPGPU", "GSPLCD", "LDR", "MCU", "MIC", "NEWS", "NFC", "NWMUDS", "NIM", "NDM", "NS", "PTM", "SOC", "SSL", "Y2R", "SRV",
+		};
+		static_assert(categoryNames.back() != nullptr, "Every log category needs a name");
+
+		struct ThreadBuffer {
+			// 1MB of records per thread that logs anything
+			static constexpr usize capacity = 4096;
+
+			std::unique_ptr<Record[]> records = std::make_unique<Record[]>(capacity);
+			// Total number of records written by the owning thread and read by the worker. This is a single-producer single-consumer queue
+			std::atomic<u64> writeIndex = 0;
+			std::atomic<u64> readIndex = 0;
+		};
+
+		const auto epoch = std::chrono::steady_clock::now();
+
+		// Buffers are never freed, even when their thread exits, so that we can still format their pending records
+		std::mutex buffersMutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+		thread_local ThreadBuffer* localBuffer = nullptr;
+
+		// Only one thread may consume records at a time
+		std::mutex consumerMutex;
+		std::atomic<u64> droppedRecords = 0;
+
+		std::atomic<bool> workerRunning = false;
+		std::thread workerThread;
+		std::mutex workerMutex;
+		std::condition_variable workerCondition;
+		bool stopRequested = false;
+
+		ThreadBuffer& getLocalBuffer() {
+			if (localBuffer == nullptr) [[unlikely]] {
+				std::unique_lock lock(buffersMutex);
+				localBuffer = buffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+			}
+
+			return *localBuffer;
+		}
+
+		void output(const std::string& message) {
+#ifdef __ANDROID__
+			__android_log_write(ANDROID_LOG_DEFAULT, "Panda3DS", message.c_str());
+#else
+			std::fwrite(message.data(), 1, message.size(), stdout);
+#endif
+		}
+
+		// Reads back the arguments packed by a PayloadWriter
+		struct PayloadReader {
+			const u8* data;
+			usize size;
+			usize offset = 0;
+
+			template <typename T>
+			T read() {
+				T value;
+				std::memcpy(&value, &data[offset], sizeof(T));
+				offset += sizeof(T);
+				return value;
+			}
+		};
+
+		struct Argument {
+			Record::ArgType type;
+			u64 integer = 0;
+			double floating = 0.0;
+			std::string_view string;
+		};
+
+		// Returns false once we run out of arguments
+		bool readArgument(PayloadReader& reader, Argument& arg) {
+			if (reader.offset >= reader.size) {
+				return false;
+			}
+
+			arg.type = static_cast<Record::ArgType>(reader.read<u8>());
+			switch (arg.type) {
+				case Record::ArgType::Int32: arg.integer = reader.read<u32>(); break;
+				case Record::ArgType::Int64:
+				case Record::ArgType::Pointer: arg.integer = reader.read<u64>(); break;
+				case Record::ArgType::Double: arg.floating = reader.read<double>(); break;
+				case Record::ArgType::String: {
+					const usize length = reader.read<u32>();
+					arg.string = std::string_view(reinterpret_cast<const char*>(&reader.data[reader.offset]), length);
+					reader.offset += length;
+					break;
+				}
+			}
+
+			return true;
+		}
+
+		void formatArgument(std::string& result, std::string spec, char conversion, const Argument& arg) {
+			char buffer[512];
+			const bool isFloatConversion = std::strchr("eEfFgGaA", conversion) != nullptr;
+
+			// The length modifiers of the format string don't necessarily match what we stored, so we replace them with our own
+			auto withLength = [&spec, conversion](const char* length) { return spec + length + conversion; };
+
+			if (conversion == 's') {
+				const std::string string = arg.type == Record::ArgType::String ? std::string(arg.string)
+											: arg.type == Record::ArgType::Double ? std::to_string(arg.floating)
+																				  : std::to_string(arg.integer);
+				// Strings can be longer than our buffer, so they get formatted straight into the result
+				const std::string stringSpec = withLength("");
+				const int length = std::snprintf(nullptr, 0, stringSpec.c_str(), string.c_str());
+				if (length > 0) {
+					const usize start = result.size();
+					result.resize(start + usize(length) + 1);
+					std::snprintf(&result[start], usize(length) + 1, stringSpec.c_str(), string.c_str());
+					result.resize(start + usize(length));
+				}
+				return;
+			} else if (arg.type == Record::ArgType::String) {
+				// Mismatched format string, print the string as-is
+				result += arg.string;
+				return;
+			} else if (conversion == 'p') {
+				std::snprintf(buffer, sizeof(buffer), withLength("").c_str(), reinterpret_cast<void*>(uintptr_t(arg.integer)));
+			} else if (isFloatConversion) {
+				const double value = arg.type == Record::ArgType::Double ? arg.floating : double(s64(arg.integer));
+				std::snprintf(buffer, sizeof(buffer), withLength("").c_str(), value);
+			} else if (arg.type == Record::ArgType::Int32) {
+				std::snprintf(buffer, sizeof(buffer), withLength("").c_str(), u32(arg.integer));
+			} else {
+				const u64 value = arg.type == Record::ArgType::Double ? u64(s64(arg.floating)) : arg.integer;
+				std::snprintf(buffer, sizeof(buffer), withLength("ll").c_str(), (unsigned long long)value);
+			}
+
+			result += buffer;
+		}
+
+		std::string formatMessage(const char* fmt, PayloadReader reader) {
+			std::string result;
+
+			while (*fmt != '\0') {
+				if (*fmt != '%') {
+					result += *fmt++;
+					continue;
+				}
+
+				if (fmt[1] == '%') {
+					result += '%';
+					fmt += 2;
+					continue;
+				}
+
+				// Parse the conversion specification. We keep the flags, width and precision but drop the length modifiers
+				std::string spec = "%";
+				fmt++;
+
+				while (*fmt != '\0' && std::strchr("-+ #0123456789.*", *fmt) != nullptr) {
+					if (*fmt == '*') {
+						// Width or precision passed as an argument
+						Argument arg;
+						spec += readArgument(reader, arg) ? std::to_string(s32(arg.integer)) : "0";
+					} else {
+						spec += *fmt;
+					}
+					fmt++;
+				}
+
+				while (*fmt != '\0' && std::strchr("hljztLq", *fmt) != nullptr) {
+					fmt++;
+				}
+
+				const char conversion = *fmt;
+				if (conversion == '\0') {
+					break;
+				}
+				fmt++;
+
+				if (conversion == 'n') {
+					continue;
+				}
+
+				Argument arg;
+				if (!readArgument(reader, arg)) {
+					result += "<missing>";
+					continue;
+				}
+
+				formatArgument(result, spec, conversion, arg);
+			}
+
+			return result;
+		}
+
+		// Format every record that's pending in the ring buffers. Records from different threads are interleaved by timestamp
+		// The consumer mutex must be held while calling this
+		void drainLocked() {
+			std::vector<Record> pending;
+
+			{
+				std::unique_lock lock(buffersMutex);
+				for (auto& buffer : buffers) {
+					const u64 writeIndex = buffer->writeIndex.load(std::memory_order_acquire);
+					const u64 readIndex = buffer->readIndex.load(std::memory_order_relaxed);
+
+					for (u64 i = readIndex; i < writeIndex; i++) {
+						pending.push_back(buffer->records[i % ThreadBuffer::capacity]);
+					}
+					buffer->readIndex.store(writeIndex, std::memory_order_release);
+				}
+			}
+
+			std::stable_sort(pending.begin(), pending.end(), [](const Record& a, const Record& b) { return a.timestamp < b.timestamp; });
+			for (const Record& record : pending) {
+				output(formatRecord(record));
+			}
+
+			if (!pending.empty()) {
+				std::fflush(stdout);
+			}
+		}
+
+		void drain() {
+			std::unique_lock consumerLock(consumerMutex);
+			drainLocked();
+		}
+
+		void workerLoop() {
+			std::unique_lock lock(workerMutex);
+			while (!stopRequested) {
+				lock.unlock();
+				drain();
+				lock.lock();
+
+				workerCondition.wait_for(lock, std::chrono::milliseconds(5), [] { return stopRequested; });
+			}
+		}
+	}  // namespace
+
+	void setLevel(Category category, Level level) { categoryLevels[static_cast<usize>(category)].store(level, std::memory_order_relaxed); }
+	Level getLevel(Category category) { return categoryLevels[static_cast<usize>(category)].load(std::memory_order_relaxed); }
+
+	const char* categoryName(Category category) {
+		const usize index = static_cast<usize>(category);
+		return index < categoryCount ? categoryNames[index] : "Unknown";
+	}
+
+	bool applyFilter(const std::string& filter) {
+		auto equalsIgnoreCase = [](std::string_view a, std::string_view b) {
+			return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return std::tolower(x) == std::tolower(y); });
+		};
+
+		auto trim = [](std::string_view string) {
+			while (!string.empty() && std::isspace(string.front())) string.remove_prefix(1);
+			while (!string.empty() && std::isspace(string.back())) string.remove_suffix(1);
+			return string;
+		};
+
+		static constexpr std::array<const char*, 5> levelNames = {"debug", "info", "warning", "error", "off"};
+		bool success = true;
+		std::string_view remaining = filter;
+
+		while (!remaining.empty()) {
+			const usize comma = remaining.find(',');
+			const std::string_view entry = trim(remaining.substr(0, comma));
+			remaining = (comma == std::string_view::npos) ? std::string_view() : remaining.substr(comma + 1);
+
+			if (entry.empty()) {
+				continue;
+			}
+
+			const usize colon = entry.find(':');
+			if (colon == std::string_view::npos) {
+				success = false;
+				continue;
+			}
+
+			const std::string_view name = trim(entry.substr(0, colon));
+			const std::string_view levelName = trim(entry.substr(colon + 1));
+
+			auto levelIt = std::find_if(levelNames.begin(), levelNames.end(), [&](const char* x) { return equalsIgnoreCase(x, levelName); });
+			if (levelIt == levelNames.end()) {
+				success = false;
+				continue;
+			}
+
+			const Level level = static_cast<Level>(levelIt - levelNames.begin());
+			if (name == "*") {
+				for (auto& categoryLevel : categoryLevels) {
+					categoryLevel.store(level, std::memory_order_relaxed);
+				}
+				continue;
+			}
+
+			auto categoryIt = std::find_if(categoryNames.begin(), categoryNames.end(), [&](const char* x) { return equalsIgnoreCase(x, name); });
+			if (categoryIt == categoryNames.end()) {
+				success = false;
+				continue;
+			}
+
+			setLevel(static_cast<Category>(categoryIt - categoryNames.begin()), level);
+		}
+
+		return success;
+	}
+
+	Record* beginRecord() {
+		ThreadBuffer& buffer = getLocalBuffer();
+		const u64 writeIndex = buffer.writeIndex.load(std::memory_order_relaxed);
+
+		if (writeIndex - buffer.readIndex.load(std::memory_order_acquire) >= ThreadBuffer::capacity) [[unlikely]] {
+			droppedRecords.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Record* record = &buffer.records[writeIndex % ThreadBuffer::capacity];
+		record->timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+		return record;
+	}
+
+	void commitRecord(Record* record) {
+		ThreadBuffer& buffer = getLocalBuffer();
+		buffer.writeIndex.store(buffer.writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+		if (!workerRunning.load(std::memory_order_acquire)) {
+			drain();
+		}
+	}
+
+	std::string formatRecord(const Record& record) { return formatMessage(record.format, PayloadReader{record.payload.data(), record.payloadSize}); }
+
+	void logOversized(Category category, Level level, const char* format, const u8* payload, usize payloadSize) {
+		const std::string message = formatMessage(format, PayloadReader{payload, payloadSize});
+
+		// Print the records that were logged before this message first, so that messages stay in order
+		std::unique_lock consumerLock(consumerMutex);
+		drainLocked();
+		output(message);
+		std::fflush(stdout);
+	}
+
+	void startWorker() {
+		std::unique_lock lock(workerMutex);
+		if (workerThread.joinable()) {
+			return;
+		}
+
+		static bool registeredExitHandler = false;
+		if (!registeredExitHandler) {
+			// Make sure pending records are printed even if we exit through Helpers::panic
+			std::atexit(stopWorker);
+			registeredExitHandler = true;
+		}
+
+		stopRequested = false;
+		workerThread = std::thread(workerLoop);
+		workerRunning.store(true, std::memory_order_release);
+	}
+
+	void stopWorker() {
+		{
+			std::unique_lock lock(workerMutex);
+			if (!workerThread.joinable()) {
+				return;
+			}
+
+			stopRequested = true;
+			workerRunning.store(false, std::memory_order_release);
+		}
+
+		workerCondition.notify_all();
+		workerThread.join();
+		drain();
+	}
+
+	void flush() { drain(); }
+	u64 getDroppedRecords() { return droppedRecords.load(std::memory_order_relaxed); }
+}  // namespace Log
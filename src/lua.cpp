@@ -279,6 +279,53 @@ static int clearServiceInterceptsThunk(lua_State* L) {
 	return 0;
 }
 
+// Returns a table with an entry for every IPC command that was called, sorted by total time. Each entry contains the service name,
+// the command header, the number of calls, the total and max time in microseconds, and the latency histogram
+static int getIPCStatsThunk(lua_State* L) {
+	const auto entries = LuaManager::g_emulator->getServiceManager().getIPCStats().snapshot();
+	lua_createtable(L, int(entries.size()), 0);
+
+	int index = 1;
+	for (const auto& entry : entries) {
+		lua_createtable(L, 0, 6);
+
+		lua_pushstring(L, KernelHandles::getServiceName(entry.handle));
+		lua_setfield(L, -2, "service");
+		lua_pushinteger(L, static_cast<lua_Integer>(entry.header));
+		lua_setfield(L, -2, "header");
+		lua_pushnumber(L, static_cast<lua_Number>(entry.stats.calls));
+		lua_setfield(L, -2, "calls");
+		lua_pushnumber(L, static_cast<lua_Number>(entry.stats.totalNanoseconds) / 1000.0);
+		lua_setfield(L, -2, "totalMicroseconds");
+		lua_pushnumber(L, static_cast<lua_Number>(entry.stats.maxNanoseconds) / 1000.0);
+		lua_setfield(L, -2, "maxMicroseconds");
+
+		lua_createtable(L, int(IPCStats::bucketCount), 0);
+		for (usize i = 0; i < IPCStats::bucketCount; i++) {
+			lua_pushnumber(L, static_cast<lua_Number>(entry.stats.histogram[i]));
+			lua_rawseti(L, -2, int(i + 1));
+		}
+		lua_setfield(L, -2, "histogram");
+
+		lua_rawseti(L, -2, index++);
+	}
+
+	return 1;
+}
+
+static int resetIPCStatsThunk(lua_State* L) {
+	LuaManager::g_emulator->getServiceManager().getIPCStats().reset();
+	return 0;
+}
+
+static int setLogFilterThunk(lua_State* L) {
+	usize length;
+	const char* const str = luaL_checklstring(L, 1, &length);
+
+	lua_pushboolean(L, Log::applyFilter(std::string(str, length)));
+	return 1;
+}
+
 static int getButtonsThunk(lua_State* L) {
 	auto buttons = LuaManager::g_emulator->getServiceManager().getHID().getOldButtons();
 	lua_pushinteger(L, static_cast<lua_Integer>(buttons));
@@ -365,6 +412,9 @@ static constexpr luaL_Reg functions[] = {
 	{ "__getButton", getButtonThunk },
 	{ "__disassembleARM", disassembleARMThunk },
 	{ "__disassembleTeak", disassembleTeakThunk },
+	{ "__getIPCStats", getIPCStatsThunk },
+	{ "__resetIPCStats", resetIPCStatsThunk },
+	{ "__setLogFilter", setLogFilterThunk },
 	{"__addServiceIntercept", addServiceInterceptThunk },
 	{"__clearServiceIntercepts", clearServiceInterceptsThunk },
 	{ nullptr, nullptr },
@@ -409,6 +459,9 @@ void LuaManager::initializeThunks() {
 		disassembleTeak = function(opcode, exp) return GLOBALS.__disassembleTeak(opcode, exp or 0) end,
 		addServiceIntercept = function(service, func, cb) return GLOBALS.__addServiceIntercept(service, func, cb) end,
 		clearServiceIntercepts = function() return GLOBALS.__clearServiceIntercepts() end,
+		getIPCStats = function() return GLOBALS.__getIPCStats() end,
+		resetIPCStats = function() GLOBALS.__resetIPCStats() end,
+		setLogFilter = function(filter) return GLOBALS.__setLogFilter(filter) end,
 
 		Frame = __Frame,
 		ButtonA = __ButtonA,
@@ -176,6 +176,56 @@ ConfigWindow::ConfigWindow(ConfigCallback configCallback, MainWindowCallback win
 	connectCheckbox(fastmemEnabled, config.fastmemEnabled);
 	genLayout->addRow(fastmemEnabled);
 
+	QCheckBox* secondCoreEnabled = new QCheckBox(tr("Emulate second CPU core (experimental, requires restart)"));
+	connectCheckbox(secondCoreEnabled, config.secondCoreEnabled);
+	genLayout->addRow(secondCoreEnabled);
+
+	QSpinBox* cpuClockPercent = new QSpinBox;
+	cpuClockPercent->setRange(EmulatorConfig::minCPUClockPercent, EmulatorConfig::maxCPUClockPercent);
+	cpuClockPercent->setSingleStep(25);
+	cpuClockPercent->setSuffix("%");
+	cpuClockPercent->setValue(config.cpuClockPercent);
+	connect(cpuClockPercent, &QSpinBox::valueChanged, this, [&](int value) {
+		config.cpuClockPercent = static_cast<u32>(value);
+		updateConfig();
+	});
+	genLayout->addRow(tr("CPU clock"), cpuClockPercent);
+
+	QCheckBox* autoNew3DSClock = new QCheckBox(tr("Use New 3DS clock for enhanced titles"));
+	connectCheckbox(autoNew3DSClock, config.autoNew3DSClock);
+	genLayout->addRow(autoNew3DSClock);
+
+	// Speeds go from the minimum speed to the maximum one, with the value below the minimum standing for unlimited speed
+	auto addSpeedBox = [&](const QString& label, u32& setting) {
+		QSpinBox* speed = new QSpinBox;
+		speed->setRange(EmulatorConfig::minSpeed - 1, EmulatorConfig::maxSpeed);
+		speed->setSpecialValueText(tr("Unlimited"));
+		speed->setSuffix("%");
+		speed->setValue(setting == 0 ? EmulatorConfig::minSpeed - 1 : setting);
+		connect(speed, &QSpinBox::valueChanged, this, [&](int value) {
+			setting = (value < int(EmulatorConfig::minSpeed)) ? 0 : static_cast<u32>(value);
+			updateConfig();
+		});
+		genLayout->addRow(label, speed);
+	};
+
+	addSpeedBox(tr("Target speed"), config.targetSpeed);
+	addSpeedBox(tr("Fast-forward speed (F6)"), config.fastForwardSpeed);
+	addSpeedBox(tr("Turbo speed (hold Tab)"), config.turboSpeed);
+
+	QSpinBox* maxFrameSkip = new QSpinBox;
+	maxFrameSkip->setRange(0, 10);
+	maxFrameSkip->setValue(config.maxFrameSkip);
+	connect(maxFrameSkip, &QSpinBox::valueChanged, this, [&](int value) {
+		config.maxFrameSkip = static_cast<u32>(value);
+		updateConfig();
+	});
+	genLayout->addRow(tr("Max frames to skip when running slow"), maxFrameSkip);
+
+	QCheckBox* skipRenderingSkippedFrames = new QCheckBox(tr("Don't render skipped frames"));
+	connectCheckbox(skipRenderingSkippedFrames, config.skipRenderingSkippedFrames);
+	genLayout->addRow(skipRenderingSkippedFrames);
+
 	QCheckBox* discordRpcEnabled = new QCheckBox(tr("Enable Discord RPC"));
 	connectCheckbox(discordRpcEnabled, config.discordRpcEnabled);
 	genLayout->addRow(discordRpcEnabled);
@@ -320,6 +370,10 @@ ConfigWindow::ConfigWindow(ConfigCallback configCallback, MainWindowCallback win
 	connectCheckbox(muteAudio, config.audioDeviceConfig.muteAudio);
 	audioLayout->addRow(muteAudio);
 
+	QCheckBox* timeStretching = new QCheckBox(tr("Time-stretch audio to match emulation speed"));
+	connectCheckbox(timeStretching, config.audioDeviceConfig.timeStretching);
+	audioLayout->addRow(timeStretching);
+
 	QComboBox* volumeCurveType = new QComboBox();
 	volumeCurveType->addItem(tr("Cubic"));
 	volumeCurveType->addItem(tr("Linear"));
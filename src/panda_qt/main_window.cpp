@@ -71,12 +71,14 @@ MainWindow::MainWindow(QApplication* app, QWidget* parent) : QMainWindow(parent)
 	auto pauseAction = emulationMenu->addAction(tr("Pause"));
 	auto resumeAction = emulationMenu->addAction(tr("Resume"));
 	auto resetAction = emulationMenu->addAction(tr("Reset"));
+	auto fastForwardAction = emulationMenu->addAction(tr("Toggle fast-forward"));
 	auto configureAction = emulationMenu->addAction(tr("Configure"));
 	configureAction->setMenuRole(QAction::PreferencesRole);
 
 	connect(pauseAction, &QAction::triggered, this, [this]() { sendMessage(EmulatorMessage{.type = MessageType::Pause}); });
 	connect(resumeAction, &QAction::triggered, this, [this]() { sendMessage(EmulatorMessage{.type = MessageType::Resume}); });
 	connect(resetAction, &QAction::triggered, this, [this]() { sendMessage(EmulatorMessage{.type = MessageType::Reset}); });
+	connect(fastForwardAction, &QAction::triggered, this, [this]() { sendMessage(EmulatorMessage{.type = MessageType::ToggleFastForward}); });
 	connect(configureAction, &QAction::triggered, this, [this]() { configWindow->show(); });
 
 	auto dumpRomFSAction = toolsMenu->addAction(tr("Dump RomFS"));
@@ -119,6 +121,11 @@ MainWindow::MainWindow(QApplication* app, QWidget* parent) : QMainWindow(parent)
 	cpuDebugger = new CPUDebugger(emu, this);
 	dspDebugger = new DSPDebugger(emu, this);
 
+	// Show the frame statistics in the title bar, updated once a second
+	statsTimer = new QTimer(this);
+	connect(statsTimer, &QTimer::timeout, this, &MainWindow::updateWindowTitle);
+	statsTimer->start(1000);
+
 	shaderEditor->setEnable(emu->getRenderer()->supportsShaderReload());
 	if (shaderEditor->supported) {
 		shaderEditor->setText(emu->getRenderer()->getUbershader());
@@ -197,6 +204,8 @@ MainWindow::MainWindow(QApplication* app, QWidget* parent) : QMainWindow(parent)
 
 		// We have to initialize controllers on the same thread they'll be polled in
 		initControllers();
+		// Pace emulation in the core rather than relying on vsync, so that target speeds, fast-forward and frame skipping work
+		emu->getFramePacer().setEnabled(true);
 		emuThreadMainLoop();
 	});
 }
@@ -223,7 +232,9 @@ void MainWindow::emuThreadMainLoop() {
 			emu->getServiceManager().getHID().updateInputs(emu->getTicks());
 		}
 
-		swapEmuBuffer();
+		if (emu->shouldPresentFrame()) {
+			swapEmuBuffer();
+		}
 	}
 
 	// Unbind GL context if we're using GL, otherwise some setups seem to be unable to join this thread
@@ -517,6 +528,9 @@ void MainWindow::dispatchMessage(const EmulatorMessage& message) {
 			break;
 		}
 
+		case MessageType::ToggleFastForward: emu->getFramePacer().toggleFastForward(); break;
+		case MessageType::SetTurbo: emu->getFramePacer().setTurbo(message.turbo.enabled); break;
+
 		case MessageType::UpdateConfig: {
 			auto& emuConfig = emu->getConfig();
 			auto& newConfig = configWindow->getConfig();
@@ -538,6 +552,22 @@ void MainWindow::dispatchMessage(const EmulatorMessage& message) {
 	}
 }
 
+void MainWindow::updateWindowTitle() {
+	// The statistics can be read from any thread. If no frames were emulated since the last update, the emulator is paused or idle
+	const FramePacer::Stats stats = emu->getFramePacer().getStats();
+	if (stats.framesEmulated == lastFramesEmulated) {
+		setWindowTitle(tr("Alber"));
+		return;
+	}
+
+	lastFramesEmulated = stats.framesEmulated;
+	setWindowTitle(QString("%1 | %2 FPS | %3% | %4 ms")
+					   .arg(tr("Alber"))
+					   .arg(stats.fps, 0, 'f', 1)
+					   .arg(stats.speed, 0, 'f', 0)
+					   .arg(stats.averageFrameTime, 0, 'f', 2));
+}
+
 void MainWindow::keyPressEvent(QKeyEvent* event) {
 	auto pressKey = [this](u32 key) {
 		EmulatorMessage message{.type = MessageType::PressKey};
@@ -566,6 +596,19 @@ void MainWindow::keyPressEvent(QKeyEvent* event) {
 			case Qt::Key_F4: sendMessage(EmulatorMessage{.type = MessageType::TogglePause}); break;
 			case Qt::Key_F5: sendMessage(EmulatorMessage{.type = MessageType::Reset}); break;
 		}
+
+		// Hold Tab for turbo, and use F6 to toggle fast-forward
+		if (!event->isAutoRepeat()) {
+			switch (event->key()) {
+				case Qt::Key_F6: sendMessage(EmulatorMessage{.type = MessageType::ToggleFastForward}); break;
+				case Qt::Key_Tab: {
+					EmulatorMessage message{.type = MessageType::SetTurbo};
+					message.turbo.enabled = true;
+					sendMessage(message);
+					break;
+				}
+			}
+		}
 	}
 }
 
@@ -592,6 +635,10 @@ void MainWindow::keyReleaseEvent(QKeyEvent* event) {
 
 			default: releaseKey(key); break;
 		}
+	} else if (event->key() == Qt::Key_Tab && !event->isAutoRepeat()) {
+		EmulatorMessage message{.type = MessageType::SetTurbo};
+		message.turbo.enabled = false;
+		sendMessage(message);
 	}
 }
 
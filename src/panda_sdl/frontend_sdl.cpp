@@ -1,7 +1,9 @@
 #include "panda_sdl/frontend_sdl.hpp"
 
+#include <fmt/format.h>
 #include <glad/gl.h>
 
+#include "profiler.hpp"
 #include "renderdoc.hpp"
 #include "sdl_sensors.hpp"
 #include "version.hpp"
@@ -35,7 +37,7 @@ FrontendSDL::FrontendSDL() : keyboardMappings(InputMappings::defaultKeyboardMapp
 	needOpenGL = needOpenGL || (config.rendererType == RendererType::OpenGL);
 #endif
 
-	const char* windowTitle = config.windowSettings.showAppVersion ? ("Alber v" PANDA3DS_VERSION) : "Alber";
+	windowTitle = config.windowSettings.showAppVersion ? ("Alber v" PANDA3DS_VERSION) : "Alber";
 	if (config.printAppVersion) {
 		printf("Welcome to Panda3DS v%s!\n", PANDA3DS_VERSION);
 	}
@@ -68,7 +70,7 @@ FrontendSDL::FrontendSDL() : keyboardMappings(InputMappings::defaultKeyboardMapp
 		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, config.rendererType == RendererType::OpenGL ? 4 : 3);
 		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, config.rendererType == RendererType::OpenGL ? 1 : 3);
-		window = SDL_CreateWindow(windowTitle, windowX, windowY, windowWidth, windowHeight, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+		window = SDL_CreateWindow(windowTitle.c_str(), windowX, windowY, windowWidth, windowHeight, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
 
 		if (window == nullptr) {
 			Helpers::panic("Window creation failed: %s", SDL_GetError());
@@ -104,7 +106,7 @@ FrontendSDL::FrontendSDL() : keyboardMappings(InputMappings::defaultKeyboardMapp
 
 #ifdef PANDA3DS_ENABLE_VULKAN
 	if (config.rendererType == RendererType::Vulkan) {
-		window = SDL_CreateWindow(windowTitle, windowX, windowY, windowWidth, windowHeight, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
+		window = SDL_CreateWindow(windowTitle.c_str(), windowX, windowY, windowWidth, windowHeight, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
 
 		if (window == nullptr) {
 			Helpers::warn("Window creation failed: %s", SDL_GetError());
@@ -114,7 +116,7 @@ FrontendSDL::FrontendSDL() : keyboardMappings(InputMappings::defaultKeyboardMapp
 
 #ifdef PANDA3DS_ENABLE_METAL
 	if (config.rendererType == RendererType::Metal) {
-		window = SDL_CreateWindow(windowTitle, windowX, windowY, windowWidth, windowHeight, SDL_WINDOW_METAL | SDL_WINDOW_RESIZABLE);
+		window = SDL_CreateWindow(windowTitle.c_str(), windowX, windowY, windowWidth, windowHeight, SDL_WINDOW_METAL | SDL_WINDOW_RESIZABLE);
 
 		if (window == nullptr) {
 			Helpers::warn("Window creation failed: %s", SDL_GetError());
@@ -123,6 +125,8 @@ FrontendSDL::FrontendSDL() : keyboardMappings(InputMappings::defaultKeyboardMapp
 #endif
 
 	emu.initGraphicsContext(window);
+	// Pace emulation in the core rather than relying on vsync, so that target speeds, fast-forward and frame skipping work
+	emu.getFramePacer().setEnabled(true);
 }
 
 bool FrontendSDL::loadROM(const std::filesystem::path& path) { return emu.loadROM(path); }
@@ -139,6 +143,7 @@ void FrontendSDL::run() {
 #endif
 
 		emu.runFrame();
+		updateWindowTitle();
 		HIDService& hid = emu.getServiceManager().getHID();
 
 		SDL_Event event;
@@ -196,6 +201,20 @@ void FrontendSDL::run() {
 								break;
 							}
 
+							// Use F9 to dump the profiler's trace in profiling builds
+							case SDLK_F9: {
+								if constexpr (Profiler::isSupported()) {
+									const std::filesystem::path tracePath = emu.getAppDataRoot() / "trace.json";
+									if (Profiler::exportChromeTrace(tracePath)) {
+										Helpers::warn("Wrote profiler trace to %s", tracePath.string().c_str());
+									} else {
+										Helpers::warn("Failed to write profiler trace to %s", tracePath.string().c_str());
+									}
+								}
+
+								break;
+							}
+
 							case SDLK_F11: {
 								if constexpr (Renderdoc::isSupported()) {
 									Renderdoc::triggerCapture();
@@ -203,6 +222,15 @@ void FrontendSDL::run() {
 
 								break;
 							}
+
+							// Hold Tab for turbo, and use F6 to toggle fast-forward
+							case SDLK_TAB: emu.getFramePacer().setTurbo(true); break;
+							case SDLK_F6: {
+								if (!event.key.repeat) {
+									emu.getFramePacer().toggleFastForward();
+								}
+								break;
+							}
 						}
 					}
 					break;
@@ -227,6 +255,8 @@ void FrontendSDL::run() {
 								break;
 							default: hid.releaseKey(key); break;
 						}
+					} else if (event.key.keysym.sym == SDLK_TAB) {
+						emu.getFramePacer().setTurbo(false);
 					}
 					break;
 				}
@@ -438,10 +468,33 @@ void FrontendSDL::run() {
 		// TODO: Should this be uncommented?
 		// kernel.evalReschedule();
 
-		SDL_GL_SwapWindow(window);
+		if (emu.shouldPresentFrame()) {
+			SDL_GL_SwapWindow(window);
+		}
 	}
 }
 
+void FrontendSDL::updateWindowTitle() {
+	// Show the frame statistics in the title bar, updating them once a second
+	const u32 now = SDL_GetTicks();
+	if (now - lastTitleUpdate < 1000) {
+		return;
+	}
+	lastTitleUpdate = now;
+
+	if (!emu.running) {
+		SDL_SetWindowTitle(window, windowTitle.c_str());
+		return;
+	}
+
+	const FramePacer::Stats stats = emu.getFramePacer().getStats();
+	const std::string title = fmt::format(
+		"{} | {:.1f} FPS | {:.0f}% | {:.2f} ms{}", windowTitle, stats.fps, stats.speed, stats.averageFrameTime,
+		emu.getFramePacer().isFastForwarding() ? " | Fast-forward" : ""
+	);
+	SDL_SetWindowTitle(window, title.c_str());
+}
+
 void FrontendSDL::setupControllerSensors(SDL_GameController* controller) {
 	bool haveGyro = SDL_GameControllerHasSensor(controller, SDL_SENSOR_GYRO) == SDL_TRUE;
 	bool haveAccelerometer = SDL_GameControllerHasSensor(controller, SDL_SENSOR_ACCEL) == SDL_TRUE;
@@ -0,0 +1,200 @@
+#include "profiler.hpp"
+
+namespace Profiler {
+	const char* categoryName(Category category) {
+		switch (category) {
+			case Category::CPU: return "CPU";
+			case Category::Kernel: return "Kernel";
+			case Category::Service: return "Service";
+			case Category::GPU: return "GPU";
+			case Category::Renderer: return "Renderer";
+			case Category::DSP: return "DSP";
+			default: return "Unknown";
+		}
+	}
+}  // namespace Profiler
+
+#ifdef PANDA3DS_ENABLE_PROFILING
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "io_file.hpp"
+
+namespace Profiler {
+	namespace {
+		struct Event {
+			const char* name;
+			u64 start;
+			u64 end;
+			Category category;
+		};
+
+		// A slot of the ring buffer. The exporter reads slots while their owner may be overwriting them, so each slot is guarded by a
+		// sequence number: It's odd while the event is being written and 2 * (index + 1) once event number "index" is complete.
+		// The reader checks it before and after copying the event, and skips the slot if it changed in between
+		struct Slot {
+			std::atomic<u64> sequence = 0;
+			std::atomic<const char*> name = nullptr;
+			std::atomic<u64> start = 0;
+			std::atomic<u64> end = 0;
+			std::atomic<Category> category = Category::CPU;
+		};
+
+		// Each thread that records events gets one of these. Only the owning thread writes to it, so recording doesn't need any locks.
+		// The buffer is a ring, so once it fills up we keep the most recent events
+		struct ThreadBuffer {
+			static constexpr usize capacity = 64 * 1024;
+
+			std::unique_ptr<Slot[]> slots = std::make_unique<Slot[]>(capacity);
+			// Total number of events ever written. The next event goes to slot writeIndex % capacity
+			std::atomic<u64> writeIndex = 0;
+			// Events before this index were thrown away by clear(). Only the owning thread may touch writeIndex, so we can't just reset it
+			std::atomic<u64> clearIndex = 0;
+			u32 threadID;
+
+			std::array<std::atomic<u64>, categoryCount> frameNanoseconds = {};
+			std::array<std::atomic<u32>, categoryCount> frameScopes = {};
+
+			explicit ThreadBuffer(u32 threadID) : threadID(threadID) {}
+		};
+
+		std::atomic<bool> enabled = true;
+		const auto epoch = std::chrono::steady_clock::now();
+
+		// Buffers are never freed, even when their thread exits, so that we can still export their events
+		std::mutex buffersMutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+		FrameStats lastFrameStats;
+
+		thread_local ThreadBuffer* localBuffer = nullptr;
+
+		u64 now() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count(); }
+
+		// Copies event number "index" out of its slot. Fails if the slot has been (or is being) overwritten by a newer event
+		bool readEvent(const Slot& slot, u64 index, Event& event) {
+			const u64 sequence = 2 * index + 2;
+			if (slot.sequence.load(std::memory_order_acquire) != sequence) {
+				return false;
+			}
+
+			event.name = slot.name.load(std::memory_order_relaxed);
+			event.start = slot.start.load(std::memory_order_relaxed);
+			event.end = slot.end.load(std::memory_order_relaxed);
+			event.category = slot.category.load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return slot.sequence.load(std::memory_order_relaxed) == sequence;
+		}
+
+		ThreadBuffer& getLocalBuffer() {
+			if (localBuffer == nullptr) [[unlikely]] {
+				std::unique_lock lock(buffersMutex);
+				localBuffer = buffers.emplace_back(std::make_unique<ThreadBuffer>(u32(buffers.size()))).get();
+			}
+
+			return *localBuffer;
+		}
+	}  // namespace
+
+	void setEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+	bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+	Scope::Scope(const char* name, Category category) : name(name), start(0), category(category) {
+		if (enabled.load(std::memory_order_relaxed)) {
+			start = now();
+		}
+	}
+
+	Scope::~Scope() {
+		// Scopes that started while the profiler was disabled are dropped
+		if (start == 0 || !enabled.load(std::memory_order_relaxed)) {
+			return;
+		}
+
+		const u64 end = now();
+		ThreadBuffer& buffer = getLocalBuffer();
+		const u64 index = buffer.writeIndex.load(std::memory_order_relaxed);
+
+		Slot& slot = buffer.slots[index % ThreadBuffer::capacity];
+
+		slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.name.store(name, std::memory_order_relaxed);
+		slot.start.store(start, std::memory_order_relaxed);
+		slot.end.store(end, std::memory_order_relaxed);
+		slot.category.store(category, std::memory_order_relaxed);
+		slot.sequence.store(2 * index + 2, std::memory_order_release);
+		buffer.writeIndex.store(index + 1, std::memory_order_release);
+
+		const usize categoryIndex = static_cast<usize>(category);
+		buffer.frameNanoseconds[categoryIndex].fetch_add(end - start, std::memory_order_relaxed);
+		buffer.frameScopes[categoryIndex].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void endFrame() {
+		std::unique_lock lock(buffersMutex);
+		lastFrameStats = {};
+
+		for (auto& buffer : buffers) {
+			for (usize i = 0; i < categoryCount; i++) {
+				lastFrameStats[i].nanoseconds += buffer->frameNanoseconds[i].exchange(0, std::memory_order_relaxed);
+				lastFrameStats[i].scopes += buffer->frameScopes[i].exchange(0, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	FrameStats getLastFrameStats() {
+		std::unique_lock lock(buffersMutex);
+		return lastFrameStats;
+	}
+
+	bool exportChromeTrace(const std::filesystem::path& path) {
+		IOFile file(path, "w");
+		if (!file.isOpen()) {
+			return false;
+		}
+
+		FILE* handle = file.getHandle();
+		std::fprintf(handle, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+		bool firstEvent = true;
+		std::unique_lock lock(buffersMutex);
+
+		for (auto& buffer : buffers) {
+			const u64 writeIndex = buffer->writeIndex.load(std::memory_order_acquire);
+			const u64 firstIndex = std::max(writeIndex - std::min<u64>(writeIndex, ThreadBuffer::capacity), buffer->clearIndex.load());
+
+			for (u64 i = firstIndex; i < writeIndex; i++) {
+				// The owning thread keeps recording while we export, so the oldest events may get overwritten under us. Skip those
+				Event event;
+				if (!readEvent(buffer->slots[i % ThreadBuffer::capacity], i, event)) {
+					continue;
+				}
+
+				// Complete events ("X"), with timestamps in microseconds
+				std::fprintf(
+					handle, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}", firstEvent ? "" : ",\n",
+					event.name, categoryName(event.category), double(event.start) / 1000.0, double(event.end - event.start) / 1000.0, buffer->threadID
+				);
+				firstEvent = false;
+			}
+		}
+
+		std::fprintf(handle, "\n]}\n");
+		file.close();
+		return true;
+	}
+
+	void clear() {
+		std::unique_lock lock(buffersMutex);
+		for (auto& buffer : buffers) {
+			buffer->clearIndex.store(buffer->writeIndex.load(std::memory_order_acquire));
+		}
+	}
+}  // namespace Profiler
+#endif
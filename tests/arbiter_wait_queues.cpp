@@ -0,0 +1,139 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <kernel/arbiter_wait_queues.hpp>
+#include <kernel/kernel_types.hpp>
+#include <array>
+#include <vector>
+
+namespace {
+	constexpr int threadCount = 32;
+
+	// Mirrors the thread bookkeeping the kernel does around arbiters, without needing a CPU and memory
+	struct FakeProcess {
+		std::array<Thread, threadCount> threads;
+		std::vector<int> threadIndices;
+		ArbiterWaitQueues queues;
+		std::vector<int> woken;
+
+		FakeProcess() {
+			for (int i = 0; i < threadCount; i++) {
+				threads[i].priority = 0x30;
+				threads[i].status = ThreadStatus::Ready;
+				threads[i].waitingAddress = 0;
+				threadIndices.push_back(i);
+			}
+		}
+
+		void wait(int index, u32 address) {
+			threads[index].status = ThreadStatus::WaitArbiter;
+			threads[index].waitingAddress = address;
+			queues.add(address, index);
+		}
+
+		s32 signal(u32 address, s32 count) {
+			return queues.signal(
+				address, count, [&](int index) { return threads[index].priority; },
+				[&](int index) {
+					threads[index].status = ThreadStatus::Ready;
+					woken.push_back(index);
+				}
+			);
+		}
+
+		// The old implementation, which scanned every thread in priority order
+		s32 signalLinear(u32 address, s32 count) {
+			s32 wokenCount = 0;
+			for (int index : threadIndices) {
+				Thread& t = threads[index];
+				if ((t.status == ThreadStatus::WaitArbiter || t.status == ThreadStatus::WaitArbiterTimeout) && t.waitingAddress == address) {
+					t.status = ThreadStatus::Ready;
+					wokenCount++;
+
+					if (wokenCount == count && count > 0) break;
+				}
+			}
+
+			return wokenCount;
+		}
+	};
+}  // namespace
+
+TEST_CASE("Arbiter signals wake the highest priority waiters", "[kernel][arbiter]") {
+	FakeProcess process;
+	process.threads[3].priority = 0x20;
+	process.threads[5].priority = 0x18;
+	process.threads[7].priority = 0x20;
+
+	for (int index : {1, 3, 5, 7}) {
+		process.wait(index, 0x1000);
+	}
+	process.wait(2, 0x2000);
+
+	REQUIRE(process.signal(0x1000, 2) == 2);
+	REQUIRE(process.woken == std::vector<int>{5, 3});
+	REQUIRE(process.queues.getWaitlist(0x1000) == ((1ull << 1) | (1ull << 7)));
+
+	// Waiters on other addresses are left alone
+	REQUIRE(process.threads[2].status == ThreadStatus::WaitArbiter);
+	REQUIRE(process.signal(0x3000, -1) == 0);
+
+	process.woken.clear();
+	REQUIRE(process.signal(0x1000, -1) == 2);
+	REQUIRE(process.woken == std::vector<int>{1, 7});
+	REQUIRE(process.queues.getWaitlist(0x1000) == 0);
+	REQUIRE(process.queues.addressCount() == 1);
+}
+
+TEST_CASE("Timed out arbiter waiters are removed", "[kernel][arbiter]") {
+	FakeProcess process;
+	process.wait(4, 0x1000);
+	process.wait(6, 0x1000);
+
+	process.queues.remove(0x1000, 4);
+	REQUIRE(process.signal(0x1000, 1) == 1);
+	REQUIRE(process.woken == std::vector<int>{6});
+	REQUIRE(process.queues.addressCount() == 0);
+
+	REQUIRE(process.signal(0x1000, 0) == 0);
+}
+
+TEST_CASE("Arbiter signalling", "[.][benchmark][kernel][arbiter]") {
+	// A futex-heavy workload: a full process where most threads are blocked on their own futex, and the rest ping-pong on a few hot ones,
+	// signalling thousands of times per frame. Many signals find no waiters at all, which is the worst case for the linear scan
+	FakeProcess process;
+	constexpr int signalsPerFrame = 4096;
+	constexpr int hotAddresses = 4;
+
+	auto futexAddress = [](int index) { return u32(0x10000000 + index * 4); };
+	for (int i = hotAddresses; i < threadCount; i++) {
+		process.wait(i, futexAddress(i));
+	}
+
+	BENCHMARK("Address-keyed wait queues") {
+		s32 woken = 0;
+		for (int i = 0; i < signalsPerFrame; i++) {
+			const int index = i % hotAddresses;
+			if (i % 3 != 0) {
+				process.wait(index, futexAddress(index));
+			}
+			woken += process.signal(futexAddress(index), 1);
+		}
+
+		process.woken.clear();
+		return woken;
+	};
+
+	BENCHMARK("Linear scan over all threads") {
+		s32 woken = 0;
+		for (int i = 0; i < signalsPerFrame; i++) {
+			const int index = i % hotAddresses;
+			if (i % 3 != 0) {
+				process.threads[index].status = ThreadStatus::WaitArbiter;
+				process.threads[index].waitingAddress = futexAddress(index);
+			}
+			woken += process.signalLinear(futexAddress(index), 1);
+		}
+
+		return woken;
+	};
+}
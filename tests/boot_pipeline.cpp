@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+#include <loader/boot_pipeline.hpp>
+#include <loader/lz77.hpp>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace {
+	// An LZ77-compressed .code file. 4 bytes stored as-is, then a run of 8 literal bytes followed by 7 back-references that repeat them.
+	// The compression works backwards from the end of the buffer, so the literals come last in the output
+	std::vector<u8> makeCompressedCode() {
+		std::vector<u8> compressed = {'C', 'O', 'D', 'E'};
+
+		// 7 back-references copying 18 bytes each from 8 bytes further into the output
+		for (int i = 0; i < 7; i++) {
+			compressed.push_back(0x05);
+			compressed.push_back(0xF0);
+		}
+		compressed.push_back(0xFE);  // Control byte for the back-references
+
+		for (u8 literal = 0; literal < 8; literal++) {
+			compressed.push_back(literal);
+		}
+		compressed.push_back(0x00);  // Control byte for the literals
+
+		// Footer: Size of the footer in the top byte, size of the compressed data with the footer in the rest, then the size difference
+		const u32 compressedDataSize = u32(compressed.size()) - 4 + 8;
+		const u32 bufferTopAndBottom = (8u << 24) | compressedDataSize;
+		const u32 sizeDiff = 8 + 7 * 18 - compressedDataSize;
+
+		compressed.resize(compressed.size() + 8);
+		std::memcpy(&compressed[compressed.size() - 8], &bufferTopAndBottom, sizeof(u32));
+		std::memcpy(&compressed[compressed.size() - 4], &sizeDiff, sizeof(u32));
+		return compressed;
+	}
+}  // namespace
+
+TEST_CASE("Boot task group runs every job", "[boot_pipeline]") {
+	Loader::TaskGroup tasks;
+	std::array<int, 16> results{};
+	std::atomic<int> jobCount = 0;
+
+	for (int i = 0; i < int(results.size()); i++) {
+		tasks.submit([&, i]() {
+			results[i] = i * 2;
+			jobCount++;
+		});
+	}
+
+	tasks.wait();
+	REQUIRE(jobCount == int(results.size()));
+	for (int i = 0; i < int(results.size()); i++) {
+		REQUIRE(results[i] == i * 2);
+	}
+
+	// The group can be reused once it has been waited on, and waiting with no jobs does nothing
+	tasks.submit([&]() { jobCount++; });
+	tasks.wait();
+	tasks.wait();
+	REQUIRE(jobCount == int(results.size()) + 1);
+}
+
+TEST_CASE("Boot timings pass through the result of a stage", "[boot_pipeline]") {
+	Loader::BootTimings timings;
+	REQUIRE(timings.measure("Stage", []() { return 42; }) == 42);
+
+	bool ran = false;
+	timings.measure("Void stage", [&]() { ran = true; });
+	REQUIRE(ran);
+}
+
+TEST_CASE("LZ77 .code decompresses in place", "[boot_pipeline]") {
+	const std::vector<u8> compressed = makeCompressedCode();
+	const u32 decompressedSize = CartLZ77::decompressedSize(compressed);
+	REQUIRE(decompressedSize == 4 + 8 + 7 * 18);
+
+	std::vector<u8> expected;
+	REQUIRE(CartLZ77::decompress(expected, compressed));
+	REQUIRE(expected.size() == decompressedSize);
+
+	// Stuff the space after the compressed data with garbage, like whatever was in FCRAM before
+	std::vector<u8> buffer(decompressedSize, 0xCC);
+	std::memcpy(buffer.data(), compressed.data(), compressed.size());
+	REQUIRE(CartLZ77::decompressInPlace(buffer.data(), u32(compressed.size()), decompressedSize));
+	REQUIRE(buffer == expected);
+
+	// The uncompressed bytes at the start are untouched, and the rest repeats the literals from the end of the output
+	REQUIRE(std::memcmp(buffer.data(), "CODE", 4) == 0);
+	for (u32 i = 0; i < 8; i++) {
+		REQUIRE(buffer[decompressedSize - 8 + i] == i);
+	}
+
+	for (u32 i = 4; i + 8 < decompressedSize; i++) {
+		REQUIRE(buffer[i] == buffer[i + 8]);
+	}
+}
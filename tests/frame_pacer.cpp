@@ -0,0 +1,126 @@
+#include <catch2/catch_test_macros.hpp>
+#include <frame_pacer.hpp>
+#include <vector>
+
+namespace {
+	using namespace std::chrono_literals;
+	using Clock = FramePacer::Clock;
+	constexpr FramePacer::Duration period = FramePacer::framePeriod;
+}  // namespace
+
+TEST_CASE("Frame pacer paces frames to the target speed", "[frame_pacer]") {
+	FramePacer pacer;
+	pacer.setEnabled(true);
+	const Clock::time_point start = Clock::now();
+
+	// Frames that finish early wait for the next frame period
+	REQUIRE(pacer.beginFrame(start));
+	REQUIRE(pacer.finishFrame(start + 5ms) == start + period);
+	REQUIRE(pacer.beginFrame(start + period));
+	REQUIRE(pacer.finishFrame(start + period + 5ms) == start + period * 2);
+
+	// At 200%, frames are half as long
+	pacer.setTargetSpeed(200);
+	REQUIRE(pacer.beginFrame(start + period * 2));
+	REQUIRE(pacer.finishFrame(start + period * 2 + 1ms) == start + period * 2 + period / 2);
+
+	// After a long stall, the pacer doesn't try to catch up with the lost time
+	pacer.setTargetSpeed(100);
+	const Clock::time_point afterStall = start + 1s;
+	REQUIRE(pacer.beginFrame(afterStall));
+	REQUIRE(pacer.finishFrame(afterStall + 1ms) == afterStall + 1ms);
+
+	const FramePacer::Stats stats = pacer.getStats();
+	REQUIRE(stats.framesEmulated == 4);
+	REQUIRE(stats.framesSkipped == 0);
+}
+
+TEST_CASE("Fast-forwarding only presents a frame per display refresh", "[frame_pacer]") {
+	FramePacer pacer;
+	pacer.setEnabled(true);
+	pacer.setFastForward(true);
+	REQUIRE(pacer.isFastForwarding());
+
+	// Unlimited fast-forward speed, with the host emulating a frame every 4ms. Presenting once every 16.67ms means every 5th frame
+	Clock::time_point now = Clock::now();
+	int presented = 0;
+	for (int i = 0; i < 25; i++) {
+		presented += pacer.beginFrame(now) ? 1 : 0;
+		now += 4ms;
+		REQUIRE(pacer.finishFrame(now) == now);
+	}
+
+	REQUIRE(presented == 5);
+	REQUIRE(pacer.getStats().framesSkipped == 20);
+	REQUIRE(pacer.getStats().speed > 400.0);
+
+	// Turbo has its own speed and takes priority over fast-forward
+	pacer.setTurbo(true);
+	pacer.setTurboSpeed(200);
+	pacer.beginFrame(now);
+	REQUIRE(pacer.finishFrame(now + 1ms) == now + period / 2);
+
+	pacer.setTurbo(false);
+	pacer.setFastForward(false);
+	REQUIRE(!pacer.isFastForwarding());
+}
+
+TEST_CASE("Frame skipping catches up when running behind", "[frame_pacer]") {
+	FramePacer pacer;
+	pacer.setEnabled(true);
+	pacer.setMaxFrameSkip(2);
+
+	// Every frame takes a frame and a half to emulate, so we keep falling behind. At most 2 frames in a row get skipped
+	Clock::time_point now = Clock::now();
+	std::vector<bool> presented;
+	for (int i = 0; i < 6; i++) {
+		presented.push_back(pacer.beginFrame(now));
+		now += period + period / 2;
+		pacer.finishFrame(now);
+	}
+
+	REQUIRE(presented == std::vector<bool>{true, true, false, false, true, false});
+
+	// Without frame skipping, every frame is presented no matter how late it is
+	pacer.setMaxFrameSkip(0);
+	REQUIRE(pacer.beginFrame(now + 10 * period));
+}
+
+TEST_CASE("Unlimited speed with frame skipping presents a frame per display refresh", "[frame_pacer]") {
+	FramePacer pacer;
+	pacer.setEnabled(true);
+	pacer.setTargetSpeed(0);
+	pacer.setMaxFrameSkip(2);
+
+	// Frames that take longer than a display refresh are never late at unlimited speed, so they're all presented
+	Clock::time_point now = Clock::now();
+	for (int i = 0; i < 5; i++) {
+		REQUIRE(pacer.beginFrame(now));
+		now += period * 2;
+		REQUIRE(pacer.finishFrame(now) == now);
+	}
+
+	// Fast frames are throttled to the display refresh rate rather than to one in every MaxFrameSkip + 1 frames
+	int presented = 0;
+	for (int i = 0; i < 25; i++) {
+		presented += pacer.beginFrame(now) ? 1 : 0;
+		now += 4ms;
+		pacer.finishFrame(now);
+	}
+
+	REQUIRE(presented == 5);
+	REQUIRE(pacer.getStats().framesSkipped == 20);
+}
+
+TEST_CASE("Disabled frame pacer presents every frame without waiting", "[frame_pacer]") {
+	FramePacer pacer;
+	pacer.setFastForward(true);
+	pacer.setMaxFrameSkip(4);
+
+	Clock::time_point now = Clock::now();
+	for (int i = 0; i < 10; i++) {
+		REQUIRE(pacer.beginFrame(now));
+		now += 1ms;
+		REQUIRE(pacer.finishFrame(now) == now);
+	}
+}
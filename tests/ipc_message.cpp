@@ -0,0 +1,86 @@
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <ipc.hpp>
+
+namespace {
+	// Command buffer followed by the static receive buffer descriptors, like the TLS of a thread
+	using ThreadBuffers = std::array<u32, IPC::Message::commandBufferWords + 32>;
+}
+
+TEST_CASE("IPC messages read and write parameters by word index", "[ipc]") {
+	ThreadBuffers buffers{};
+	IPC::Message message(buffers.data());
+
+	buffers[0] = 0x00010082;
+	buffers[1] = 0x12345678;
+	buffers[2] = 0xAABBCCDD;
+	buffers[3] = 0x11223344;
+
+	REQUIRE(message.header() == 0x00010082);
+	REQUIRE(message.commandID() == 1);
+	REQUIRE(message.read32(1) == 0x12345678);
+	REQUIRE(message.read8(1) == 0x78);
+	REQUIRE(message.read16(1) == 0x5678);
+	REQUIRE(message.read64(2) == 0x11223344AABBCCDDull);
+
+	message.respond(0x1, 3, 0);
+	message.write32(1, 0);
+	message.write64(2, 0x0123456789ABCDEFull);
+	REQUIRE(buffers[0] == IPC::responseHeader(0x1, 3, 0));
+	REQUIRE(buffers[1] == 0);
+	REQUIRE(buffers[2] == 0x89ABCDEF);
+	REQUIRE(buffers[3] == 0x01234567);
+
+	// Narrow writes leave the rest of the word alone
+	message.write8(1, 0xFF);
+	message.write16(2, 0xBEEF);
+	REQUIRE(buffers[1] == 0xFF);
+	REQUIRE(buffers[2] == 0x89ABBEEF);
+}
+
+TEST_CASE("IPC messages encode and decode translate parameters", "[ipc]") {
+	ThreadBuffers buffers{};
+	IPC::Message message(buffers.data());
+
+	REQUIRE(IPC::copyHandleDescriptor(1) == 0);
+	REQUIRE(IPC::copyHandleDescriptor(2) == 0x04000000);
+	REQUIRE(IPC::moveHandleDescriptor(1) == 0x10);
+	REQUIRE(IPC::callingPidDescriptor() == 0x20);
+	REQUIRE(IPC::staticBufferDescriptor(0x100, 0) == IPC::pointerHeader(0, 0x100, IPC::BufferType::Send));
+
+	message.writeStaticBuffer(4, 2, 0x40, 0x08001000);
+	const auto staticBuffer = message.readStaticBuffer(4);
+	REQUIRE(buffers[4] == 0x00100802);
+	REQUIRE(staticBuffer.id == 2);
+	REQUIRE(staticBuffer.size == 0x40);
+	REQUIRE(staticBuffer.address == 0x08001000);
+
+	message.writeMappedBuffer(6, 1, 0x1000, 0x14000000);
+	const auto mappedBuffer = message.readMappedBuffer(6);
+	REQUIRE(buffers[6] == 0x0001000A);
+	REQUIRE(mappedBuffer.permissions == 1);
+	REQUIRE(mappedBuffer.size == 0x1000);
+	REQUIRE(mappedBuffer.address == 0x14000000);
+
+	buffers[8] = IPC::pxiBufferDescriptor(0x200, 3, true);
+	buffers[9] = 0x1FF00000;
+	const auto pxiBuffer = message.readPXIBuffer(8);
+	REQUIRE(pxiBuffer.id == 3);
+	REQUIRE(pxiBuffer.size == 0x200);
+	REQUIRE(pxiBuffer.readOnly);
+	REQUIRE(pxiBuffer.address == 0x1FF00000);
+}
+
+TEST_CASE("IPC messages find the static buffers a thread receives into", "[ipc]") {
+	ThreadBuffers buffers{};
+	IPC::Message message(buffers.data());
+
+	// Receive buffer descriptors are pairs of words right after the command buffer, indexed by buffer ID
+	buffers[IPC::Message::receiveBufferWords + 2] = IPC::staticBufferDescriptor(0x80, 1);
+	buffers[IPC::Message::receiveBufferWords + 3] = 0x0FFFC000;
+
+	const auto receiveBuffer = message.getReceiveBuffer(1);
+	REQUIRE(receiveBuffer.id == 1);
+	REQUIRE(receiveBuffer.size == 0x80);
+	REQUIRE(receiveBuffer.address == 0x0FFFC000);
+}
@@ -0,0 +1,89 @@
+#include <catch2/catch_test_macros.hpp>
+#include <kernel/kernel_object_table.hpp>
+#include <kernel/kernel_types.hpp>
+#include <kernel/slab_pool.hpp>
+
+TEST_CASE("Closed handles are recycled with a new generation", "[kernel][handles]") {
+	KernelObjectTable objects;
+	const HorizonHandle dummy = objects.allocate(KernelObjectType::Dummy);
+	const HorizonHandle first = objects.allocate(KernelObjectType::Event);
+	const HorizonHandle second = objects.allocate(KernelObjectType::Event);
+
+	// Handles are plain indices until a slot gets reused
+	REQUIRE(dummy == 0);
+	REQUIRE(first == 1);
+	REQUIRE(second == 2);
+
+	objects.free(first);
+	REQUIRE(objects.get(first) == nullptr);
+	REQUIRE(objects.isStale(first));
+	REQUIRE(objects.get(second) != nullptr);
+
+	const HorizonHandle recycled = objects.allocate(KernelObjectType::Mutex);
+	REQUIRE(KernelObjectTable::getIndex(recycled) == KernelObjectTable::getIndex(first));
+	REQUIRE(recycled != first);
+	REQUIRE(objects.get(first) == nullptr);
+	REQUIRE(objects.get(recycled)->type == KernelObjectType::Mutex);
+	REQUIRE(objects.getSlotCount() == 3);
+
+	// Service handles and handles that were never allocated are invalid, but not stale
+	REQUIRE(objects.get(0xFFFF8001) == nullptr);
+	REQUIRE(!objects.isStale(0xFFFF8001));
+	REQUIRE(objects.get(3) == nullptr);
+	REQUIRE(!objects.isStale(3));
+
+	const auto& eventStats = objects.getStats(KernelObjectType::Event);
+	REQUIRE(eventStats.live == 1);
+	REQUIRE(eventStats.peak == 2);
+	REQUIRE(eventStats.created == 2);
+	REQUIRE(eventStats.destroyed == 1);
+}
+
+TEST_CASE("Objects a service holds outlive the guest closing its handle", "[kernel][handles]") {
+	KernelObjectTable objects;
+	objects.allocate(KernelObjectType::Dummy);
+	const HorizonHandle event = objects.allocate(KernelObjectType::Event);
+	REQUIRE(objects.getRefCount(event) == 1);
+
+	// A service stores the interrupt event it was given, then the guest closes its own handle
+	objects.retain(event);
+	REQUIRE(!objects.release(event));
+	REQUIRE(objects.get(event) != nullptr);
+	REQUIRE(objects.getRefCount(event) == 1);
+
+	// Once the service drops the event as well, the object can be destroyed
+	REQUIRE(objects.release(event));
+	objects.free(event);
+	REQUIRE(objects.get(event) == nullptr);
+	REQUIRE(objects.isStale(event));
+
+	// Stale handles can't be retained or released, and a recycled slot starts over with a single reference
+	objects.retain(event);
+	REQUIRE(!objects.release(event));
+	const HorizonHandle recycled = objects.allocate(KernelObjectType::Event);
+	REQUIRE(KernelObjectTable::getIndex(recycled) == KernelObjectTable::getIndex(event));
+	REQUIRE(objects.getRefCount(recycled) == 1);
+	REQUIRE(objects.getRefCount(event) == 0);
+}
+
+TEST_CASE("Slab pools reuse freed objects", "[kernel][handles]") {
+	SlabPool<Event, 4> pool;
+	Event* events[4];
+	for (auto& event : events) {
+		event = pool.allocate(ResetType::OneShot);
+	}
+
+	REQUIRE(pool.getCapacity() == 4);
+	REQUIRE(pool.getLiveObjects() == 4);
+
+	pool.free(events[2]);
+	Event* event = pool.allocate(ResetType::Sticky);
+	REQUIRE(event == events[2]);
+	REQUIRE(event->resetType == ResetType::Sticky);
+	REQUIRE(event->waitlist == 0);
+	REQUIRE(pool.getCapacity() == 4);
+
+	pool.allocate(ResetType::OneShot);
+	REQUIRE(pool.getCapacity() == 8);
+	REQUIRE(pool.getLiveObjects() == 5);
+}
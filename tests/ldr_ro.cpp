@@ -0,0 +1,190 @@
+#include <catch2/catch_test_macros.hpp>
+#include <config.hpp>
+#include <cstring>
+#include <kernel/fcram.hpp>
+#include <memory.hpp>
+#include <services/ldr_ro.hpp>
+#include <string>
+#include <vector>
+
+using namespace KernelMemoryTypes;
+
+namespace {
+	// Addresses the CRS and CRO are mapped to, one page each
+	constexpr u32 crsAddr = 0x08000000;
+	constexpr u32 croAddr = 0x08001000;
+	constexpr u32 imageSize = 0x1000;
+
+	// CRO header fields used by the test images
+	namespace Header {
+		enum : u32 {
+			ID = 0x080,
+			PrevCRO = 0x08C,
+			FileSize = 0x090,
+			FixedSize = 0x098,
+			OnUnresolved = 0x0AC,
+			ModuleNameOffset = 0x0C0,
+			SegmentTableOffset = 0x0C8,
+			NamedExportTableOffset = 0x0D0,
+			ExportStringTableOffset = 0x0E0,
+			ImportPatchTableOffset = 0x0F8,
+			NamedImportTableOffset = 0x100,
+			ImportStringTableOffset = 0x118,
+			RelocationPatchTableOffset = 0x128,
+		};
+	}
+
+	// Builds a CRS or CRO image. All offsets are relative to the start of the image, like in the file
+	class ImageBuilder {
+		std::vector<u8> data = std::vector<u8>(imageSize, 0);
+
+	  public:
+		ImageBuilder(const std::string& name) {
+			putString(Header::ID, "CRO0");
+			put32(Header::FileSize, imageSize);
+			put32(Header::FixedSize, imageSize);
+
+			putString(0x140, name);
+			setTable(Header::ModuleNameOffset, 0x140, u32(name.size()) + 1);
+		}
+
+		void put32(u32 offset, u32 value) { std::memcpy(&data[offset], &value, sizeof(u32)); }
+		void putString(u32 offset, const std::string& string) { std::memcpy(&data[offset], string.c_str(), string.size() + 1); }
+
+		void setTable(u32 headerOffset, u32 offset, u32 size) {
+			put32(headerOffset, offset);
+			put32(headerOffset + 4, size);
+		}
+
+		void putRelocation(u32 offset, u32 segmentTag, u8 segmentIndexOrLast, u32 addend) {
+			const LDR::Relocation relocation = {
+				.segmentTag = segmentTag, .patchType = 2, .segmentIndex = segmentIndexOrLast, .isResolved = 0, .padding = 0, .addend = addend
+			};
+			std::memcpy(&data[offset], &relocation, sizeof(relocation));
+		}
+
+		const std::vector<u8>& get() const { return data; }
+	};
+
+	constexpr u32 segmentTag(u32 segment, u32 offset) { return (offset << 4) | segment; }
+
+	// The static module exports "exportedFunc" from its .text and imports "croFunc" from the CRO.
+	// The segments of the CRS hold absolute addresses, as they point into the already loaded executable
+	std::vector<u8> makeCRS() {
+		ImageBuilder crs("static");
+		crs.put32(0x150, crsAddr + 0x200);  // .text
+		crs.put32(0x154, 0x100);
+		crs.put32(0x158, 0);
+		crs.setTable(Header::SegmentTableOffset, 0x150, 1);
+
+		crs.put32(0x160, 0x180);
+		crs.put32(0x164, segmentTag(0, 0x10));
+		crs.setTable(Header::NamedExportTableOffset, 0x160, 1);
+		crs.putString(0x180, "exportedFunc");
+		crs.setTable(Header::ExportStringTableOffset, 0x180, 0x10);
+
+		crs.put32(0x190, 0x1A0);
+		crs.put32(0x194, 0x1C0);
+		crs.setTable(Header::NamedImportTableOffset, 0x190, 1);
+		crs.putString(0x1A0, "croFunc");
+		crs.setTable(Header::ImportStringTableOffset, 0x1A0, 0x10);
+		crs.putRelocation(0x1C0, segmentTag(0, 0x40), 1, 0);
+		crs.setTable(Header::ImportPatchTableOffset, 0x1C0, 1);
+		return crs.get();
+	}
+
+	// The CRO exports "croFunc" and imports "exportedFunc" into .data, with one internal relocation in .data pointing to its .text
+	std::vector<u8> makeCRO() {
+		ImageBuilder cro("cro");
+		cro.put32(Header::OnUnresolved, segmentTag(0, 0));
+
+		cro.put32(0x150, 0x400);  // .text
+		cro.put32(0x154, 0x100);
+		cro.put32(0x158, 0);
+		cro.put32(0x15C, 0x500);  // .data
+		cro.put32(0x160, 0x100);
+		cro.put32(0x164, 2);
+		cro.setTable(Header::SegmentTableOffset, 0x150, 2);
+
+		cro.put32(0x170, 0x180);
+		cro.put32(0x174, segmentTag(0, 0x10));
+		cro.setTable(Header::NamedExportTableOffset, 0x170, 1);
+		cro.putString(0x180, "croFunc");
+		cro.setTable(Header::ExportStringTableOffset, 0x180, 8);
+
+		cro.put32(0x190, 0x1A0);
+		cro.put32(0x194, 0x1C0);
+		cro.setTable(Header::NamedImportTableOffset, 0x190, 1);
+		cro.putString(0x1A0, "exportedFunc");
+		cro.setTable(Header::ImportStringTableOffset, 0x1A0, 0x10);
+		cro.putRelocation(0x1C0, segmentTag(1, 0x20), 1, 4);
+		cro.setTable(Header::ImportPatchTableOffset, 0x1C0, 1);
+
+		cro.putRelocation(0x1D0, segmentTag(1, 0x30), 0, 8);
+		cro.setTable(Header::RelocationPatchTableOffset, 0x1D0, 1);
+		return cro.get();
+	}
+
+	struct LinkerFixture {
+		EmulatorConfig config;
+		KFcram fcram;
+		Memory memory;
+		LDR::Linker linker;
+
+		LinkerFixture() : config(""), fcram(memory), memory(fcram, config), linker(memory) {
+			memory.reset();
+			REQUIRE(memory.allocMemory(crsAddr, 2, FcramRegion::App, true, true, true, MemoryState::Private));
+
+			write(crsAddr, makeCRS());
+			write(croAddr, makeCRO());
+		}
+
+		void write(u32 addr, const std::vector<u8>& image) { std::memcpy(memory.getWritePointer(addr), image.data(), image.size()); }
+		std::vector<u8> read(u32 addr) {
+			const u8* pointer = (const u8*)memory.getReadPointer(addr);
+			return std::vector<u8>(pointer, pointer + imageSize);
+		}
+	};
+}  // namespace
+
+TEST_CASE("LDR links the imports of a CRO and restores its tables on unload", "[ldr]") {
+	LinkerFixture fixture;
+	Memory& mem = fixture.memory;
+	LDR::Linker& linker = fixture.linker;
+	const std::vector<u8> original = fixture.read(croAddr);
+
+	linker.loadCRS(crsAddr);
+	REQUIRE(linker.getLoadedCRS() == crsAddr);
+
+	for (int i = 0; i < 2; i++) {
+		const LDR::Module& module = linker.loadCRO(croAddr, croAddr + 0x500, 0, false, 0, false);
+		REQUIRE(module.name == "cro");
+		REQUIRE(module.getSegmentAddr(segmentTag(1, 0x20)) == croAddr + 0x520);
+		REQUIRE(linker.getModule(croAddr) == &module);
+
+		// The import of the CRO points to the symbol exported by the CRS plus the addend, and its batch is marked as resolved
+		REQUIRE(mem.read32(croAddr + 0x520) == crsAddr + 0x210 + 4);
+		REQUIRE(mem.read8(croAddr + 0x1C0 + 6) == 1);
+		// The internal relocation points to .text
+		REQUIRE(mem.read32(croAddr + 0x530) == croAddr + 0x400 + 8);
+		// The CRO exported its symbol to the CRS
+		REQUIRE(mem.read32(crsAddr + 0x240) == croAddr + 0x410);
+		REQUIRE(mem.read8(crsAddr + 0x1C0 + 6) == 1);
+		REQUIRE(mem.read32(crsAddr + Header::PrevCRO) == croAddr);
+
+		linker.unloadCRO(croAddr);
+		REQUIRE(linker.getModule(croAddr) == nullptr);
+
+		// Imports of the CRO and of the CRS now point to the unresolved handler of their module
+		REQUIRE(mem.read32(croAddr + 0x520) == croAddr + 0x400);
+		REQUIRE(mem.read8(croAddr + 0x1C0 + 6) == 0);
+		REQUIRE(mem.read32(crsAddr + 0x240) == crsAddr + 0x200);
+		REQUIRE(mem.read8(crsAddr + 0x1C0 + 6) == 0);
+		REQUIRE(mem.read32(crsAddr + Header::PrevCRO) == 0);
+
+		// Everything except the contents of .data is back to how it was before loading, so the CRO can be loaded again
+		std::vector<u8> unloaded = fixture.read(croAddr);
+		std::memcpy(&unloaded[0x500], &original[0x500], 0x100);
+		REQUIRE(unloaded == original);
+	}
+}
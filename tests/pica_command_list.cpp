@@ -0,0 +1,181 @@
+#include <PICA/gpu.hpp>
+#include <PICA/regs.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <config.hpp>
+#include <kernel/fcram.hpp>
+#include <memory.hpp>
+#include <vector>
+
+using namespace PICA;
+
+// A minimal GPU setup, with the null renderer so that no graphics context is needed
+struct CommandListFixture {
+	EmulatorConfig config;
+	KFcram fcram;
+	Memory memory;
+	GPU gpu;
+
+	CommandListFixture() : config(makeConfig()), fcram(memory), memory(fcram, config), gpu(memory, config) { gpu.reset(); }
+
+	static EmulatorConfig makeConfig() {
+		EmulatorConfig config("");
+		config.rendererType = RendererType::Null;
+		config.accelerateShaders = false;
+		return config;
+	}
+};
+
+class CommandListBuilder {
+	std::vector<u32> words;
+
+  public:
+	// Write "values" to consecutive registers starting at "id", or to the same register if consecutive is false
+	void write(u32 id, const std::vector<u32>& values, u32 maskIndex = 0xf, bool consecutive = true) {
+		const u32 extraParams = u32(values.size()) - 1;
+		words.push_back(values[0]);
+		words.push_back(id | (maskIndex << 16) | (extraParams << 20) | (consecutive ? (1u << 31) : 0));
+		words.insert(words.end(), values.begin() + 1, values.end());
+
+		// Commands are 8-byte aligned
+		if (words.size() % 2 != 0) {
+			words.push_back(0);
+		}
+	}
+
+	void write(u32 id, u32 value, u32 maskIndex = 0xf) { write(id, std::vector<u32>{value}, maskIndex); }
+
+	std::vector<u32>& get() { return words; }
+	u32 sizeInBytes() const { return u32(words.size() * sizeof(u32)); }
+};
+
+// Builds a command list resembling what games submit between draws: Viewport, TEV, texture and framebuffer config
+static CommandListBuilder buildTypicalCommandList() {
+	CommandListBuilder builder;
+	builder.write(InternalRegs::ViewportWidth, {0x45E000, 0x38111111, 0x469000, 0x3747AE14});
+	builder.write(InternalRegs::DepthScale, 0xBF8000);
+	builder.write(InternalRegs::DepthOffset, 0x000000);
+	builder.write(InternalRegs::ViewportXY, 0);
+	builder.write(InternalRegs::TexUnitCfg, 0x00011001);
+
+	for (u32 stage = 0; stage < 6; stage++) {
+		const u32 base = stage < 4 ? 0xC0 + stage * 8 : 0xF0 + (stage - 4) * 8;
+		builder.write(base, {0x00E30E30 + stage, 0x00000000, 0x00010001, 0xFF000000 | stage, 0x00000000});
+	}
+
+	builder.write(InternalRegs::TexEnvBufferColor, 0xFF00FF00);
+	// Partial masked write, as well as a non-consecutive write to the same register
+	builder.write(InternalRegs::TexEnvUpdateBuffer, 0x0000FF00, 0x2);
+	builder.write(InternalRegs::DepthmapEnable, {1, 0, 1}, 0xf, false);
+	return builder;
+}
+
+TEST_CASE("Bulk command list decoding matches per-register decoding", "[pica][command-list]") {
+	CommandListFixture fast;
+	CommandListFixture reference;
+	CommandListBuilder builder = buildTypicalCommandList();
+
+	fast.gpu.runCommandList(builder.get().data(), builder.sizeInBytes());
+
+	// Apply the same writes through the slow path
+	const auto& words = builder.get();
+	for (usize i = 0; i < words.size();) {
+		const u32 param1 = words[i++];
+		const u32 header = words[i++];
+		const u32 id = header & 0xffff;
+		const u32 maskIndex = (header >> 16) & 0xf;
+		const u32 paramCount = (header >> 20) & 0xff;
+		const bool consecutive = (header >> 31) != 0;
+
+		u32 mask = 0;
+		for (u32 bit = 0; bit < 4; bit++) {
+			if (maskIndex & (1 << bit)) {
+				mask |= 0xffu << (bit * 8);
+			}
+		}
+
+		reference.gpu.writeInternalReg(id, param1, mask);
+		for (u32 p = 0; p < paramCount; p++) {
+			reference.gpu.writeInternalReg(consecutive ? id + p + 1 : id, words[i++], mask);
+		}
+
+		i += i % 2;
+	}
+
+	const auto& fastRegs = fast.gpu.getRegisters();
+	const auto& referenceRegs = reference.gpu.getRegisters();
+	for (u32 i = 0; i < fastRegs.size(); i++) {
+		INFO("Register " << i);
+		REQUIRE(fastRegs[i] == referenceRegs[i]);
+	}
+
+	REQUIRE((fast.gpu.getDirtyRegGroups() & DirtyRegs::Rasterizer) != 0);
+	REQUIRE((fast.gpu.getDirtyRegGroups() & DirtyRegs::Texturing) != 0);
+	REQUIRE((fast.gpu.getDirtyRegGroups() & DirtyRegs::TexEnv) != 0);
+}
+
+TEST_CASE("Dirty register groups", "[pica][command-list]") {
+	REQUIRE(DirtyRegs::groupOf(InternalRegs::ViewportWidth) == DirtyRegs::Rasterizer);
+	REQUIRE(DirtyRegs::groupOf(InternalRegs::TexEnvBufferColor) == DirtyRegs::TexEnv);
+	REQUIRE(DirtyRegs::groupOf(InternalRegs::VertexShaderEntrypoint) == DirtyRegs::VertexShader);
+
+	REQUIRE(DirtyRegs::groupsInRange(0x41, 0x44) == DirtyRegs::Rasterizer);
+	REQUIRE(DirtyRegs::groupsInRange(0x7F, 0xC0) == (DirtyRegs::Rasterizer | DirtyRegs::Texturing | DirtyRegs::TexEnv));
+	REQUIRE(DirtyRegs::groupsInRange(0x00, 0x2FF) == DirtyRegs::All);
+
+	// Nothing has been drawn since the reset, so everything should still be dirty after running a command list
+	CommandListFixture fixture;
+	CommandListBuilder builder = buildTypicalCommandList();
+	fixture.gpu.runCommandList(builder.get().data(), builder.sizeInBytes());
+	REQUIRE(fixture.gpu.getDirtyRegGroups() == DirtyRegs::All);
+}
+
+// Sets up a vertex shader that does nothing and a single fixed vertex attribute, so that draws don't need any vertex data in memory
+static void setupTrivialDraw(CommandListBuilder& builder) {
+	builder.write(InternalRegs::VertexShaderTransferIndex, 0);
+	builder.write(InternalRegs::VertexShaderData0, 0x88000000);  // END
+	builder.write(InternalRegs::AttribFormatHigh, 1 << 16);
+	builder.write(InternalRegs::VertexCountReg, 3);
+}
+
+TEST_CASE("Consecutive draws with the same state are batched", "[pica][command-list]") {
+	CommandListFixture fixture;
+	CommandListBuilder builder;
+	setupTrivialDraw(builder);
+
+	builder.write(InternalRegs::SignalDrawArrays, 1);
+	builder.write(InternalRegs::SignalDrawArrays, 1);
+	// Vertex pipeline state doesn't affect the already shaded vertices, so it doesn't break the batch
+	builder.write(InternalRegs::VertexCountReg, 6);
+	builder.write(InternalRegs::SignalDrawArrays, 1);
+	// Viewport changes do
+	builder.write(InternalRegs::ViewportXY, 0x10);
+	builder.write(InternalRegs::SignalDrawArrays, 1);
+
+	fixture.gpu.runCommandList(builder.get().data(), builder.sizeInBytes());
+	fixture.gpu.display();
+
+	REQUIRE(fixture.gpu.getDrawBatchStats().drawsIn == 4);
+	REQUIRE(fixture.gpu.getDrawBatchStats().drawsOut == 2);
+}
+
+TEST_CASE("Command list replay", "[.][benchmark][pica][command-list]") {
+	CommandListFixture fixture;
+	CommandListBuilder builder;
+
+	// Concatenate a bunch of typical command lists with varying values, so that every replay has actual changes to apply
+	for (u32 i = 0; i < 256; i++) {
+		CommandListBuilder list = buildTypicalCommandList();
+		auto& words = list.get();
+		words[0] += i;
+		builder.get().insert(builder.get().end(), words.begin(), words.end());
+	}
+
+	auto& words = builder.get();
+	const u32 size = builder.sizeInBytes();
+
+	BENCHMARK("Replay 256 command lists") {
+		fixture.gpu.runCommandList(words.data(), size);
+		return fixture.gpu.getDirtyRegGroups();
+	};
+}
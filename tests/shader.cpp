@@ -369,3 +369,127 @@ SHADER_TEST_CASE("Address Register Offset", "[video_core][shader][shader_jit]")
 	REQUIRE(shader->runVector({-127.f}) == floatUniforms[41]);
 	REQUIRE(shader->runVector({-129.f}) == floatUniforms[40]);
 }
+
+TEST_CASE("Code hash only covers reachable code", "[shader][vertex][hash]") {
+	const auto shader = assembleVertexShader({
+		{nihstro::OpCode::Id::ADD, output0, input0, input1},
+		{nihstro::OpCode::Id::END},
+	});
+	const PICAShader::Hash hash = shader->getCodeHash();
+
+	// Writing past the END instruction doesn't change the program
+	shader->setBufferIndex(0x100);
+	shader->uploadWord(0xDEADBEEF);
+	REQUIRE(shader->getCodeHash() == hash);
+
+	// Neither does re-uploading the exact same code
+	shader->setBufferIndex(0);
+	shader->uploadWord(shader->loadedShader[0]);
+	REQUIRE(shader->getCodeHash() == hash);
+
+	// Starting from another entrypoint gives us a different program
+	shader->entrypoint = 0x100;
+	REQUIRE(shader->getCodeHash() != hash);
+	shader->entrypoint = 0;
+	REQUIRE(shader->getCodeHash() == hash);
+
+	// Modifying reachable code does
+	const u32 firstInstruction = shader->loadedShader[0];
+	shader->setBufferIndex(0);
+	shader->uploadWord(firstInstruction ^ 1);
+	REQUIRE(shader->getCodeHash() != hash);
+
+	shader->setBufferIndex(0);
+	shader->uploadWord(firstInstruction);
+	REQUIRE(shader->getCodeHash() == hash);
+}
+
+#if defined(PANDA3DS_SHADER_JIT_SUPPORTED)
+TEST_CASE("Shader JIT evicts the least recently used shaders when the arena is full", "[shader][jit]") {
+	const auto add = assembleVertexShader({
+		{nihstro::OpCode::Id::ADD, output0, input0, input1},
+		{nihstro::OpCode::Id::END},
+	});
+	const auto mul = assembleVertexShader({
+		{nihstro::OpCode::Id::MUL, output0, input0, input1},
+		{nihstro::OpCode::Id::END},
+	});
+	const auto max = assembleVertexShader({
+		{nihstro::OpCode::Id::MAX, output0, input0, input1},
+		{nihstro::OpCode::Id::END},
+	});
+
+	// Make the arena big enough for 2 of these shaders, but not 3
+	ShaderJIT probe;
+	probe.prepare(*add);
+	const usize shaderSize = probe.getMemoryStats().arenaUsed;
+
+	ShaderJIT shaderJit;
+	shaderJit.setAccurateMul(true);
+	shaderJit.setMemoryBudget(shaderSize * 2 + shaderSize / 2);
+	shaderJit.prepare(*add);
+	shaderJit.prepare(*mul);
+	REQUIRE(shaderJit.getMemoryStats().cachedShaders == 2);
+	REQUIRE(shaderJit.getMemoryStats().evictions == 0);
+
+	// Using the ADD shader again makes MUL the least recently used one, so that's what has to go to make room for MAX
+	shaderJit.prepare(*add);
+	shaderJit.prepare(*max);
+	auto stats = shaderJit.getMemoryStats();
+	REQUIRE(stats.compilations == 3);
+	REQUIRE(stats.evictions == 1);
+	REQUIRE(stats.cachedShaders == 2);
+	REQUIRE(stats.arenaUsed <= stats.arenaCapacity);
+
+	shaderJit.prepare(*add);
+	REQUIRE(shaderJit.getMemoryStats().compilations == 3);
+	shaderJit.prepare(*mul);
+	stats = shaderJit.getMemoryStats();
+	REQUIRE(stats.compilations == 4);
+	REQUIRE(stats.evictions == 2);
+
+	// The shader that survived the evictions still runs the right code
+	shaderJit.prepare(*add);
+	add->inputs[0] = vectorOnes;
+	add->inputs[1] = vectorOnes;
+	shaderJit.run(*add);
+	REQUIRE(add->outputs[0][0].toFloat32() == 2.0f);
+}
+
+TEST_CASE("Shader JIT caps the number of cached shaders in LRU order", "[shader][jit]") {
+	// The same code with different operand descriptors that the code never uses. These all share one block of code, so they never fill
+	// up the arena and only the cap on the number of shaders keeps the cache from growing
+	std::array<std::unique_ptr<PICAShader>, 3> shaders;
+	for (u32 i = 0; i < shaders.size(); i++) {
+		shaders[i] = assembleVertexShader({
+			{nihstro::OpCode::Id::ADD, output0, input0, input1},
+			{nihstro::OpCode::Id::END},
+		});
+		shaders[i]->setOpDescriptorIndex(0x10);
+		shaders[i]->uploadDescriptor(i + 1);
+	}
+
+	ShaderJIT shaderJit;
+	shaderJit.setMaxCachedShaders(2);
+	shaderJit.prepare(*shaders[0]);
+	const usize shaderSize = shaderJit.getMemoryStats().arenaUsed;
+	shaderJit.prepare(*shaders[1]);
+	shaderJit.prepare(*shaders[0]);
+	shaderJit.prepare(*shaders[2]);
+
+	auto stats = shaderJit.getMemoryStats();
+	REQUIRE(stats.compilations == 3);
+	REQUIRE(stats.dedupHits == 2);
+	REQUIRE(stats.uniqueBlocks == 1);
+	REQUIRE(stats.arenaUsed == shaderSize);
+	REQUIRE(stats.cachedShaders == 2);
+	REQUIRE(stats.evictions == 1);
+
+	// Shader 1 was the least recently used one when shader 2 came in
+	shaderJit.prepare(*shaders[0]);
+	REQUIRE(shaderJit.getMemoryStats().compilations == 3);
+	shaderJit.prepare(*shaders[1]);
+	REQUIRE(shaderJit.getMemoryStats().compilations == 4);
+	REQUIRE(shaderJit.getMemoryStats().evictions == 2);
+}
+#endif
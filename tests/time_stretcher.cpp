@@ -0,0 +1,145 @@
+#include <audio/time_stretcher.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <memory>
+#include <numbers>
+#include <vector>
+
+namespace {
+	using Audio::TimeStretcher;
+	constexpr double toneFrequency = 440.0;
+
+	// Generates a stereo sine wave, one chunk at a time
+	struct ToneGenerator {
+		usize frame = 0;
+
+		std::vector<s16> generate(usize frames) {
+			std::vector<s16> out;
+			for (usize i = 0; i < frames; i++, frame++) {
+				const double phase = 2.0 * std::numbers::pi * toneFrequency * double(frame) / double(TimeStretcher::sampleRate);
+				const s16 sample = s16(std::lround(10000.0 * std::sin(phase)));
+				out.push_back(sample);
+				out.push_back(sample);
+			}
+
+			return out;
+		}
+	};
+
+	// Estimate the frequency of the left channel by counting rising zero crossings
+	double measureFrequency(const std::vector<s16>& samples) {
+		usize crossings = 0;
+		for (usize i = 2; i < samples.size(); i += 2) {
+			if (samples[i - 2] < 0 && samples[i] >= 0) {
+				crossings++;
+			}
+		}
+
+		return double(crossings) * double(TimeStretcher::sampleRate) / double(samples.size() / 2);
+	}
+
+	struct SimulationResult {
+		std::vector<s16> output;  // Audio output after the stretcher settled
+		double averageRatio = 0.0;
+		usize droppedFrames = 0;  // Frames dropped after the stretcher settled
+	};
+
+	// Produce audio at the specified speed, in bursts of one emulated frame's worth of audio like the emulator does, while the device consumes
+	// it in fixed-size chunks. Only the second half of the simulation is measured, once the ratio settled
+	SimulationResult simulate(TimeStretcher& stretcher, TimeStretcher::Samples& samples, double speed, usize seconds) {
+		ToneGenerator generator;
+		SimulationResult result;
+		std::vector<s16> chunk(512 * 2);
+		const usize chunks = seconds * TimeStretcher::sampleRate / 512;
+
+		constexpr usize framesPerVideoFrame = TimeStretcher::sampleRate / 60;
+		double produced = 0.0;
+		usize consumed = 0;
+		double ratioSum = 0.0;
+		usize droppedBeforeSettling = 0;
+
+		for (usize i = 0; i < chunks; i++) {
+			// Produce audio until we're caught up with the device
+			while (produced < double(consumed) * speed) {
+				const auto frame = generator.generate(framesPerVideoFrame);
+				// Like the DSP, drop audio that doesn't fit instead of waiting
+				if (samples.size() + frame.size() <= samples.Capacity()) {
+					samples.push(frame.data(), frame.size());
+				}
+
+				produced += framesPerVideoFrame;
+			}
+
+			if (i == chunks / 2) {
+				droppedBeforeSettling = stretcher.getDroppedFrames();
+			}
+
+			const usize written = stretcher.process(samples, chunk.data(), 512);
+			consumed += 512;
+
+			if (i >= chunks / 2) {
+				REQUIRE(written == 512);
+				result.output.insert(result.output.end(), chunk.begin(), chunk.end());
+				ratioSum += stretcher.getRatio();
+			}
+		}
+
+		result.averageRatio = ratioSum / double(chunks - chunks / 2);
+		result.droppedFrames = stretcher.getDroppedFrames() - droppedBeforeSettling;
+		return result;
+	}
+}  // namespace
+
+TEST_CASE("Time stretcher passes full speed audio through unchanged", "[audio]") {
+	auto stretcher = std::make_unique<TimeStretcher>();
+	auto samples = std::make_unique<TimeStretcher::Samples>();
+
+	const auto result = simulate(*stretcher, *samples, 1.0, 4);
+	REQUIRE(std::abs(result.averageRatio - 1.0) < 0.05);
+	REQUIRE(std::abs(measureFrequency(result.output) - toneFrequency) < 5.0);
+	REQUIRE(stretcher->getDroppedFrames() == 0);
+}
+
+TEST_CASE("Time stretcher keeps the pitch when emulation runs fast or slow", "[audio]") {
+	for (double speed : {0.7, 2.0, 3.0}) {
+		auto stretcher = std::make_unique<TimeStretcher>();
+		auto samples = std::make_unique<TimeStretcher::Samples>();
+
+		const auto result = simulate(*stretcher, *samples, speed, 6);
+
+		// The stretcher consumes audio as fast as it's produced, without the buffer running empty or overflowing
+		REQUIRE(std::abs(result.averageRatio - speed) < speed * 0.05);
+		REQUIRE(result.droppedFrames == 0);
+		REQUIRE(std::abs(measureFrequency(result.output) - toneFrequency) < toneFrequency * 0.03);
+	}
+}
+
+TEST_CASE("Time stretcher drops audio it can't keep up with", "[audio]") {
+	auto stretcher = std::make_unique<TimeStretcher>();
+	auto samples = std::make_unique<TimeStretcher::Samples>();
+
+	// Far faster than the max ratio, eg unlimited fast-forward
+	const auto result = simulate(*stretcher, *samples, 10.0, 4);
+	REQUIRE(result.averageRatio > TimeStretcher::maxRatio * 0.95);
+	REQUIRE(result.droppedFrames != 0);
+	REQUIRE(samples->size() / 2 <= TimeStretcher::maxLatency);
+	REQUIRE(std::abs(measureFrequency(result.output) - toneFrequency) < toneFrequency * 0.05);
+}
+
+TEST_CASE("Time stretcher doesn't block when out of audio", "[audio]") {
+	auto stretcher = std::make_unique<TimeStretcher>();
+	auto samples = std::make_unique<TimeStretcher::Samples>();
+	std::vector<s16> output(512 * 2);
+
+	REQUIRE(stretcher->process(*samples, output.data(), 512) == 0);
+
+	// Not enough for a whole segment yet
+	ToneGenerator generator;
+	const auto tone = generator.generate(TimeStretcher::segmentLength - 1);
+	samples->push(tone.data(), tone.size());
+	REQUIRE(stretcher->process(*samples, output.data(), 512) == 0);
+
+	const auto more = generator.generate(TimeStretcher::segmentLength);
+	samples->push(more.data(), more.size());
+	REQUIRE(stretcher->process(*samples, output.data(), 512) != 0);
+}
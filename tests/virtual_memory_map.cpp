@@ -0,0 +1,321 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <kernel/fcram.hpp>
+#include <kernel/virtual_memory_map.hpp>
+#include <list>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace {
+	constexpr u32 userPages = 0x40000000 >> 12;
+
+	// The list-based region tracking Memory used before, kept around to check that the interval map gives the same results
+	struct ReferenceMemoryMap {
+		struct Block {
+			u32 baseAddr;
+			u32 pages;
+			u32 perms;
+			u32 state;
+
+			u32 end() const { return baseAddr + (pages << 12); }
+		};
+
+		std::list<Block> blocks = {Block{0, userPages, 0, 0}};
+
+		bool change(u32 vaddr, s32 pages, std::optional<u32> perms, std::optional<u32> state) {
+			bool blockFound = false;
+
+			for (auto it = blocks.begin(); it != blocks.end(); it++) {
+				u32 blockStart = it->baseAddr;
+				u32 blockEnd = it->end();
+
+				u32 reqStart = vaddr;
+				u32 reqEnd = vaddr + (pages << 12);
+
+				if (!(reqStart >= blockStart && reqEnd <= blockEnd)) continue;
+
+				auto oldState = it->state;
+				u32 oldPerms = it->perms;
+				it->baseAddr = reqStart;
+				it->pages = pages;
+				if (perms) it->perms = *perms;
+				if (state) it->state = *state;
+
+				if (blockStart < reqStart) {
+					blocks.insert(it, Block{blockStart, (reqStart - blockStart) >> 12, oldPerms, oldState});
+				}
+
+				if (reqEnd < blockEnd) {
+					blocks.insert(std::next(it), Block{reqEnd, (blockEnd - reqEnd) >> 12, oldPerms, oldState});
+				}
+
+				blockFound = true;
+				break;
+			}
+
+			for (auto it = blocks.begin(); it != blocks.end();) {
+				auto next = std::next(it);
+				if (next == blocks.end()) break;
+
+				if (it->state != next->state || it->perms != next->perms) {
+					it++;
+					continue;
+				}
+
+				next->baseAddr = it->baseAddr;
+				next->pages += it->pages;
+				it = blocks.erase(it);
+			}
+
+			return blockFound;
+		}
+
+		const Block* query(u32 vaddr) const {
+			for (auto& block : blocks) {
+				if (vaddr >= block.baseAddr && vaddr < block.end()) {
+					return &block;
+				}
+			}
+
+			return nullptr;
+		}
+
+		bool testState(u32 vaddr, s32 pages, u32 state) const {
+			for (auto& block : blocks) {
+				if (vaddr >= block.end()) continue;
+				if (block.state != state) return false;
+				if (block.end() >= vaddr + (pages << 12)) return true;
+			}
+
+			return false;
+		}
+	};
+
+	bool sameRegions(const VirtualMemoryMap& map, const ReferenceMemoryMap& reference) {
+		if (map.size() != reference.blocks.size()) {
+			return false;
+		}
+
+		auto block = reference.blocks.begin();
+		for (auto it = map.begin(); it != map.end(); it++, block++) {
+			if (it->first != block->baseAddr || it->second.pages != block->pages || it->second.perms != block->perms ||
+				it->second.state != block->state) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// The list-based FCRAM allocator used before. It couldn't free memory
+	struct ReferenceFcramRegion {
+		struct Block {
+			s32 pages;
+			s32 pageOffset;
+			bool used;
+		};
+
+		std::list<Block> blocks;
+		u32 start;
+
+		ReferenceFcramRegion(u32 start, s32 pages) : blocks({Block{pages, 0, false}}), start(start) {}
+
+		std::list<FcramBlock> alloc(s32 allocPages, bool linear) {
+			std::list<FcramBlock> out;
+			for (auto it = blocks.begin(); it != blocks.end(); it++) {
+				if (it->used) continue;
+				if (it->pages < allocPages && linear) continue;
+
+				if (it->pages > allocPages) {
+					blocks.insert(it, Block{it->pages - allocPages, it->pageOffset + allocPages, false});
+					it->pages = allocPages;
+				}
+
+				it->used = true;
+				allocPages -= it->pages;
+				out.push_back(FcramBlock(start + (it->pageOffset << 12), it->pages));
+
+				if (allocPages < 1) break;
+			}
+
+			return out;
+		}
+	};
+
+	// Allocate pages from a region and return the blocks that were used
+	std::list<FcramBlock> allocate(KFcram::Region& region, s32 pages, bool linear) {
+		std::list<FcramBlock> out;
+		region.alloc(out, pages, linear);
+		return out;
+	}
+}  // namespace
+
+TEST_CASE("Virtual memory map matches the list implementation", "[memory]") {
+	VirtualMemoryMap map;
+	ReferenceMemoryMap reference;
+	map.reset(userPages, 0, 0);
+
+	// Work on a small window of the address space so that changes overlap and regions get split and merged a lot
+	std::mt19937 rng(1234);
+	constexpr u32 windowPages = 256;
+	constexpr u32 windowStart = 0x08000000;
+
+	for (int i = 0; i < 5000; i++) {
+		const u32 firstPage = rng() % windowPages;
+		const s32 pages = s32(1 + rng() % std::min<u32>(16, windowPages - firstPage));
+		const u32 vaddr = windowStart + (firstPage << 12);
+
+		// Only a few different states and permissions, so that neighbouring regions often end up identical
+		std::optional<u32> perms = std::nullopt;
+		std::optional<u32> state = std::nullopt;
+		if (rng() % 4 != 0) perms = rng() % 3;
+		if (perms == std::nullopt || rng() % 2 == 0) state = rng() % 3;
+
+		// The list implementation changes the range when it fits in a single block, so check that first
+		const auto containing = reference.query(vaddr);
+		const bool fits = containing != nullptr && vaddr + (u32(pages) << 12) <= containing->end();
+
+		if (fits) {
+			REQUIRE(map.change(vaddr, pages, perms, state));
+			reference.change(vaddr, pages, perms, state);
+		} else {
+			REQUIRE(!map.change(vaddr, pages, perms, state));
+		}
+
+		REQUIRE(sameRegions(map, reference));
+
+		const u32 queryAddress = windowStart - 0x1000 + (rng() % (windowPages + 2)) * 0x1000 + rng() % 0x1000;
+		const auto it = map.find(queryAddress);
+		const auto block = reference.query(queryAddress);
+		REQUIRE(it != map.end());
+		REQUIRE(it->first == block->baseAddr);
+		REQUIRE(it->second.pages == block->pages);
+
+		const u32 testState = rng() % 3;
+		REQUIRE(map.testState(vaddr, pages, testState) == reference.testState(vaddr, pages, testState));
+	}
+
+	REQUIRE(map.find(0x40000000) == map.end());
+	REQUIRE(!map.testState(0x40000000, 1, 0));
+}
+
+TEST_CASE("Changing an empty range of virtual memory does nothing", "[memory]") {
+	VirtualMemoryMap map;
+	map.reset(userPages, 0, 0);
+	REQUIRE(map.change(0x08000000, 4, 1, 1));
+
+	REQUIRE(map.change(0x08001000, 0, 2, 2));
+	REQUIRE(map.change(0x08001000, -1, 2, 2));
+	REQUIRE(map.size() == 3);
+	REQUIRE(map.testState(0x08000000, 4, 1));
+}
+
+TEST_CASE("FCRAM regions allocate first-fit and coalesce freed pages", "[memory]") {
+	KFcram::Region region;
+	region.reset(0x100000, 64 * 0x1000);
+
+	auto a = allocate(region, 8, false);
+	auto b = allocate(region, 8, true);
+	auto c = allocate(region, 8, false);
+	REQUIRE(a.front().paddr == 0x100000);
+	REQUIRE(b.front().paddr == 0x108000);
+	REQUIRE(c.front().paddr == 0x110000);
+	REQUIRE(region.getFreeCount() == 40);
+
+	// Free the middle allocation. Linear allocations that are too big for the hole skip it, while non-linear ones are split across holes
+	region.free(0x108000, 8);
+	REQUIRE(region.getFreeBlockCount() == 2);
+
+	auto linear = allocate(region, 12, true);
+	REQUIRE(linear.size() == 1);
+	REQUIRE(linear.front().paddr == 0x118000);
+
+	auto split = allocate(region, 10, false);
+	REQUIRE(split.size() == 2);
+	REQUIRE(split.front().paddr == 0x108000);
+	REQUIRE(split.front().pages == 8);
+	REQUIRE(split.back().paddr == 0x124000);
+	REQUIRE(split.back().pages == 2);
+
+	// Freeing everything merges the region back into a single block
+	for (auto* list : {&a, &c, &linear, &split}) {
+		for (auto& block : *list) {
+			region.free(block.paddr, block.pages);
+		}
+	}
+
+	REQUIRE(region.getFreeCount() == 64);
+	REQUIRE(region.getUsedCount() == 0);
+	REQUIRE(region.getFreeBlockCount() == 1);
+	REQUIRE(allocate(region, 64, true).front().paddr == 0x100000);
+}
+
+TEST_CASE("FCRAM allocations match the list implementation", "[memory]") {
+	KFcram::Region region;
+	ReferenceFcramRegion reference(0x100000, 4096);
+	region.reset(0x100000, 4096 * 0x1000);
+
+	std::mt19937 rng(5678);
+	s32 freePages = 4096;
+	while (freePages > 64) {
+		const s32 pages = s32(1 + rng() % 64);
+		const bool linear = rng() % 2 == 0;
+
+		const auto blocks = allocate(region, pages, linear);
+		const auto expected = reference.alloc(pages, linear);
+		REQUIRE(blocks.size() == expected.size());
+
+		for (auto it = blocks.begin(), expectedIt = expected.begin(); it != blocks.end(); it++, expectedIt++) {
+			REQUIRE(it->paddr == expectedIt->paddr);
+			REQUIRE(it->pages == expectedIt->pages);
+		}
+
+		freePages -= pages;
+		REQUIRE(region.getFreeCount() == u32(freePages));
+	}
+}
+
+TEST_CASE("Virtual memory queries", "[.][benchmark][memory]") {
+	// A process with lots of mappings: every other page of a 16MB heap has different permissions, like a game that mprotects lots of small
+	// buffers, for 2048 regions
+	VirtualMemoryMap map;
+	ReferenceMemoryMap reference;
+	map.reset(userPages, 0, 0);
+
+	constexpr u32 heapStart = 0x08000000;
+	constexpr u32 heapPages = 4096;
+	map.change(heapStart, heapPages, 3, 1);
+	reference.change(heapStart, heapPages, 3, 1);
+
+	for (u32 page = 0; page < heapPages; page += 2) {
+		map.change(heapStart + (page << 12), 1, 1, std::nullopt);
+		reference.change(heapStart + (page << 12), 1, 1, std::nullopt);
+	}
+
+	std::vector<u32> addresses;
+	std::mt19937 rng(42);
+	for (int i = 0; i < 1024; i++) {
+		addresses.push_back(heapStart + (rng() % heapPages) * 0x1000);
+	}
+
+	BENCHMARK("Interval map") {
+		u32 pages = 0;
+		for (u32 address : addresses) {
+			pages += map.find(address)->second.pages;
+			pages += map.testState(address, 1, 1);
+		}
+
+		return pages;
+	};
+
+	BENCHMARK("List") {
+		u32 pages = 0;
+		for (u32 address : addresses) {
+			pages += reference.query(address)->pages;
+			pages += reference.testState(address, 1, 1);
+		}
+
+		return pages;
+	};
+}